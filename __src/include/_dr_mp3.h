@@ -0,0 +1,3 @@
+#pragma once
+
+#include <dr_mp3.h>
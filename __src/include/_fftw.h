@@ -10,3 +10,5 @@ double A_weighting_db( double f );
 
 typedef std::pair< double, double > SplinePoint;
 SplinePoint catmullRom( SplinePoint const& p0, SplinePoint const& p1, SplinePoint const& p2, SplinePoint const& p3, double t );
+// weights w such that `catmullRom( p0, p1, p2, p3, t ).second == sum( w[k] * pk.second )`
+void catmullRom_weights( double t, double weights[4] );
@@ -0,0 +1,6 @@
+#pragma once
+
+// stb_vorbis is a single .c file, only its declarations here
+#define STB_VORBIS_HEADER_ONLY
+#include <stb_vorbis.c>
+#undef STB_VORBIS_HEADER_ONLY
@@ -0,0 +1,163 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "mappedFile.h"
+
+// 64 bit xxhash (XXH64) of `size` bytes
+uint64_t hash_bytes( void const* data, size_t size, uint64_t seed = 0 );
+
+// four character section tag, e.g. `analysis_cache_tag( "RMS " )`
+constexpr uint32_t analysis_cache_tag( char const ( &name )[5] ) {
+  return uint32_t( uint8_t( name[0] ) ) | ( uint32_t( uint8_t( name[1] ) ) << 8 ) | ( uint32_t( uint8_t( name[2] ) ) << 16 )
+         | ( uint32_t( uint8_t( name[3] ) ) << 24 );
+}
+
+// identity of an analysis, everything that went into it is folded into one 64 bit value in the order it is added
+class AnalysisCacheKey {
+  public:
+  AnalysisCacheKey& add_bytes( void const* data, size_t size );
+  AnalysisCacheKey& add( std::string_view value );
+  template < typename T >
+    requires( std::is_arithmetic_v< T > || std::is_enum_v< T > )
+  AnalysisCacheKey& add( T value ) {
+    return add_bytes( &value, sizeof( T ) );
+  }
+  // folds in the contents of the file, returns false if it can not be read
+  bool add_file( std::filesystem::path const& file_path );
+
+  uint64_t value() const { return value_; }
+
+  private:
+  uint64_t value_ = 0;
+};
+
+// the cache file is a header (magic, format version, key, section amount), a table of (tag, element size, offset, byte size) entries
+// and the sections themselves, each starting on a 64 byte boundary so they can be read in place from the mapping.
+// everything is stored in the native byte order, a file from a machine with the other one fails the magic check.
+class AnalysisCacheWriter {
+  public:
+  explicit AnalysisCacheWriter( uint64_t key );
+
+  // `values` are not copied, they have to stay alive until `write`
+  template < typename T >
+  void add_section( uint32_t tag, T const* values, size_t amount ) {
+    static_assert( std::is_trivially_copyable_v< T > );
+    add_section_bytes( tag, sizeof( T ), values, amount * sizeof( T ) );
+  }
+  template < typename T >
+  void add_section( uint32_t tag, std::vector< T > const& values ) {
+    add_section( tag, values.data(), values.size() );
+  }
+
+  // writes a temporary file next to `file_path` and renames it, so a reader never sees half a file. returns if the file was written
+  bool write( std::filesystem::path const& file_path ) const;
+
+  private:
+  struct Section {
+    uint32_t tag;
+    uint32_t element_size;
+    void const* data;
+    size_t byte_size;
+  };
+
+  void add_section_bytes( uint32_t tag, size_t element_size, void const* data, size_t byte_size );
+
+  uint64_t key_;
+  std::vector< Section > sections_;
+};
+
+// writes a cache file of the same layout whose sections are produced piece by piece (e.g. segment by segment), so none of them is ever held whole.
+// the size of every section is declared up front, the file only appears under its name once `commit` succeeds, until then it is a temporary
+// file next to it that is removed if the writer goes away first.
+class AnalysisCacheStreamWriter {
+  public:
+  explicit AnalysisCacheStreamWriter( uint64_t key );
+  ~AnalysisCacheStreamWriter();
+
+  AnalysisCacheStreamWriter( AnalysisCacheStreamWriter const& ) = delete;
+  AnalysisCacheStreamWriter& operator=( AnalysisCacheStreamWriter const& ) = delete;
+
+  // declares the section `tag` of `amount` elements of `T`, before `open`
+  template < typename T >
+  void add_section( uint32_t tag, size_t amount ) {
+    static_assert( std::is_trivially_copyable_v< T > );
+    add_section_bytes( tag, sizeof( T ), amount * sizeof( T ) );
+  }
+
+  // creates the temporary file for `file_path` with the header, the section table and zeroed sections. returns if it was created
+  bool open( std::filesystem::path const& file_path );
+
+  // writes `amount` elements to the section `tag` from its element `element_offset` on. returns false if they do not fit or the write failed,
+  // after which `commit` fails too
+  template < typename T >
+  bool write( uint32_t tag, size_t element_offset, T const* values, size_t amount ) {
+    static_assert( std::is_trivially_copyable_v< T > );
+    return write_bytes( tag, sizeof( T ), element_offset * sizeof( T ), values, amount * sizeof( T ) );
+  }
+  template < typename T >
+  bool write( uint32_t tag, size_t element_offset, std::vector< T > const& values ) {
+    return write( tag, element_offset, values.data(), values.size() );
+  }
+
+  // renames the temporary file to `file_path`, nothing can be written after. returns if the file is in place
+  bool commit();
+
+  private:
+  struct Section {
+    uint32_t tag;
+    uint32_t element_size;
+    uint64_t offset;
+    uint64_t byte_size;
+  };
+
+  void add_section_bytes( uint32_t tag, size_t element_size, size_t byte_size );
+  bool write_bytes( uint32_t tag, size_t element_size, size_t byte_offset, void const* data, size_t byte_size );
+  // closes and removes the temporary file
+  void discard();
+
+  uint64_t key_;
+  std::vector< Section > sections_;
+  std::filesystem::path file_path_;
+  std::filesystem::path temp_path_;
+  std::ofstream file_stream_;
+  bool is_failed_ = false;
+};
+
+// maps a cache file and hands out its sections without copying them, they stay valid as long as the reader lives
+class AnalysisCacheReader {
+  public:
+  // returns if `file_path` is a cache file of this format version for `key`, anything else (missing, stale, damaged) is a miss
+  bool open( std::filesystem::path const& file_path, uint64_t key );
+
+  // the section `tag`, if it is there and holds elements of type `T`
+  template < typename T >
+  std::optional< std::span< T const > > section( uint32_t tag ) const {
+    static_assert( std::is_trivially_copyable_v< T > );
+    std::optional< std::span< uint8_t const > > bytes = section_bytes( tag, sizeof( T ) );
+    if( !bytes ) {
+      return std::nullopt;
+    }
+    return std::span< T const >( reinterpret_cast< T const* >( bytes->data() ), bytes->size() / sizeof( T ) );
+  }
+
+  private:
+  struct Section {
+    uint32_t tag;
+    uint32_t element_size;
+    std::span< uint8_t const > bytes;
+  };
+
+  std::optional< std::span< uint8_t const > > section_bytes( uint32_t tag, size_t element_size ) const;
+
+  MappedFile file_;
+  std::vector< Section > sections_;
+};
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "_dr_flac.h"
+#include "_dr_mp3.h"
+#include "_dr_wav.h"
+#include "_stb_vorbis.h"
+#include "mappedWavFile.h"
+#include "pcmSampleView.h"
+
+// every sample of an audio file: read in place from a mapping for the wav formats `MappedWavFile` supports, decoded otherwise.
+// `owner` keeps the mapping or the decoded buffer alive
+struct PcmSamples {
+  PcmSampleView view;
+  uint32_t sample_rate = 0;
+  std::shared_ptr< void const > owner = nullptr;
+};
+
+// returns false if `file_path` can not be read
+bool load_pcm_samples( std::filesystem::path const& file_path, PcmSamples& samples );
+
+// what the header of an audio file tells, without decoding it
+struct AudioFormat {
+  uint32_t channels = 0;
+  uint32_t sample_rate = 0;
+  uint64_t total_pcm_frame_count = 0;
+  // the samples can be read in place from a mapping (see `load_pcm_samples`), so they take no memory of their own
+  bool is_mapped = false;
+};
+
+// returns false if `file_path` can not be read. mp3 has no length in its header, so its length is estimated from the size of the file
+// and the bitrate of its first frame (exact for a constant bitrate) instead of decoding the whole file like `Mp3FileStream` does
+bool read_audio_format( std::filesystem::path const& file_path, AudioFormat& format );
+
+// the extensions `open_audio_stream` can decode, in the order `find_audio_file` looks for them
+extern std::vector< std::string > const AUDIO_FILE_EXTENSIONS;
+
+// `directory / stem` with the first of AUDIO_FILE_EXTENSIONS that exists, with ".wav" if none does
+std::filesystem::path find_audio_file( std::filesystem::path const& directory, std::string const& stem );
+
+// interleaved float frames of a decoded audio file, chunk by chunk instead of all at once,
+// so only the chunk being worked on has to be in memory
+class AudioStream {
+  public:
+  virtual ~AudioStream() = default;
+
+  virtual uint32_t channels() const = 0;
+  virtual uint32_t sample_rate() const = 0;
+  virtual uint64_t total_pcm_frame_count() const = 0;
+
+  // decodes up to `frame_amount` interleaved frames into `output` (`frame_amount * channels()` floats), returns how many were decoded, 0 at the end
+  virtual size_t read( float* output, size_t frame_amount ) = 0;
+  // back to the first frame, returns if that worked
+  virtual bool rewind() = 0;
+};
+
+// the decoder for the extension of `file_path`, nullptr if there is none or the file can not be decoded
+std::unique_ptr< AudioStream > open_audio_stream( std::filesystem::path const& file_path );
+
+// mappable formats are converted straight from the mapping, anything else is decoded by dr_wav
+class WavFileStream : public AudioStream {
+  public:
+  WavFileStream() = default;
+  ~WavFileStream() override;
+
+  WavFileStream( WavFileStream const& ) = delete;
+  WavFileStream& operator=( WavFileStream const& ) = delete;
+
+  // reads the header of `file_path`, an already open file is closed first. returns if the file can be decoded
+  bool open( std::filesystem::path const& file_path );
+  void close();
+
+  bool is_open() const { return mapped_wav_.is_open() || ( wav_ != nullptr ); }
+  uint32_t channels() const override;
+  uint32_t sample_rate() const override;
+  uint64_t total_pcm_frame_count() const override;
+
+  size_t read( float* output, size_t frame_amount ) override;
+  bool rewind() override;
+
+  private:
+  MappedWavFile mapped_wav_;
+  uint64_t mapped_position_ = 0;
+  std::unique_ptr< drwav > wav_ = nullptr;
+};
+
+class FlacFileStream : public AudioStream {
+  public:
+  FlacFileStream() = default;
+  ~FlacFileStream() override;
+
+  FlacFileStream( FlacFileStream const& ) = delete;
+  FlacFileStream& operator=( FlacFileStream const& ) = delete;
+
+  bool open( std::filesystem::path const& file_path );
+  void close();
+
+  bool is_open() const { return flac_ != nullptr; }
+  uint32_t channels() const override;
+  uint32_t sample_rate() const override;
+  uint64_t total_pcm_frame_count() const override;
+
+  size_t read( float* output, size_t frame_amount ) override;
+  bool rewind() override;
+
+  private:
+  drflac* flac_ = nullptr;
+};
+
+class Mp3FileStream : public AudioStream {
+  public:
+  Mp3FileStream() = default;
+  ~Mp3FileStream() override;
+
+  Mp3FileStream( Mp3FileStream const& ) = delete;
+  Mp3FileStream& operator=( Mp3FileStream const& ) = delete;
+
+  // mp3 has no length in its header, so this decodes the whole file once to count the frames
+  bool open( std::filesystem::path const& file_path );
+  void close();
+
+  bool is_open() const { return mp3_ != nullptr; }
+  uint32_t channels() const override;
+  uint32_t sample_rate() const override;
+  uint64_t total_pcm_frame_count() const override;
+
+  size_t read( float* output, size_t frame_amount ) override;
+  bool rewind() override;
+
+  private:
+  std::unique_ptr< drmp3 > mp3_ = nullptr;
+  uint64_t total_pcm_frame_count_ = 0;
+};
+
+class VorbisFileStream : public AudioStream {
+  public:
+  VorbisFileStream() = default;
+  ~VorbisFileStream() override;
+
+  VorbisFileStream( VorbisFileStream const& ) = delete;
+  VorbisFileStream& operator=( VorbisFileStream const& ) = delete;
+
+  bool open( std::filesystem::path const& file_path );
+  void close();
+
+  bool is_open() const { return vorbis_ != nullptr; }
+  uint32_t channels() const override;
+  uint32_t sample_rate() const override;
+  uint64_t total_pcm_frame_count() const override;
+
+  size_t read( float* output, size_t frame_amount ) override;
+  bool rewind() override;
+
+  private:
+  stb_vorbis* vorbis_ = nullptr;
+  uint32_t channels_ = 0;
+  uint32_t sample_rate_ = 0;
+};
+
+// decodes another stream on its own thread, at most `buffer_frames` frames ahead of `read`, so the decode of the next chunk
+// overlaps the analysis of the current one. reads block until the decoder caught up or reached the end
+class ThreadedAudioStream : public AudioStream {
+  public:
+  ThreadedAudioStream( std::unique_ptr< AudioStream > stream, size_t buffer_frames );
+  ~ThreadedAudioStream() override;
+
+  ThreadedAudioStream( ThreadedAudioStream const& ) = delete;
+  ThreadedAudioStream& operator=( ThreadedAudioStream const& ) = delete;
+
+  uint32_t channels() const override { return channels_; }
+  uint32_t sample_rate() const override { return sample_rate_; }
+  uint64_t total_pcm_frame_count() const override { return total_pcm_frame_count_; }
+
+  size_t read( float* output, size_t frame_amount ) override;
+  bool rewind() override;
+
+  private:
+  void start();
+  void stop();
+  void decode();
+
+  std::unique_ptr< AudioStream > stream_;
+  uint32_t channels_;
+  uint32_t sample_rate_;
+  uint64_t total_pcm_frame_count_;
+
+  // ring of interleaved frames, the positions count frames since the start and only ever grow
+  std::vector< float > buffer_;
+  size_t buffer_frames_;
+  size_t decode_chunk_frames_;
+  uint64_t read_position_ = 0;
+  uint64_t write_position_ = 0;
+  bool is_decode_finished_ = false;
+  bool is_stop_requested_ = false;
+
+  std::mutex mutex_;
+  std::condition_variable frames_available_;
+  std::condition_variable space_available_;
+  std::thread decode_thread_;
+};
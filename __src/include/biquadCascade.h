@@ -0,0 +1,56 @@
+#pragma once
+
+#include <Iir.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// a single second order section, normalized so that `a0 == 1`
+struct BiquadCoefficients {
+  double b0;
+  double b1;
+  double b2;
+  double a1;
+  double a2;
+};
+
+typedef std::vector< BiquadCoefficients > BiquadCascade;
+
+// appends the stages of a (set up) iir1 filter, so several designs can be chained into one cascade
+void append_biquad_cascade( BiquadCascade& cascade, Iir::Cascade& filter );
+
+// filters `frame_amount` frames of interleaved `channels` channel data through the cascade, every channel starting from a zero state.
+// transposed direct form II with double state, neighbouring channels run in SIMD lanes (4 with AVX, 2 with SSE2, the rest scalar).
+void filter_biquad_cascade( BiquadCascade const& cascade, float const* input, float* output, size_t frame_amount, size_t channels );
+
+// same result as `filter_biquad_cascade`, but block-parallel:
+// the signal is split into blocks which are filtered concurrently from a zero state, then the true initial state of every block is propagated serially
+// through the state transition matrix of the cascade (`A^block_length`, by repeated squaring), and every block gets the zero-input response of its
+// initial state added. this is exact for linear filters, up to rounding.
+// with fewer channels than SIMD lanes, every thread runs as many blocks side by side as fill the lanes, so a mono signal is vectorized as well.
+// `thread_count` of 0 uses `std::thread::hardware_concurrency()`, blocks but the last are never shorter than `min_block_size` frames.
+void filter_biquad_cascade_block_parallel( BiquadCascade const& cascade,
+                                           float const* input,
+                                           float* output,
+                                           size_t frame_amount,
+                                           size_t channels,
+                                           uint32_t thread_count = 0,
+                                           size_t min_block_size = 1 << 15 );
+
+// `filter_biquad_cascade` over a stream that arrives in chunks, the state of every channel is kept from one chunk to the next,
+// so all `process` calls together give the same output as one call over the whole stream
+class BiquadCascadeFilter {
+  public:
+  BiquadCascadeFilter( BiquadCascade cascade, size_t channels );
+
+  size_t channels() const { return channels_; }
+
+  void process( float const* input, float* output, size_t frame_amount );
+  // back to the zero state
+  void reset();
+
+  private:
+  BiquadCascade cascade_;
+  size_t channels_;
+  std::vector< double > states_;
+};
@@ -4,9 +4,19 @@
 #include <cairo.h>
 #include <fftw3.h>
 #include <filesystem>
+#include <memory>
+#include <optional>
+#include <thread>
 #include <vector>
 
 #include "_spdlog.h"
+#include "magDbNormalizer.h"
+#include "onsetDetector.h"
+#include "pcmSampleView.h"
+#include "spectrogram.h"
+
+class AnalysisCacheReader;
+class AnalysisCacheStreamWriter;
 
 class CircleVideoGenerator {
   public:
@@ -16,34 +26,45 @@ class CircleVideoGenerator {
   static int32_t const IIR_FILTER_ORDER;
   static double const BASS_LP_CUTOFF;
   static double const BASS_HP_CUTOFF;
+  static double const BASS_MIN_SAMPLE_RATE;
   static double const PCM_FRAME_COUNT_MULT;
   static double const EPILEPSY_WARNING_VISIBLE_SECONDS;
   static double const EPILEPSY_WARNING_FADEOUT_SECONDS;
-  static uint32_t const FFTW_PLAN_FLAGS;
   static std::string const EPILEPSY_WARNING_HEADER_FONT;
   static std::string const EPILEPSY_WARNING_CONTENT_FONT;
   static double const FFT_COMPUTE_ALPHA;
   static uint32_t const FFT_POINTCLOUD_POINT_AMOUNT;
   static double const FFT_POINTCLOUD_MAG_DB_RANGE;
   static uint32_t const FFT_DISPLAY_BIN_AMOUNT;
+  static uint32_t const FFT_BATCH_SIZE;
+  static size_t const FFT_POINTCLOUD_BLOCK_FRAMES;
   static double const FFT_DISPLAY_MIN_FREQ;
   static double const FFT_DISPLAY_MAX_FREQ;
   static double const FFT_DISPLAY_MAG_DB_RANGE;
   static double const FFT_DISPLAY_MIN_RADIUS;
   static double const FFT_DISPLAY_MAX_RADIUS;
+  static MagDbNormalizationMode const FFT_MAG_DB_NORMALIZATION_MODE;
+  static double const FFT_MAG_DB_LOOKAHEAD_SECONDS;
+  static double const FFT_MAG_DB_RELEASE_DB_PER_SECOND;
+  static double const SHAKE_BEAT_WEIGHT;
+  static bool const ANALYSIS_CACHE_ENABLED;
+  static size_t const STREAMING_MEMORY_BUDGET;
+  static size_t const STREAMING_CHUNK_FRAMES;
+  static size_t const STREAMING_DECODE_AHEAD_FRAMES;
 
   private:
   static double FFT_POINTCLOUD_MIN_FREQ;
   static double FFT_POINTCLOUD_MAX_FREQ;
-  static double FFT_POINTCLOUD_MAX_MAG_DB;
-  static double FFT_POINTCLOUD_MIN_MAG_DB;
-  static double FFT_DISPLAY_MAX_MAG_DB;
-  static double FFT_DISPLAY_MIN_MAG_DB;
 
   private:
   struct AudioData;
-  struct ThreadInputData;
+  struct PointcloudTable;
+  struct PointcloudSimulation;
+  struct FrameDescriptor;
+  struct RenderContext;
   struct FrameInformation;
+  class SpectrumFrameAnalysis;
+  class PointcloudWorkers;
 
   private:
   struct Point {
@@ -61,44 +82,74 @@ class CircleVideoGenerator {
     uint32_t channels;
     uint32_t sample_rate;
     uint64_t total_pcm_frame_count;
-    std::shared_ptr< float[] > sample_data = nullptr;  // dr_wav allocated
+    // only the fields above and `duration` are set when the analysis comes from the cache, the render threads need no more
+    // interleaved, read in place from the mapped file (16 bit and float wavs) or from the dr_wav decoded buffer, `sample_data_owner` keeps either alive
+    PcmSampleView sample_data;
+    std::shared_ptr< void const > sample_data_owner = nullptr;
+    std::vector< float > mono_sample_data;             // average of all channels, for analysis
     float sample_min = 0.0;
     float sample_max = 0.0;
-    std::shared_ptr< float[] > processed_sample_data = nullptr;  // new[] allocated
-    float processed_sample_min = 0.0;
-    float processed_sample_max = 0.0;
+    // mono, band passed to the bass range and decimated, sample `m` belongs to pcm frame `m * bass_decimation_factor`
+    std::vector< float > bass_sample_data;
+    uint32_t bass_decimation_factor = 1;
+    float bass_sample_min = 0.0;
+    float bass_sample_max = 0.0;
+    // prefix sums of the squared samples, see `square_prefix_sum`
+    std::vector< double > sample_square_prefix_sum;
+    std::vector< double > bass_sample_square_prefix_sum;
     double duration;
   };
-  struct ThreadInputData {
-    uint64_t i;
-    uint64_t amount_output_frames;
-    std::filesystem::path project_temp_pictureset_picture_path;
+  struct PointcloudTable {
+    size_t point_amount = 0;
+    std::vector< float > radius;  // per point, constant over time
+    // frame-major, the position of point `p` at frame `i` is at `( i * point_amount ) + p`
+    std::vector< float > x;
+    std::vector< float > y;
+  };
+  // per point state of the point cloud, it carries over from one block of simulated frames to the next
+  struct PointcloudSimulation {
+    // the magnitude at the frequency of point `p` is a spline over the magnitudes `bin_index[p]` to `bin_index[p] + 3`
+    std::vector< int64_t > bin_index;
+    std::vector< double > bin_weights[4];
+    std::vector< double > x;
+    std::vector< double > y;
+    std::vector< double > speed_x;
+    std::vector< double > speed_y;
+  };
+  struct FrameDescriptor {
+    uint64_t i;  // index into the per-frame tables of the render context
     int64_t pcm_frame_offset;
     uint64_t pcm_frame_count;
-    std::shared_ptr< AudioData > audio_data_ptr = nullptr;
+  };
+  struct RenderContext {
+    size_t amount_output_frames;
+    // the per-frame tables below start at this frame, they only hold the frames being rendered
+    size_t first_frame = 0;
+    std::filesystem::path project_temp_pictureset_path;
+    std::shared_ptr< AudioData const > audio_data = nullptr;
     std::shared_ptr< cairo_surface_t > common_epilepsy_warning_surface = nullptr;
     std::shared_ptr< cairo_surface_t > common_bg_surface = nullptr;
     std::shared_ptr< cairo_surface_t > common_circle_surface = nullptr;
     std::shared_ptr< cairo_surface_t > project_art_surface = nullptr;
     std::shared_ptr< cairo_surface_t > static_text_surface = nullptr;
-    // list of points
-    std::shared_ptr< std::vector< CircleVideoGenerator::Point > > fft_pointcloud_values;
-    // list of (freq, mag_db)
-    std::shared_ptr< std::vector< std::pair< double, double > > > fft_display_values;
+    // rms of the pcm window of every frame
+    std::vector< double > sound_intensity_per_frame;
+    std::vector< double > bass_intensity_per_frame;
+    // spectral flux onsets and beats, 0.0 to 1.0 relative to the tempo window whatever its loudness, modulation sources for the effects
+    std::vector< double > onset_strength_per_frame;
+    std::vector< double > beat_strength_per_frame;
+    CircleVideoGenerator::PointcloudTable fft_pointcloud_table;
+    // x axis: freq, values: mag_db
+    Spectrogram fft_display_spectrogram;
+    // what the display values of a frame are normalized over
+    std::vector< MagDbRange > fft_display_range_per_frame;
   };
   struct FrameInformation {
     size_t amount_output_frames;
     double pcm_frames_per_output_frame;
-    std::shared_ptr< cairo_surface_t > common_epilepsy_warning_surface = nullptr;
-    std::shared_ptr< cairo_surface_t > common_bg_surface = nullptr;
-    std::shared_ptr< cairo_surface_t > common_circle_surface = nullptr;
-    std::shared_ptr< cairo_surface_t > project_art_surface = nullptr;
-    std::shared_ptr< cairo_surface_t > static_text_surface = nullptr;
-    // list of list of points
-    std::vector< std::shared_ptr< std::vector< CircleVideoGenerator::Point > > > fft_pointcloud_values_per_frame;
-    // list of list of (freq, mag_db)
-    std::vector< std::shared_ptr< std::vector< std::pair< double, double > > > > fft_display_values_per_frame;
-    std::vector< std::vector< CircleVideoGenerator::ThreadInputData > > thread_input_lists;
+    // shared read-only by all render threads
+    std::shared_ptr< CircleVideoGenerator::RenderContext > render_context = nullptr;
+    std::vector< std::vector< CircleVideoGenerator::FrameDescriptor > > frame_descriptor_lists;
     std::vector< std::thread > thread_list;
   };
 
@@ -113,19 +164,61 @@ class CircleVideoGenerator {
   static void calculate_frames();
   static void prepare_surfaces();
   static void prepare_fft();
-  static void prepare_threads();
+  static void prepare_threads( size_t frame_begin, size_t frame_end );
   static void start_threads();
   static void join_threads();
   static void clean_up();
 
   private:
+  // if the tables of the whole-file analysis of the audio would not fit into STREAMING_MEMORY_BUDGET
+  static bool should_stream_audio();
+  // analyzes and renders the audio in segments of frames from a chunked decode and writes the analysis cache along,
+  // in place of everything `render` does between the cache and `clean_up`
+  static void render_streaming();
+  // renders the analysis `open_analysis_cache` found in segments of frames
+  static void render_streaming_from_cache( AnalysisCacheReader const& reader );
+
+  // hash of the audio file and every constant the analysis depends on, empty if the audio can not be read
+  static std::optional< uint64_t > get_analysis_cache_key();
+  // fills everything `prepare_audio`, `calculate_frames` and `prepare_fft` would from the analysis cache, returns false on a miss
+  static bool load_analysis_cache();
+  static void save_analysis_cache();
+  // checks the analysis cache and fills everything but the per-frame tables of the render context from it, returns false on a miss
+  static bool open_analysis_cache( AnalysisCacheReader& reader );
+  // the per-frame tables of the render context for the frames `frame_begin` to `frame_begin + frame_amount`
+  static void read_analysis_cache_frames( AnalysisCacheReader const& reader, size_t frame_begin, size_t frame_amount );
+  // declares every section and writes the ones that are not per frame, returns false if the cache is not used or can not be written
+  static bool begin_analysis_cache( AnalysisCacheStreamWriter& writer );
+  // the first `frame_amount` frames of the per-frame tables of the render context, as the frames from `frame_begin` on
+  static bool write_analysis_cache_frames( AnalysisCacheStreamWriter& writer, size_t frame_begin, size_t frame_amount );
+  static void create_frame_information();
+  // FFT_MAG_DB_NORMALIZATION_MODE and its timing in frames, for a range of `mag_db_range`
+  static MagDbNormalization get_mag_db_normalization( double mag_db_range );
+  // the onset and beat tracking at FPS
+  static OnsetDetection get_onset_detection();
   static void save_surface( std::shared_ptr< cairo_surface_t > surface, std::filesystem::path const& file_path );
   static void create_lowpass_for_audio_data();
   static void create_epilepsy_warning();
+  // scatters the random points, their radius goes into `pointcloud_table`
+  static CircleVideoGenerator::PointcloudSimulation create_pointcloud_simulation( size_t fft_size, CircleVideoGenerator::PointcloudTable& pointcloud_table );
+  // advances every point by `frame_amount` frames of clamped magnitudes (`bin_amount` per frame, starting at fft index 1) and their ranges,
+  // the positions go into the frames of `pointcloud_table` from `table_frame_begin` on, the partitions of the points run on `workers`
+  static void simulate_pointcloud( CircleVideoGenerator::PointcloudWorkers& workers,
+                                   CircleVideoGenerator::PointcloudSimulation& simulation,
+                                   double const* mag_db_per_frame,
+                                   MagDbRange const* range_per_frame,
+                                   size_t bin_amount,
+                                   size_t frame_amount,
+                                   size_t table_frame_begin,
+                                   CircleVideoGenerator::PointcloudTable& pointcloud_table );
 
-  static void draw_pointcloud_on_surface( std::shared_ptr< cairo_surface_t > surface, CircleVideoGenerator::ThreadInputData const& input_data );
-  static void draw_freqs_on_surface( std::shared_ptr< cairo_surface_t > surface, CircleVideoGenerator::ThreadInputData const& input_data );
-  static void thread_run( std::vector< CircleVideoGenerator::ThreadInputData > inputs );
+  static void draw_pointcloud_on_surface( std::shared_ptr< cairo_surface_t > surface,
+                                          CircleVideoGenerator::RenderContext const& context,
+                                          CircleVideoGenerator::FrameDescriptor const& frame );
+  static void draw_freqs_on_surface( std::shared_ptr< cairo_surface_t > surface,
+                                     CircleVideoGenerator::RenderContext const& context,
+                                     CircleVideoGenerator::FrameDescriptor const& frame );
+  static void thread_run( CircleVideoGenerator::RenderContext const& context, std::vector< CircleVideoGenerator::FrameDescriptor > const& frames );
 
   private:
   // general class things
@@ -145,8 +238,10 @@ class CircleVideoGenerator {
 
   // will be created
   static std::filesystem::path project_temp_pictureset_path_;
+  static std::filesystem::path project_analysis_cache_path_;
 
   // will be computed
   static std::shared_ptr< CircleVideoGenerator::AudioData > audio_data_;
   static std::shared_ptr< CircleVideoGenerator::FrameInformation > frame_information_;
+  static std::optional< uint64_t > analysis_cache_key_;
 };
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <fftw3.h>
+#include <vector>
+
+// spectral kernel of a constant q transform (brown & puckette): bin `r` is the inner product of the (unwindowed) frame with a windowed complex
+// exponential at `frequencies[r]`, evaluated as `sum( spectrum * conj( kernel spectrum ) )` on the fft of the frame.
+// the kernel spectrum of a bin is only relevant around its frequency, so row `r` keeps the one run of weights
+// `weights[row_offsets[r] .. row_offsets[r + 1])` that starts at the fft index `first_columns[r]`.
+struct ConstantQKernel {
+  size_t fft_size = 0;
+  std::vector< double > frequencies;
+  std::vector< uint32_t > first_columns;
+  std::vector< uint32_t > row_offsets;
+  std::vector< std::complex< float > > weights;
+
+  size_t bin_amount() const { return frequencies.size(); }
+};
+
+// quality `frequency / bandwidth` of bins that are spaced by the factor `bin_ratio`
+double constant_q_quality( double bin_ratio );
+
+// kernel for frames of `fft_size` samples, the exponential of a bin spans `quality * sample_rate / frequency` samples around the center of the frame
+// but at most the whole frame, so below `quality * sample_rate / fft_size` the bins get the resolution of the whole frame instead.
+// weights below `threshold` times the peak of their row are dropped, a sinusoid of amplitude `a` at a bin frequency ends up as `a / 2` in that bin.
+ConstantQKernel make_constant_q_kernel( size_t fft_size,
+                                        double sample_rate,
+                                        std::vector< double > const& frequencies,
+                                        double quality,
+                                        double threshold = 0.0054 );
+
+// `magnitudes[f][r] = | constant q bin r of spectrum[f] |` for the `frame_amount` rows of `spectrum` (`fft_size / 2 + 1` values each) and `magnitudes`
+void constant_q_magnitudes( ConstantQKernel const& kernel,
+                            fftwf_complex const* spectrum,
+                            size_t spectrum_stride,
+                            float* magnitudes,
+                            size_t magnitudes_stride,
+                            size_t frame_amount );
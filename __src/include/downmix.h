@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "pcmSampleView.h"
+
+// averages every interleaved frame of `channels` channels into one mono sample, with dedicated 1 and 2 channel paths
+void downmix_to_mono( float const* interleaved, float* mono, size_t frame_amount, uint32_t channels );
+// same for 16 bit samples, they are converted block by block on the way
+void downmix_to_mono( int16_t const* interleaved, float* mono, size_t frame_amount, uint32_t channels );
+// either of the above, by the format of `samples`
+void downmix_to_mono( PcmSampleView const& samples, float* mono );
+
+// `output[i] = input[i] * PCM_INT16_SCALE`
+void int16_to_float( int16_t const* input, float* output, size_t amount );
+// all samples of `samples` as interleaved float
+void pcm_to_float( PcmSampleView const& samples, float* output );
+// widens `[sample_min, sample_max]` to every sample of `samples`
+void pcm_sample_range( PcmSampleView const& samples, float& sample_min, float& sample_max );
+
+// `output[i] = input[i] * window[i]`
+void multiply_window( float const* input, float const* window, float* output, size_t amount );
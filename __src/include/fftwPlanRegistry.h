@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <fftw3.h>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+#include "_spdlog.h"
+
+// one place for all fftw plans of the process, so every transform is planned only once and planning never races (the planner is not thread safe).
+// plans are shared, so they have to be executed with the new-array functions (e.g. `fftwf_execute_dft_r2c`) on buffers from `fftwf_alloc_*`.
+// wisdom is cached on disk per cpu, fftw version, planner rigor and transform, so only the first run on a machine pays for the expensive planning.
+class FftwPlanRegistry {
+  public:
+  static uint32_t const FFTW_PLAN_FLAGS;
+
+  static void init( std::filesystem::path const& wisdom_path );
+  static void deinit();
+
+  // real to complex transform of `fft_size` samples
+  static std::shared_ptr< fftwf_plan_s > get_r2c_plan( int fft_size );
+  // `batch_size` real to complex transforms of `fft_size` samples in one call,
+  // transform `b` reads the samples at `b * fft_size` and writes the bins at `b * ( fft_size / 2 + 1 )`
+  static std::shared_ptr< fftwf_plan_s > get_r2c_batch_plan( int fft_size, int batch_size );
+
+  private:
+  // looks up `plan_key`, or makes the plan with `make_plan` on scratch buffers of the given sizes
+  static std::shared_ptr< fftwf_plan_s > get_plan( std::string const& plan_key,
+                                                   size_t input_size,
+                                                   size_t output_size,
+                                                   std::function< fftwf_plan( float*, fftwf_complex* ) > const& make_plan );
+  static std::string get_machine_key();
+  // the planner rigor of FFTW_PLAN_FLAGS, wisdom is only reused by the rigor that made it
+  static std::string get_planner_rigor();
+  // imports the cached wisdom for `plan_key`, returns if there was any
+  static bool import_wisdom( std::string const& plan_key );
+  static void export_wisdom( std::string const& plan_key );
+
+  static spdlogger logger_;
+  static std::filesystem::path wisdom_path_;
+  static std::map< std::string, std::shared_ptr< fftwf_plan_s > > plans_;
+  static std::mutex plans_mutex_;
+};
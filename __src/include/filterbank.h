@@ -0,0 +1,50 @@
+#pragma once
+
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "logBinning.h"
+
+// perceptual frequency scales
+enum class FilterbankScale {
+  // htk mel, `2595 * log10( 1 + f / 700 )`
+  MEL,
+  // traunmueller bark, `26.81 * f / ( 1960 + f ) - 0.53`
+  BARK,
+};
+
+enum class FilterbankNormalization {
+  // every triangle peaks at 1
+  NONE,
+  // every triangle has the same area (slaney), wide bands do not come out louder than narrow ones
+  SLANEY,
+};
+
+// `band_amount` triangles whose peaks are evenly spaced on `scale` between `min_freq` and `max_freq`, each triangle reaches from the peak of the
+// band below to the peak of the band above (the outermost ones to `min_freq` and `max_freq`)
+struct FilterbankLayout {
+  FilterbankScale scale = FilterbankScale::MEL;
+  FilterbankNormalization normalization = FilterbankNormalization::SLANEY;
+  size_t fft_size = 0;
+  double sample_rate = 0.0;
+  uint32_t band_amount = 0;
+  double min_freq = 0.0;
+  double max_freq = 0.0;
+
+  auto operator<=>( FilterbankLayout const& ) const = default;
+};
+
+double filterbank_scale_from_hz( FilterbankScale scale, double freq );
+double filterbank_scale_to_hz( FilterbankScale scale, double value );
+
+// center frequency of band `band`
+double filterbank_band_freq( FilterbankLayout const& layout, uint32_t band );
+
+// maps the magnitudes of the fft indices `1 .. fft_size / 2` (the dc index is skipped, like `make_log_binning_matrix`) onto the bands.
+// a band too narrow to cover any fft index takes the index closest to its center.
+SparseMatrix make_filterbank_matrix( FilterbankLayout const& layout );
+
+// same, but every layout is only built once per process
+std::shared_ptr< SparseMatrix const > get_filterbank_matrix( FilterbankLayout const& layout );
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// magnitudes of one (already windowed) frame at arbitrary frequencies, several frequencies at once in simd lanes.
+// every frequency costs a few flops per sample, while a full fft costs about 2.5 log2( fft_size ) flops per sample for all of its bins,
+// so the bank only pays off for consumers that need a handful of frequencies, see `is_cheaper_than_fft`.
+// the display and the point cloud of the generators need hundreds, so it is not part of the generator and only built for its test and benchmark.
+class GoertzelBank {
+  public:
+  // `frequencies` in hz
+  GoertzelBank( std::vector< double > const& frequencies, double sample_rate );
+
+  size_t frequency_amount() const { return frequency_amount_; }
+
+  // `output[f] = | sum( frame[m] * e^( -j 2 pi frequencies[f] m / sample_rate ) ) |`, which is what a fft bin at that frequency would hold
+  void magnitudes( float const* frame, size_t frame_size, float* output ) const;
+
+  // rough cost per frame of the bank against a full fft of `fft_size`, to pick one per consumer
+  static bool is_cheaper_than_fft( size_t frequency_amount, size_t frame_size, size_t fft_size );
+
+  private:
+  size_t frequency_amount_;
+  // `2 cos( w )` per frequency, padded to a whole number of simd blocks
+  std::vector< double > coefficients_;
+};
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// compressed sparse row matrix, row `r` holds the entries `[row_offsets[r], row_offsets[r + 1])` of `column_indices` and `weights`.
+// the columns of a row are ascending.
+struct SparseMatrix {
+  size_t row_amount = 0;
+  size_t column_amount = 0;
+  std::vector< uint32_t > row_offsets;
+  std::vector< uint32_t > column_indices;
+  std::vector< float > weights;
+};
+
+// maps the magnitudes of the fft indices `1 .. fft_size / 2` (the dc index is skipped) onto `bin_amount + 1` logarithmically spaced display bins.
+// bin `b` sums every fft index with a frequency in `[min_freq * ( max_freq / min_freq )^( b / bin_amount ), ... ( b + 1 ) ...)`,
+// bins that cover no fft index at all get the catmull-rom interpolation of the spectrum at their lower edge instead.
+SparseMatrix make_log_binning_matrix( size_t fft_size, double sample_rate, double min_freq, double max_freq, uint32_t bin_amount );
+
+// `output[f][r] = sum( weights * input[f][column] )` for the `frame_amount` rows of `input` and `output`.
+// rows that cover a contiguous run of columns (all of the log binning and filterbank ones but the interpolated bins) are a simd dot product.
+void sparse_multiply( SparseMatrix const& matrix, float const* input, size_t input_stride, float* output, size_t output_stride, size_t frame_amount );
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+
+enum class MagDbNormalizationMode {
+  // one range for the whole track from its loudest frame, no range is known before every frame is analyzed
+  GLOBAL,
+  // a range per frame that holds the loudest of the next `lookahead_frames` frames and falls back slowly after a peak.
+  // the range of a frame is known `lookahead_frames` frames after it, only those frames are kept
+  STREAMING,
+};
+
+struct MagDbNormalization {
+  MagDbNormalizationMode mode = MagDbNormalizationMode::GLOBAL;
+  // the range reaches this far below its maximum
+  double mag_db_range = 60.0;
+  // STREAMING only
+  size_t lookahead_frames = 0;
+  double release_db_per_frame = 0.0;
+};
+
+// magnitudes of a frame are clamped to and normalized over its range
+struct MagDbRange {
+  double min_mag_db;
+  double max_mag_db;
+
+  double clamp( double mag_db ) const { return std::clamp( mag_db, min_mag_db, max_mag_db ); }
+  // 0.0 at `min_mag_db`, 1.0 at `max_mag_db`
+  double normalize( double mag_db ) const { return std::clamp( ( mag_db - min_mag_db ) / ( max_mag_db - min_mag_db ), 0.0, 1.0 ); }
+};
+
+// turns the loudest magnitude of every frame, pushed in order, into the range of every frame, handed out in order
+class MagDbNormalizer {
+  public:
+  explicit MagDbNormalizer( MagDbNormalization const& normalization );
+
+  // the loudest magnitude of the next frame
+  void push( double frame_max_mag_db );
+  // there are no more frames, the range of every pushed frame is known now
+  void finish();
+
+  // if the range of the next frame is known
+  bool has_next() const;
+  // the range of the next frame, nullopt while it still needs more frames
+  std::optional< MagDbRange > next();
+
+  // frames pushed and ranges handed out so far
+  uint64_t pushed_amount() const { return pushed_amount_; }
+  uint64_t next_frame() const { return next_frame_; }
+
+  private:
+  struct Peak {
+    uint64_t frame;
+    double mag_db;
+  };
+
+  MagDbNormalization normalization_;
+  uint64_t pushed_amount_ = 0;
+  uint64_t next_frame_ = 0;
+  bool is_finished_ = false;
+
+  // GLOBAL: the loudest frame so far
+  double max_mag_db_;
+  // STREAMING: the frames from `next_frame_` on that are louder than every frame after them, so the front is the loudest of the window
+  std::deque< Peak > peaks_;
+  std::optional< double > envelope_mag_db_;
+};
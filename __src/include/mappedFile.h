@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+// read-only memory mapping of a whole file, the pages are only read from disk when they are touched.
+// empty files can not be mapped.
+class MappedFile {
+  public:
+  MappedFile() = default;
+  ~MappedFile();
+
+  MappedFile( MappedFile const& ) = delete;
+  MappedFile& operator=( MappedFile const& ) = delete;
+  MappedFile( MappedFile&& other ) noexcept;
+  MappedFile& operator=( MappedFile&& other ) noexcept;
+
+  // maps `file_path`, an already mapped file is closed first. returns if the file is mapped
+  bool open( std::filesystem::path const& file_path );
+  void close();
+
+  bool is_open() const { return data_ != nullptr; }
+  uint8_t const* data() const { return data_; }
+  size_t size() const { return size_; }
+
+  private:
+  uint8_t const* data_ = nullptr;
+  size_t size_ = 0;
+};
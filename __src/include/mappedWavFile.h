@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+
+#include "mappedFile.h"
+#include "pcmSampleView.h"
+
+// a wav file read in place from a read-only mapping, the header is parsed here and no sample is decoded or copied.
+// only the formats the analysis converts on the fly are supported: 16 bit integer and 32 bit float pcm (also as WAVE_FORMAT_EXTENSIBLE),
+// everything else still goes through dr_wav.
+// the mapping reads from the page cache, so concurrent renders of the same track share one copy of it.
+class MappedWavFile {
+  public:
+  // maps and parses `file_path`, an already open file is closed first. returns false if it is not a wav of a supported format
+  bool open( std::filesystem::path const& file_path );
+  void close();
+
+  bool is_open() const { return file_.is_open(); }
+  uint32_t channels() const { return samples_.channels; }
+  uint32_t sample_rate() const { return sample_rate_; }
+  uint64_t total_pcm_frame_count() const { return samples_.frame_amount; }
+  // valid as long as the file is open
+  PcmSampleView const& samples() const { return samples_; }
+
+  private:
+  MappedFile file_;
+  uint32_t sample_rate_ = 0;
+  PcmSampleView samples_;
+};
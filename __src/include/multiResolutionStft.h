@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fftw3.h>
+#include <memory>
+#include <vector>
+
+#include "logBinning.h"
+#include "stft.h"
+
+// one resolution of a multi resolution analysis
+struct MultiResolutionBand {
+  // the signal of the band is decimated by this power of two first, which keeps the fft of long windows small
+  uint32_t decimation = 1;
+  // at the decimated rate
+  size_t window_size = 0;
+  // crossover to the next band, the last band goes up to the top of the display
+  double max_freq = 0.0;
+};
+
+// three bands for an analysis that would use `window_size` samples per frame: the lows get a window four times as long, the mids the same one and
+// the highs a quarter of it. the two lower bands are decimated as far as their crossover (faded over `crossover_octaves`) allows.
+std::vector< MultiResolutionBand > design_three_band_resolution( double sample_rate,
+                                                                  size_t window_size,
+                                                                  double low_crossover,
+                                                                  double high_crossover,
+                                                                  double crossover_octaves );
+
+// share of `band` in the display bin at `freq`, the bands are faded into each other over `crossover_octaves` around every crossover.
+// the shares of all bands add up to 1.
+double multi_resolution_crossover_weight( std::vector< MultiResolutionBand > const& bands, size_t band, double freq, double crossover_octaves );
+
+// stft that runs one fft size per band and stitches the magnitudes into `bin_amount + 1` log spaced display bins (like `make_log_binning_matrix`).
+// all bands share the frame centers (`floor( i * hop )` at the original rate), their magnitudes are normalized by their window sums,
+// so a sinusoid comes out at the same level in every band.
+class MultiResolutionStft {
+  public:
+  // per thread buffers of `compute_rows`
+  struct Workspace {
+    std::vector< std::shared_ptr< float[] > > signals;
+    std::vector< std::shared_ptr< fftwf_complex[] > > spectra;
+    std::vector< float > magnitudes;
+  };
+
+  // `samples` has to outlive the stft, the decimated signals of the bands are made here
+  MultiResolutionStft( std::vector< float > const& samples,
+                       double sample_rate,
+                       double hop,
+                       std::vector< MultiResolutionBand > const& bands,
+                       size_t batch_size,
+                       double min_freq,
+                       double max_freq,
+                       uint32_t bin_amount,
+                       double crossover_octaves );
+
+  size_t bin_amount() const { return crossover_map_.row_amount; }
+  size_t band_amount() const { return bands_.size(); }
+  StftLayout const& band_layout( size_t band ) const { return bands_[band].layout; }
+  // display bins x the magnitudes of all bands (fft indices from 1 on), one after the other
+  SparseMatrix const& crossover_map() const { return crossover_map_; }
+
+  Workspace make_workspace() const;
+  // display bins of the frames `[frame_begin, frame_begin + frame_amount)` into the rows of `output`
+  void compute_rows( Workspace& workspace, size_t frame_begin, size_t frame_amount, float* output, size_t output_stride ) const;
+
+  private:
+  struct BandState {
+    MultiResolutionBand band;
+    StftLayout layout;
+    double sample_rate = 0.0;
+    // empty for undecimated bands, they read the original samples
+    std::vector< float > decimated_samples;
+    std::vector< float > window;
+    std::shared_ptr< fftwf_plan_s > fft_plan;
+    // where the magnitudes of the band start in a row of `Workspace::magnitudes`
+    size_t column_offset = 0;
+  };
+
+  std::vector< float > const& samples_;
+  size_t batch_size_ = 1;
+  std::vector< BandState > bands_;
+  SparseMatrix crossover_map_;
+};
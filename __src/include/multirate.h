@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// anti-alias low pass of one decimation stage, a kaiser windowed sinc of odd length
+struct DecimationStage {
+  uint32_t factor;
+  std::vector< float > taps;
+};
+
+// designs a stage that decimates by `factor` and keeps everything up to `passband_edge` (relative to the input rate, 0.0 - 0.5),
+// what would alias into that passband is attenuated by `stopband_attenuation_db`
+DecimationStage design_decimation_stage( uint32_t factor, double passband_edge, double stopband_attenuation_db = 80.0 );
+
+// splits a total decimation factor (a power of two) into stages of at most `max_stage_factor`, each designed to keep `passband_edge`
+// (relative to the initial rate) intact
+std::vector< DecimationStage > design_decimation_stages( uint32_t total_factor, double passband_edge, uint32_t max_stage_factor = 8 );
+
+// decimates by `stage.factor`, only the outputs that survive the downsampling are computed (polyphase form).
+// the filter is zero phase, output sample `m` is centered on input sample `m * factor`, outside of the input counts as silence.
+std::vector< float > decimate( std::vector< float > const& input, DecimationStage const& stage );
+
+// `decimate` over a stream that arrives in chunks: every output is computed as soon as the input it needs is there,
+// so the outputs of all `push` calls and `finish` together equal `decimate` over the whole stream.
+// only the input that later outputs still need is kept.
+class StreamingDecimator {
+  public:
+  explicit StreamingDecimator( DecimationStage stage );
+
+  // appends the outputs that became computable to `output`
+  void push( float const* input, size_t amount, std::vector< float >& output );
+  // the stream ended, appends the remaining outputs (the input past the end counts as silence)
+  void finish( std::vector< float >& output );
+
+  private:
+  // computes the outputs up to (excluding) `output_end`
+  void emit( size_t output_end, std::vector< float >& output );
+
+  DecimationStage stage_;
+  int64_t half_length_;
+  // input samples from the absolute position `history_begin_` on
+  std::vector< float > history_;
+  int64_t history_begin_ = 0;
+  int64_t input_end_ = 0;
+  size_t next_output_ = 0;
+};
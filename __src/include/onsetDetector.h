@@ -0,0 +1,108 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+struct OnsetDetection {
+  // rate of the frames (spectra) that are pushed
+  double frames_per_second = 60.0;
+  // bins further than this below the loudest bin of their frame count as this far below, so the noise floor does not flicker into the flux
+  double mag_db_range = 60.0;
+  // an onset is the strongest flux this many seconds around it, it is also how far the detector looks ahead (twice)
+  double peak_seconds = 0.05;
+  // the flux of a frame counts above its mean from this many seconds before it to `peak_seconds` after it, plus `threshold_db`.
+  // the flux is the rise of the frame in dB averaged over all bins, noise and steady tones stay well below 1 dB, hits go far above
+  double threshold_seconds = 0.5;
+  double threshold_db = 1.5;
+  // onsets below this share of the strongest one in the tempo window are not reported
+  double min_onset_strength = 0.1;
+  // tempo range, anything else is folded into it by the autocorrelation
+  double min_bpm = 60.0;
+  double max_bpm = 200.0;
+  // the tempo is weighted by a log gaussian around `prior_bpm`, `prior_octaves` wide, against octave errors
+  double prior_bpm = 120.0;
+  double prior_octaves = 1.0;
+  // seconds of onsets the tempo and the beat phase are taken from
+  double tempo_window_seconds = 6.0;
+  // the onset and beat strengths fall to 1/e this many seconds after their peak
+  double release_seconds = 0.15;
+};
+
+// what a frame adds to the effects, everything in 0.0 to 1.0
+struct OnsetFrame {
+  // the flux above its threshold relative to the strongest of the tempo window, held with the release
+  double onset_strength = 0.0;
+  // 1.0 times the confidence of the tempo at every beat, held with the release
+  double beat_strength = 0.0;
+  bool is_onset = false;
+  bool is_beat = false;
+  // the tempo the beat of this frame follows, 0.0 while there is none
+  double bpm = 0.0;
+};
+
+// spectral flux onsets and a beat tracker over the magnitudes (in dB) of every frame, pushed in order, the onset strength and beats of
+// every frame handed out in order. a frame is ready `lookahead_frames()` frames after it, only the frames of the tempo window are kept
+class OnsetDetector {
+  public:
+  OnsetDetector( OnsetDetection const& detection, size_t bin_amount );
+
+  // the `bin_amount` magnitudes in dB of the next frame
+  void push( float const* mag_db );
+  // there are no more frames, every pushed frame is ready now
+  void finish();
+
+  // if the next frame is ready
+  bool has_next() const;
+  // the next frame, nullopt while it still needs more frames
+  std::optional< OnsetFrame > next();
+
+  size_t lookahead_frames() const { return 2 * peak_frames_; }
+  // frames pushed and handed out so far
+  uint64_t pushed_amount() const { return pushed_amount_; }
+  uint64_t next_frame() const { return next_frame_; }
+
+  private:
+  float flux( uint64_t frame ) const { return flux_[frame - history_begin_]; }
+  float novelty( uint64_t frame ) const { return novelty_[frame - history_begin_]; }
+  // the flux of `frame` above its threshold, needs the flux up to `peak_frames_` after it
+  void compute_novelty( uint64_t frame );
+  // tempo and beat grid from the novelty of the tempo window ending at `newest_frame`
+  void track_tempo( uint64_t newest_frame );
+  void track_phase( uint64_t newest_frame );
+  void trim_history();
+
+  OnsetDetection detection_;
+  size_t bin_amount_;
+  size_t peak_frames_;
+  size_t threshold_frames_;
+  size_t tempo_window_frames_;
+  size_t min_lag_;
+  size_t max_lag_;
+  double release_;
+  std::vector< float > tempo_prior_;
+
+  uint64_t pushed_amount_ = 0;
+  uint64_t novelty_amount_ = 0;
+  uint64_t next_frame_ = 0;
+  bool is_finished_ = false;
+
+  // the floored magnitudes of the last frame
+  std::vector< float > previous_mag_db_;
+  std::vector< float > floored_mag_db_;
+  // flux and novelty of the frames from `history_begin_` on
+  uint64_t history_begin_ = 0;
+  std::vector< float > flux_;
+  std::vector< float > novelty_;
+
+  // tempo as a period in frames, 0.0 while there is none, its confidence and the beat grid `beat_anchor_ - k * period_`
+  double period_ = 0.0;
+  double confidence_ = 0.0;
+  double beat_anchor_ = 0.0;
+  std::vector< float > autocorrelation_;
+  std::optional< uint64_t > last_onset_;
+  std::optional< double > last_beat_;
+  double onset_strength_ = 0.0;
+  double beat_strength_ = 0.0;
+};
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// evaluates the exponential smoothing recurrence `y[n] = alpha * x[n] + ( 1 - alpha ) * y[n - 1]` with `y[0] = x[0]` in place,
+// along the rows of a row-major [row_amount x column_amount] table (i.e. every column, for a spectrogram every bin, is smoothed over the frames).
+// the rows are split into blocks which are scanned concurrently from a zero carry, then every block is fixed up with the carry of the block before it,
+// scaled by `( 1 - alpha )^k`. all inner loops run over the columns, so they vectorize across bins.
+// `thread_count` of 0 uses `std::thread::hardware_concurrency()`.
+void exponential_smoothing_scan( float* table, size_t row_amount, size_t column_amount, size_t row_stride, double alpha, uint32_t thread_count = 0 );
+void exponential_smoothing_scan( double* table, size_t row_amount, size_t column_amount, size_t row_stride, double alpha, uint32_t thread_count = 0 );
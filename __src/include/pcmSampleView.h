@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+enum class PcmSampleFormat { FLOAT32, INT16 };
+
+// scale of 16 bit samples to -1.0 - 1.0, the same as dr_wav uses
+inline constexpr float PCM_INT16_SCALE = 1.0f / 32768.0f;
+
+// interleaved samples read where they are (a mapped file or a decoded buffer), they are only converted to float where they are consumed
+struct PcmSampleView {
+  PcmSampleFormat format = PcmSampleFormat::FLOAT32;
+  void const* data = nullptr;
+  uint32_t channels = 0;
+  uint64_t frame_amount = 0;
+
+  bool empty() const { return ( data == nullptr ) || ( frame_amount == 0 ); }
+  size_t sample_amount() const { return size_t( frame_amount ) * channels; }
+  float const* float32() const { return static_cast< float const* >( data ); }
+  int16_t const* int16() const { return static_cast< int16_t const* >( data ); }
+
+  // sample `index` (interleaved) as float
+  float operator[]( size_t index ) const {
+    return ( format == PcmSampleFormat::INT16 ) ? float( int16()[index] ) * PCM_INT16_SCALE : float32()[index];
+  }
+  // the frames `[first_frame, first_frame + amount)`, which have to be inside of the view
+  PcmSampleView frames( uint64_t first_frame, uint64_t amount ) const {
+    size_t const sample_size = ( format == PcmSampleFormat::INT16 ) ? sizeof( int16_t ) : sizeof( float );
+    return PcmSampleView{ format, static_cast< uint8_t const* >( data ) + ( first_frame * channels * sample_size ), channels, amount };
+  }
+};
@@ -4,73 +4,129 @@
 #include <cairo.h>
 #include <fftw3.h>
 #include <filesystem>
+#include <memory>
+#include <optional>
+#include <thread>
 #include <vector>
 
 #include "_spdlog.h"
+#include "pcmSampleView.h"
+#include "filterbank.h"
+#include "magDbNormalizer.h"
+#include "onsetDetector.h"
+#include "spectrogram.h"
+
+class AnalysisCacheReader;
+class AnalysisCacheStreamWriter;
 
 class RegularVideoGenerator {
   public:
+  // where the display bins come from
+  enum class FftDisplaySource {
+    // windowed fft magnitudes summed over the log spaced bins, bins without fft indices are interpolated
+    LOG_BINNED_FFT,
+    // constant q transform at the bin frequencies
+    CONSTANT_Q,
+    // windowed fft magnitudes through mel spaced triangle filters, FFT_DISPLAY_FILTERBANK_BAND_AMOUNT of them
+    MEL_FILTERBANK,
+    // same, bark spaced
+    BARK_FILTERBANK,
+    // log binned fft magnitudes of a long window for the lows, today's window for the mids and a short one for the highs
+    MULTI_RESOLUTION_FFT,
+  };
+
   static double const FPS;
   static int32_t const VIDEO_WIDTH;
   static int32_t const VIDEO_HEIGHT;
   static int32_t const IIR_FILTER_ORDER;
   static double const BASS_LP_CUTOFF;
   static double const BASS_HP_CUTOFF;
+  static double const BASS_MIN_SAMPLE_RATE;
   static double const PCM_FRAME_COUNT_MULT;
   static double const EPILEPSY_WARNING_VISIBLE_SECONDS;
   static double const EPILEPSY_WARNING_FADEOUT_SECONDS;
-  static uint32_t const FFTW_PLAN_FLAGS;
   static std::string const EPILEPSY_WARNING_HEADER_FONT;
   static std::string const EPILEPSY_WARNING_CONTENT_FONT;
   static double const FFT_COMPUTE_ALPHA;
   static double const FFT_DISPLAY_MIN_FREQ;
   static double const FFT_DISPLAY_MAG_DB_RANGE;
   static uint32_t const FFT_DISPLAY_BIN_AMOUNT;
+  static uint32_t const FFT_BATCH_SIZE;
+  static FftDisplaySource const FFT_DISPLAY_SOURCE;
+  static uint32_t const FFT_DISPLAY_FILTERBANK_BAND_AMOUNT;
+  static FilterbankNormalization const FFT_DISPLAY_FILTERBANK_NORMALIZATION;
+  static double const FFT_MULTI_RESOLUTION_LOW_CROSSOVER;
+  static double const FFT_MULTI_RESOLUTION_HIGH_CROSSOVER;
+  static double const FFT_MULTI_RESOLUTION_CROSSOVER_OCTAVES;
+  static MagDbNormalizationMode const FFT_MAG_DB_NORMALIZATION_MODE;
+  static double const FFT_MAG_DB_LOOKAHEAD_SECONDS;
+  static double const FFT_MAG_DB_RELEASE_DB_PER_SECOND;
+  static double const SHAKE_BEAT_WEIGHT;
+  static bool const ANALYSIS_CACHE_ENABLED;
+  static size_t const STREAMING_MEMORY_BUDGET;
+  static size_t const STREAMING_CHUNK_FRAMES;
+  static size_t const STREAMING_DECODE_AHEAD_FRAMES;
 
   private:
   static double FFT_DISPLAY_MAX_FREQ;
-  static double FFT_DISPLAY_MAX_MAG_DB;
-  static double FFT_DISPLAY_MIN_MAG_DB;
 
   private:
   struct AudioData {
     uint32_t channels;
     uint32_t sample_rate;
     uint64_t total_pcm_frame_count;
-    std::shared_ptr< float[] > sample_data = nullptr;  // dr_wav allocated
+    // interleaved, read in place from the mapped file (16 bit and float wavs) or from the dr_wav decoded buffer, `sample_data_owner` keeps either alive
+    PcmSampleView sample_data;
+    std::shared_ptr< void const > sample_data_owner = nullptr;
+    // pcm frame of the first frame of `sample_data`, a streaming render of a track that is not mapped only holds the samples of its segment
+    int64_t sample_data_first_frame = 0;
+    // the fields below stay empty when the analysis comes from the cache, the render threads only draw `sample_data`
+    std::vector< float > mono_sample_data;             // average of all channels, for analysis
     float sample_min = 0.0;
     float sample_max = 0.0;
-    std::shared_ptr< float[] > processed_sample_data = nullptr;  // new[] allocated
-    float processed_sample_min = 0.0;
-    float processed_sample_max = 0.0;
+    // mono, band passed to the bass range and decimated, sample `m` belongs to pcm frame `m * bass_decimation_factor`
+    std::vector< float > bass_sample_data;
+    uint32_t bass_decimation_factor = 1;
+    float bass_sample_min = 0.0;
+    float bass_sample_max = 0.0;
+    // prefix sums of the squared samples, see `square_prefix_sum`
+    std::vector< double > sample_square_prefix_sum;
+    std::vector< double > bass_sample_square_prefix_sum;
     double duration;
   };
-  struct ThreadInputData {
-    uint64_t i;
-    uint64_t amount_output_frames;
-    std::filesystem::path project_temp_pictureset_picture_path;
+  struct FrameDescriptor {
+    uint64_t i;  // index into the per-frame tables of the render context
     int64_t pcm_frame_offset;
     uint64_t pcm_frame_count;
-    std::shared_ptr< AudioData > audio_data_ptr = nullptr;
+  };
+  struct RenderContext {
+    size_t amount_output_frames;
+    // the per-frame tables below start at this frame, they only hold the frames being rendered
+    size_t first_frame = 0;
+    std::filesystem::path project_temp_pictureset_path;
+    std::shared_ptr< AudioData const > audio_data = nullptr;
     std::shared_ptr< cairo_surface_t > common_epilepsy_warning_surface = nullptr;
     std::shared_ptr< cairo_surface_t > common_bg_surface = nullptr;
     std::shared_ptr< cairo_surface_t > common_circle_surface = nullptr;
     std::shared_ptr< cairo_surface_t > project_art_surface = nullptr;
     std::shared_ptr< cairo_surface_t > static_text_surface = nullptr;
-    // list of (freq, mag_db)
-    std::shared_ptr< std::vector< std::pair< double, double > > > fft_display_values;
+    // rms of the pcm window of every frame
+    std::vector< double > sound_intensity_per_frame;
+    std::vector< double > bass_intensity_per_frame;
+    // spectral flux onsets and beats, 0.0 to 1.0 relative to the tempo window whatever its loudness, modulation sources for the effects
+    std::vector< double > onset_strength_per_frame;
+    std::vector< double > beat_strength_per_frame;
+    // x axis: normalized bin position (0 - 1), values: mag_db
+    Spectrogram fft_display_spectrogram;
+    // what the display values of a frame are normalized over
+    std::vector< MagDbRange > fft_display_range_per_frame;
   };
   struct FrameInformation {
     size_t amount_output_frames;
     double pcm_frames_per_output_frame;
-    std::shared_ptr< cairo_surface_t > common_epilepsy_warning_surface = nullptr;
-    std::shared_ptr< cairo_surface_t > common_bg_surface = nullptr;
-    std::shared_ptr< cairo_surface_t > common_circle_surface = nullptr;
-    std::shared_ptr< cairo_surface_t > project_art_surface = nullptr;
-    std::shared_ptr< cairo_surface_t > static_text_surface = nullptr;
-    // list of list of (freq, mag_db)
-    std::vector< std::shared_ptr< std::vector< std::pair< double, double > > > > fft_display_values_per_frame;
-    std::vector< std::vector< RegularVideoGenerator::ThreadInputData > > thread_input_lists;
+    // shared read-only by all render threads
+    std::shared_ptr< RegularVideoGenerator::RenderContext > render_context = nullptr;
+    std::vector< std::vector< RegularVideoGenerator::FrameDescriptor > > frame_descriptor_lists;
     std::vector< std::thread > thread_list;
   };
 
@@ -81,23 +137,53 @@ class RegularVideoGenerator {
   static void render();
 
   private:
+  // decodes the audio file into `audio_data_`, the part of `prepare_audio` the render threads need
+  static void read_audio();
   static void prepare_audio();
   static void calculate_frames();
   static void prepare_surfaces();
   static void prepare_fft();
-  static void prepare_threads();
+  static void prepare_threads( size_t frame_begin, size_t frame_end );
   static void start_threads();
   static void join_threads();
   static void clean_up();
 
   private:
+  // if the samples and the whole-file analysis of the audio (only the tables when `is_cached`) would not fit into STREAMING_MEMORY_BUDGET
+  static bool should_stream_audio( bool is_cached );
+  // analyzes and renders the audio in segments of frames from a chunked decode and writes the analysis cache along,
+  // in place of everything `render` does between the cache and `clean_up`
+  static void render_streaming();
+  // renders the analysis `open_analysis_cache` found in segments of frames
+  static void render_streaming_from_cache( AnalysisCacheReader const& reader );
+
+  // hash of the audio file and every constant the analysis depends on, empty if the audio can not be read
+  static std::optional< uint64_t > get_analysis_cache_key();
+  static void save_analysis_cache();
+  // checks the analysis cache and fills everything but the per-frame tables of the render context from it, returns false on a miss
+  static bool open_analysis_cache( AnalysisCacheReader& reader );
+  // the per-frame tables of the render context for the frames `frame_begin` to `frame_begin + frame_amount`
+  static void read_analysis_cache_frames( AnalysisCacheReader const& reader, size_t frame_begin, size_t frame_amount );
+  // declares every section and writes the ones that are not per frame, returns false if the cache is not used or can not be written
+  static bool begin_analysis_cache( AnalysisCacheStreamWriter& writer );
+  // the first `frame_amount` frames of the per-frame tables of the render context, as the frames from `frame_begin` on
+  static bool write_analysis_cache_frames( AnalysisCacheStreamWriter& writer, size_t frame_begin, size_t frame_amount );
+  static void create_frame_information();
+  // FFT_MAG_DB_NORMALIZATION_MODE and its timing in frames
+  static MagDbNormalization get_mag_db_normalization();
+  // the onset and beat tracking at FPS
+  static OnsetDetection get_onset_detection();
   static void save_surface( std::shared_ptr< cairo_surface_t > surface, std::filesystem::path const& file_path );
   static void create_lowpass_for_audio_data();
   static void create_epilepsy_warning();
 
-  static void draw_samples_on_surface( std::shared_ptr< cairo_surface_t > surface, RegularVideoGenerator::ThreadInputData const& input_data );
-  static void draw_freqs_on_surface( std::shared_ptr< cairo_surface_t > surface, RegularVideoGenerator::ThreadInputData const& input_data );
-  static void thread_run( std::vector< RegularVideoGenerator::ThreadInputData > inputs );
+  static void draw_samples_on_surface( std::shared_ptr< cairo_surface_t > surface,
+                                       RegularVideoGenerator::RenderContext const& context,
+                                       RegularVideoGenerator::FrameDescriptor const& frame );
+  static void draw_freqs_on_surface( std::shared_ptr< cairo_surface_t > surface,
+                                     RegularVideoGenerator::RenderContext const& context,
+                                     RegularVideoGenerator::FrameDescriptor const& frame );
+  static void thread_run( RegularVideoGenerator::RenderContext const& context, std::vector< RegularVideoGenerator::FrameDescriptor > const& frames );
 
   private:
   // general class things
@@ -117,8 +203,10 @@ class RegularVideoGenerator {
 
   // will be created
   static std::filesystem::path project_temp_pictureset_path_;
+  static std::filesystem::path project_analysis_cache_path_;
 
   // will be computed
   static std::shared_ptr< RegularVideoGenerator::AudioData > audio_data_;
   static std::shared_ptr< RegularVideoGenerator::FrameInformation > frame_information_;
+  static std::optional< uint64_t > analysis_cache_key_;
 };
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <fftw3.h>
+
+// `magnitudes[i] = | bins[i] |` for `amount` interleaved complex values
+void complex_magnitudes( fftwf_complex const* bins, float* magnitudes, size_t amount );
+
+// `sum( bins[i] * weights[i] )` over `amount` complex values
+std::complex< float > complex_dot( fftwf_complex const* bins, std::complex< float > const* weights, size_t amount );
+
+// `sum( a[i] * b[i] )` over `amount` values
+float dot_product( float const* a, float const* b, size_t amount );
+
+// `sum( max( current[i] - previous[i], 0 ) )` over `amount` values, the rectified flux between two frames
+float rectified_flux( float const* current, float const* previous, size_t amount );
+
+// `db[i] = 20 * log10( max( amplitudes[i] * gains[i], 1e-12 ) )` with a vectorized polynomial logarithm (avx2, sse2 or neon),
+// off by less than 1e-4 dB. `gains` may be null (all 1), `db` may be `amplitudes`.
+void amplitude_to_db( float const* amplitudes, float const* gains, float* db, size_t amount );
+// same with `std::log10` in double, the reference of `amplitude_to_db`
+void amplitude_to_db_reference( float const* amplitudes, float const* gains, float* db, size_t amount );
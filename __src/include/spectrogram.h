@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// one frame of a spectrogram, `x[bin]` is the shared x axis value and `values[bin]` the value of this frame
+struct SpectrogramRow {
+  float const* x = nullptr;
+  float const* values = nullptr;
+  size_t bin_amount = 0;
+};
+
+// row-major [frames x bins] float matrix in one 64 byte aligned allocation, with the x axis that all frames share stored once.
+// rows are padded to a whole number of cache lines, so every row starts on its own cache line and concurrent writers never share one.
+class Spectrogram {
+  public:
+  static size_t const ALIGNMENT;
+
+  Spectrogram() = default;
+  Spectrogram( size_t frame_amount, size_t bin_amount );
+
+  size_t frame_amount() const { return frame_amount_; }
+  size_t bin_amount() const { return bin_amount_; }
+  // distance in floats between the starts of two consecutive rows
+  size_t row_stride() const { return row_stride_; }
+
+  float* data() { return values_.get(); }
+  float const* data() const { return values_.get(); }
+  float* row( size_t frame ) { return values_.get() + ( frame * row_stride_ ); }
+  float const* row( size_t frame ) const { return values_.get() + ( frame * row_stride_ ); }
+  std::vector< float >& x_axis() { return x_axis_; }
+  std::vector< float > const& x_axis() const { return x_axis_; }
+
+  SpectrogramRow row_view( size_t frame ) const;
+
+  private:
+  struct AlignedDeleter {
+    void operator()( float* p ) const;
+  };
+
+  size_t frame_amount_ = 0;
+  size_t bin_amount_ = 0;
+  size_t row_stride_ = 0;
+  std::unique_ptr< float[], AlignedDeleter > values_ = nullptr;
+  std::vector< float > x_axis_;
+};
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// hop and window model of the analysis.
+// frame `i` is centered on sample `floor( i * hop )`, covers the `window_size` samples from `frame_begin( i )` and is zero padded to `fft_size`.
+struct StftLayout {
+  size_t window_size = 0;
+  size_t fft_size = 0;
+  double hop = 0.0;
+
+  // the smallest power of two transform that fits the window
+  static StftLayout from_window( size_t window_size, double hop );
+
+  int64_t frame_begin( size_t frame ) const;
+};
+
+// writes the windowed samples of `frame` into `output` (`fft_size` floats, the part past the window is zeroed).
+// samples outside of `[0, sample_amount)` count as silence, `window` has `fft_size` entries of which the first `window_size` are used.
+void stft_window_frame( StftLayout const& layout, size_t frame, float const* samples, size_t sample_amount, float const* window, float* output );
+
+// keeps the newest samples of a stream, addressed by their absolute position in the stream
+class SampleRingBuffer {
+  public:
+  explicit SampleRingBuffer( size_t capacity = 0 );
+
+  // position one past the newest sample
+  int64_t end_position() const { return end_position_; }
+  size_t capacity() const { return samples_.size(); }
+  // keeps the newest samples, the capacity is rounded up to a power of two
+  void reserve( size_t capacity );
+  void push( float const* samples, size_t amount );
+  // copies the samples `[position, position + amount)`, positions before the stream or past its end count as silence.
+  // positions that already were overwritten are not allowed.
+  void read( int64_t position, float* output, size_t amount ) const;
+
+  private:
+  std::vector< float > samples_;
+  size_t mask_ = 0;
+  int64_t end_position_ = 0;
+};
+
+// streaming front end of the analysis: samples are pushed as they are decoded and every frame is windowed as soon as all of its samples are there.
+// only the samples that later frames still need are kept.
+class StftEngine {
+  public:
+  StftEngine( StftLayout const& layout, std::vector< float > window );
+
+  StftLayout const& layout() const { return layout_; }
+  // index of the frame `pop_frame` windows next
+  size_t next_frame() const { return next_frame_; }
+
+  void push( float const* samples, size_t amount );
+  // no more samples will come, the remaining frames see silence past the end
+  void finish();
+  // windows the next frame into `output` (`fft_size` floats) if all of its samples are available, returns false otherwise
+  bool pop_frame( float* output );
+
+  private:
+  StftLayout layout_;
+  std::vector< float > window_;
+  SampleRingBuffer input_;
+  size_t next_frame_ = 0;
+  bool is_finished_ = false;
+};
+
+// sliding dft over the newest `window_size` samples at the bins `[bin_begin, bin_end)` of the `fft_size` transform, updated per sample.
+// meant for consumers that only need a narrow band, e.g. the low end of the spectrum, where a full transform per frame would be wasted.
+// the window has to be a periodic cosine sum over `fft_size` (`cosine_window( ..., false )` coefficients) and is applied in the frequency domain,
+// so after every push `magnitudes` matches `| fft( window * newest samples ) |` at those bins.
+class SlidingDft {
+  public:
+  SlidingDft( StftLayout const& layout, std::vector< double > const& window_coefficients, size_t bin_begin, size_t bin_end );
+
+  size_t bin_amount() const { return bin_amount_; }
+
+  void push( float const* samples, size_t amount );
+  void magnitudes( float* output ) const;
+
+  // rough operation counts per frame of a sliding dft of `bin_amount` bins against a windowed full transform, to pick one per consumer
+  static bool is_cheaper_than_fft( StftLayout const& layout, size_t bin_amount, size_t window_coefficient_amount );
+
+  private:
+  size_t window_size_;
+  size_t bin_amount_;
+  std::vector< double > window_coefficients_;
+  // unwindowed dfts at the bins `[bin_begin - ( coefficients - 1 ), bin_end + ( coefficients - 1 ) )`
+  std::vector< std::complex< double > > accumulators_;
+  // `e^( j w )` shifts the window by one sample, `e^( -j w ( window_size - 1 ) )` is the phase of the newest sample
+  std::vector< std::complex< double > > shift_twiddles_;
+  std::vector< std::complex< double > > newest_twiddles_;
+  // the last `window_size` samples, to take the oldest one out again
+  std::vector< float > history_;
+  size_t history_position_ = 0;
+};
@@ -4,6 +4,8 @@
 #include <string>
 #include <vector>
 
+#include "pcmSampleView.h"
+
 template < typename T >
 T my_mod( T a, T b ) {
   while( a >= b ) {
@@ -18,3 +20,12 @@ T my_mod( T a, T b ) {
 std::string replace( std::string const& source, std::string const& from, std::string const& to );
 
 std::vector< std::string > split_multiline( std::string const& str );
+
+// kahan compensated prefix sums of the squared samples (clamped to -1.0 - 1.0), summed over all channels of a frame.
+// entry `i` covers the frames `[0, i)`, so the table has `frame_amount + 1` entries and any window sum is a single difference.
+std::vector< double > square_prefix_sum( float const* samples, size_t frame_amount, size_t channels );
+// same over samples of either format
+std::vector< double > square_prefix_sum( PcmSampleView const& samples );
+
+// sum over the frames `[begin, end)` of a prefix sum table, frames outside of the table count as silence
+double prefix_sum_range( std::vector< double > const& prefix_sum, int64_t begin, int64_t end );
@@ -0,0 +1,3 @@
+#define DR_FLAC_IMPLEMENTATION
+
+#include "_dr_flac.h"
@@ -0,0 +1,3 @@
+#define DR_MP3_IMPLEMENTATION
+
+#include "_dr_mp3.h"
@@ -25,3 +25,13 @@ SplinePoint catmullRom( SplinePoint const& p0, SplinePoint const& p1, SplinePoin
                * ( ( 2.0 * p1.second ) + ( -p0.second + p2.second ) * t + ( 2.0 * p0.second - 5.0 * p1.second + 4.0 * p2.second - p3.second ) * t2
                    + ( -p0.second + 3.0 * p1.second - 3.0 * p2.second + p3.second ) * t3 ) };
 }
+
+void catmullRom_weights( double t, double weights[4] ) {
+  double t2 = t * t;
+  double t3 = t2 * t;
+
+  weights[0] = 0.5 * ( -t + ( 2.0 * t2 ) - t3 );
+  weights[1] = 0.5 * ( 2.0 - ( 5.0 * t2 ) + ( 3.0 * t3 ) );
+  weights[2] = 0.5 * ( t + ( 4.0 * t2 ) - ( 3.0 * t3 ) );
+  weights[3] = 0.5 * ( -t2 + t3 );
+}
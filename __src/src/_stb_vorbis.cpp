@@ -0,0 +1 @@
+#include <stb_vorbis.c>
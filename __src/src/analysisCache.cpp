@@ -0,0 +1,362 @@
+#include "analysisCache.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <system_error>
+
+// "PGAC" in the native byte order
+static uint32_t const ANALYSIS_CACHE_MAGIC = analysis_cache_tag( "PGAC" );
+// bump on any change of the file layout
+static uint32_t const ANALYSIS_CACHE_VERSION = 1;
+static size_t const ANALYSIS_CACHE_SECTION_ALIGNMENT = 64;
+
+struct AnalysisCacheHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint64_t key;
+  uint32_t section_amount;
+  uint32_t reserved;
+};
+
+struct AnalysisCacheSectionEntry {
+  uint32_t tag;
+  uint32_t element_size;
+  uint64_t offset;
+  uint64_t byte_size;
+};
+
+// places every section on the next aligned offset after the header, the table and the sections before it, returns the size of the file
+static uint64_t place_sections( std::vector< AnalysisCacheSectionEntry >& entries ) {
+  auto align = []( uint64_t offset ) {
+    return ( ( offset + ANALYSIS_CACHE_SECTION_ALIGNMENT - 1 ) / ANALYSIS_CACHE_SECTION_ALIGNMENT ) * ANALYSIS_CACHE_SECTION_ALIGNMENT;
+  };
+  uint64_t offset = sizeof( AnalysisCacheHeader ) + ( entries.size() * sizeof( AnalysisCacheSectionEntry ) );
+  for( AnalysisCacheSectionEntry& entry : entries ) {
+    entry.offset = align( offset );
+    offset = entry.offset + entry.byte_size;
+  }
+  return offset;
+}
+
+static std::filesystem::path get_temp_path( std::filesystem::path const& file_path ) {
+  std::filesystem::path temp_path = file_path;
+  temp_path += ".tmp";
+  return temp_path;
+}
+
+#pragma region hash
+
+static uint64_t const XXH_PRIME64_1 = 0x9E3779B185EBCA87ULL;
+static uint64_t const XXH_PRIME64_2 = 0xC2B2AE3D27D4EB4FULL;
+static uint64_t const XXH_PRIME64_3 = 0x165667B19E3779F9ULL;
+static uint64_t const XXH_PRIME64_4 = 0x85EBCA77C2B2AE63ULL;
+static uint64_t const XXH_PRIME64_5 = 0x27D4EB2F165667C5ULL;
+
+static uint64_t xxh_read_64( uint8_t const* p ) {
+  uint64_t value;
+  std::memcpy( &value, p, sizeof( value ) );
+  return value;
+}
+
+static uint32_t xxh_read_32( uint8_t const* p ) {
+  uint32_t value;
+  std::memcpy( &value, p, sizeof( value ) );
+  return value;
+}
+
+static uint64_t xxh_round( uint64_t acc, uint64_t input ) {
+  acc += input * XXH_PRIME64_2;
+  acc = std::rotl( acc, 31 );
+  return acc * XXH_PRIME64_1;
+}
+
+static uint64_t xxh_merge_round( uint64_t acc, uint64_t value ) {
+  acc ^= xxh_round( 0, value );
+  return ( acc * XXH_PRIME64_1 ) + XXH_PRIME64_4;
+}
+
+uint64_t hash_bytes( void const* data, size_t size, uint64_t seed ) {
+  uint8_t const* p = static_cast< uint8_t const* >( data );
+  uint8_t const* const end = p + size;
+  uint64_t h;
+
+  if( size >= 32 ) {
+    // four independent lanes, so the multiplies of a stripe overlap
+    uint64_t v1 = seed + XXH_PRIME64_1 + XXH_PRIME64_2;
+    uint64_t v2 = seed + XXH_PRIME64_2;
+    uint64_t v3 = seed;
+    uint64_t v4 = seed - XXH_PRIME64_1;
+    uint8_t const* const stripes_end = end - 32;
+    do {
+      v1 = xxh_round( v1, xxh_read_64( p ) );
+      v2 = xxh_round( v2, xxh_read_64( p + 8 ) );
+      v3 = xxh_round( v3, xxh_read_64( p + 16 ) );
+      v4 = xxh_round( v4, xxh_read_64( p + 24 ) );
+      p += 32;
+    } while( p <= stripes_end );
+
+    h = std::rotl( v1, 1 ) + std::rotl( v2, 7 ) + std::rotl( v3, 12 ) + std::rotl( v4, 18 );
+    h = xxh_merge_round( h, v1 );
+    h = xxh_merge_round( h, v2 );
+    h = xxh_merge_round( h, v3 );
+    h = xxh_merge_round( h, v4 );
+  } else {
+    h = seed + XXH_PRIME64_5;
+  }
+
+  h += uint64_t( size );
+
+  for( ; p + 8 <= end; p += 8 ) {
+    h ^= xxh_round( 0, xxh_read_64( p ) );
+    h = ( std::rotl( h, 27 ) * XXH_PRIME64_1 ) + XXH_PRIME64_4;
+  }
+  if( p + 4 <= end ) {
+    h ^= uint64_t( xxh_read_32( p ) ) * XXH_PRIME64_1;
+    h = ( std::rotl( h, 23 ) * XXH_PRIME64_2 ) + XXH_PRIME64_3;
+    p += 4;
+  }
+  for( ; p < end; p++ ) {
+    h ^= uint64_t( *p ) * XXH_PRIME64_5;
+    h = std::rotl( h, 11 ) * XXH_PRIME64_1;
+  }
+
+  // avalanche
+  h ^= h >> 33;
+  h *= XXH_PRIME64_2;
+  h ^= h >> 29;
+  h *= XXH_PRIME64_3;
+  h ^= h >> 32;
+  return h;
+}
+
+#pragma endregion hash
+
+#pragma region key
+
+AnalysisCacheKey& AnalysisCacheKey::add_bytes( void const* data, size_t size ) {
+  // chaining through the seed keeps the order, the length is part of every hash so ( "ab", "c" ) and ( "a", "bc" ) differ
+  value_ = hash_bytes( data, size, value_ );
+  return *this;
+}
+
+AnalysisCacheKey& AnalysisCacheKey::add( std::string_view value ) {
+  return add_bytes( value.data(), value.size() );
+}
+
+bool AnalysisCacheKey::add_file( std::filesystem::path const& file_path ) {
+  MappedFile file;
+  if( !file.open( file_path ) ) {
+    return false;
+  }
+  add_bytes( file.data(), file.size() );
+  return true;
+}
+
+#pragma endregion key
+
+#pragma region writer
+
+AnalysisCacheWriter::AnalysisCacheWriter( uint64_t key ) : key_( key ) {}
+
+void AnalysisCacheWriter::add_section_bytes( uint32_t tag, size_t element_size, void const* data, size_t byte_size ) {
+  sections_.push_back( Section{ tag, uint32_t( element_size ), data, byte_size } );
+}
+
+bool AnalysisCacheWriter::write( std::filesystem::path const& file_path ) const {
+  AnalysisCacheHeader header{ ANALYSIS_CACHE_MAGIC, ANALYSIS_CACHE_VERSION, key_, uint32_t( sections_.size() ), 0 };
+
+  std::vector< AnalysisCacheSectionEntry > entries;
+  entries.reserve( sections_.size() );
+  for( Section const& section : sections_ ) {
+    entries.push_back( AnalysisCacheSectionEntry{ section.tag, section.element_size, 0, uint64_t( section.byte_size ) } );
+  }
+  place_sections( entries );
+
+  std::filesystem::path const temp_path = get_temp_path( file_path );
+  {
+    std::ofstream file_stream( temp_path, std::ios::binary | std::ios::trunc );
+    if( !file_stream ) {
+      return false;
+    }
+    file_stream.write( reinterpret_cast< char const* >( &header ), sizeof( header ) );
+    file_stream.write( reinterpret_cast< char const* >( entries.data() ), std::streamsize( entries.size() * sizeof( AnalysisCacheSectionEntry ) ) );
+    uint64_t position = sizeof( AnalysisCacheHeader ) + ( entries.size() * sizeof( AnalysisCacheSectionEntry ) );
+    char const padding[ANALYSIS_CACHE_SECTION_ALIGNMENT] = {};
+    for( size_t s = 0; s < sections_.size(); s++ ) {
+      file_stream.write( padding, std::streamsize( entries[s].offset - position ) );
+      file_stream.write( static_cast< char const* >( sections_[s].data ), std::streamsize( sections_[s].byte_size ) );
+      position = entries[s].offset + entries[s].byte_size;
+    }
+    if( !file_stream.flush() ) {
+      file_stream.close();
+      std::error_code ec;
+      std::filesystem::remove( temp_path, ec );
+      return false;
+    }
+  }
+
+  std::error_code ec;
+  std::filesystem::rename( temp_path, file_path, ec );
+  if( ec ) {
+    std::filesystem::remove( temp_path, ec );
+    return false;
+  }
+  return true;
+}
+
+#pragma endregion writer
+
+#pragma region stream writer
+
+AnalysisCacheStreamWriter::AnalysisCacheStreamWriter( uint64_t key ) : key_( key ) {}
+
+AnalysisCacheStreamWriter::~AnalysisCacheStreamWriter() {
+  discard();
+}
+
+void AnalysisCacheStreamWriter::add_section_bytes( uint32_t tag, size_t element_size, size_t byte_size ) {
+  sections_.push_back( Section{ tag, uint32_t( element_size ), 0, uint64_t( byte_size ) } );
+}
+
+bool AnalysisCacheStreamWriter::open( std::filesystem::path const& file_path ) {
+  discard();
+  is_failed_ = false;
+
+  AnalysisCacheHeader header{ ANALYSIS_CACHE_MAGIC, ANALYSIS_CACHE_VERSION, key_, uint32_t( sections_.size() ), 0 };
+  std::vector< AnalysisCacheSectionEntry > entries;
+  entries.reserve( sections_.size() );
+  for( Section const& section : sections_ ) {
+    entries.push_back( AnalysisCacheSectionEntry{ section.tag, section.element_size, 0, section.byte_size } );
+  }
+  uint64_t const file_size = place_sections( entries );
+  for( size_t s = 0; s < sections_.size(); s++ ) {
+    sections_[s].offset = entries[s].offset;
+  }
+
+  file_path_ = file_path;
+  temp_path_ = get_temp_path( file_path );
+  file_stream_.open( temp_path_, std::ios::binary | std::ios::trunc );
+  if( !file_stream_ ) {
+    discard();
+    return false;
+  }
+  file_stream_.write( reinterpret_cast< char const* >( &header ), sizeof( header ) );
+  file_stream_.write( reinterpret_cast< char const* >( entries.data() ), std::streamsize( entries.size() * sizeof( AnalysisCacheSectionEntry ) ) );
+  // the last byte sizes the file, everything not written yet reads as zero
+  uint64_t const table_end = sizeof( AnalysisCacheHeader ) + ( entries.size() * sizeof( AnalysisCacheSectionEntry ) );
+  if( file_size > table_end ) {
+    char const zero = 0;
+    file_stream_.seekp( std::streamoff( file_size - 1 ) );
+    file_stream_.write( &zero, 1 );
+  }
+  if( !file_stream_ ) {
+    discard();
+    return false;
+  }
+  return true;
+}
+
+bool AnalysisCacheStreamWriter::write_bytes( uint32_t tag, size_t element_size, size_t byte_offset, void const* data, size_t byte_size ) {
+  auto it = std::find_if( sections_.begin(), sections_.end(), [tag]( Section const& section ) { return section.tag == tag; } );
+  bool const fits = file_stream_.is_open() && ( it != sections_.end() ) && ( it->element_size == element_size ) && ( byte_offset <= it->byte_size )
+                    && ( byte_size <= it->byte_size - byte_offset );
+  if( !fits ) {
+    is_failed_ = true;
+    return false;
+  }
+  if( byte_size == 0 ) {
+    return true;
+  }
+  file_stream_.seekp( std::streamoff( it->offset + byte_offset ) );
+  file_stream_.write( static_cast< char const* >( data ), std::streamsize( byte_size ) );
+  if( !file_stream_ ) {
+    is_failed_ = true;
+    return false;
+  }
+  return true;
+}
+
+bool AnalysisCacheStreamWriter::commit() {
+  if( !file_stream_.is_open() || is_failed_ || !file_stream_.flush() ) {
+    discard();
+    return false;
+  }
+  file_stream_.close();
+
+  std::error_code ec;
+  std::filesystem::rename( temp_path_, file_path_, ec );
+  if( ec ) {
+    discard();
+    return false;
+  }
+  temp_path_.clear();
+  return true;
+}
+
+void AnalysisCacheStreamWriter::discard() {
+  if( file_stream_.is_open() ) {
+    file_stream_.close();
+  }
+  if( !temp_path_.empty() ) {
+    std::error_code ec;
+    std::filesystem::remove( temp_path_, ec );
+    temp_path_.clear();
+  }
+}
+
+#pragma endregion stream writer
+
+#pragma region reader
+
+bool AnalysisCacheReader::open( std::filesystem::path const& file_path, uint64_t key ) {
+  sections_.clear();
+  if( !file_.open( file_path ) ) {
+    return false;
+  }
+
+  auto miss = [this]() {
+    sections_.clear();
+    file_.close();
+    return false;
+  };
+
+  if( file_.size() < sizeof( AnalysisCacheHeader ) ) {
+    return miss();
+  }
+  AnalysisCacheHeader header;
+  std::memcpy( &header, file_.data(), sizeof( header ) );
+  if( ( header.magic != ANALYSIS_CACHE_MAGIC ) || ( header.version != ANALYSIS_CACHE_VERSION ) || ( header.key != key ) ) {
+    return miss();
+  }
+  uint64_t const table_end = sizeof( AnalysisCacheHeader ) + ( uint64_t( header.section_amount ) * sizeof( AnalysisCacheSectionEntry ) );
+  if( table_end > file_.size() ) {
+    return miss();
+  }
+
+  sections_.reserve( header.section_amount );
+  for( uint32_t s = 0; s < header.section_amount; s++ ) {
+    AnalysisCacheSectionEntry entry;
+    std::memcpy( &entry, file_.data() + sizeof( AnalysisCacheHeader ) + ( s * sizeof( AnalysisCacheSectionEntry ) ), sizeof( entry ) );
+    bool const is_valid = ( entry.element_size > 0 ) && ( entry.offset % ANALYSIS_CACHE_SECTION_ALIGNMENT == 0 ) && ( entry.offset >= table_end )
+                          && ( entry.offset <= file_.size() ) && ( entry.byte_size <= file_.size() - entry.offset )
+                          && ( entry.byte_size % entry.element_size == 0 );
+    if( !is_valid ) {
+      return miss();
+    }
+    sections_.push_back( Section{ entry.tag, entry.element_size, std::span< uint8_t const >( file_.data() + entry.offset, size_t( entry.byte_size ) ) } );
+  }
+
+  return true;
+}
+
+std::optional< std::span< uint8_t const > > AnalysisCacheReader::section_bytes( uint32_t tag, size_t element_size ) const {
+  auto it = std::find_if( sections_.begin(), sections_.end(), [tag]( Section const& section ) { return section.tag == tag; } );
+  if( ( it == sections_.end() ) || ( it->element_size != element_size ) ) {
+    return std::nullopt;
+  }
+  return it->bytes;
+}
+
+#pragma endregion reader
@@ -0,0 +1,477 @@
+#include "audioStream.h"
+
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <utility>
+
+#include "downmix.h"
+
+// frames per read when a whole file is decoded
+static size_t const LOAD_CHUNK_FRAMES = 65536;
+// read after the id3 tag of an mp3 to find its first frame, a frame is at most 2881 bytes and the decoder wants a few in a row
+static size_t const MP3_FORMAT_SCAN_BYTES = 16384;
+
+bool load_pcm_samples( std::filesystem::path const& file_path, PcmSamples& samples ) {
+  std::shared_ptr< MappedWavFile > mapped_wav = std::make_shared< MappedWavFile >();
+  if( mapped_wav->open( file_path ) ) {
+    samples.view = mapped_wav->samples();
+    samples.sample_rate = mapped_wav->sample_rate();
+    samples.owner = std::move( mapped_wav );
+    return true;
+  }
+
+  std::unique_ptr< AudioStream > stream = open_audio_stream( file_path );
+  if( ( stream == nullptr ) || ( stream->channels() == 0 ) ) {
+    return false;
+  }
+
+  // the last read only finds the end, so with a known length the buffer never has to grow
+  uint32_t const channels = stream->channels();
+  std::shared_ptr< std::vector< float > > sample_data = std::make_shared< std::vector< float > >();
+  sample_data->reserve( size_t( stream->total_pcm_frame_count() + LOAD_CHUNK_FRAMES ) * channels );
+  size_t frame_amount = 0;
+  for( size_t read_amount = LOAD_CHUNK_FRAMES; read_amount > 0; frame_amount += read_amount ) {
+    sample_data->resize( ( frame_amount + LOAD_CHUNK_FRAMES ) * channels );
+    read_amount = stream->read( sample_data->data() + ( frame_amount * channels ), LOAD_CHUNK_FRAMES );
+  }
+  sample_data->resize( frame_amount * channels );
+
+  samples.view = PcmSampleView{ PcmSampleFormat::FLOAT32, sample_data->data(), channels, uint64_t( frame_amount ) };
+  samples.sample_rate = stream->sample_rate();
+  samples.owner = std::move( sample_data );
+  return true;
+}
+
+static std::string get_lowercase_extension( std::filesystem::path const& file_path ) {
+  std::string extension = file_path.extension().string();
+  std::transform( extension.begin(), extension.end(), extension.begin(), []( unsigned char c ) { return char( std::tolower( c ) ); } );
+  return extension;
+}
+
+// size of the id3v2 tag in front of the first mp3 frame, 0 if there is none. the size in the tag header is syncsafe (7 bits per byte)
+static uint64_t get_id3v2_tag_size( uint8_t const* header, size_t amount ) {
+  if( ( amount < 10 ) || ( std::memcmp( header, "ID3", 3 ) != 0 ) ) {
+    return 0;
+  }
+  uint64_t const tag_size = ( uint64_t( header[6] & 0x7f ) << 21 ) | ( uint64_t( header[7] & 0x7f ) << 14 ) | ( uint64_t( header[8] & 0x7f ) << 7 )
+                            | uint64_t( header[9] & 0x7f );
+  // the header, the tag and the footer if the flags say there is one
+  return 10 + tag_size + ( ( header[5] & 0x10 ) != 0 ? 10 : 0 );
+}
+
+static bool estimate_mp3_format( std::filesystem::path const& file_path, AudioFormat& format ) {
+  std::error_code error;
+  uint64_t const file_size = std::filesystem::file_size( file_path, error );
+  std::ifstream file( file_path, std::ios::binary );
+  if( error || !file ) {
+    return false;
+  }
+
+  std::vector< uint8_t > buffer( MP3_FORMAT_SCAN_BYTES );
+  file.read( reinterpret_cast< char* >( buffer.data() ), 10 );
+  uint64_t const audio_begin = std::min( get_id3v2_tag_size( buffer.data(), size_t( file.gcount() ) ), file_size );
+  file.clear();
+  file.seekg( std::streamoff( audio_begin ) );
+  file.read( reinterpret_cast< char* >( buffer.data() ), std::streamsize( buffer.size() ) );
+
+  // without an output the decoder only parses the frame header
+  drmp3dec decoder;
+  drmp3dec_init( &decoder );
+  drmp3dec_frame_info info = {};
+  int const frame_samples = drmp3dec_decode_frame( &decoder, buffer.data(), int( file.gcount() ), nullptr, &info );
+  if( ( frame_samples <= 0 ) || ( info.channels <= 0 ) || ( info.hz <= 0 ) || ( info.bitrate_kbps <= 0 ) ) {
+    return false;
+  }
+  format.channels = uint32_t( info.channels );
+  format.sample_rate = uint32_t( info.hz );
+  double const duration = double( file_size - audio_begin ) * 8.0 / ( double( info.bitrate_kbps ) * 1000.0 );
+  format.total_pcm_frame_count = uint64_t( duration * double( info.hz ) );
+  format.is_mapped = false;
+  return true;
+}
+
+bool read_audio_format( std::filesystem::path const& file_path, AudioFormat& format ) {
+  MappedWavFile mapped_wav;
+  if( mapped_wav.open( file_path ) ) {
+    format.channels = mapped_wav.channels();
+    format.sample_rate = mapped_wav.sample_rate();
+    format.total_pcm_frame_count = mapped_wav.total_pcm_frame_count();
+    format.is_mapped = true;
+    return true;
+  }
+  if( ( get_lowercase_extension( file_path ) == ".mp3" ) && estimate_mp3_format( file_path, format ) ) {
+    return true;
+  }
+
+  // the other decoders only read the header when they are opened
+  std::unique_ptr< AudioStream > stream = open_audio_stream( file_path );
+  if( stream == nullptr ) {
+    return false;
+  }
+  format.channels = stream->channels();
+  format.sample_rate = stream->sample_rate();
+  format.total_pcm_frame_count = stream->total_pcm_frame_count();
+  format.is_mapped = false;
+  return true;
+}
+
+std::vector< std::string > const AUDIO_FILE_EXTENSIONS = { ".wav", ".flac", ".mp3", ".ogg" };
+
+std::filesystem::path find_audio_file( std::filesystem::path const& directory, std::string const& stem ) {
+  for( std::string const& extension : AUDIO_FILE_EXTENSIONS ) {
+    std::filesystem::path const file_path = directory / ( stem + extension );
+    if( std::filesystem::is_regular_file( file_path ) ) {
+      return file_path;
+    }
+  }
+  return directory / ( stem + AUDIO_FILE_EXTENSIONS.front() );
+}
+
+template < typename T >
+static std::unique_ptr< AudioStream > open_file_stream( std::filesystem::path const& file_path ) {
+  std::unique_ptr< T > stream = std::make_unique< T >();
+  if( !stream->open( file_path ) ) {
+    return nullptr;
+  }
+  return stream;
+}
+
+std::unique_ptr< AudioStream > open_audio_stream( std::filesystem::path const& file_path ) {
+  std::string const extension = get_lowercase_extension( file_path );
+  if( extension == ".wav" ) {
+    return open_file_stream< WavFileStream >( file_path );
+  }
+  if( extension == ".flac" ) {
+    return open_file_stream< FlacFileStream >( file_path );
+  }
+  if( extension == ".mp3" ) {
+    return open_file_stream< Mp3FileStream >( file_path );
+  }
+  if( extension == ".ogg" ) {
+    return open_file_stream< VorbisFileStream >( file_path );
+  }
+  return nullptr;
+}
+
+#pragma region wav
+
+WavFileStream::~WavFileStream() {
+  close();
+}
+
+bool WavFileStream::open( std::filesystem::path const& file_path ) {
+  close();
+
+  if( mapped_wav_.open( file_path ) ) {
+    return true;
+  }
+
+  std::unique_ptr< drwav > wav = std::make_unique< drwav >();
+  if( !drwav_init_file( wav.get(), file_path.string().c_str(), nullptr ) ) {
+    return false;
+  }
+  wav_ = std::move( wav );
+  return true;
+}
+
+void WavFileStream::close() {
+  mapped_wav_.close();
+  mapped_position_ = 0;
+  if( wav_ != nullptr ) {
+    drwav_uninit( wav_.get() );
+    wav_.reset();
+  }
+}
+
+uint32_t WavFileStream::channels() const {
+  if( mapped_wav_.is_open() ) {
+    return mapped_wav_.channels();
+  }
+  return is_open() ? uint32_t( wav_->channels ) : 0;
+}
+
+uint32_t WavFileStream::sample_rate() const {
+  if( mapped_wav_.is_open() ) {
+    return mapped_wav_.sample_rate();
+  }
+  return is_open() ? uint32_t( wav_->sampleRate ) : 0;
+}
+
+uint64_t WavFileStream::total_pcm_frame_count() const {
+  if( mapped_wav_.is_open() ) {
+    return mapped_wav_.total_pcm_frame_count();
+  }
+  return is_open() ? uint64_t( wav_->totalPCMFrameCount ) : 0;
+}
+
+size_t WavFileStream::read( float* output, size_t frame_amount ) {
+  if( mapped_wav_.is_open() ) {
+    size_t const frames = size_t( std::min< uint64_t >( frame_amount, mapped_wav_.total_pcm_frame_count() - mapped_position_ ) );
+    pcm_to_float( mapped_wav_.samples().frames( mapped_position_, frames ), output );
+    mapped_position_ += frames;
+    return frames;
+  }
+  if( !is_open() ) {
+    return 0;
+  }
+  return size_t( drwav_read_pcm_frames_f32( wav_.get(), frame_amount, output ) );
+}
+
+bool WavFileStream::rewind() {
+  if( mapped_wav_.is_open() ) {
+    mapped_position_ = 0;
+    return true;
+  }
+  return is_open() && drwav_seek_to_pcm_frame( wav_.get(), 0 );
+}
+
+#pragma endregion wav
+
+#pragma region flac
+
+FlacFileStream::~FlacFileStream() {
+  close();
+}
+
+bool FlacFileStream::open( std::filesystem::path const& file_path ) {
+  close();
+
+  flac_ = drflac_open_file( file_path.string().c_str(), nullptr );
+  return flac_ != nullptr;
+}
+
+void FlacFileStream::close() {
+  if( flac_ != nullptr ) {
+    drflac_close( flac_ );
+    flac_ = nullptr;
+  }
+}
+
+uint32_t FlacFileStream::channels() const {
+  return is_open() ? uint32_t( flac_->channels ) : 0;
+}
+
+uint32_t FlacFileStream::sample_rate() const {
+  return is_open() ? uint32_t( flac_->sampleRate ) : 0;
+}
+
+uint64_t FlacFileStream::total_pcm_frame_count() const {
+  return is_open() ? uint64_t( flac_->totalPCMFrameCount ) : 0;
+}
+
+size_t FlacFileStream::read( float* output, size_t frame_amount ) {
+  if( !is_open() ) {
+    return 0;
+  }
+  return size_t( drflac_read_pcm_frames_f32( flac_, frame_amount, output ) );
+}
+
+bool FlacFileStream::rewind() {
+  return is_open() && drflac_seek_to_pcm_frame( flac_, 0 );
+}
+
+#pragma endregion flac
+
+#pragma region mp3
+
+Mp3FileStream::~Mp3FileStream() {
+  close();
+}
+
+bool Mp3FileStream::open( std::filesystem::path const& file_path ) {
+  close();
+
+  std::unique_ptr< drmp3 > mp3 = std::make_unique< drmp3 >();
+  if( !drmp3_init_file( mp3.get(), file_path.string().c_str(), nullptr ) ) {
+    return false;
+  }
+  // counting leaves the decoder where it was
+  total_pcm_frame_count_ = uint64_t( drmp3_get_pcm_frame_count( mp3.get() ) );
+  mp3_ = std::move( mp3 );
+  return true;
+}
+
+void Mp3FileStream::close() {
+  if( mp3_ != nullptr ) {
+    drmp3_uninit( mp3_.get() );
+    mp3_.reset();
+  }
+  total_pcm_frame_count_ = 0;
+}
+
+uint32_t Mp3FileStream::channels() const {
+  return is_open() ? uint32_t( mp3_->channels ) : 0;
+}
+
+uint32_t Mp3FileStream::sample_rate() const {
+  return is_open() ? uint32_t( mp3_->sampleRate ) : 0;
+}
+
+uint64_t Mp3FileStream::total_pcm_frame_count() const {
+  return total_pcm_frame_count_;
+}
+
+size_t Mp3FileStream::read( float* output, size_t frame_amount ) {
+  if( !is_open() ) {
+    return 0;
+  }
+  return size_t( drmp3_read_pcm_frames_f32( mp3_.get(), frame_amount, output ) );
+}
+
+bool Mp3FileStream::rewind() {
+  return is_open() && drmp3_seek_to_pcm_frame( mp3_.get(), 0 );
+}
+
+#pragma endregion mp3
+
+#pragma region vorbis
+
+VorbisFileStream::~VorbisFileStream() {
+  close();
+}
+
+bool VorbisFileStream::open( std::filesystem::path const& file_path ) {
+  close();
+
+  int error = 0;
+  vorbis_ = stb_vorbis_open_filename( file_path.string().c_str(), &error, nullptr );
+  if( vorbis_ == nullptr ) {
+    return false;
+  }
+  stb_vorbis_info const info = stb_vorbis_get_info( vorbis_ );
+  channels_ = uint32_t( info.channels );
+  sample_rate_ = uint32_t( info.sample_rate );
+  return true;
+}
+
+void VorbisFileStream::close() {
+  if( vorbis_ != nullptr ) {
+    stb_vorbis_close( vorbis_ );
+    vorbis_ = nullptr;
+  }
+  channels_ = 0;
+  sample_rate_ = 0;
+}
+
+uint32_t VorbisFileStream::channels() const {
+  return channels_;
+}
+
+uint32_t VorbisFileStream::sample_rate() const {
+  return sample_rate_;
+}
+
+uint64_t VorbisFileStream::total_pcm_frame_count() const {
+  return is_open() ? uint64_t( stb_vorbis_stream_length_in_samples( vorbis_ ) ) : 0;
+}
+
+size_t VorbisFileStream::read( float* output, size_t frame_amount ) {
+  if( !is_open() || ( channels_ == 0 ) ) {
+    return 0;
+  }
+  // stb_vorbis counts the output in ints
+  size_t const float_amount = std::min< size_t >( frame_amount, size_t( INT_MAX ) / channels_ ) * channels_;
+  return size_t( stb_vorbis_get_samples_float_interleaved( vorbis_, int( channels_ ), output, int( float_amount ) ) );
+}
+
+bool VorbisFileStream::rewind() {
+  return is_open() && ( stb_vorbis_seek_start( vorbis_ ) != 0 );
+}
+
+#pragma endregion vorbis
+
+#pragma region threaded
+
+ThreadedAudioStream::ThreadedAudioStream( std::unique_ptr< AudioStream > stream, size_t buffer_frames )
+    : stream_( std::move( stream ) ),
+      channels_( stream_->channels() ),
+      sample_rate_( stream_->sample_rate() ),
+      total_pcm_frame_count_( stream_->total_pcm_frame_count() ),
+      buffer_frames_( std::max< size_t >( buffer_frames, 1 ) ),
+      // a few decodes per buffer, so the decoder can refill while the reader is still working on the rest
+      decode_chunk_frames_( std::max< size_t >( buffer_frames_ / 4, 1 ) ) {
+  buffer_.resize( buffer_frames_ * channels_ );
+  start();
+}
+
+ThreadedAudioStream::~ThreadedAudioStream() {
+  stop();
+}
+
+void ThreadedAudioStream::start() {
+  is_stop_requested_ = false;
+  decode_thread_ = std::thread( &ThreadedAudioStream::decode, this );
+}
+
+void ThreadedAudioStream::stop() {
+  {
+    std::lock_guard< std::mutex > lock( mutex_ );
+    is_stop_requested_ = true;
+  }
+  space_available_.notify_all();
+  if( decode_thread_.joinable() ) {
+    decode_thread_.join();
+  }
+}
+
+void ThreadedAudioStream::decode() {
+  std::unique_lock< std::mutex > lock( mutex_ );
+  while( true ) {
+    space_available_.wait( lock, [this]() { return is_stop_requested_ || ( write_position_ + decode_chunk_frames_ <= read_position_ + buffer_frames_ ); } );
+    if( is_stop_requested_ ) {
+      return;
+    }
+
+    // the frames from the write position on belong to the decoder until it moves the position past them, so the decode itself runs unlocked
+    size_t const offset = size_t( write_position_ % buffer_frames_ );
+    size_t const frame_amount = std::min( decode_chunk_frames_, buffer_frames_ - offset );
+    lock.unlock();
+    size_t const decoded_amount = stream_->read( buffer_.data() + ( offset * channels_ ), frame_amount );
+    lock.lock();
+
+    write_position_ += decoded_amount;
+    is_decode_finished_ = decoded_amount == 0;
+    frames_available_.notify_all();
+    if( is_decode_finished_ ) {
+      return;
+    }
+  }
+}
+
+size_t ThreadedAudioStream::read( float* output, size_t frame_amount ) {
+  size_t read_amount = 0;
+  std::unique_lock< std::mutex > lock( mutex_ );
+  while( read_amount < frame_amount ) {
+    frames_available_.wait( lock, [this]() { return is_decode_finished_ || ( write_position_ > read_position_ ); } );
+    if( write_position_ == read_position_ ) {
+      break;
+    }
+
+    size_t const offset = size_t( read_position_ % buffer_frames_ );
+    size_t const amount = size_t( std::min< uint64_t >( { frame_amount - read_amount, write_position_ - read_position_, buffer_frames_ - offset } ) );
+    std::copy_n( buffer_.data() + ( offset * channels_ ), amount * channels_, output + ( read_amount * channels_ ) );
+    read_position_ += amount;
+    read_amount += amount;
+    space_available_.notify_all();
+  }
+  return read_amount;
+}
+
+bool ThreadedAudioStream::rewind() {
+  stop();
+
+  read_position_ = 0;
+  write_position_ = 0;
+  is_decode_finished_ = false;
+  if( !stream_->rewind() ) {
+    is_decode_finished_ = true;
+    return false;
+  }
+  start();
+  return true;
+}
+
+#pragma endregion threaded
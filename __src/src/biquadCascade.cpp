@@ -0,0 +1,426 @@
+#include "biquadCascade.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <thread>
+#include <utility>
+
+#if defined( __AVX__ )
+#include <immintrin.h>
+#define BIQUAD_CASCADE_AVX
+#define BIQUAD_CASCADE_SSE2
+#elif defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && ( _M_IX86_FP >= 2 ) )
+#include <emmintrin.h>
+#define BIQUAD_CASCADE_SSE2
+#endif
+
+void append_biquad_cascade( BiquadCascade& cascade, Iir::Cascade& filter ) {
+  for( int i = 0; i < filter.getNumStages(); i++ ) {
+    Iir::Biquad const& stage = filter[i];
+    double const a0 = stage.getA0();
+    BiquadCoefficients coefficients;
+    coefficients.b0 = stage.getB0() / a0;
+    coefficients.b1 = stage.getB1() / a0;
+    coefficients.b2 = stage.getB2() / a0;
+    coefficients.a1 = stage.getA1() / a0;
+    coefficients.a2 = stage.getA2() / a0;
+    cascade.push_back( coefficients );
+  }
+}
+
+// one channel per lane, the recursion runs in double in every lane
+struct ScalarLanes {
+  typedef double type;
+  static size_t const WIDTH = 1;
+  static type set1( double value ) { return value; }
+  static type add( type a, type b ) { return a + b; }
+  static type sub( type a, type b ) { return a - b; }
+  static type mul( type a, type b ) { return a * b; }
+  static type load( float const* ptr ) { return double( *ptr ); }
+  static void store( float* ptr, type value ) { *ptr = float( value ); }
+  static type from_array( double const* values ) { return values[0]; }
+  static void to_array( double* values, type value ) { values[0] = value; }
+};
+
+#if defined( BIQUAD_CASCADE_SSE2 )
+struct Sse2Lanes {
+  typedef __m128d type;
+  static size_t const WIDTH = 2;
+  static type set1( double value ) { return _mm_set1_pd( value ); }
+  static type add( type a, type b ) { return _mm_add_pd( a, b ); }
+  static type sub( type a, type b ) { return _mm_sub_pd( a, b ); }
+  static type mul( type a, type b ) { return _mm_mul_pd( a, b ); }
+  static type load( float const* ptr ) { return _mm_cvtps_pd( _mm_castsi128_ps( _mm_loadl_epi64( reinterpret_cast< __m128i const* >( ptr ) ) ) ); }
+  static void store( float* ptr, type value ) { _mm_storel_epi64( reinterpret_cast< __m128i* >( ptr ), _mm_castps_si128( _mm_cvtpd_ps( value ) ) ); }
+  static type from_array( double const* values ) { return _mm_loadu_pd( values ); }
+  static void to_array( double* values, type value ) { _mm_storeu_pd( values, value ); }
+};
+#endif
+
+#if defined( BIQUAD_CASCADE_AVX )
+struct AvxLanes {
+  typedef __m256d type;
+  static size_t const WIDTH = 4;
+  static type set1( double value ) { return _mm256_set1_pd( value ); }
+  static type add( type a, type b ) { return _mm256_add_pd( a, b ); }
+  static type sub( type a, type b ) { return _mm256_sub_pd( a, b ); }
+  static type mul( type a, type b ) { return _mm256_mul_pd( a, b ); }
+  static type load( float const* ptr ) { return _mm256_cvtps_pd( _mm_loadu_ps( ptr ) ); }
+  static void store( float* ptr, type value ) { _mm_storeu_ps( ptr, _mm256_cvtpd_ps( value ) ); }
+  static type from_array( double const* values ) { return _mm256_loadu_pd( values ); }
+  static void to_array( double* values, type value ) { _mm256_storeu_pd( values, value ); }
+};
+#endif
+
+// the zero-input response stops once the summed magnitude of the state is below anything a float sample could show
+static double const DECAYED_STATE_MAGNITUDE = 1e-12;
+
+enum class BlockMode {
+  FILTER,                   // output = cascade( input, state )
+  ADD_ZERO_INPUT_RESPONSE,  // output += cascade( 0, state ), until the state has decayed
+};
+
+// transposed direct form II over `Lanes::WIDTH` neighbouring channels of interleaved data.
+// `input` and `output` point at the first channel of the lane group, `states` holds `2 * cascade.size()` doubles per channel of the group,
+// `state[2 * s]` and `state[2 * s + 1]` being the two delay elements of stage `s`. states are read at the start and written back at the end.
+template < typename Lanes >
+static void filter_lanes( BiquadCascade const& cascade,
+                          float const* input,
+                          float* output,
+                          size_t frame_amount,
+                          size_t channels,
+                          double* states,
+                          BlockMode mode ) {
+  typedef typename Lanes::type type;
+  // vector registers carry alignment attributes that get lost as template arguments, so they are wrapped
+  struct Register {
+    type value;
+  };
+  size_t const stage_amount = cascade.size();
+  size_t const n = 2 * stage_amount;
+
+  std::vector< Register > coefficients( 5 * stage_amount );
+  for( size_t s = 0; s < stage_amount; s++ ) {
+    coefficients[( 5 * s ) + 0].value = Lanes::set1( cascade[s].b0 );
+    coefficients[( 5 * s ) + 1].value = Lanes::set1( cascade[s].b1 );
+    coefficients[( 5 * s ) + 2].value = Lanes::set1( cascade[s].b2 );
+    coefficients[( 5 * s ) + 3].value = Lanes::set1( cascade[s].a1 );
+    coefficients[( 5 * s ) + 4].value = Lanes::set1( cascade[s].a2 );
+  }
+
+  double lane_values[Lanes::WIDTH];
+  std::vector< Register > z( n );
+  for( size_t k = 0; k < n; k++ ) {
+    for( size_t l = 0; l < Lanes::WIDTH; l++ ) {
+      lane_values[l] = states[( l * n ) + k];
+    }
+    z[k].value = Lanes::from_array( lane_values );
+  }
+
+  type const zero = Lanes::set1( 0.0 );
+  for( size_t i = 0; i < frame_amount; i++ ) {
+    type x = ( mode == BlockMode::FILTER ) ? Lanes::load( input + ( i * channels ) ) : zero;
+    for( size_t s = 0; s < stage_amount; s++ ) {
+      Register const* c = coefficients.data() + ( 5 * s );
+      Register* zs = z.data() + ( 2 * s );
+      type const y = Lanes::add( Lanes::mul( c[0].value, x ), zs[0].value );
+      zs[0].value = Lanes::add( Lanes::sub( Lanes::mul( c[1].value, x ), Lanes::mul( c[3].value, y ) ), zs[1].value );
+      zs[1].value = Lanes::sub( Lanes::mul( c[2].value, x ), Lanes::mul( c[4].value, y ) );
+      x = y;
+    }
+
+    if( mode == BlockMode::FILTER ) {
+      Lanes::store( output + ( i * channels ), x );
+      continue;
+    }
+    Lanes::store( output + ( i * channels ), Lanes::add( Lanes::load( output + ( i * channels ) ), x ) );
+    if( ( i & 63 ) == 63 ) {
+      double state_magnitude = 0.0;
+      for( size_t k = 0; k < n; k++ ) {
+        Lanes::to_array( lane_values, z[k].value );
+        for( size_t l = 0; l < Lanes::WIDTH; l++ ) {
+          state_magnitude += std::abs( lane_values[l] );
+        }
+      }
+      if( state_magnitude < DECAYED_STATE_MAGNITUDE ) {
+        break;
+      }
+    }
+  }
+
+  for( size_t k = 0; k < n; k++ ) {
+    Lanes::to_array( lane_values, z[k].value );
+    for( size_t l = 0; l < Lanes::WIDTH; l++ ) {
+      states[( l * n ) + k] = lane_values[l];
+    }
+  }
+}
+
+// runs every channel, in the widest lane groups available
+static void filter_channels( BiquadCascade const& cascade,
+                             float const* input,
+                             float* output,
+                             size_t frame_amount,
+                             size_t channels,
+                             double* states,
+                             BlockMode mode ) {
+  size_t const n = 2 * cascade.size();
+  // the zero-input fix-up has no input, offsetting a null pointer is undefined
+  auto channel_input = [&]( size_t c ) { return ( mode == BlockMode::FILTER ) ? input + c : nullptr; };
+  size_t c = 0;
+#if defined( BIQUAD_CASCADE_AVX )
+  for( ; c + AvxLanes::WIDTH <= channels; c += AvxLanes::WIDTH ) {
+    filter_lanes< AvxLanes >( cascade, channel_input( c ), output + c, frame_amount, channels, states + ( c * n ), mode );
+  }
+#endif
+#if defined( BIQUAD_CASCADE_SSE2 )
+  for( ; c + Sse2Lanes::WIDTH <= channels; c += Sse2Lanes::WIDTH ) {
+    filter_lanes< Sse2Lanes >( cascade, channel_input( c ), output + c, frame_amount, channels, states + ( c * n ), mode );
+  }
+#endif
+  for( ; c < channels; c++ ) {
+    filter_lanes< ScalarLanes >( cascade, channel_input( c ), output + c, frame_amount, channels, states + ( c * n ), mode );
+  }
+}
+
+#if defined( BIQUAD_CASCADE_AVX )
+static size_t const WIDEST_LANE_WIDTH = AvxLanes::WIDTH;
+#elif defined( BIQUAD_CASCADE_SSE2 )
+static size_t const WIDEST_LANE_WIDTH = Sse2Lanes::WIDTH;
+#else
+static size_t const WIDEST_LANE_WIDTH = ScalarLanes::WIDTH;
+#endif
+// frames of every section that `filter_sections` gathers side by side at a time
+static size_t const SECTION_CHUNK_FRAMES = 4096;
+
+// frames `begin` to `begin + length` of a signal
+struct Section {
+  size_t begin;
+  size_t length;
+};
+
+// runs independent sections of the same interleaved signal side by side, section `s` in place of the channels `s * channels` on of a wider signal,
+// so even a single channel fills the simd lanes. `states` holds `2 * cascade.size()` doubles per channel of every section, in section order.
+// they are read at the start, with `BlockMode::FILTER` the states of every section are written back at the end of that section.
+static void filter_sections( BiquadCascade const& cascade,
+                             float const* input,
+                             float* output,
+                             size_t channels,
+                             Section const* sections,
+                             size_t section_amount,
+                             double* states,
+                             BlockMode mode ) {
+  if( section_amount == 1 ) {
+    float const* section_input = ( mode == BlockMode::FILTER ) ? input + ( sections[0].begin * channels ) : nullptr;
+    filter_channels( cascade, section_input, output + ( sections[0].begin * channels ), sections[0].length, channels, states, mode );
+    return;
+  }
+
+  size_t const n = 2 * cascade.size();
+  size_t const lane_channels = section_amount * channels;
+  size_t max_length = 0;
+  for( size_t s = 0; s < section_amount; s++ ) {
+    max_length = std::max( max_length, sections[s].length );
+  }
+  std::vector< double > lane_states( states, states + ( lane_channels * n ) );
+  std::vector< float > lane_input( ( mode == BlockMode::FILTER ) ? SECTION_CHUNK_FRAMES * lane_channels : 0 );
+  std::vector< float > lane_output( SECTION_CHUNK_FRAMES * lane_channels );
+
+  for( size_t i = 0; i < max_length; ) {
+    // chunks end where a section ends, so its state is taken at its own length
+    size_t chunk_frames = std::min( SECTION_CHUNK_FRAMES, max_length - i );
+    for( size_t s = 0; s < section_amount; s++ ) {
+      if( sections[s].length > i ) {
+        chunk_frames = std::min( chunk_frames, sections[s].length - i );
+      }
+    }
+
+    // sections past their end run on silence, nothing of them is used
+    if( mode == BlockMode::FILTER ) {
+      for( size_t j = 0; j < chunk_frames; j++ ) {
+        float* lane_frame = lane_input.data() + ( j * lane_channels );
+        for( size_t s = 0; s < section_amount; s++ ) {
+          bool const is_inside = i + j < sections[s].length;
+          float const* frame = input + ( ( sections[s].begin + i + j ) * channels );
+          for( size_t c = 0; c < channels; c++ ) {
+            lane_frame[( s * channels ) + c] = is_inside ? frame[c] : 0.0f;
+          }
+        }
+      }
+    } else {
+      std::fill( lane_output.begin(), lane_output.end(), 0.0f );
+    }
+    float const* chunk_input = ( mode == BlockMode::FILTER ) ? lane_input.data() : nullptr;
+    filter_channels( cascade, chunk_input, lane_output.data(), chunk_frames, lane_channels, lane_states.data(), mode );
+
+    for( size_t s = 0; s < section_amount; s++ ) {
+      if( i >= sections[s].length ) {
+        continue;
+      }
+      for( size_t j = 0; j < chunk_frames; j++ ) {
+        float const* lane_frame = lane_output.data() + ( j * lane_channels ) + ( s * channels );
+        float* frame = output + ( ( sections[s].begin + i + j ) * channels );
+        for( size_t c = 0; c < channels; c++ ) {
+          frame[c] = ( mode == BlockMode::FILTER ) ? lane_frame[c] : frame[c] + lane_frame[c];
+        }
+      }
+    }
+    i += chunk_frames;
+
+    if( mode == BlockMode::FILTER ) {
+      for( size_t s = 0; s < section_amount; s++ ) {
+        if( sections[s].length == i ) {
+          std::copy_n( lane_states.data() + ( s * channels * n ), channels * n, states + ( s * channels * n ) );
+        }
+      }
+      continue;
+    }
+    double state_magnitude = 0.0;
+    for( double state : lane_states ) {
+      state_magnitude += std::abs( state );
+    }
+    if( state_magnitude < DECAYED_STATE_MAGNITUDE ) {
+      break;
+    }
+  }
+}
+
+// row-major square matrix multiplication, `result = a * b`
+static void multiply_matrix( std::vector< double > const& a, std::vector< double > const& b, std::vector< double >& result, size_t n ) {
+  std::fill( result.begin(), result.end(), 0.0 );
+  for( size_t row = 0; row < n; row++ ) {
+    for( size_t k = 0; k < n; k++ ) {
+      double const a_val = a[( row * n ) + k];
+      for( size_t col = 0; col < n; col++ ) {
+        result[( row * n ) + col] += a_val * b[( k * n ) + col];
+      }
+    }
+  }
+}
+
+// state transition matrix of the cascade over `steps` samples of zero input
+static std::vector< double > state_transition_power( BiquadCascade const& cascade, size_t steps ) {
+  size_t const n = 2 * cascade.size();
+
+  // columns of the single step matrix are the responses to the unit states
+  std::vector< double > base( n * n );
+  std::vector< double > state( n );
+  float unused_output = 0.0f;
+  for( size_t col = 0; col < n; col++ ) {
+    std::fill( state.begin(), state.end(), 0.0 );
+    state[col] = 1.0;
+    filter_lanes< ScalarLanes >( cascade, nullptr, &unused_output, 1, 1, state.data(), BlockMode::ADD_ZERO_INPUT_RESPONSE );
+    for( size_t row = 0; row < n; row++ ) {
+      base[( row * n ) + col] = state[row];
+    }
+  }
+
+  std::vector< double > result( n * n, 0.0 );
+  for( size_t i = 0; i < n; i++ ) {
+    result[( i * n ) + i] = 1.0;
+  }
+  std::vector< double > tmp( n * n );
+  while( steps > 0 ) {
+    if( steps & 1 ) {
+      multiply_matrix( result, base, tmp, n );
+      result.swap( tmp );
+    }
+    steps >>= 1;
+    if( steps > 0 ) {
+      multiply_matrix( base, base, tmp, n );
+      base.swap( tmp );
+    }
+  }
+  return result;
+}
+
+void filter_biquad_cascade( BiquadCascade const& cascade, float const* input, float* output, size_t frame_amount, size_t channels ) {
+  std::vector< double > states( channels * 2 * cascade.size(), 0.0 );
+  filter_channels( cascade, input, output, frame_amount, channels, states.data(), BlockMode::FILTER );
+}
+
+void filter_biquad_cascade_block_parallel( BiquadCascade const& cascade,
+                                           float const* input,
+                                           float* output,
+                                           size_t frame_amount,
+                                           size_t channels,
+                                           uint32_t thread_count,
+                                           size_t min_block_size ) {
+  if( thread_count == 0 ) {
+    thread_count = std::max< uint32_t >( 1, std::thread::hardware_concurrency() );
+  }
+  // with fewer channels than lanes, every thread runs several blocks side by side
+  size_t const blocks_per_thread = std::max< size_t >( 1, WIDEST_LANE_WIDTH / std::max< size_t >( 1, channels ) );
+  size_t block_amount = std::clamp< size_t >( frame_amount / std::max< size_t >( 1, min_block_size ), 1, thread_count * blocks_per_thread );
+  if( ( block_amount == 1 ) || cascade.empty() ) {
+    filter_biquad_cascade( cascade, input, output, frame_amount, channels );
+    return;
+  }
+
+  // every block but the last is `block_length` frames, so a single transition matrix propagates all states
+  size_t const n = 2 * cascade.size();
+  size_t const block_length = ( frame_amount + block_amount - 1 ) / block_amount;
+  block_amount = ( frame_amount + block_length - 1 ) / block_length;
+  std::vector< Section > blocks( block_amount );
+  for( size_t b = 0; b < block_amount; b++ ) {
+    blocks[b].begin = b * block_length;
+    blocks[b].length = std::min( block_length, frame_amount - blocks[b].begin );
+  }
+
+  // runs the blocks `first_block` on, `blocks_per_thread` at a time on a thread each
+  auto run_blocks = [&]( size_t first_block, std::vector< double >& states, BlockMode mode ) {
+    std::vector< std::thread > threads;
+    threads.reserve( ( block_amount - first_block + blocks_per_thread - 1 ) / blocks_per_thread );
+    for( size_t b = first_block; b < block_amount; b += blocks_per_thread ) {
+      threads.emplace_back( filter_sections,
+                            std::cref( cascade ),
+                            input,
+                            output,
+                            channels,
+                            blocks.data() + b,
+                            std::min( blocks_per_thread, block_amount - b ),
+                            states.data() + ( b * channels * n ),
+                            mode );
+    }
+    for( auto& thread : threads ) {
+      thread.join();
+    }
+  };
+
+  // phase 1: filter every block from a zero state, keep the states it ends in
+  std::vector< double > block_states( block_amount * channels * n, 0.0 );
+  run_blocks( 0, block_states, BlockMode::FILTER );
+
+  // phase 2: true initial state of block `b + 1` is `A^block_length * initial_b + zero_state_final_b`
+  std::vector< double > const transition = state_transition_power( cascade, block_length );
+  std::vector< double > initial_states( block_amount * channels * n, 0.0 );
+  for( size_t b = 0; b + 1 < block_amount; b++ ) {
+    for( size_t c = 0; c < channels; c++ ) {
+      double const* initial = initial_states.data() + ( ( ( b * channels ) + c ) * n );
+      double const* zero_state_final = block_states.data() + ( ( ( b * channels ) + c ) * n );
+      double* next_initial = initial_states.data() + ( ( ( ( b + 1 ) * channels ) + c ) * n );
+      for( size_t row = 0; row < n; row++ ) {
+        double value = zero_state_final[row];
+        for( size_t col = 0; col < n; col++ ) {
+          value += transition[( row * n ) + col] * initial[col];
+        }
+        next_initial[row] = value;
+      }
+    }
+  }
+
+  // phase 3: add the zero-input response of the true initial state to every block but the first
+  run_blocks( 1, initial_states, BlockMode::ADD_ZERO_INPUT_RESPONSE );
+}
+
+BiquadCascadeFilter::BiquadCascadeFilter( BiquadCascade cascade, size_t channels )
+    : cascade_( std::move( cascade ) ), channels_( channels ), states_( channels * 2 * cascade_.size(), 0.0 ) {}
+
+void BiquadCascadeFilter::process( float const* input, float* output, size_t frame_amount ) {
+  filter_channels( cascade_, input, output, frame_amount, channels_, states_.data(), BlockMode::FILTER );
+}
+
+void BiquadCascadeFilter::reset() {
+  std::fill( states_.begin(), states_.end(), 0.0 );
+}
@@ -1,6 +1,9 @@
 #include "circleVideoGenerator.h"
 
 #include <Iir.h>
+#include <barrier>
+#include <cmath>
+#include <functional>
 #include <limits>
 #include <memory>
 #include <numbers>
@@ -8,9 +11,19 @@
 
 #include "_dr_wav.h"
 #include "_fftw.h"
+#include "analysisCache.h"
+#include "audioStream.h"
+#include "biquadCascade.h"
 #include "cairo.h"
+#include "downmix.h"
+#include "fftwPlanRegistry.h"
 #include "fontManager.h"
 #include "loggerFactory.h"
+#include "multirate.h"
+#include "onsetDetector.h"
+#include "parallelScan.h"
+#include "spectralKernels.h"
+#include "stft.h"
 #include "surface.h"
 #include "utils.h"
 #include "window_functions.h"
@@ -25,12 +38,12 @@ int32_t const CircleVideoGenerator::VIDEO_HEIGHT = 1080;
 int32_t const CircleVideoGenerator::IIR_FILTER_ORDER = 16;
 double const CircleVideoGenerator::BASS_LP_CUTOFF = 80.0;
 double const CircleVideoGenerator::BASS_HP_CUTOFF = 20.0;
+// the bass path is decimated by powers of two as long as the rate stays above this
+double const CircleVideoGenerator::BASS_MIN_SAMPLE_RATE = 8.0 * CircleVideoGenerator::BASS_LP_CUTOFF;
 // amount of pcm samples played per frame * this = amount of pcm samples shown per frame
 double const CircleVideoGenerator::PCM_FRAME_COUNT_MULT = CircleVideoGenerator::FPS / 10.0;
 double const CircleVideoGenerator::EPILEPSY_WARNING_VISIBLE_SECONDS = 3.0;
 double const CircleVideoGenerator::EPILEPSY_WARNING_FADEOUT_SECONDS = 2.0;
-// uint32_t const CircleVideoGenerator::FFTW_PLAN_FLAGS = FFTW_EXHAUSTIVE;
-uint32_t const CircleVideoGenerator::FFTW_PLAN_FLAGS = FFTW_ESTIMATE;
 std::string const CircleVideoGenerator::EPILEPSY_WARNING_HEADER_FONT = "BarberChop.otf";
 std::string const CircleVideoGenerator::EPILEPSY_WARNING_CONTENT_FONT = "arial_narrow_7.ttf";
 // 0.0 = max smooth, 1.0 = no smooth
@@ -38,18 +51,32 @@ double const CircleVideoGenerator::FFT_COMPUTE_ALPHA = 0.7;
 uint32_t const CircleVideoGenerator::FFT_POINTCLOUD_POINT_AMOUNT = 1024;
 double const CircleVideoGenerator::FFT_POINTCLOUD_MAG_DB_RANGE = 60.0;
 uint32_t const CircleVideoGenerator::FFT_DISPLAY_BIN_AMOUNT = 512;
+// frames per fftw call, large batches of large transforms fall out of cache (see test/fft_batch.cpp)
+uint32_t const CircleVideoGenerator::FFT_BATCH_SIZE = 4;
+// frames of the spectrum held at a time for the point cloud simulation, the whole-file analysis never keeps more of it
+size_t const CircleVideoGenerator::FFT_POINTCLOUD_BLOCK_FRAMES = 256;
 double const CircleVideoGenerator::FFT_DISPLAY_MIN_FREQ = 20.0;
 double const CircleVideoGenerator::FFT_DISPLAY_MAX_FREQ = 200.0;
 double const CircleVideoGenerator::FFT_DISPLAY_MAG_DB_RANGE = 25.0;
 double const CircleVideoGenerator::FFT_DISPLAY_MIN_RADIUS = 270;
 double const CircleVideoGenerator::FFT_DISPLAY_MAX_RADIUS = 540;
+// GLOBAL clamps every frame to the loudest of the whole track, STREAMING follows the loudness over the next FFT_MAG_DB_LOOKAHEAD_SECONDS
+// and lets the streaming render skip its level pass
+MagDbNormalizationMode const CircleVideoGenerator::FFT_MAG_DB_NORMALIZATION_MODE = MagDbNormalizationMode::GLOBAL;
+double const CircleVideoGenerator::FFT_MAG_DB_LOOKAHEAD_SECONDS = 2.0;
+double const CircleVideoGenerator::FFT_MAG_DB_RELEASE_DB_PER_SECOND = 6.0;
+// share of the bass shake that is gated by the beats and onsets, 0.0 = bass only, 1.0 = none of the bass between the beats
+double const CircleVideoGenerator::SHAKE_BEAT_WEIGHT = 0.5;
+// reuse the analysis of an earlier render of the same audio with the same constants
+bool const CircleVideoGenerator::ANALYSIS_CACHE_ENABLED = true;
+// tracks whose whole-file analysis would need more than this are analyzed and rendered in segments from a chunked decode
+size_t const CircleVideoGenerator::STREAMING_MEMORY_BUDGET = size_t( 512 ) << 20;
+size_t const CircleVideoGenerator::STREAMING_CHUNK_FRAMES = 65536;
+// how far the decode thread may run ahead of the analysis
+size_t const CircleVideoGenerator::STREAMING_DECODE_AHEAD_FRAMES = 4 * CircleVideoGenerator::STREAMING_CHUNK_FRAMES;
 
 double CircleVideoGenerator::FFT_POINTCLOUD_MIN_FREQ = 20.0;
 double CircleVideoGenerator::FFT_POINTCLOUD_MAX_FREQ = 22050.0;
-double CircleVideoGenerator::FFT_POINTCLOUD_MAX_MAG_DB = -std::numeric_limits< float >::max();
-double CircleVideoGenerator::FFT_POINTCLOUD_MIN_MAG_DB = std::numeric_limits< float >::max();
-double CircleVideoGenerator::FFT_DISPLAY_MAX_MAG_DB = -std::numeric_limits< float >::max();
-double CircleVideoGenerator::FFT_DISPLAY_MIN_MAG_DB = std::numeric_limits< float >::max();
 
 double CircleVideoGenerator::Point::base_speed_x = CircleVideoGenerator::VIDEO_WIDTH / 5.0;
 double CircleVideoGenerator::Point::base_speed_y = CircleVideoGenerator::VIDEO_HEIGHT / 200.0;
@@ -66,8 +93,37 @@ std::filesystem::path CircleVideoGenerator::project_art_path_;
 std::filesystem::path CircleVideoGenerator::project_audio_path_;
 std::filesystem::path CircleVideoGenerator::project_title_path_;
 std::filesystem::path CircleVideoGenerator::project_temp_pictureset_path_;
+std::filesystem::path CircleVideoGenerator::project_analysis_cache_path_;
 std::shared_ptr< CircleVideoGenerator::AudioData > CircleVideoGenerator::audio_data_ = nullptr;
 std::shared_ptr< CircleVideoGenerator::FrameInformation > CircleVideoGenerator::frame_information_ = nullptr;
+std::optional< uint64_t > CircleVideoGenerator::analysis_cache_key_ = std::nullopt;
+
+// everything of the analysis that is not a table, one entry of the summary section
+struct CircleAnalysisCacheSummary {
+  uint32_t channels;
+  uint32_t sample_rate;
+  uint64_t total_pcm_frame_count;
+  uint64_t amount_output_frames;
+  double pcm_frames_per_output_frame;
+  double fft_pointcloud_max_freq;
+  uint64_t pointcloud_point_amount;
+  uint64_t display_bin_amount;
+  uint64_t display_row_stride;
+};
+
+// bump when the analysis code changes in a way the constants do not show, so older caches miss
+static uint32_t const ANALYSIS_CACHE_REVISION = 4;
+static uint32_t const ANALYSIS_CACHE_SUMMARY_TAG = analysis_cache_tag( "SUMM" );
+static uint32_t const ANALYSIS_CACHE_SOUND_INTENSITY_TAG = analysis_cache_tag( "RMS " );
+static uint32_t const ANALYSIS_CACHE_BASS_INTENSITY_TAG = analysis_cache_tag( "BASS" );
+static uint32_t const ANALYSIS_CACHE_ONSET_STRENGTH_TAG = analysis_cache_tag( "ONST" );
+static uint32_t const ANALYSIS_CACHE_BEAT_STRENGTH_TAG = analysis_cache_tag( "BEAT" );
+static uint32_t const ANALYSIS_CACHE_DISPLAY_VALUES_TAG = analysis_cache_tag( "DISP" );
+static uint32_t const ANALYSIS_CACHE_DISPLAY_X_AXIS_TAG = analysis_cache_tag( "DISX" );
+static uint32_t const ANALYSIS_CACHE_DISPLAY_RANGE_TAG = analysis_cache_tag( "DRNG" );
+static uint32_t const ANALYSIS_CACHE_POINTCLOUD_RADIUS_TAG = analysis_cache_tag( "PCR " );
+static uint32_t const ANALYSIS_CACHE_POINTCLOUD_X_TAG = analysis_cache_tag( "PCX " );
+static uint32_t const ANALYSIS_CACHE_POINTCLOUD_Y_TAG = analysis_cache_tag( "PCY " );
 
 void CircleVideoGenerator::init( std::filesystem::path const& project_path, std::filesystem::path const& common_path ) {
   logger_ = LoggerFactory::get_logger( "CircleVideoGenerator" );
@@ -82,7 +138,7 @@ void CircleVideoGenerator::init( std::filesystem::path const& project_path, std:
   common_bg_path_ = common_path_ / "bg.art.png";
   common_circle_path_ = common_path_ / "circle.png";
   project_art_path_ = project_path_ / "art.png";
-  project_audio_path_ = project_path_ / "audio.wav";
+  project_audio_path_ = find_audio_file( project_path_, "audio" );
   project_title_path_ = project_path_ / "title.txt";
 
   for( auto const& file : std::vector< std::filesystem::path >(
@@ -101,6 +157,9 @@ void CircleVideoGenerator::init( std::filesystem::path const& project_path, std:
   logger_->trace( "[init] creating directory {:?}", project_temp_pictureset_path_.string() );
   std::filesystem::create_directory( project_temp_pictureset_path_ );
 
+  // kept between renders, a stale one is never read because its key does not match
+  project_analysis_cache_path_ = project_path_ / "__analysis.circle.cache";
+
   is_ready_ = ready_val;
   logger_->trace( "[init] exit" );
 }
@@ -119,15 +178,35 @@ void CircleVideoGenerator::render() {
     return;
   }
 
-  prepare_audio();
+  // long tracks render in segments, from the analysis cache if it is there
+  analysis_cache_key_ = get_analysis_cache_key();
+  if( should_stream_audio() ) {
+    AnalysisCacheReader cache_reader;
+    if( open_analysis_cache( cache_reader ) ) {
+      render_streaming_from_cache( cache_reader );
+    } else {
+      render_streaming();
+    }
 
-  calculate_frames();
+    clean_up();
 
-  prepare_surfaces();
+    logger_->trace( "[render] exit" );
+    return;
+  }
+
+  if( !load_analysis_cache() ) {
+    prepare_audio();
+
+    calculate_frames();
+
+    prepare_fft();
+
+    save_analysis_cache();
+  }
 
-  prepare_fft();
+  prepare_surfaces();
 
-  prepare_threads();
+  prepare_threads( 0, frame_information_->amount_output_frames );
 
   start_threads();
 
@@ -148,20 +227,32 @@ void CircleVideoGenerator::prepare_audio() {
 
   audio_data_ = std::make_shared< CircleVideoGenerator::AudioData >();
 
-  audio_data_->sample_data = std::shared_ptr< float[] >( drwav_open_file_and_read_pcm_frames_f32( project_audio_path_.string().c_str(),
-                                                                                                  &audio_data_->channels,
-                                                                                                  &audio_data_->sample_rate,
-                                                                                                  &audio_data_->total_pcm_frame_count,
-                                                                                                  nullptr ),
-                                                         []( float* p ) { drwav_free( p, nullptr ); } );
+  // 16 bit and float wavs are not decoded at all, the analysis reads them from the mapping
+  PcmSamples pcm_samples;
+  if( !load_pcm_samples( project_audio_path_, pcm_samples ) ) {
+    logger_->error( "[prepare_audio] can not read {:?}", project_audio_path_.string() );
+  }
+  audio_data_->sample_data = pcm_samples.view;
+  audio_data_->sample_data_owner = std::move( pcm_samples.owner );
+  audio_data_->channels = pcm_samples.view.channels;
+  audio_data_->sample_rate = pcm_samples.sample_rate;
+  audio_data_->total_pcm_frame_count = pcm_samples.view.frame_amount;
   logger_->debug( "[prepare_audio] audio_data_->channels: {}", audio_data_->channels );
   logger_->debug( "[prepare_audio] audio_data_->sample_rate: {}", audio_data_->sample_rate );
   logger_->debug( "[prepare_audio] audio_data_->total_pcm_frame_count: {}", audio_data_->total_pcm_frame_count );
   audio_data_->duration = double( audio_data_->total_pcm_frame_count ) / double( audio_data_->sample_rate );
   logger_->debug( "[prepare_audio] audio_data_->duration: {}", audio_data_->duration );
 
+  // downmixed once, every analysis window reads it directly
+  audio_data_->mono_sample_data.resize( audio_data_->total_pcm_frame_count );
+  downmix_to_mono( audio_data_->sample_data, audio_data_->mono_sample_data.data() );
+
   create_lowpass_for_audio_data();
 
+  // any window rms is O(1) from these
+  audio_data_->sample_square_prefix_sum = square_prefix_sum( audio_data_->sample_data );
+  audio_data_->bass_sample_square_prefix_sum = square_prefix_sum( audio_data_->bass_sample_data.data(), audio_data_->bass_sample_data.size(), 1 );
+
   logger_->trace( "[prepare_audio] exit" );
 }
 
@@ -173,12 +264,30 @@ void CircleVideoGenerator::calculate_frames() {
     return;
   }
 
-  frame_information_ = std::make_shared< CircleVideoGenerator::FrameInformation >();
+  create_frame_information();
 
-  frame_information_->amount_output_frames = size_t( std::ceil( audio_data_->duration * FPS ) );
-  logger_->debug( "[calculate_frames] frame_information_->amount_output_frames: {}", frame_information_->amount_output_frames );
-  frame_information_->pcm_frames_per_output_frame = double( audio_data_->total_pcm_frame_count ) / double( frame_information_->amount_output_frames );
-  logger_->debug( "[calculate_frames] frame_information_->pcm_frames_per_output_frame: {}", frame_information_->pcm_frames_per_output_frame );
+  uint64_t const pcm_frame_count = uint64_t( double( frame_information_->pcm_frames_per_output_frame ) * PCM_FRAME_COUNT_MULT );
+  int64_t const bass_decimation_factor = audio_data_->bass_decimation_factor;
+  frame_information_->render_context->sound_intensity_per_frame.resize( frame_information_->amount_output_frames );
+  frame_information_->render_context->bass_intensity_per_frame.resize( frame_information_->amount_output_frames );
+  double pcm_frame_offset_dbl = 0.0;
+  for( size_t i = 0; i < frame_information_->amount_output_frames; i++ ) {
+    // played sample will be in the middle of the shown samples
+    int64_t pcm_frame_offset = std::min< int64_t >( audio_data_->total_pcm_frame_count, int64_t( pcm_frame_offset_dbl ) - int64_t( pcm_frame_count / 2 ) );
+
+    double const rms_sum_value = prefix_sum_range( audio_data_->sample_square_prefix_sum, pcm_frame_offset, pcm_frame_offset + int64_t( pcm_frame_count ) );
+    frame_information_->render_context->sound_intensity_per_frame[i]
+        = std::sqrt( rms_sum_value / ( double( audio_data_->channels ) * double( pcm_frame_count ) ) );
+
+    // the bass is at the decimated rate, only the samples belonging to pcm frames in the window count
+    int64_t const bass_window_begin = ( pcm_frame_offset + ( pcm_frame_offset > 0 ? bass_decimation_factor - 1 : 0 ) ) / bass_decimation_factor;
+    int64_t const bass_window_end = ( pcm_frame_offset + int64_t( pcm_frame_count ) + bass_decimation_factor - 1 ) / bass_decimation_factor;
+    double const bass_rms_sum_value = prefix_sum_range( audio_data_->bass_sample_square_prefix_sum, bass_window_begin, bass_window_end );
+    frame_information_->render_context->bass_intensity_per_frame[i]
+        = std::sqrt( bass_rms_sum_value / double( std::max< int64_t >( bass_window_end - bass_window_begin, 1 ) ) );
+
+    pcm_frame_offset_dbl += frame_information_->pcm_frames_per_output_frame;
+  }
 
   // frame_information_->fft_size = 1;
   // while( frame_information_->fft_size < frame_information_->pcm_frames_per_output_frame ) {
@@ -199,6 +308,22 @@ void CircleVideoGenerator::calculate_frames() {
   logger_->trace( "[calculate_frames] exit" );
 }
 
+void CircleVideoGenerator::create_frame_information() {
+  frame_information_ = std::make_shared< CircleVideoGenerator::FrameInformation >();
+
+  frame_information_->amount_output_frames = size_t( std::ceil( audio_data_->duration * FPS ) );
+  logger_->debug( "[create_frame_information] frame_information_->amount_output_frames: {}", frame_information_->amount_output_frames );
+  frame_information_->pcm_frames_per_output_frame = double( audio_data_->total_pcm_frame_count ) / double( frame_information_->amount_output_frames );
+  logger_->debug( "[create_frame_information] frame_information_->pcm_frames_per_output_frame: {}", frame_information_->pcm_frames_per_output_frame );
+
+  frame_information_->render_context = std::make_shared< CircleVideoGenerator::RenderContext >();
+  frame_information_->render_context->amount_output_frames = frame_information_->amount_output_frames;
+  frame_information_->render_context->project_temp_pictureset_path = project_temp_pictureset_path_;
+  frame_information_->render_context->audio_data = audio_data_;
+
+  FFT_POINTCLOUD_MAX_FREQ = double( audio_data_->sample_rate ) / 2.0;
+}
+
 void CircleVideoGenerator::prepare_surfaces() {
   logger_->trace( "[prepare_surfaces] enter" );
 
@@ -208,8 +333,8 @@ void CircleVideoGenerator::prepare_surfaces() {
   }
 
   create_epilepsy_warning();
-  frame_information_->common_bg_surface = surface_load_file( common_bg_path_ );
-  frame_information_->common_circle_surface = surface_load_file( common_circle_path_ );
+  frame_information_->render_context->common_bg_surface = surface_load_file( common_bg_path_ );
+  frame_information_->render_context->common_circle_surface = surface_load_file( common_circle_path_ );
   {
     std::shared_ptr< cairo_surface_t > raw_art_surface = surface_load_file( project_art_path_ );
     double raw_art_width = cairo_image_surface_get_width( raw_art_surface.get() );
@@ -247,214 +372,534 @@ void CircleVideoGenerator::prepare_surfaces() {
       cairo_destroy( cr );
     }
 
-    frame_information_->project_art_surface = centered_circle;
+    frame_information_->render_context->project_art_surface = centered_circle;
   }
-  frame_information_->static_text_surface = surface_render_text_into_overlay( FontManager::get_font_face( "Roboto-Regular.ttf" ),
-                                                                              project_title_path_,
-                                                                              VIDEO_WIDTH,
-                                                                              VIDEO_HEIGHT,
-                                                                              979,
-                                                                              24,
-                                                                              917,
-                                                                              387 );
-
-  logger_->debug( "[prepare_surfaces] frame_information_->common_epilepsy_warning_surface: {}",
-                  static_cast< void* >( frame_information_->common_epilepsy_warning_surface.get() ) );
-  logger_->debug( "[prepare_surfaces] frame_information_->common_bg_surface: {}", static_cast< void* >( frame_information_->common_bg_surface.get() ) );
-  logger_->debug( "[prepare_surfaces] frame_information_->common_circle_surface: {}", static_cast< void* >( frame_information_->common_circle_surface.get() ) );
-  logger_->debug( "[prepare_surfaces] frame_information_->project_art_surface: {}", static_cast< void* >( frame_information_->project_art_surface.get() ) );
-  logger_->debug( "[prepare_surfaces] frame_information_->static_text_surface: {}", static_cast< void* >( frame_information_->static_text_surface.get() ) );
+  frame_information_->render_context->static_text_surface = surface_render_text_into_overlay( FontManager::get_font_face( "Roboto-Regular.ttf" ),
+                                                                                              project_title_path_,
+                                                                                              VIDEO_WIDTH,
+                                                                                              VIDEO_HEIGHT,
+                                                                                              979,
+                                                                                              24,
+                                                                                              917,
+                                                                                              387 );
+
+  logger_->debug( "[prepare_surfaces] render_context->common_epilepsy_warning_surface: {}",
+                  static_cast< void* >( frame_information_->render_context->common_epilepsy_warning_surface.get() ) );
+  logger_->debug( "[prepare_surfaces] render_context->common_bg_surface: {}",
+                  static_cast< void* >( frame_information_->render_context->common_bg_surface.get() ) );
+  logger_->debug( "[prepare_surfaces] render_context->common_circle_surface: {}",
+                  static_cast< void* >( frame_information_->render_context->common_circle_surface.get() ) );
+  logger_->debug( "[prepare_surfaces] render_context->project_art_surface: {}",
+                  static_cast< void* >( frame_information_->render_context->project_art_surface.get() ) );
+  logger_->debug( "[prepare_surfaces] render_context->static_text_surface: {}",
+                  static_cast< void* >( frame_information_->render_context->static_text_surface.get() ) );
 
   logger_->trace( "[prepare_surfaces] exit" );
 }
 
-void CircleVideoGenerator::prepare_fft() {
-  logger_->trace( "[prepare_fft] enter" );
+// the bass only has content between BASS_HP_CUTOFF and BASS_LP_CUTOFF, so it is filtered and analyzed at a fraction of the sample rate
+static uint32_t get_bass_decimation_factor( uint32_t sample_rate ) {
+  uint32_t bass_decimation_factor = 1;
+  while( ( double( sample_rate ) / double( bass_decimation_factor * 2 ) ) >= CircleVideoGenerator::BASS_MIN_SAMPLE_RATE ) {
+    bass_decimation_factor *= 2;
+  }
+  return bass_decimation_factor;
+}
 
-  if( !is_ready_ ) {
-    logger_->error( "[prepare_fft] generator is not ready!" );
-    return;
+static std::vector< DecimationStage > design_bass_decimation_stages( uint32_t sample_rate, uint32_t bass_decimation_factor ) {
+  // keep a little headroom above the low pass cutoff free of aliasing
+  double const bass_passband_edge = ( 1.25 * CircleVideoGenerator::BASS_LP_CUTOFF ) / double( sample_rate );
+  return design_decimation_stages( bass_decimation_factor, bass_passband_edge );
+}
+
+// low pass followed by high pass, as one cascade
+static BiquadCascade create_bass_cascade( double bass_sample_rate ) {
+  Iir::Butterworth::LowPass< CircleVideoGenerator::IIR_FILTER_ORDER > lowpass;
+  Iir::Butterworth::HighPass< CircleVideoGenerator::IIR_FILTER_ORDER > highpass;
+  lowpass.setup( bass_sample_rate, CircleVideoGenerator::BASS_LP_CUTOFF );
+  highpass.setup( bass_sample_rate, CircleVideoGenerator::BASS_HP_CUTOFF );
+
+  BiquadCascade bass_cascade;
+  append_biquad_cascade( bass_cascade, lowpass );
+  append_biquad_cascade( bass_cascade, highpass );
+  return bass_cascade;
+}
+
+// the display bins are a catmull-rom spline over the fft magnitudes (which skip the dc index), this is where every bin sits on it.
+// the bin frequencies go into `x_axis`
+static void init_display_interpolation( size_t fft_size,
+                                        uint32_t sample_rate,
+                                        std::vector< float >& x_axis,
+                                        std::vector< int64_t >& a_indices,
+                                        std::vector< double >& ts ) {
+  uint32_t const bin_amount = CircleVideoGenerator::FFT_DISPLAY_BIN_AMOUNT;
+  double const min_freq = CircleVideoGenerator::FFT_DISPLAY_MIN_FREQ;
+  double const max_freq = CircleVideoGenerator::FFT_DISPLAY_MAX_FREQ;
+  x_axis.resize( bin_amount );
+  a_indices.resize( bin_amount );
+  ts.resize( bin_amount );
+  for( uint32_t bin = 0; bin < bin_amount; bin++ ) {
+    double relative_freq = double( bin ) / double( bin_amount - 1 );
+    double freq = min_freq + ( ( max_freq - min_freq ) * relative_freq );
+    double fft_freq_bin = ( double( fft_size ) * freq / sample_rate ) - 1.0;  // -1 because we skipped the first index earlier
+
+    x_axis[bin] = float( freq );
+    a_indices[bin] = int64_t( std::floor( fft_freq_bin ) );
+    ts[bin] = fft_freq_bin - double( a_indices[bin] );
   }
+}
 
-#pragma region init fft vals
+// one display row from the (clamped) magnitudes of a frame
+static void interpolate_display_row( std::vector< std::pair< double, double > > const& fft_display_vals,
+                                     std::vector< int64_t > const& a_indices,
+                                     std::vector< double > const& ts,
+                                     float* display_row ) {
+  for( size_t bin = 0; bin < a_indices.size(); bin++ ) {
+    int64_t a_index = a_indices[bin];
+    double t = ts[bin];
+    int64_t b_index = a_index + ( t > 0.0 ? 1 : 0 );
+
+    // mag_db = std::lerp( fft_display_vals[a_index].second, fft_display_vals[b_index].second, t );
+    display_row[bin]
+        = float( catmullRom( fft_display_vals[a_index - 1], fft_display_vals[a_index], fft_display_vals[b_index], fft_display_vals[b_index + 1], t ).second );
+  }
+}
 
-  uint64_t pcm_frame_count = uint64_t( double( frame_information_->pcm_frames_per_output_frame ) * PCM_FRAME_COUNT_MULT );
-  size_t fft_size = 1;
-  while( fft_size < pcm_frame_count ) {
-    fft_size = fft_size << 1;
+// the fft of the analysis for samples that arrive chunk by chunk, frames are transformed FFT_BATCH_SIZE at a time as soon as they are complete
+class StreamingSpectrum {
+  public:
+  StreamingSpectrum( StftLayout const& layout, uint32_t sample_rate );
+
+  // fft indices 1 to `fft_size / 2`
+  size_t bin_amount() const { return fft_freqs_.size(); }
+  std::vector< double > const& freqs() const { return fft_freqs_; }
+  // index of the frame `transform` computes next
+  size_t next_frame() const { return next_frame_; }
+
+  void push( float const* samples, size_t amount ) { engine_.push( samples, amount ); }
+  void finish() {
+    engine_.finish();
+    is_finished_ = true;
   }
-  size_t fft_output_size = fft_size / 2 + 1;
-  logger_->trace( "[prepare_fft] pcm_frame_count: {}", pcm_frame_count );
-  logger_->trace( "[prepare_fft] fft_size: {}", fft_size );
-  logger_->trace( "[prepare_fft] fft_output_size: {}", fft_output_size );
 
-  std::shared_ptr< double[] > fft_windows = std::make_shared< double[] >( fft_size );
-  nuttallwin_octave( fft_windows.get(), fft_size, false );
-  std::shared_ptr< float[] > signal_data_for_frame = std::make_shared< float[] >( fft_size );
-  std::shared_ptr< fftwf_complex[] > fft_output = std::make_shared< fftwf_complex[] >( fft_output_size );
-  fftwf_plan fft_plan = fftwf_plan_dft_r2c_1d( fft_size, signal_data_for_frame.get(), fft_output.get(), FFTW_PLAN_FLAGS );
+  // transforms the complete frames before `frame_end`, `on_frame( frame, mag_db )` gets the `bin_amount` magnitudes of every frame in order
+  template < typename OnFrame >
+  void transform( size_t frame_end, OnFrame&& on_frame ) {
+    size_t const fft_size = engine_.layout().fft_size;
+    size_t const fft_output_size = fft_size / 2 + 1;
+    while( next_frame_ < frame_end ) {
+      size_t const batch_frame_limit = std::min( batch_size_, frame_end - next_frame_ );
+      size_t batch_frame_amount = 0;
+      for( ; batch_frame_amount < batch_frame_limit; batch_frame_amount++ ) {
+        float* signal_data_for_frame = signal_data_for_batch_.get() + ( batch_frame_amount * fft_size );
+        if( !engine_.pop_frame( signal_data_for_frame ) ) {
+          if( !is_finished_ ) {
+            break;
+          }
+          // starts past the end of the track
+          std::fill( signal_data_for_frame, signal_data_for_frame + fft_size, 0.0f );
+        }
+      }
+      if( batch_frame_amount == 0 ) {
+        return;
+      }
+      // the last batch may not be full
+      std::fill( signal_data_for_batch_.get() + ( batch_frame_amount * fft_size ), signal_data_for_batch_.get() + ( batch_size_ * fft_size ), 0.0f );
+
+      fftwf_execute_dft_r2c( fft_plan_.get(), signal_data_for_batch_.get(), fft_output_.get() );
+      complex_magnitudes( fft_output_.get(), fft_mags_.data(), fft_output_size * batch_frame_amount );
+      for( size_t b = 0; b < batch_frame_amount; b++ ) {
+        amplitude_to_db( fft_mags_.data() + ( b * fft_output_size ) + 1, fft_gains_.data(), fft_mag_db_.data(), fft_mag_db_.size() );
+        on_frame( next_frame_ + b, static_cast< float const* >( fft_mag_db_.data() ) );
+      }
+      next_frame_ += batch_frame_amount;
+    }
+  }
 
-  double fft_pointcloud_min_mag_db = std::numeric_limits< float >::max();
-  double fft_pointcloud_max_mag_db = -std::numeric_limits< float >::max();
-  double fft_display_min_mag_db = std::numeric_limits< float >::max();
-  double fft_display_max_mag_db = -std::numeric_limits< float >::max();
+  private:
+  StftEngine engine_;
+  size_t batch_size_;
+  std::shared_ptr< float[] > signal_data_for_batch_;
+  std::shared_ptr< fftwf_complex[] > fft_output_;
+  std::shared_ptr< fftwf_plan_s > fft_plan_;
+  std::vector< float > fft_mags_;
+  std::vector< float > fft_gains_;
+  std::vector< double > fft_freqs_;
+  std::vector< float > fft_mag_db_;
+  size_t next_frame_ = 0;
+  bool is_finished_ = false;
+};
+
+static std::vector< float > create_fft_window( size_t fft_size ) {
+  std::vector< double > fft_windows_dbl( fft_size );
+  nuttallwin_octave( fft_windows_dbl.data(), fft_size, false );
+  return std::vector< float >( fft_windows_dbl.begin(), fft_windows_dbl.end() );
+}
 
-#pragma endregion init fft vals
+StreamingSpectrum::StreamingSpectrum( StftLayout const& layout, uint32_t sample_rate )
+    : engine_( layout, create_fft_window( layout.fft_size ) ), batch_size_( std::max< size_t >( 1, CircleVideoGenerator::FFT_BATCH_SIZE ) ) {
+  size_t const fft_size = layout.fft_size;
+  size_t const fft_output_size = fft_size / 2 + 1;
+  // frame `b` of a batch is at `b * fft_size` in the signal and at `b * fft_output_size` in the output and the magnitudes
+  signal_data_for_batch_ = std::shared_ptr< float[] >( fftwf_alloc_real( fft_size * batch_size_ ), fftwf_free );
+  fft_output_ = std::shared_ptr< fftwf_complex[] >( fftwf_alloc_complex( fft_output_size * batch_size_ ), fftwf_free );
+  fft_plan_ = FftwPlanRegistry::get_r2c_batch_plan( int( fft_size ), int( batch_size_ ) );
+  fft_mags_.resize( fft_output_size * batch_size_ );
+
+  // every fft index `fi + 1` is compensated by `sqrt( fi + 1 )` (a tilt of +3 dB per octave) and normalized by the fft size
+  fft_gains_.resize( fft_output_size - 1 );
+  fft_freqs_.resize( fft_output_size - 1 );
+  for( size_t fi = 0; fi < fft_output_size - 1; fi++ ) {
+    fft_freqs_[fi] = double( fi + 1 ) * double( sample_rate ) / double( fft_size );
+    double mag_compensation = std::sqrt( fft_freqs_[fi] / ( 1.0 * double( sample_rate ) / double( fft_size ) ) );
+    fft_gains_[fi] = float( mag_compensation / double( fft_size ) );
+  }
+  fft_mag_db_.resize( fft_output_size - 1 );
+}
 
-#pragma region compute fft
+// what `SpectrumFrameAnalysis` hands out per frame besides its rows
+struct SpectrumFrame {
+  MagDbRange display_range;
+  MagDbRange pointcloud_range;
+  OnsetFrame onsets;
+};
+
+// everything between the spectrum and the per-frame tables, shared by `prepare_fft` and the streaming render.
+// the magnitudes of every frame are pushed in order and wait until the ranges and the onsets of their frame are known, then they are handed out
+// clamped, as a display row and as the magnitudes of the point cloud. a GLOBAL range needs the loudest magnitudes of every frame in a level pass
+// before the first frame is pushed, a STREAMING range looks ahead over the pushed frames
+class CircleVideoGenerator::SpectrumFrameAnalysis {
+  public:
+  SpectrumFrameAnalysis( size_t fft_size, uint32_t sample_rate, std::vector< double > freqs );
+
+  bool has_level_pass() const { return has_level_pass_; }
+  // the magnitudes of every frame once, then `finish_level_pass`, before the first `push`
+  void push_level( float const* mag_db ) { push_max_mag_db( mag_db ); }
+  void finish_level_pass();
+
+  // the magnitudes of the next frame, every frame more than `delay_frames` behind has to be taken with `next` first
+  void push( float const* mag_db );
+  // there are no more frames, every pushed frame is ready now
+  void finish();
+  size_t delay_frames() const { return delay_rows_ - 1; }
+  std::vector< float > const& display_x_axis() const { return display_x_axis_; }
+
+  bool has_next() const;
+  // the next frame: its display row (FFT_DISPLAY_BIN_AMOUNT values, not smoothed yet) and its clamped magnitudes for the point cloud
+  // (one per frequency)
+  SpectrumFrame next( float* display_row, double* pointcloud_mag_db );
+
+  private:
+  void push_max_mag_db( float const* mag_db );
+
+  std::vector< double > freqs_;
+  MagDbNormalizer display_normalizer_;
+  MagDbNormalizer pointcloud_normalizer_;
+  OnsetDetector onset_detector_;
+  bool has_level_pass_;
+  // the magnitudes of the frames waiting for `next`, frame `i` in row `i % delay_rows_`
+  size_t delay_rows_;
+  std::vector< float > delayed_mag_db_;
+  size_t pushed_amount_ = 0;
+  size_t next_frame_ = 0;
+  bool is_finished_ = false;
+  std::vector< float > display_x_axis_;
+  std::vector< int64_t > display_a_indices_;
+  std::vector< double > display_ts_;
+  std::vector< std::pair< double, double > > display_vals_;
+};
+
+CircleVideoGenerator::SpectrumFrameAnalysis::SpectrumFrameAnalysis( size_t fft_size, uint32_t sample_rate, std::vector< double > freqs )
+    : freqs_( std::move( freqs ) ),
+      display_normalizer_( get_mag_db_normalization( FFT_DISPLAY_MAG_DB_RANGE ) ),
+      pointcloud_normalizer_( get_mag_db_normalization( FFT_POINTCLOUD_MAG_DB_RANGE ) ),
+      onset_detector_( get_onset_detection(), freqs_.size() ),
+      has_level_pass_( FFT_MAG_DB_NORMALIZATION_MODE == MagDbNormalizationMode::GLOBAL ) {
+  size_t delay_frames = onset_detector_.lookahead_frames();
+  if( !has_level_pass_ ) {
+    delay_frames = std::max( delay_frames, get_mag_db_normalization( FFT_DISPLAY_MAG_DB_RANGE ).lookahead_frames );
+  }
+  delay_rows_ = delay_frames + 1;
+  delayed_mag_db_.resize( delay_rows_ * freqs_.size() );
 
-  double pcm_frame_offset_dbl = 0.0;
-  std::vector< std::vector< std::pair< double, double > > > fft_vals_per_frame;
-  fft_vals_per_frame.reserve( frame_information_->amount_output_frames );
-  for( size_t i = 0; i < frame_information_->amount_output_frames; i++ ) {
-    // played sample will be in the middle of the shown samples
-    int64_t pcm_frame_offset = std::min< int64_t >( audio_data_->total_pcm_frame_count, int64_t( pcm_frame_offset_dbl ) - int64_t( pcm_frame_count / 2 ) );
-    // logger_->debug( "[prepare_threads] output frame {} from sample {} to {}", i, pcm_frame_offset, pcm_frame_offset + ( pcm_frame_count - 1 ) );
+  init_display_interpolation( fft_size, sample_rate, display_x_axis_, display_a_indices_, display_ts_ );
+  display_vals_.resize( freqs_.size() );
+  for( size_t fi = 0; fi < freqs_.size(); fi++ ) {
+    display_vals_[fi].first = freqs_[fi];
+  }
+}
 
-    for( int64_t si = 0; si < fft_size; si++ ) {
-      signal_data_for_frame[si] = 0.0f;
+void CircleVideoGenerator::SpectrumFrameAnalysis::push_max_mag_db( float const* mag_db ) {
+  // the loudest magnitudes of the frame in the bands of the display and of the point cloud
+  double fft_display_max_mag_db = -std::numeric_limits< float >::max();
+  double fft_pointcloud_max_mag_db = -std::numeric_limits< float >::max();
+  for( size_t fi = 0; fi < freqs_.size(); fi++ ) {
+    if( ( FFT_DISPLAY_MIN_FREQ <= freqs_[fi] ) && ( freqs_[fi] <= FFT_DISPLAY_MAX_FREQ ) ) {
+      fft_display_max_mag_db = std::max( double( mag_db[fi] ), fft_display_max_mag_db );
     }
-    for( int64_t si = 0; si < fft_output_size; si++ ) {
-      fft_output[si][0] = 0.0f;
-      fft_output[si][1] = 0.0f;
+    if( ( FFT_POINTCLOUD_MIN_FREQ <= freqs_[fi] ) && ( freqs_[fi] <= FFT_POINTCLOUD_MAX_FREQ ) ) {
+      fft_pointcloud_max_mag_db = std::max( double( mag_db[fi] ), fft_pointcloud_max_mag_db );
     }
+  }
+  display_normalizer_.push( fft_display_max_mag_db );
+  pointcloud_normalizer_.push( fft_pointcloud_max_mag_db );
+}
 
-    for( uint64_t si = 0; si < pcm_frame_count; si++ ) {
-      int64_t sample_frame_index = ( pcm_frame_offset + int64_t( si ) );
-      if( sample_frame_index < 0 ) {
-        continue;
-      }
-      if( sample_frame_index >= int64_t( audio_data_->total_pcm_frame_count ) ) {
-        continue;
-      }
+void CircleVideoGenerator::SpectrumFrameAnalysis::finish_level_pass() {
+  display_normalizer_.finish();
+  pointcloud_normalizer_.finish();
+}
 
-      float average_sample = 0.0f;
-      for( uint32_t channel = 0; channel < audio_data_->channels; channel++ ) {
-        average_sample += audio_data_->sample_data[( sample_frame_index * audio_data_->channels ) + channel];
-      }
+void CircleVideoGenerator::SpectrumFrameAnalysis::push( float const* mag_db ) {
+  std::copy_n( mag_db, freqs_.size(), delayed_mag_db_.data() + ( ( pushed_amount_ % delay_rows_ ) * freqs_.size() ) );
+  onset_detector_.push( mag_db );
+  if( !has_level_pass_ ) {
+    push_max_mag_db( mag_db );
+  }
+  pushed_amount_++;
+}
 
-      signal_data_for_frame[si] = ( average_sample / float( audio_data_->channels ) ) * fft_windows[si];
-    }
+void CircleVideoGenerator::SpectrumFrameAnalysis::finish() {
+  if( is_finished_ ) {
+    return;
+  }
+  is_finished_ = true;
+  // the ranges and onsets of the last frames have no more frames to look ahead to
+  if( !has_level_pass_ ) {
+    display_normalizer_.finish();
+    pointcloud_normalizer_.finish();
+  }
+  onset_detector_.finish();
+}
 
-    fftwf_execute( fft_plan );
+bool CircleVideoGenerator::SpectrumFrameAnalysis::has_next() const {
+  return ( next_frame_ < pushed_amount_ ) && display_normalizer_.has_next() && pointcloud_normalizer_.has_next() && onset_detector_.has_next();
+}
 
-    std::vector< std::pair< double, double > > fft_output_vals;
-    fft_output_vals.reserve( fft_output_size - 1 );
+SpectrumFrame CircleVideoGenerator::SpectrumFrameAnalysis::next( float* display_row, double* pointcloud_mag_db ) {
+  SpectrumFrame frame;
+  frame.display_range = *display_normalizer_.next();
+  frame.pointcloud_range = *pointcloud_normalizer_.next();
+  frame.onsets = *onset_detector_.next();
 
-    for( uint32_t fi = 0; fi < fft_output_size - 1; fi++ ) {
-      double freq = double( fi + 1 ) * double( audio_data_->sample_rate ) / double( fft_size );
-      double mag_compensation = std::sqrt( freq / ( 1.0 * double( audio_data_->sample_rate ) / double( fft_size ) ) );
+  float const* mag_db = delayed_mag_db_.data() + ( ( next_frame_ % delay_rows_ ) * freqs_.size() );
+  for( size_t fi = 0; fi < freqs_.size(); fi++ ) {
+    display_vals_[fi].second = frame.display_range.clamp( double( mag_db[fi] ) );
+    pointcloud_mag_db[fi] = frame.pointcloud_range.clamp( double( mag_db[fi] ) );
+  }
+  interpolate_display_row( display_vals_, display_a_indices_, display_ts_, display_row );
+  next_frame_++;
+  return frame;
+}
 
-      std::pair< double, double > val;
-      val.first = freq;
-      double mag_real = fft_output[fi + 1][0];
-      double mag_imag = fft_output[fi + 1][1];
-      double mag = std::sqrt( ( mag_real * mag_real ) + ( mag_imag * mag_imag ) ) * mag_compensation / double( fft_size );
-      val.second = 20.0 * std::log10( mag + 1e-12 );
-      fft_output_vals.push_back( val );
+// the partition threads of `simulate_pointcloud`, started once per analysis and handed one block of frames after the other,
+// the calling thread simulates the first partition itself
+class CircleVideoGenerator::PointcloudWorkers {
+  public:
+  explicit PointcloudWorkers( size_t point_amount );
+  ~PointcloudWorkers();
+
+  // runs `simulate_partition( p_begin, p_end )` for every partition of the points, returns once all are done
+  void run( std::function< void( size_t, size_t ) > const& simulate_partition );
+
+  private:
+  static std::vector< std::pair< size_t, size_t > > get_partitions( size_t point_amount );
+  void worker_run( size_t partition );
+
+  std::vector< std::pair< size_t, size_t > > partitions_;
+  std::function< void( size_t, size_t ) > const* simulate_partition_ = nullptr;
+  bool is_stopping_ = false;
+  // every worker and the calling thread meet before and after a block
+  std::barrier<> block_begin_;
+  std::barrier<> block_end_;
+  std::vector< std::thread > threads_;
+};
+
+CircleVideoGenerator::PointcloudWorkers::PointcloudWorkers( size_t point_amount )
+    : partitions_( get_partitions( point_amount ) ), block_begin_( std::ptrdiff_t( partitions_.size() ) ), block_end_( std::ptrdiff_t( partitions_.size() ) ) {
+  threads_.reserve( partitions_.size() - 1 );
+  for( size_t partition = 1; partition < partitions_.size(); partition++ ) {
+    threads_.emplace_back( &CircleVideoGenerator::PointcloudWorkers::worker_run, this, partition );
+  }
+}
 
-      if( ( FFT_DISPLAY_MIN_FREQ <= val.first ) && ( val.first <= FFT_DISPLAY_MAX_FREQ ) ) {
-        fft_display_min_mag_db = std::min( val.second, fft_display_min_mag_db );
-        fft_display_max_mag_db = std::max( val.second, fft_display_max_mag_db );
-      }
-      if( ( FFT_POINTCLOUD_MIN_FREQ <= val.first ) && ( val.first <= FFT_POINTCLOUD_MAX_FREQ ) ) {
-        fft_pointcloud_min_mag_db = std::min( val.second, fft_pointcloud_min_mag_db );
-        fft_pointcloud_max_mag_db = std::max( val.second, fft_pointcloud_max_mag_db );
-      }
-    }
-    fft_vals_per_frame.push_back( fft_output_vals );
+CircleVideoGenerator::PointcloudWorkers::~PointcloudWorkers() {
+  is_stopping_ = true;
+  block_begin_.arrive_and_wait();
+  for( auto& thread : threads_ ) {
+    thread.join();
+  }
+}
 
-    pcm_frame_offset_dbl += frame_information_->pcm_frames_per_output_frame;
+std::vector< std::pair< size_t, size_t > > CircleVideoGenerator::PointcloudWorkers::get_partitions( size_t point_amount ) {
+  // keep partitions a multiple of 16 points, so neighbouring threads do not share cache lines of the table rows
+  size_t const partition_granularity = 16;
+  size_t const thread_count = std::max< uint32_t >( 1, std::thread::hardware_concurrency() );
+  size_t const partition_amount = std::clamp< size_t >( ( point_amount + partition_granularity - 1 ) / partition_granularity, 1, thread_count );
+  size_t partition_size = ( point_amount + partition_amount - 1 ) / partition_amount;
+  partition_size = std::max< size_t >( 1, ( ( partition_size + partition_granularity - 1 ) / partition_granularity ) * partition_granularity );
+  std::vector< std::pair< size_t, size_t > > partitions;
+  for( size_t p_begin = 0; p_begin < point_amount; p_begin += partition_size ) {
+    partitions.emplace_back( p_begin, std::min( p_begin + partition_size, point_amount ) );
   }
+  if( partitions.empty() ) {
+    partitions.emplace_back( 0, 0 );
+  }
+  return partitions;
+}
 
-#pragma endregion compute fft
+void CircleVideoGenerator::PointcloudWorkers::worker_run( size_t partition ) {
+  while( true ) {
+    block_begin_.arrive_and_wait();
+    if( is_stopping_ ) {
+      return;
+    }
+    ( *simulate_partition_ )( partitions_[partition].first, partitions_[partition].second );
+    block_end_.arrive_and_wait();
+  }
+}
 
-#pragma region min/max mag
+void CircleVideoGenerator::PointcloudWorkers::run( std::function< void( size_t, size_t ) > const& simulate_partition ) {
+  simulate_partition_ = &simulate_partition;
+  block_begin_.arrive_and_wait();
+  simulate_partition( partitions_.front().first, partitions_.front().second );
+  block_end_.arrive_and_wait();
+  simulate_partition_ = nullptr;
+}
 
-  FFT_POINTCLOUD_MAX_FREQ = double( audio_data_->sample_rate ) / 2.0;
-  FFT_POINTCLOUD_MAX_MAG_DB = std::ceil( fft_pointcloud_max_mag_db );
-  FFT_POINTCLOUD_MIN_MAG_DB = FFT_POINTCLOUD_MAX_MAG_DB - FFT_POINTCLOUD_MAG_DB_RANGE;
-  FFT_DISPLAY_MAX_MAG_DB = std::ceil( fft_display_max_mag_db );
-  FFT_DISPLAY_MIN_MAG_DB = FFT_DISPLAY_MAX_MAG_DB - FFT_DISPLAY_MAG_DB_RANGE;
-  logger_->trace( "[prepare_fft] FFT_POINTCLOUD_MAX_MAG_DB: {}", FFT_POINTCLOUD_MAX_MAG_DB );
-  logger_->trace( "[prepare_fft] FFT_POINTCLOUD_MIN_MAG_DB: {}", FFT_POINTCLOUD_MIN_MAG_DB );
-  logger_->trace( "[prepare_fft] FFT_DISPLAY_MAX_MAG_DB: {}", FFT_DISPLAY_MAX_MAG_DB );
-  logger_->trace( "[prepare_fft] FFT_DISPLAY_MIN_MAG_DB: {}", FFT_DISPLAY_MIN_MAG_DB );
-
-#pragma endregion min / max mag
-
-#pragma region clamp fft display vals
-
-  std::vector< std::vector< std::pair< double, double > > > fft_display_vals_per_frame;
-  fft_display_vals_per_frame.reserve( fft_vals_per_frame.size() );
-  for( std::vector< std::pair< double, double > > fft_vals : fft_vals_per_frame ) {
-    std::vector< std::pair< double, double > > fft_display_vals;
-    fft_display_vals.reserve( fft_vals.size() );
-    for( std::pair< double, double > pair : fft_vals ) {
-      std::pair< double, double > val;
-      val.first = pair.first;
-      val.second = std::clamp( pair.second, FFT_DISPLAY_MIN_MAG_DB, FFT_DISPLAY_MAX_MAG_DB );
-      fft_display_vals.push_back( val );
-    }
-    fft_display_vals_per_frame.push_back( fft_display_vals );
+void CircleVideoGenerator::prepare_fft() {
+  logger_->trace( "[prepare_fft] enter" );
+
+  if( !is_ready_ ) {
+    logger_->error( "[prepare_fft] generator is not ready!" );
+    return;
   }
 
-#pragma endregion clamp fft display vals
+#pragma region init fft vals
 
-#pragma region clamp fft pointcloud vals
+  uint64_t pcm_frame_count = uint64_t( double( frame_information_->pcm_frames_per_output_frame ) * PCM_FRAME_COUNT_MULT );
+  StftLayout const stft_layout = StftLayout::from_window( pcm_frame_count, frame_information_->pcm_frames_per_output_frame );
+  size_t fft_size = stft_layout.fft_size;
+  logger_->trace( "[prepare_fft] pcm_frame_count: {}", pcm_frame_count );
+  logger_->trace( "[prepare_fft] fft_size: {}", fft_size );
 
-  std::vector< std::vector< std::pair< double, double > > > fft_pointcloud_vals_per_frame;
-  fft_pointcloud_vals_per_frame.reserve( fft_vals_per_frame.size() );
-  for( std::vector< std::pair< double, double > > fft_vals : fft_vals_per_frame ) {
-    std::vector< std::pair< double, double > > fft_pointcloud_vals;
-    fft_pointcloud_vals.reserve( fft_vals.size() );
-    for( std::pair< double, double > pair : fft_vals ) {
-      std::pair< double, double > val;
-      val.first = pair.first;
-      val.second = std::clamp( pair.second, FFT_POINTCLOUD_MIN_MAG_DB, FFT_POINTCLOUD_MAX_MAG_DB );
-      fft_pointcloud_vals.push_back( val );
+  size_t const amount_output_frames = frame_information_->amount_output_frames;
+  std::vector< float > const& mono_sample_data = audio_data_->mono_sample_data;
+  // the spectrum of every frame is computed from the samples in memory and handed on, it is never kept for the whole track
+  auto transform_track = [&]( StreamingSpectrum& spectrum, auto&& on_frame ) {
+    for( size_t sample_begin = 0; sample_begin < mono_sample_data.size(); sample_begin += STREAMING_CHUNK_FRAMES ) {
+      spectrum.push( mono_sample_data.data() + sample_begin, std::min( STREAMING_CHUNK_FRAMES, mono_sample_data.size() - sample_begin ) );
+      spectrum.transform( amount_output_frames, on_frame );
     }
-    fft_pointcloud_vals_per_frame.push_back( fft_pointcloud_vals );
-  }
+    spectrum.finish();
+    spectrum.transform( amount_output_frames, on_frame );
+  };
 
-#pragma endregion clamp fft pointcloud vals
+  StreamingSpectrum spectrum( stft_layout, audio_data_->sample_rate );
+  size_t const fft_bin_amount = spectrum.bin_amount();
+  CircleVideoGenerator::SpectrumFrameAnalysis analysis( fft_size, audio_data_->sample_rate, spectrum.freqs() );
 
-#pragma region compute display vals
+#pragma endregion init fft vals
 
-  frame_information_->fft_display_values_per_frame.reserve( fft_display_vals_per_frame.size() );
-  for( std::vector< std::pair< double, double > > fft_display_vals : fft_display_vals_per_frame ) {
-    std::shared_ptr< std::vector< std::pair< double, double > > > formatted_fft_display_values
-        = std::make_shared< std::vector< std::pair< double, double > > >();
-    formatted_fft_display_values->reserve( FFT_DISPLAY_BIN_AMOUNT );
-
-    for( uint32_t bin = 0; bin < FFT_DISPLAY_BIN_AMOUNT; bin++ ) {
-      double relative_freq = double( bin ) / double( FFT_DISPLAY_BIN_AMOUNT - 1 );
-      double freq = FFT_DISPLAY_MIN_FREQ + ( ( FFT_DISPLAY_MAX_FREQ - FFT_DISPLAY_MIN_FREQ ) * relative_freq );
-      double fft_freq_bin = ( double( fft_size ) * freq / audio_data_->sample_rate ) - 1.0;  // -1 because we skipped the first index earlier
-
-      int64_t a_index = int64_t( std::floor( fft_freq_bin ) );
-      int64_t b_index = int64_t( std::ceil( fft_freq_bin ) );
-      double t = fft_freq_bin - double( a_index );
-      std::pair< double, double > val;
-      val.first = freq;
-
-      // val.second = std::lerp( fft_display_vals[a_index].second, fft_display_vals[b_index].second, t );
-      val.second = catmullRom( fft_display_vals[a_index - 1], fft_display_vals[a_index], fft_display_vals[b_index], fft_display_vals[b_index + 1], t ).second;
-      if( frame_information_->fft_display_values_per_frame.size() > 0 ) {
-        // apply smoothing
-        val.second
-            = ( FFT_COMPUTE_ALPHA * val.second ) + ( ( 1.0 - FFT_COMPUTE_ALPHA ) * frame_information_->fft_display_values_per_frame.back()->at( bin ).second );
-      }
+#pragma region level pass
 
-      formatted_fft_display_values->push_back( val );
+  // a GLOBAL range needs the loudest magnitudes of the whole track before the first frame, so the spectrum is computed twice instead of kept
+  if( analysis.has_level_pass() ) {
+    StreamingSpectrum level_spectrum( stft_layout, audio_data_->sample_rate );
+    transform_track( level_spectrum, [&]( size_t, float const* fft_mag_db ) { analysis.push_level( fft_mag_db ); } );
+    analysis.finish_level_pass();
+  }
+
+#pragma endregion level pass
+
+#pragma region compute frames
+
+  CircleVideoGenerator::RenderContext& render_context = *frame_information_->render_context;
+  render_context.onset_strength_per_frame.resize( amount_output_frames );
+  render_context.beat_strength_per_frame.resize( amount_output_frames );
+  render_context.fft_display_range_per_frame.resize( amount_output_frames );
+  Spectrogram& fft_display_spectrogram = render_context.fft_display_spectrogram;
+  fft_display_spectrogram = Spectrogram( amount_output_frames, FFT_DISPLAY_BIN_AMOUNT );
+  fft_display_spectrogram.x_axis() = analysis.display_x_axis();
+
+  CircleVideoGenerator::PointcloudTable& pointcloud_table = render_context.fft_pointcloud_table;
+  CircleVideoGenerator::PointcloudSimulation pointcloud_simulation = create_pointcloud_simulation( fft_size, pointcloud_table );
+  // the partition threads wait for the next block in between, so they are only started once
+  CircleVideoGenerator::PointcloudWorkers pointcloud_workers( pointcloud_table.point_amount );
+  pointcloud_table.x.resize( amount_output_frames * pointcloud_table.point_amount );
+  pointcloud_table.y.resize( amount_output_frames * pointcloud_table.point_amount );
+  // the clamped magnitudes of the point cloud are simulated FFT_POINTCLOUD_BLOCK_FRAMES frames at a time
+  std::vector< double > fft_pointcloud_mag_db_per_frame( FFT_POINTCLOUD_BLOCK_FRAMES * fft_bin_amount );
+  std::vector< MagDbRange > fft_pointcloud_range_per_frame( FFT_POINTCLOUD_BLOCK_FRAMES );
+
+  size_t display_frame = 0;
+  size_t pointcloud_block_begin = 0;
+  auto emit_ready_frames = [&]() {
+    while( analysis.has_next() ) {
+      size_t const block_row = display_frame - pointcloud_block_begin;
+      SpectrumFrame const frame
+          = analysis.next( fft_display_spectrogram.row( display_frame ), fft_pointcloud_mag_db_per_frame.data() + ( block_row * fft_bin_amount ) );
+      render_context.fft_display_range_per_frame[display_frame] = frame.display_range;
+      fft_pointcloud_range_per_frame[block_row] = frame.pointcloud_range;
+      render_context.onset_strength_per_frame[display_frame] = frame.onsets.onset_strength;
+      render_context.beat_strength_per_frame[display_frame] = frame.onsets.beat_strength;
+      display_frame++;
+
+      if( ( block_row + 1 == FFT_POINTCLOUD_BLOCK_FRAMES ) || ( display_frame == amount_output_frames ) ) {
+        simulate_pointcloud( pointcloud_workers,
+                             pointcloud_simulation,
+                             fft_pointcloud_mag_db_per_frame.data(),
+                             fft_pointcloud_range_per_frame.data(),
+                             fft_bin_amount,
+                             block_row + 1,
+                             pointcloud_block_begin,
+                             pointcloud_table );
+        pointcloud_block_begin = display_frame;
+      }
     }
+  };
 
-    frame_information_->fft_display_values_per_frame.push_back( formatted_fft_display_values );
-  }
+  transform_track( spectrum, [&]( size_t, float const* fft_mag_db ) {
+    analysis.push( fft_mag_db );
+    emit_ready_frames();
+  } );
+  analysis.finish();
+  emit_ready_frames();
+
+#pragma endregion compute frames
+
+#pragma region compute display vals
+
+  // apply smoothing
+  exponential_smoothing_scan( fft_display_spectrogram.data(),
+                              fft_display_spectrogram.frame_amount(),
+                              FFT_DISPLAY_BIN_AMOUNT,
+                              fft_display_spectrogram.row_stride(),
+                              FFT_COMPUTE_ALPHA );
 
 #pragma endregion compute display vals
 
-#pragma region init pointcloud vec
+  logger_->trace( "[prepare_fft] exit" );
+}
+
+MagDbNormalization CircleVideoGenerator::get_mag_db_normalization( double mag_db_range ) {
+  MagDbNormalization normalization;
+  normalization.mode = FFT_MAG_DB_NORMALIZATION_MODE;
+  normalization.mag_db_range = mag_db_range;
+  normalization.lookahead_frames = size_t( std::ceil( FFT_MAG_DB_LOOKAHEAD_SECONDS * FPS ) );
+  normalization.release_db_per_frame = FFT_MAG_DB_RELEASE_DB_PER_SECOND / FPS;
+  return normalization;
+}
+
+OnsetDetection CircleVideoGenerator::get_onset_detection() {
+  OnsetDetection detection;
+  detection.frames_per_second = FPS;
+  return detection;
+}
+
+CircleVideoGenerator::PointcloudSimulation CircleVideoGenerator::create_pointcloud_simulation( size_t fft_size,
+                                                                                                CircleVideoGenerator::PointcloudTable& pointcloud_table ) {
+  logger_->trace( "[create_pointcloud_simulation] enter: fft_size: {}", fft_size );
 
   double fft_pointcloud_starting_x = 0.0 - CircleVideoGenerator::Point::base_radius;
   double fft_pointcloud_ending_x = double( VIDEO_WIDTH ) + CircleVideoGenerator::Point::base_radius;
@@ -488,99 +933,137 @@ void CircleVideoGenerator::prepare_fft() {
     }
   }
 
-#pragma endregion init pointcloud vec
-
-#pragma region compute pointcloud vals
-
-  frame_information_->fft_pointcloud_values_per_frame.reserve( fft_pointcloud_vals_per_frame.size() );
-  for( std::vector< std::pair< double, double > > fft_pointcloud_vals : fft_pointcloud_vals_per_frame ) {
-    for( uint32_t p_i = 0; p_i < pointcloud_vec.size(); p_i++ ) {
-      CircleVideoGenerator::Point& point = pointcloud_vec[p_i];
-      double freq = point.z;
-      double fft_freq_bin = ( double( fft_size ) * freq / audio_data_->sample_rate ) - 1.0;  // -1 because we skipped the first index earlier
+  pointcloud_table.point_amount = pointcloud_vec.size();
+  pointcloud_table.radius.resize( pointcloud_table.point_amount );
+  for( size_t p_i = 0; p_i < pointcloud_vec.size(); p_i++ ) {
+    pointcloud_table.radius[p_i] = float( pointcloud_vec[p_i].radius );
+  }
 
-      int64_t a_index = int64_t( std::floor( fft_freq_bin ) );
-      int64_t b_index = int64_t( std::ceil( fft_freq_bin ) );
-      double t = fft_freq_bin - double( a_index );
+  // the frequency of a point never changes, so its spline indices and weights are computed once and the per frame loop stays branchless
+  CircleVideoGenerator::PointcloudSimulation simulation;
+  size_t const p_amount = pointcloud_vec.size();
+  simulation.bin_index.resize( p_amount );
+  for( std::vector< double >& weights : simulation.bin_weights ) {
+    weights.resize( p_amount );
+  }
+  simulation.x.resize( p_amount );
+  simulation.y.resize( p_amount );
+  simulation.speed_x.resize( p_amount );
+  simulation.speed_y.resize( p_amount );
+  for( size_t p_i = 0; p_i < p_amount; p_i++ ) {
+    CircleVideoGenerator::Point const& point = pointcloud_vec[p_i];
+    double fft_freq_bin = ( double( fft_size ) * point.z / audio_data_->sample_rate ) - 1.0;  // -1 because we skipped the first index earlier
+
+    // catmull-rom over `a_index - 1`, `a_index`, `b_index`, `b_index + 1`, `b_index` is either `a_index` or `a_index + 1`
+    int64_t a_index = int64_t( std::floor( fft_freq_bin ) );
+    double t = fft_freq_bin - double( a_index );
+    double weights[4];
+    catmullRom_weights( t, weights );
+    if( int64_t( std::ceil( fft_freq_bin ) ) == a_index ) {
+      // p1 == p2 on exact bins, fold the duplicated sample into the outer weights
+      weights[1] += weights[2];
+      weights[2] = weights[3];
+      weights[3] = 0.0;
+    }
+    simulation.bin_index[p_i] = a_index - 1;
+    for( int k = 0; k < 4; k++ ) {
+      simulation.bin_weights[k][p_i] = weights[k];
+    }
 
-      // double mag_db_val = std::lerp( fft_pointcloud_vals[a_index].second, fft_pointcloud_vals[b_index].second, t );
-      double mag_db_val
-          = catmullRom( fft_pointcloud_vals[a_index - 1], fft_pointcloud_vals[a_index], fft_pointcloud_vals[b_index], fft_pointcloud_vals[b_index + 1], t )
-                .second;
-      double norm_mag_db = ( mag_db_val - FFT_POINTCLOUD_MIN_MAG_DB ) / ( FFT_POINTCLOUD_MAX_MAG_DB - FFT_POINTCLOUD_MIN_MAG_DB );
-      norm_mag_db = std::clamp( norm_mag_db, 0.0, 1.0 );
-      double point_speed = std::lerp( CircleVideoGenerator::Point::base_speed_x * 0.0625, CircleVideoGenerator::Point::base_speed_x, norm_mag_db );
+    simulation.x[p_i] = point.x;
+    simulation.y[p_i] = point.y;
+    simulation.speed_x[p_i] = point.speed_x;
+    simulation.speed_y[p_i] = point.speed_y;
+  }
 
-      // apply smoothing
-      point.speed_x = ( FFT_COMPUTE_ALPHA * point_speed ) + ( ( 1.0 - FFT_COMPUTE_ALPHA ) * point.speed_x );
+  logger_->trace( "[create_pointcloud_simulation] exit" );
+  return simulation;
+}
 
-      point.x += point.speed_x / FPS;
-      point.y += point.speed_y / FPS;
+void CircleVideoGenerator::simulate_pointcloud( CircleVideoGenerator::PointcloudWorkers& workers,
+                                                CircleVideoGenerator::PointcloudSimulation& simulation,
+                                                double const* mag_db_per_frame,
+                                                MagDbRange const* range_per_frame,
+                                                size_t bin_amount,
+                                                size_t frame_amount,
+                                                size_t table_frame_begin,
+                                                CircleVideoGenerator::PointcloudTable& pointcloud_table ) {
+  double const fft_pointcloud_starting_x = 0.0 - CircleVideoGenerator::Point::base_radius;
+  double const fft_pointcloud_ending_x = double( VIDEO_WIDTH ) + CircleVideoGenerator::Point::base_radius;
+  double const fft_pointcloud_starting_y = 0.0 - CircleVideoGenerator::Point::base_radius;
+  double const fft_pointcloud_ending_y = double( VIDEO_HEIGHT ) + CircleVideoGenerator::Point::base_radius;
+  size_t const point_amount = pointcloud_table.point_amount;
+
+  // every point only depends on its own state and the spectrum, so the points are split into partitions that are simulated on their own threads
+  std::function< void( size_t, size_t ) > const simulate_pointcloud_partition = [&]( size_t p_begin, size_t p_end ) {
+    double const min_speed_x = CircleVideoGenerator::Point::base_speed_x * 0.0625;
+    double const max_speed_x = CircleVideoGenerator::Point::base_speed_x;
+    for( size_t i = 0; i < frame_amount; i++ ) {
+      double const min_mag_db = range_per_frame[i].min_mag_db;
+      double const mag_db_scale = 1.0 / ( range_per_frame[i].max_mag_db - range_per_frame[i].min_mag_db );
+      double const* fft_pointcloud_vals = mag_db_per_frame + ( i * bin_amount );
+      float* table_x = pointcloud_table.x.data() + ( ( table_frame_begin + i ) * point_amount );
+      float* table_y = pointcloud_table.y.data() + ( ( table_frame_begin + i ) * point_amount );
+      for( size_t p_i = p_begin; p_i < p_end; p_i++ ) {
+        double const* vals = fft_pointcloud_vals + simulation.bin_index[p_i];
+        double mag_db_val = ( simulation.bin_weights[0][p_i] * vals[0] ) + ( simulation.bin_weights[1][p_i] * vals[1] )
+                            + ( simulation.bin_weights[2][p_i] * vals[2] ) + ( simulation.bin_weights[3][p_i] * vals[3] );
+        double norm_mag_db = std::clamp( ( mag_db_val - min_mag_db ) * mag_db_scale, 0.0, 1.0 );
+        double point_speed = min_speed_x + ( ( max_speed_x - min_speed_x ) * norm_mag_db );
 
-      if( point.x < fft_pointcloud_starting_x ) {
-        point.x = fft_pointcloud_ending_x;
-      }
-      if( point.x > fft_pointcloud_ending_x ) {
-        point.x = fft_pointcloud_starting_x;
-      }
-      if( point.y < fft_pointcloud_starting_y ) {
-        point.y = fft_pointcloud_ending_y;
-      }
-      if( point.y > fft_pointcloud_ending_y ) {
-        point.y = fft_pointcloud_starting_y;
+        // apply smoothing
+        double speed_x = ( FFT_COMPUTE_ALPHA * point_speed ) + ( ( 1.0 - FFT_COMPUTE_ALPHA ) * simulation.speed_x[p_i] );
+        double x = simulation.x[p_i] + ( speed_x / FPS );
+        double y = simulation.y[p_i] + ( simulation.speed_y[p_i] / FPS );
+
+        x = ( x < fft_pointcloud_starting_x ) ? fft_pointcloud_ending_x : x;
+        x = ( x > fft_pointcloud_ending_x ) ? fft_pointcloud_starting_x : x;
+        y = ( y < fft_pointcloud_starting_y ) ? fft_pointcloud_ending_y : y;
+        y = ( y > fft_pointcloud_ending_y ) ? fft_pointcloud_starting_y : y;
+
+        simulation.speed_x[p_i] = speed_x;
+        simulation.x[p_i] = x;
+        simulation.y[p_i] = y;
+        table_x[p_i] = float( x );
+        table_y[p_i] = float( y );
       }
     }
+  };
 
-    frame_information_->fft_pointcloud_values_per_frame.push_back( std::make_shared< std::vector< Point > >( pointcloud_vec ) );
-  }
-
-#pragma endregion compute pointcloud vals
-
-  logger_->trace( "[prepare_fft] exit" );
+  workers.run( simulate_pointcloud_partition );
 }
 
-void CircleVideoGenerator::prepare_threads() {
-  logger_->trace( "[prepare_threads] enter" );
+void CircleVideoGenerator::prepare_threads( size_t frame_begin, size_t frame_end ) {
+  logger_->trace( "[prepare_threads] enter: frame_begin: {}, frame_end: {}", frame_begin, frame_end );
 
   if( !is_ready_ ) {
     logger_->error( "[prepare_threads] generator is not ready!" );
     return;
   }
 
-  uint32_t thread_count = std::thread::hardware_concurrency();
+  uint32_t thread_count = std::max< uint32_t >( 1, std::thread::hardware_concurrency() );
   logger_->debug( "[prepare_threads] thread_count: {}", thread_count );
-  frame_information_->thread_input_lists.reserve( std::thread::hardware_concurrency() );
-  for( int i = 0; i < frame_information_->thread_input_lists.capacity(); i++ ) {
-    std::vector< CircleVideoGenerator::ThreadInputData > vec;
-    vec.reserve( ( frame_information_->amount_output_frames / frame_information_->thread_input_lists.capacity() ) + 1 );
-    frame_information_->thread_input_lists.push_back( vec );
+  frame_information_->frame_descriptor_lists.resize( thread_count );
+  for( auto& descriptor_list : frame_information_->frame_descriptor_lists ) {
+    descriptor_list.clear();
+    descriptor_list.reserve( ( ( frame_end - frame_begin ) / thread_count ) + 1 );
   }
 
-  double pcm_frame_offset = 0.0;
-  for( size_t i = 0; i < frame_information_->amount_output_frames; i++ ) {
-    CircleVideoGenerator::ThreadInputData input_data;
-    input_data.i = i;
-    input_data.amount_output_frames = frame_information_->amount_output_frames;
-    input_data.project_temp_pictureset_picture_path = project_temp_pictureset_path_ / fmt::format( "{}.png", i );
-    input_data.pcm_frame_count = uint64_t( double( frame_information_->pcm_frames_per_output_frame ) * PCM_FRAME_COUNT_MULT );
+  uint64_t const pcm_frame_count = uint64_t( double( frame_information_->pcm_frames_per_output_frame ) * PCM_FRAME_COUNT_MULT );
+  double pcm_frame_offset = double( frame_begin ) * frame_information_->pcm_frames_per_output_frame;
+  for( size_t i = frame_begin; i < frame_end; i++ ) {
+    CircleVideoGenerator::FrameDescriptor frame;
+    frame.i = i;
+    frame.pcm_frame_count = pcm_frame_count;
     // played sample will be in the middle of the shown samples
-    input_data.pcm_frame_offset
-        = std::min< int64_t >( audio_data_->total_pcm_frame_count, int64_t( pcm_frame_offset ) - int64_t( input_data.pcm_frame_count / 2 ) );
-    input_data.audio_data_ptr = audio_data_;
-    input_data.common_epilepsy_warning_surface = frame_information_->common_epilepsy_warning_surface;
-    input_data.common_bg_surface = frame_information_->common_bg_surface;
-    input_data.common_circle_surface = frame_information_->common_circle_surface;
-    input_data.project_art_surface = frame_information_->project_art_surface;
-    input_data.static_text_surface = frame_information_->static_text_surface;
-    input_data.fft_pointcloud_values = frame_information_->fft_pointcloud_values_per_frame[i];
-    input_data.fft_display_values = frame_information_->fft_display_values_per_frame[i];
+    frame.pcm_frame_offset = std::min< int64_t >( audio_data_->total_pcm_frame_count, int64_t( pcm_frame_offset ) - int64_t( frame.pcm_frame_count / 2 ) );
     // logger_->debug( "[prepare_threads] output frame {} from sample {} to {}",
-    //                 input_data.i,
-    //                 input_data.pcm_frame_offset,
-    //                 input_data.pcm_frame_offset + ( input_data.pcm_frame_count - 1 ) );
+    //                 frame.i,
+    //                 frame.pcm_frame_offset,
+    //                 frame.pcm_frame_offset + ( frame.pcm_frame_count - 1 ) );
 
-    size_t thread_index = i % frame_information_->thread_input_lists.capacity();
-    frame_information_->thread_input_lists[thread_index].push_back( input_data );
+    size_t thread_index = i % thread_count;
+    frame_information_->frame_descriptor_lists[thread_index].push_back( frame );
 
     pcm_frame_offset += frame_information_->pcm_frames_per_output_frame;
   }
@@ -596,9 +1079,11 @@ void CircleVideoGenerator::start_threads() {
     return;
   }
 
-  frame_information_->thread_input_lists.reserve( frame_information_->thread_input_lists.size() );
-  for( auto const& input_list : frame_information_->thread_input_lists ) {
-    frame_information_->thread_list.emplace_back( CircleVideoGenerator::thread_run, input_list );
+  frame_information_->thread_list.reserve( frame_information_->frame_descriptor_lists.size() );
+  for( auto const& descriptor_list : frame_information_->frame_descriptor_lists ) {
+    frame_information_->thread_list.emplace_back( CircleVideoGenerator::thread_run,
+                                                  std::cref( *frame_information_->render_context ),
+                                                  std::cref( descriptor_list ) );
   }
 
   logger_->trace( "[start_threads] exit" );
@@ -615,6 +1100,7 @@ void CircleVideoGenerator::join_threads() {
   for( auto& thread : frame_information_->thread_list ) {
     thread.join();
   }
+  frame_information_->thread_list.clear();
 
   logger_->trace( "[join_threads] exit" );
 }
@@ -636,6 +1122,7 @@ void CircleVideoGenerator::clean_up() {
   // from prepare_audio
   // keep __filtered_#_#.wav
   audio_data_.reset();
+  analysis_cache_key_.reset();
 
   // don't delete things other programs still need
   // // from init
@@ -646,6 +1133,633 @@ void CircleVideoGenerator::clean_up() {
   logger_->trace( "[clean_up] exit" );
 }
 
+#pragma region streaming
+
+// grows `ring` so that pushing `amount` more samples keeps everything from `needed_begin` on
+static void reserve_sample_ring( SampleRingBuffer& ring, int64_t needed_begin, size_t amount ) {
+  int64_t const needed_amount = ring.end_position() + int64_t( amount ) - std::max< int64_t >( 0, needed_begin );
+  if( needed_amount > int64_t( ring.capacity() ) ) {
+    ring.reserve( size_t( needed_amount ) );
+  }
+}
+
+bool CircleVideoGenerator::should_stream_audio() {
+  logger_->trace( "[should_stream_audio] enter" );
+
+  // only the header, a track that is too long for the whole-file path must not be decoded to find that out
+  AudioFormat format;
+  if( !read_audio_format( project_audio_path_, format ) || ( format.total_pcm_frame_count == 0 ) || ( format.sample_rate == 0 ) ) {
+    // the whole-file path reports it
+    return false;
+  }
+
+  double const total_pcm_frame_count = double( format.total_pcm_frame_count );
+  double const amount_output_frames = std::ceil( total_pcm_frame_count / double( format.sample_rate ) * FPS );
+  double const pcm_frames_per_output_frame = total_pcm_frame_count / amount_output_frames;
+  StftLayout const stft_layout = StftLayout::from_window( size_t( pcm_frames_per_output_frame * PCM_FRAME_COUNT_MULT ), pcm_frames_per_output_frame );
+  double const fft_bin_amount = double( stft_layout.fft_size / 2 );
+
+  // the decoded samples (a mapped wav is read in place), their mono mix and its prefix sum, then per frame the tables of the render context:
+  // the display row and range, the point positions and the intensities and onset strengths. the spectrum itself is only held for a block of
+  // FFT_POINTCLOUD_BLOCK_FRAMES
+  double const decoded_channels = format.is_mapped ? 0.0 : double( format.channels );
+  double const sample_bytes = total_pcm_frame_count * ( ( ( decoded_channels + 1.0 ) * sizeof( float ) ) + sizeof( double ) );
+  double const frame_bytes = ( double( Spectrogram( 0, FFT_DISPLAY_BIN_AMOUNT ).row_stride() ) * sizeof( float ) )
+                             + ( double( FFT_POINTCLOUD_POINT_AMOUNT ) * 2.0 * sizeof( float ) ) + ( 4.0 * sizeof( double ) ) + sizeof( MagDbRange );
+  double const block_bytes = double( FFT_POINTCLOUD_BLOCK_FRAMES ) * ( ( fft_bin_amount * sizeof( double ) ) + sizeof( MagDbRange ) );
+  double const whole_file_bytes = sample_bytes + ( amount_output_frames * frame_bytes ) + block_bytes;
+  bool const should_stream = whole_file_bytes > double( STREAMING_MEMORY_BUDGET );
+  logger_->debug( "[should_stream_audio] whole_file_bytes: {}, STREAMING_MEMORY_BUDGET: {}, should_stream: {}",
+                  whole_file_bytes,
+                  STREAMING_MEMORY_BUDGET,
+                  should_stream );
+
+  logger_->trace( "[should_stream_audio] exit" );
+  return should_stream;
+}
+
+void CircleVideoGenerator::render_streaming() {
+  logger_->trace( "[render_streaming] enter" );
+
+  if( !is_ready_ ) {
+    logger_->error( "[render_streaming] generator is not ready!" );
+    return;
+  }
+
+  std::unique_ptr< AudioStream > file_stream = open_audio_stream( project_audio_path_ );
+  if( file_stream == nullptr ) {
+    logger_->error( "[render_streaming] can not read {:?}", project_audio_path_.string() );
+    return;
+  }
+  // the next chunks are decoded while the current one is analyzed
+  ThreadedAudioStream audio_stream( std::move( file_stream ), STREAMING_DECODE_AHEAD_FRAMES );
+
+  // only the fields the render threads need, there is no whole-file sample data
+  audio_data_ = std::make_shared< CircleVideoGenerator::AudioData >();
+  audio_data_->channels = audio_stream.channels();
+  audio_data_->sample_rate = audio_stream.sample_rate();
+  audio_data_->total_pcm_frame_count = audio_stream.total_pcm_frame_count();
+  audio_data_->duration = double( audio_data_->total_pcm_frame_count ) / double( audio_data_->sample_rate );
+  audio_data_->bass_decimation_factor = get_bass_decimation_factor( audio_data_->sample_rate );
+  logger_->debug( "[render_streaming] audio_data_->channels: {}", audio_data_->channels );
+  logger_->debug( "[render_streaming] audio_data_->sample_rate: {}", audio_data_->sample_rate );
+  logger_->debug( "[render_streaming] audio_data_->total_pcm_frame_count: {}", audio_data_->total_pcm_frame_count );
+
+  create_frame_information();
+
+  size_t const amount_output_frames = frame_information_->amount_output_frames;
+  double const pcm_frames_per_output_frame = frame_information_->pcm_frames_per_output_frame;
+  uint32_t const channels = audio_data_->channels;
+  uint64_t const pcm_frame_count = uint64_t( pcm_frames_per_output_frame * PCM_FRAME_COUNT_MULT );
+  StftLayout const stft_layout = StftLayout::from_window( pcm_frame_count, pcm_frames_per_output_frame );
+
+  std::vector< float > chunk( STREAMING_CHUNK_FRAMES * channels );
+  std::vector< float > mono_chunk( STREAMING_CHUNK_FRAMES );
+  auto read_chunk = [&]() {
+    size_t const frame_amount = audio_stream.read( chunk.data(), STREAMING_CHUNK_FRAMES );
+    downmix_to_mono( chunk.data(), mono_chunk.data(), frame_amount, channels );
+    return frame_amount;
+  };
+
+  StreamingSpectrum spectrum( stft_layout, audio_data_->sample_rate );
+  size_t const fft_bin_amount = spectrum.bin_amount();
+  CircleVideoGenerator::SpectrumFrameAnalysis analysis( stft_layout.fft_size, audio_data_->sample_rate, spectrum.freqs() );
+
+#pragma region level pass
+
+  // a GLOBAL range needs the loudest magnitudes of the whole track before the first frame, so the track is decoded and transformed twice.
+  // a STREAMING range only needs the frames up to its lookahead, those are computed along with the render pass
+  if( analysis.has_level_pass() ) {
+    StreamingSpectrum level_spectrum( stft_layout, audio_data_->sample_rate );
+    auto push_level = [&]( size_t, float const* fft_mag_db ) { analysis.push_level( fft_mag_db ); };
+    for( size_t frame_amount = read_chunk(); frame_amount > 0; frame_amount = read_chunk() ) {
+      level_spectrum.push( mono_chunk.data(), frame_amount );
+      level_spectrum.transform( amount_output_frames, push_level );
+    }
+    level_spectrum.finish();
+    level_spectrum.transform( amount_output_frames, push_level );
+    analysis.finish_level_pass();
+
+    if( !audio_stream.rewind() ) {
+      logger_->error( "[render_streaming] can not rewind {:?}", project_audio_path_.string() );
+      return;
+    }
+  }
+
+#pragma endregion level pass
+
+  prepare_surfaces();
+
+#pragma region render pass
+
+  // the spectrum runs `analysis.delay_frames()` frames ahead of the frames it is clamped and drawn for.
+  // per frame of a segment: the intensities and onset strengths, the display row and range and the point positions.
+  // the decode chunk, the sample windows of the analysis, the delayed magnitudes and the point cloud block stay the same size for the whole track
+  size_t const segment_frame_bytes = ( 4 * sizeof( double ) ) + ( Spectrogram( 0, FFT_DISPLAY_BIN_AMOUNT ).row_stride() * sizeof( float ) )
+                                     + ( FFT_POINTCLOUD_POINT_AMOUNT * 2 * sizeof( float ) ) + sizeof( MagDbRange );
+  size_t const delay_bytes
+      = ( ( analysis.delay_frames() + 1 ) * fft_bin_amount + ( analysis.delay_frames() * size_t( std::ceil( pcm_frames_per_output_frame ) ) * 2 ) )
+        * sizeof( float );
+  size_t const block_bytes = FFT_POINTCLOUD_BLOCK_FRAMES * ( ( fft_bin_amount * sizeof( double ) ) + sizeof( MagDbRange ) );
+  size_t const fixed_bytes = ( ( ( STREAMING_CHUNK_FRAMES * ( channels + 3 ) ) + ( STREAMING_DECODE_AHEAD_FRAMES * channels ) ) * sizeof( float ) )
+                             + ( 2 * ( pcm_frame_count + STREAMING_CHUNK_FRAMES ) * sizeof( float ) ) + ( stft_layout.fft_size * 4 * sizeof( float ) )
+                             + delay_bytes + block_bytes;
+  size_t const segment_frame_amount
+      = std::clamp< size_t >( ( STREAMING_MEMORY_BUDGET - std::min( fixed_bytes, STREAMING_MEMORY_BUDGET ) ) / segment_frame_bytes, 1, amount_output_frames );
+  logger_->debug( "[render_streaming] segment_frame_amount: {}", segment_frame_amount );
+
+  int64_t const total_pcm_frame_count = int64_t( audio_data_->total_pcm_frame_count );
+  int64_t const bass_decimation_factor = audio_data_->bass_decimation_factor;
+  auto get_pcm_frame_offset = [&]( size_t i ) {
+    // played sample will be in the middle of the shown samples
+    return std::min< int64_t >( total_pcm_frame_count, int64_t( double( i ) * pcm_frames_per_output_frame ) - int64_t( pcm_frame_count / 2 ) );
+  };
+  auto get_bass_window_begin = [&]( int64_t pcm_frame_offset ) {
+    return ( pcm_frame_offset + ( pcm_frame_offset > 0 ? bass_decimation_factor - 1 : 0 ) ) / bass_decimation_factor;
+  };
+
+  // clamped squared samples, summed over the channels, per pcm frame
+  SampleRingBuffer frame_energies;
+  std::vector< float > frame_energy_chunk( STREAMING_CHUNK_FRAMES );
+  // the bass band, decimated and filtered with the state carried from chunk to chunk
+  SampleRingBuffer bass_samples;
+  std::vector< StreamingDecimator > bass_decimators;
+  for( DecimationStage& stage : design_bass_decimation_stages( audio_data_->sample_rate, audio_data_->bass_decimation_factor ) ) {
+    bass_decimators.emplace_back( std::move( stage ) );
+  }
+  std::vector< std::vector< float > > bass_stage_outputs( bass_decimators.size() );
+  BiquadCascadeFilter bass_filter( create_bass_cascade( double( audio_data_->sample_rate ) / double( bass_decimation_factor ) ), 1 );
+  std::vector< float > bass_chunk;
+  std::vector< float > window_values;
+  size_t sound_frame = 0;
+  size_t bass_frame = 0;
+  bool is_finished = false;
+
+  auto push_chunk = [&]( size_t frame_amount ) {
+    is_finished = frame_amount == 0;
+
+    for( size_t pi = 0; pi < frame_amount; pi++ ) {
+      double frame_energy = 0.0;
+      for( uint32_t c = 0; c < channels; c++ ) {
+        double sample = std::clamp( double( chunk[( pi * channels ) + c] ), -1.0, 1.0 );
+        frame_energy += sample * sample;
+      }
+      frame_energy_chunk[pi] = float( frame_energy );
+    }
+    reserve_sample_ring( frame_energies, get_pcm_frame_offset( sound_frame ), frame_amount );
+    frame_energies.push( frame_energy_chunk.data(), frame_amount );
+
+    if( is_finished ) {
+      spectrum.finish();
+    } else {
+      spectrum.push( mono_chunk.data(), frame_amount );
+    }
+
+    float const* stage_input = mono_chunk.data();
+    size_t stage_input_amount = frame_amount;
+    for( size_t s = 0; s < bass_decimators.size(); s++ ) {
+      bass_stage_outputs[s].clear();
+      bass_decimators[s].push( stage_input, stage_input_amount, bass_stage_outputs[s] );
+      if( is_finished ) {
+        bass_decimators[s].finish( bass_stage_outputs[s] );
+      }
+      stage_input = bass_stage_outputs[s].data();
+      stage_input_amount = bass_stage_outputs[s].size();
+    }
+    bass_chunk.resize( stage_input_amount );
+    bass_filter.process( stage_input, bass_chunk.data(), stage_input_amount );
+    reserve_sample_ring( bass_samples, get_bass_window_begin( get_pcm_frame_offset( bass_frame ) ), stage_input_amount );
+    bass_samples.push( bass_chunk.data(), stage_input_amount );
+  };
+
+  CircleVideoGenerator::RenderContext& render_context = *frame_information_->render_context;
+  render_context.sound_intensity_per_frame.resize( segment_frame_amount );
+  render_context.bass_intensity_per_frame.resize( segment_frame_amount );
+  render_context.onset_strength_per_frame.resize( segment_frame_amount );
+  render_context.beat_strength_per_frame.resize( segment_frame_amount );
+  render_context.fft_display_range_per_frame.resize( segment_frame_amount );
+
+  Spectrogram& fft_display_spectrogram = render_context.fft_display_spectrogram;
+  fft_display_spectrogram = Spectrogram( segment_frame_amount, FFT_DISPLAY_BIN_AMOUNT );
+  fft_display_spectrogram.x_axis() = analysis.display_x_axis();
+  std::vector< float > previous_display_row( FFT_DISPLAY_BIN_AMOUNT );
+
+  CircleVideoGenerator::PointcloudTable& pointcloud_table = render_context.fft_pointcloud_table;
+  CircleVideoGenerator::PointcloudSimulation pointcloud_simulation = create_pointcloud_simulation( stft_layout.fft_size, pointcloud_table );
+  CircleVideoGenerator::PointcloudWorkers pointcloud_workers( pointcloud_table.point_amount );
+  pointcloud_table.x.resize( segment_frame_amount * pointcloud_table.point_amount );
+  pointcloud_table.y.resize( segment_frame_amount * pointcloud_table.point_amount );
+  // the clamped magnitudes of the point cloud are simulated FFT_POINTCLOUD_BLOCK_FRAMES frames at a time, a block never crosses a segment
+  std::vector< double > fft_pointcloud_mag_db_per_frame( FFT_POINTCLOUD_BLOCK_FRAMES * fft_bin_amount );
+  std::vector< MagDbRange > fft_pointcloud_range_per_frame( FFT_POINTCLOUD_BLOCK_FRAMES );
+
+  // every segment goes into the analysis cache as soon as it is complete, the cache is only in place once the last one is
+  AnalysisCacheStreamWriter cache_writer( analysis_cache_key_.value_or( 0 ) );
+  bool is_caching = begin_analysis_cache( cache_writer );
+
+  // frames that got their ranges, clamped and went into the tables
+  size_t display_frame = 0;
+  size_t pointcloud_block_begin = 0;
+  auto emit_ready_frames = [&]( size_t segment_begin, size_t segment_end ) {
+    while( ( display_frame < segment_end ) && analysis.has_next() ) {
+      size_t const row = display_frame - segment_begin;
+      size_t const block_row = display_frame - pointcloud_block_begin;
+      SpectrumFrame const frame
+          = analysis.next( fft_display_spectrogram.row( row ), fft_pointcloud_mag_db_per_frame.data() + ( block_row * fft_bin_amount ) );
+      render_context.fft_display_range_per_frame[row] = frame.display_range;
+      fft_pointcloud_range_per_frame[block_row] = frame.pointcloud_range;
+      render_context.onset_strength_per_frame[row] = frame.onsets.onset_strength;
+      render_context.beat_strength_per_frame[row] = frame.onsets.beat_strength;
+      display_frame++;
+
+      if( ( block_row + 1 == FFT_POINTCLOUD_BLOCK_FRAMES ) || ( display_frame == segment_end ) ) {
+        simulate_pointcloud( pointcloud_workers,
+                             pointcloud_simulation,
+                             fft_pointcloud_mag_db_per_frame.data(),
+                             fft_pointcloud_range_per_frame.data(),
+                             fft_bin_amount,
+                             block_row + 1,
+                             pointcloud_block_begin - segment_begin,
+                             pointcloud_table );
+        pointcloud_block_begin = display_frame;
+      }
+    }
+  };
+
+  // computes every frame of the segment whose samples are there, returns if the segment is complete
+  auto compute_ready_frames = [&]( size_t segment_begin, size_t segment_end ) {
+    for( ; sound_frame < segment_end; sound_frame++ ) {
+      int64_t const pcm_frame_offset = get_pcm_frame_offset( sound_frame );
+      if( !is_finished && ( frame_energies.end_position() < pcm_frame_offset + int64_t( pcm_frame_count ) ) ) {
+        break;
+      }
+      window_values.resize( std::max< size_t >( window_values.size(), pcm_frame_count ) );
+      frame_energies.read( pcm_frame_offset, window_values.data(), pcm_frame_count );
+      double rms_sum_value = 0.0;
+      for( size_t pi = 0; pi < pcm_frame_count; pi++ ) {
+        rms_sum_value += window_values[pi];
+      }
+      render_context.sound_intensity_per_frame[sound_frame - segment_begin] = std::sqrt( rms_sum_value / ( double( channels ) * double( pcm_frame_count ) ) );
+    }
+
+    for( ; bass_frame < segment_end; bass_frame++ ) {
+      // the bass is at the decimated rate, only the samples belonging to pcm frames in the window count
+      int64_t const pcm_frame_offset = get_pcm_frame_offset( bass_frame );
+      int64_t const bass_window_begin = get_bass_window_begin( pcm_frame_offset );
+      int64_t const bass_window_end = ( pcm_frame_offset + int64_t( pcm_frame_count ) + bass_decimation_factor - 1 ) / bass_decimation_factor;
+      if( !is_finished && ( bass_samples.end_position() < bass_window_end ) ) {
+        break;
+      }
+      size_t const bass_window_amount = size_t( std::max< int64_t >( bass_window_end - bass_window_begin, 0 ) );
+      window_values.resize( std::max( window_values.size(), bass_window_amount ) );
+      bass_samples.read( bass_window_begin, window_values.data(), bass_window_amount );
+      double bass_rms_sum_value = 0.0;
+      for( size_t bi = 0; bi < bass_window_amount; bi++ ) {
+        double sample = std::clamp( double( window_values[bi] ), -1.0, 1.0 );
+        bass_rms_sum_value += sample * sample;
+      }
+      render_context.bass_intensity_per_frame[bass_frame - segment_begin]
+          = std::sqrt( bass_rms_sum_value / double( std::max< int64_t >( bass_window_end - bass_window_begin, 1 ) ) );
+    }
+
+    // the frames are emitted as soon as their ranges are known, so at most `analysis.delay_frames()` of them wait
+    spectrum.transform( std::min( amount_output_frames, segment_end + analysis.delay_frames() ), [&]( size_t, float const* fft_mag_db ) {
+      analysis.push( fft_mag_db );
+      emit_ready_frames( segment_begin, segment_end );
+    } );
+    if( spectrum.next_frame() == amount_output_frames ) {
+      // the ranges and onsets of the last frames have no more frames to look ahead to
+      analysis.finish();
+      emit_ready_frames( segment_begin, segment_end );
+    }
+
+    return ( sound_frame == segment_end ) && ( bass_frame == segment_end ) && ( display_frame == segment_end );
+  };
+
+  for( size_t segment_begin = 0; segment_begin < amount_output_frames; segment_begin += segment_frame_amount ) {
+    size_t const segment_end = std::min( amount_output_frames, segment_begin + segment_frame_amount );
+    size_t const segment_frames = segment_end - segment_begin;
+
+    while( !compute_ready_frames( segment_begin, segment_end ) ) {
+      // once the stream is finished every frame is ready
+      push_chunk( read_chunk() );
+    }
+
+    // apply smoothing, the first frame continues from the last one of the previous segment
+    if( segment_begin > 0 ) {
+      float* first_row = fft_display_spectrogram.row( 0 );
+      for( size_t bin = 0; bin < FFT_DISPLAY_BIN_AMOUNT; bin++ ) {
+        first_row[bin] = float( ( FFT_COMPUTE_ALPHA * first_row[bin] ) + ( ( 1.0 - FFT_COMPUTE_ALPHA ) * previous_display_row[bin] ) );
+      }
+    }
+    exponential_smoothing_scan( fft_display_spectrogram.data(),
+                                segment_frames,
+                                FFT_DISPLAY_BIN_AMOUNT,
+                                fft_display_spectrogram.row_stride(),
+                                FFT_COMPUTE_ALPHA );
+    float const* last_row = fft_display_spectrogram.row( segment_frames - 1 );
+    std::copy( last_row, last_row + FFT_DISPLAY_BIN_AMOUNT, previous_display_row.begin() );
+
+    is_caching = is_caching && write_analysis_cache_frames( cache_writer, segment_begin, segment_frames );
+
+    render_context.first_frame = segment_begin;
+    prepare_threads( segment_begin, segment_end );
+    start_threads();
+    join_threads();
+    logger_->debug( "[render_streaming] rendered frames {} to {}", segment_begin, segment_end - 1 );
+  }
+
+  if( is_caching ) {
+    if( cache_writer.commit() ) {
+      logger_->debug( "[render_streaming] analysis saved to {:?}", project_analysis_cache_path_.string() );
+    } else {
+      logger_->warn( "[render_streaming] could not write {:?}, the next render recomputes the analysis", project_analysis_cache_path_.string() );
+    }
+  }
+
+#pragma endregion render pass
+
+  logger_->trace( "[render_streaming] exit" );
+}
+
+void CircleVideoGenerator::render_streaming_from_cache( AnalysisCacheReader const& reader ) {
+  logger_->trace( "[render_streaming_from_cache] enter" );
+
+  if( !is_ready_ ) {
+    logger_->error( "[render_streaming_from_cache] generator is not ready!" );
+    return;
+  }
+
+  prepare_surfaces();
+
+  // per frame of a segment the tables `read_analysis_cache_frames` copies out of the mapping
+  CircleVideoGenerator::RenderContext& render_context = *frame_information_->render_context;
+  size_t const amount_output_frames = frame_information_->amount_output_frames;
+  size_t const segment_frame_bytes = ( 4 * sizeof( double ) ) + ( render_context.fft_display_spectrogram.row_stride() * sizeof( float ) )
+                                     + ( render_context.fft_pointcloud_table.point_amount * 2 * sizeof( float ) ) + sizeof( MagDbRange );
+  size_t const segment_frame_amount = std::clamp< size_t >( STREAMING_MEMORY_BUDGET / segment_frame_bytes, 1, std::max< size_t >( amount_output_frames, 1 ) );
+  logger_->debug( "[render_streaming_from_cache] segment_frame_amount: {}", segment_frame_amount );
+
+  for( size_t segment_begin = 0; segment_begin < amount_output_frames; segment_begin += segment_frame_amount ) {
+    size_t const segment_end = std::min( amount_output_frames, segment_begin + segment_frame_amount );
+    read_analysis_cache_frames( reader, segment_begin, segment_end - segment_begin );
+
+    render_context.first_frame = segment_begin;
+    prepare_threads( segment_begin, segment_end );
+    start_threads();
+    join_threads();
+    logger_->debug( "[render_streaming_from_cache] rendered frames {} to {}", segment_begin, segment_end - 1 );
+  }
+
+  logger_->trace( "[render_streaming_from_cache] exit" );
+}
+
+#pragma endregion streaming
+
+std::optional< uint64_t > CircleVideoGenerator::get_analysis_cache_key() {
+  logger_->trace( "[get_analysis_cache_key] enter" );
+
+  AnalysisCacheKey key;
+  key.add( "CircleVideoGenerator" ).add( ANALYSIS_CACHE_REVISION );
+  if( !key.add_file( project_audio_path_ ) ) {
+    logger_->error( "[get_analysis_cache_key] could not read {:?}", project_audio_path_.string() );
+    return std::nullopt;
+  }
+  key.add( FPS ).add( VIDEO_WIDTH ).add( VIDEO_HEIGHT );
+  key.add( IIR_FILTER_ORDER ).add( BASS_LP_CUTOFF ).add( BASS_HP_CUTOFF ).add( BASS_MIN_SAMPLE_RATE ).add( PCM_FRAME_COUNT_MULT );
+  key.add( FFT_COMPUTE_ALPHA ).add( FFT_POINTCLOUD_POINT_AMOUNT ).add( FFT_POINTCLOUD_MAG_DB_RANGE ).add( FFT_POINTCLOUD_MIN_FREQ );
+  key.add( FFT_DISPLAY_BIN_AMOUNT ).add( FFT_DISPLAY_MIN_FREQ ).add( FFT_DISPLAY_MAX_FREQ ).add( FFT_DISPLAY_MAG_DB_RANGE );
+  key.add( FFT_MAG_DB_NORMALIZATION_MODE ).add( FFT_MAG_DB_LOOKAHEAD_SECONDS ).add( FFT_MAG_DB_RELEASE_DB_PER_SECOND );
+  key.add( CircleVideoGenerator::Point::base_speed_x ).add( CircleVideoGenerator::Point::base_speed_y ).add( CircleVideoGenerator::Point::base_radius );
+  logger_->debug( "[get_analysis_cache_key] key: {:#018x}", key.value() );
+
+  logger_->trace( "[get_analysis_cache_key] exit" );
+  return key.value();
+}
+
+bool CircleVideoGenerator::load_analysis_cache() {
+  logger_->trace( "[load_analysis_cache] enter" );
+
+  AnalysisCacheReader reader;
+  if( !open_analysis_cache( reader ) ) {
+    logger_->trace( "[load_analysis_cache] exit: miss" );
+    return false;
+  }
+  read_analysis_cache_frames( reader, 0, frame_information_->amount_output_frames );
+  logger_->info( "[load_analysis_cache] analysis loaded from {:?}", project_analysis_cache_path_.string() );
+
+  logger_->trace( "[load_analysis_cache] exit: hit" );
+  return true;
+}
+
+bool CircleVideoGenerator::open_analysis_cache( AnalysisCacheReader& reader ) {
+  logger_->trace( "[open_analysis_cache] enter" );
+
+  if( !is_ready_ ) {
+    logger_->error( "[open_analysis_cache] generator is not ready!" );
+    return false;
+  }
+  if( !ANALYSIS_CACHE_ENABLED || !analysis_cache_key_ ) {
+    logger_->trace( "[open_analysis_cache] exit: cache not used" );
+    return false;
+  }
+
+  if( !reader.open( project_analysis_cache_path_, *analysis_cache_key_ ) ) {
+    logger_->debug( "[open_analysis_cache] no analysis cache at {:?} for this audio and these constants", project_analysis_cache_path_.string() );
+    logger_->trace( "[open_analysis_cache] exit: miss" );
+    return false;
+  }
+
+  auto const summary_section = reader.section< CircleAnalysisCacheSummary >( ANALYSIS_CACHE_SUMMARY_TAG );
+  auto const sound_intensity = reader.section< double >( ANALYSIS_CACHE_SOUND_INTENSITY_TAG );
+  auto const bass_intensity = reader.section< double >( ANALYSIS_CACHE_BASS_INTENSITY_TAG );
+  auto const onset_strength = reader.section< double >( ANALYSIS_CACHE_ONSET_STRENGTH_TAG );
+  auto const beat_strength = reader.section< double >( ANALYSIS_CACHE_BEAT_STRENGTH_TAG );
+  auto const display_values = reader.section< float >( ANALYSIS_CACHE_DISPLAY_VALUES_TAG );
+  auto const display_x_axis = reader.section< float >( ANALYSIS_CACHE_DISPLAY_X_AXIS_TAG );
+  auto const display_range = reader.section< MagDbRange >( ANALYSIS_CACHE_DISPLAY_RANGE_TAG );
+  auto const pointcloud_radius = reader.section< float >( ANALYSIS_CACHE_POINTCLOUD_RADIUS_TAG );
+  auto const pointcloud_x = reader.section< float >( ANALYSIS_CACHE_POINTCLOUD_X_TAG );
+  auto const pointcloud_y = reader.section< float >( ANALYSIS_CACHE_POINTCLOUD_Y_TAG );
+  if( !summary_section || ( summary_section->size() != 1 ) ) {
+    logger_->warn( "[open_analysis_cache] {:?} has no summary, recomputing", project_analysis_cache_path_.string() );
+    return false;
+  }
+  CircleAnalysisCacheSummary const& summary = summary_section->front();
+  size_t const frame_amount = size_t( summary.amount_output_frames );
+  size_t const point_amount = size_t( summary.pointcloud_point_amount );
+  // no frames yet, `read_analysis_cache_frames` fills the ones being rendered
+  Spectrogram fft_display_spectrogram( 0, size_t( summary.display_bin_amount ) );
+  bool const is_complete = sound_intensity && ( sound_intensity->size() == frame_amount ) && bass_intensity && ( bass_intensity->size() == frame_amount )
+                           && onset_strength && ( onset_strength->size() == frame_amount ) && beat_strength && ( beat_strength->size() == frame_amount )
+                           && ( fft_display_spectrogram.row_stride() == summary.display_row_stride ) && display_values
+                           && ( display_values->size() == frame_amount * fft_display_spectrogram.row_stride() ) && display_x_axis
+                           && ( display_x_axis->size() == fft_display_spectrogram.bin_amount() ) && display_range
+                           && ( display_range->size() == frame_amount ) && pointcloud_radius
+                           && ( pointcloud_radius->size() == point_amount ) && pointcloud_x && ( pointcloud_x->size() == frame_amount * point_amount )
+                           && pointcloud_y && ( pointcloud_y->size() == frame_amount * point_amount );
+  if( !is_complete ) {
+    logger_->warn( "[open_analysis_cache] {:?} is incomplete, recomputing", project_analysis_cache_path_.string() );
+    return false;
+  }
+
+  audio_data_ = std::make_shared< CircleVideoGenerator::AudioData >();
+  audio_data_->channels = summary.channels;
+  audio_data_->sample_rate = summary.sample_rate;
+  audio_data_->total_pcm_frame_count = summary.total_pcm_frame_count;
+  audio_data_->duration = double( audio_data_->total_pcm_frame_count ) / double( audio_data_->sample_rate );
+  logger_->debug( "[open_analysis_cache] audio_data_->duration: {}", audio_data_->duration );
+
+  frame_information_ = std::make_shared< CircleVideoGenerator::FrameInformation >();
+  frame_information_->amount_output_frames = frame_amount;
+  frame_information_->pcm_frames_per_output_frame = summary.pcm_frames_per_output_frame;
+  logger_->debug( "[open_analysis_cache] frame_information_->amount_output_frames: {}", frame_information_->amount_output_frames );
+
+  frame_information_->render_context = std::make_shared< CircleVideoGenerator::RenderContext >();
+  CircleVideoGenerator::RenderContext& render_context = *frame_information_->render_context;
+  render_context.amount_output_frames = frame_amount;
+  render_context.project_temp_pictureset_path = project_temp_pictureset_path_;
+  render_context.audio_data = audio_data_;
+  fft_display_spectrogram.x_axis().assign( display_x_axis->begin(), display_x_axis->end() );
+  render_context.fft_display_spectrogram = std::move( fft_display_spectrogram );
+  render_context.fft_pointcloud_table.point_amount = point_amount;
+  render_context.fft_pointcloud_table.radius.assign( pointcloud_radius->begin(), pointcloud_radius->end() );
+
+  FFT_POINTCLOUD_MAX_FREQ = summary.fft_pointcloud_max_freq;
+
+  logger_->trace( "[open_analysis_cache] exit: hit" );
+  return true;
+}
+
+// elements `frame_begin * per_frame` to `( frame_begin + frame_amount ) * per_frame` of a section `open_analysis_cache` checked
+template < typename T >
+static void assign_analysis_cache_frames( AnalysisCacheReader const& reader,
+                                          uint32_t tag,
+                                          size_t frame_begin,
+                                          size_t frame_amount,
+                                          size_t per_frame,
+                                          std::vector< T >& values ) {
+  std::span< T const > const frames = reader.section< T >( tag )->subspan( frame_begin * per_frame, frame_amount * per_frame );
+  values.assign( frames.begin(), frames.end() );
+}
+
+void CircleVideoGenerator::read_analysis_cache_frames( AnalysisCacheReader const& reader, size_t frame_begin, size_t frame_amount ) {
+  logger_->trace( "[read_analysis_cache_frames] enter: frame_begin: {}, frame_amount: {}", frame_begin, frame_amount );
+
+  CircleVideoGenerator::RenderContext& render_context = *frame_information_->render_context;
+  size_t const point_amount = render_context.fft_pointcloud_table.point_amount;
+  assign_analysis_cache_frames( reader, ANALYSIS_CACHE_SOUND_INTENSITY_TAG, frame_begin, frame_amount, 1, render_context.sound_intensity_per_frame );
+  assign_analysis_cache_frames( reader, ANALYSIS_CACHE_BASS_INTENSITY_TAG, frame_begin, frame_amount, 1, render_context.bass_intensity_per_frame );
+  assign_analysis_cache_frames( reader, ANALYSIS_CACHE_ONSET_STRENGTH_TAG, frame_begin, frame_amount, 1, render_context.onset_strength_per_frame );
+  assign_analysis_cache_frames( reader, ANALYSIS_CACHE_BEAT_STRENGTH_TAG, frame_begin, frame_amount, 1, render_context.beat_strength_per_frame );
+  assign_analysis_cache_frames( reader, ANALYSIS_CACHE_DISPLAY_RANGE_TAG, frame_begin, frame_amount, 1, render_context.fft_display_range_per_frame );
+  assign_analysis_cache_frames( reader, ANALYSIS_CACHE_POINTCLOUD_X_TAG, frame_begin, frame_amount, point_amount, render_context.fft_pointcloud_table.x );
+  assign_analysis_cache_frames( reader, ANALYSIS_CACHE_POINTCLOUD_Y_TAG, frame_begin, frame_amount, point_amount, render_context.fft_pointcloud_table.y );
+
+  // same row stride, so the padded rows are one copy
+  Spectrogram const& previous_spectrogram = render_context.fft_display_spectrogram;
+  Spectrogram fft_display_spectrogram( frame_amount, previous_spectrogram.bin_amount() );
+  std::span< float const > const display_values = reader.section< float >( ANALYSIS_CACHE_DISPLAY_VALUES_TAG )
+                                                      ->subspan( frame_begin * fft_display_spectrogram.row_stride(),
+                                                                 frame_amount * fft_display_spectrogram.row_stride() );
+  std::copy( display_values.begin(), display_values.end(), fft_display_spectrogram.data() );
+  fft_display_spectrogram.x_axis() = previous_spectrogram.x_axis();
+  render_context.fft_display_spectrogram = std::move( fft_display_spectrogram );
+
+  logger_->trace( "[read_analysis_cache_frames] exit" );
+}
+
+void CircleVideoGenerator::save_analysis_cache() {
+  logger_->trace( "[save_analysis_cache] enter" );
+
+  AnalysisCacheStreamWriter writer( analysis_cache_key_.value_or( 0 ) );
+  if( !begin_analysis_cache( writer ) || !write_analysis_cache_frames( writer, 0, frame_information_->amount_output_frames ) ) {
+    logger_->trace( "[save_analysis_cache] exit: not saved" );
+    return;
+  }
+  if( writer.commit() ) {
+    logger_->debug( "[save_analysis_cache] analysis saved to {:?}", project_analysis_cache_path_.string() );
+  } else {
+    logger_->warn( "[save_analysis_cache] could not write {:?}, the next render recomputes the analysis", project_analysis_cache_path_.string() );
+  }
+
+  logger_->trace( "[save_analysis_cache] exit" );
+}
+
+bool CircleVideoGenerator::begin_analysis_cache( AnalysisCacheStreamWriter& writer ) {
+  logger_->trace( "[begin_analysis_cache] enter" );
+
+  if( !is_ready_ ) {
+    logger_->error( "[begin_analysis_cache] generator is not ready!" );
+    return false;
+  }
+  if( !ANALYSIS_CACHE_ENABLED || !analysis_cache_key_ ) {
+    logger_->trace( "[begin_analysis_cache] exit: cache not used" );
+    return false;
+  }
+
+  CircleVideoGenerator::RenderContext const& render_context = *frame_information_->render_context;
+  Spectrogram const& fft_display_spectrogram = render_context.fft_display_spectrogram;
+  size_t const frame_amount = frame_information_->amount_output_frames;
+  size_t const point_amount = render_context.fft_pointcloud_table.point_amount;
+  CircleAnalysisCacheSummary summary;
+  summary.channels = audio_data_->channels;
+  summary.sample_rate = audio_data_->sample_rate;
+  summary.total_pcm_frame_count = audio_data_->total_pcm_frame_count;
+  summary.amount_output_frames = frame_amount;
+  summary.pcm_frames_per_output_frame = frame_information_->pcm_frames_per_output_frame;
+  summary.fft_pointcloud_max_freq = FFT_POINTCLOUD_MAX_FREQ;
+  summary.pointcloud_point_amount = point_amount;
+  summary.display_bin_amount = fft_display_spectrogram.bin_amount();
+  summary.display_row_stride = fft_display_spectrogram.row_stride();
+
+  writer.add_section< CircleAnalysisCacheSummary >( ANALYSIS_CACHE_SUMMARY_TAG, 1 );
+  writer.add_section< double >( ANALYSIS_CACHE_SOUND_INTENSITY_TAG, frame_amount );
+  writer.add_section< double >( ANALYSIS_CACHE_BASS_INTENSITY_TAG, frame_amount );
+  writer.add_section< double >( ANALYSIS_CACHE_ONSET_STRENGTH_TAG, frame_amount );
+  writer.add_section< double >( ANALYSIS_CACHE_BEAT_STRENGTH_TAG, frame_amount );
+  writer.add_section< float >( ANALYSIS_CACHE_DISPLAY_VALUES_TAG, frame_amount * fft_display_spectrogram.row_stride() );
+  writer.add_section< float >( ANALYSIS_CACHE_DISPLAY_X_AXIS_TAG, fft_display_spectrogram.x_axis().size() );
+  writer.add_section< MagDbRange >( ANALYSIS_CACHE_DISPLAY_RANGE_TAG, frame_amount );
+  writer.add_section< float >( ANALYSIS_CACHE_POINTCLOUD_RADIUS_TAG, point_amount );
+  writer.add_section< float >( ANALYSIS_CACHE_POINTCLOUD_X_TAG, frame_amount * point_amount );
+  writer.add_section< float >( ANALYSIS_CACHE_POINTCLOUD_Y_TAG, frame_amount * point_amount );
+  bool const is_begun = writer.open( project_analysis_cache_path_ ) && writer.write( ANALYSIS_CACHE_SUMMARY_TAG, 0, &summary, 1 )
+                        && writer.write( ANALYSIS_CACHE_DISPLAY_X_AXIS_TAG, 0, fft_display_spectrogram.x_axis() )
+                        && writer.write( ANALYSIS_CACHE_POINTCLOUD_RADIUS_TAG, 0, render_context.fft_pointcloud_table.radius );
+  if( !is_begun ) {
+    logger_->warn( "[begin_analysis_cache] could not write {:?}, the next render recomputes the analysis", project_analysis_cache_path_.string() );
+  }
+
+  logger_->trace( "[begin_analysis_cache] exit" );
+  return is_begun;
+}
+
+bool CircleVideoGenerator::write_analysis_cache_frames( AnalysisCacheStreamWriter& writer, size_t frame_begin, size_t frame_amount ) {
+  logger_->trace( "[write_analysis_cache_frames] enter: frame_begin: {}, frame_amount: {}", frame_begin, frame_amount );
+
+  CircleVideoGenerator::RenderContext const& render_context = *frame_information_->render_context;
+  Spectrogram const& fft_display_spectrogram = render_context.fft_display_spectrogram;
+  CircleVideoGenerator::PointcloudTable const& pointcloud_table = render_context.fft_pointcloud_table;
+  size_t const point_amount = pointcloud_table.point_amount;
+  size_t const row_stride = fft_display_spectrogram.row_stride();
+  bool const is_written
+      = writer.write( ANALYSIS_CACHE_SOUND_INTENSITY_TAG, frame_begin, render_context.sound_intensity_per_frame.data(), frame_amount )
+        && writer.write( ANALYSIS_CACHE_BASS_INTENSITY_TAG, frame_begin, render_context.bass_intensity_per_frame.data(), frame_amount )
+        && writer.write( ANALYSIS_CACHE_ONSET_STRENGTH_TAG, frame_begin, render_context.onset_strength_per_frame.data(), frame_amount )
+        && writer.write( ANALYSIS_CACHE_BEAT_STRENGTH_TAG, frame_begin, render_context.beat_strength_per_frame.data(), frame_amount )
+        && writer.write( ANALYSIS_CACHE_DISPLAY_VALUES_TAG, frame_begin * row_stride, fft_display_spectrogram.data(), frame_amount * row_stride )
+        && writer.write( ANALYSIS_CACHE_DISPLAY_RANGE_TAG, frame_begin, render_context.fft_display_range_per_frame.data(), frame_amount )
+        && writer.write( ANALYSIS_CACHE_POINTCLOUD_X_TAG, frame_begin * point_amount, pointcloud_table.x.data(), frame_amount * point_amount )
+        && writer.write( ANALYSIS_CACHE_POINTCLOUD_Y_TAG, frame_begin * point_amount, pointcloud_table.y.data(), frame_amount * point_amount );
+  if( !is_written ) {
+    logger_->warn( "[write_analysis_cache_frames] could not write {:?}, the next render recomputes the analysis", project_analysis_cache_path_.string() );
+  }
+
+  logger_->trace( "[write_analysis_cache_frames] exit" );
+  return is_written;
+}
+
 void CircleVideoGenerator::save_surface( std::shared_ptr< cairo_surface_t > surface, std::filesystem::path const& file_path ) {
   // logger_->trace( "[save_surface] enter: surface: {}, file_path: {:?}", static_cast< void* >( surface.get() ), file_path.string() );
 
@@ -665,35 +1779,32 @@ void CircleVideoGenerator::create_lowpass_for_audio_data() {
     return;
   }
 
-  uint64_t sample_amount = audio_data_->total_pcm_frame_count * audio_data_->channels;
+  pcm_sample_range( audio_data_->sample_data, audio_data_->sample_min, audio_data_->sample_max );
+  audio_data_->sample_min = std::clamp( audio_data_->sample_min, -1.0f, 1.0f );
+  audio_data_->sample_max = std::clamp( audio_data_->sample_max, -1.0f, 1.0f );
 
-  audio_data_->processed_sample_data = std::make_shared< float[] >( sample_amount );
-  memset( audio_data_->processed_sample_data.get(), 0, sample_amount * sizeof( audio_data_->processed_sample_data[0] ) );
+  audio_data_->bass_decimation_factor = get_bass_decimation_factor( audio_data_->sample_rate );
+  double const bass_sample_rate = double( audio_data_->sample_rate ) / double( audio_data_->bass_decimation_factor );
+  logger_->debug( "[create_lowpass_for_audio_data] bass_decimation_factor: {}, bass_sample_rate: {}", audio_data_->bass_decimation_factor, bass_sample_rate );
 
-  Iir::Butterworth::LowPass< IIR_FILTER_ORDER > lowpass;
-  Iir::Butterworth::HighPass< IIR_FILTER_ORDER > highpass;
+  std::vector< float > mono_sample_data;
+  for( DecimationStage const& stage : design_bass_decimation_stages( audio_data_->sample_rate, audio_data_->bass_decimation_factor ) ) {
+    mono_sample_data = decimate( mono_sample_data.empty() ? audio_data_->mono_sample_data : mono_sample_data, stage );
+  }
+
+  BiquadCascade const bass_cascade = create_bass_cascade( bass_sample_rate );
 
   // fill buf1 into audio_data_
-  for( uint64_t c = 0; c < audio_data_->channels; c++ ) {
-    lowpass.setup( audio_data_->sample_rate, BASS_LP_CUTOFF );
-    highpass.setup( audio_data_->sample_rate, BASS_HP_CUTOFF );
-    for( uint64_t i = 0; i < audio_data_->total_pcm_frame_count; i++ ) {
-      uint64_t sample_index = ( i * audio_data_->channels ) + c;
-
-      audio_data_->sample_min = std::min( audio_data_->sample_min, audio_data_->sample_data[sample_index] );
-      audio_data_->sample_max = std::max( audio_data_->sample_max, audio_data_->sample_data[sample_index] );
-      audio_data_->sample_min = std::clamp( audio_data_->sample_min, -1.0f, 1.0f );
-      audio_data_->sample_max = std::clamp( audio_data_->sample_max, -1.0f, 1.0f );
-
-      float lowpassed_sample = lowpass.filter( audio_data_->sample_data[sample_index] );
-      float highpassed_sample = highpass.filter( lowpassed_sample );
-      audio_data_->processed_sample_data[sample_index] = highpassed_sample;
-      audio_data_->processed_sample_min = std::min( audio_data_->processed_sample_min, audio_data_->processed_sample_data[sample_index] );
-      audio_data_->processed_sample_max = std::max( audio_data_->processed_sample_max, audio_data_->processed_sample_data[sample_index] );
-      audio_data_->processed_sample_min = std::clamp( audio_data_->processed_sample_min, -1.0f, 1.0f );
-      audio_data_->processed_sample_max = std::clamp( audio_data_->processed_sample_max, -1.0f, 1.0f );
-    }
+  audio_data_->bass_sample_data.resize( mono_sample_data.size() );
+  filter_biquad_cascade_block_parallel( bass_cascade, mono_sample_data.data(), audio_data_->bass_sample_data.data(), mono_sample_data.size(), 1 );
+
+  // min/max outside of the filter recursion
+  for( float bass_sample : audio_data_->bass_sample_data ) {
+    audio_data_->bass_sample_min = std::min( audio_data_->bass_sample_min, bass_sample );
+    audio_data_->bass_sample_max = std::max( audio_data_->bass_sample_max, bass_sample );
   }
+  audio_data_->bass_sample_min = std::clamp( audio_data_->bass_sample_min, -1.0f, 1.0f );
+  audio_data_->bass_sample_max = std::clamp( audio_data_->bass_sample_max, -1.0f, 1.0f );
 
 #if defined( DO_SAVE_LOWPASS_AUDIO )
   {
@@ -701,15 +1812,15 @@ void CircleVideoGenerator::create_lowpass_for_audio_data() {
     drwav_data_format dw_fmt;
     dw_fmt.container = drwav_container::drwav_container_riff;
     dw_fmt.format = DR_WAVE_FORMAT_IEEE_FLOAT;
-    dw_fmt.channels = audio_data_->channels;
-    dw_fmt.sampleRate = audio_data_->sample_rate;
+    dw_fmt.channels = 1;
+    dw_fmt.sampleRate = uint32_t( bass_sample_rate );
     dw_fmt.bitsPerSample = 32;
     std::filesystem::path tmp_audio_path( project_path_ / fmt::format( "__filtered_{}_{}.wav", BASS_LP_CUTOFF, BASS_HP_CUTOFF ) );
     if( std::filesystem::is_regular_file( tmp_audio_path ) ) {
       std::filesystem::remove( tmp_audio_path );
     }
     if( drwav_init_file_write( &dw_obj, tmp_audio_path.string().c_str(), &dw_fmt, nullptr ) ) {
-      size_t framesWritten = drwav_write_pcm_frames( &dw_obj, audio_data_->total_pcm_frame_count, audio_data_->processed_sample_data.get() );
+      size_t framesWritten = drwav_write_pcm_frames( &dw_obj, audio_data_->bass_sample_data.size(), audio_data_->bass_sample_data.data() );
       logger_->debug( "[create_lowpass_for_audio_data] framesWritten: {}", framesWritten );
       drwav_uninit( &dw_obj );
     }
@@ -727,10 +1838,10 @@ void CircleVideoGenerator::create_epilepsy_warning() {
     return;
   }
 
-  frame_information_->common_epilepsy_warning_surface = surface_create_size( VIDEO_WIDTH, VIDEO_HEIGHT );
+  frame_information_->render_context->common_epilepsy_warning_surface = surface_create_size( VIDEO_WIDTH, VIDEO_HEIGHT );
 
   // drawing the epilepsy warning
-  surface_fill( frame_information_->common_epilepsy_warning_surface, 0.0, 0.0, 0.0, 1.0 );
+  surface_fill( frame_information_->render_context->common_epilepsy_warning_surface, 0.0, 0.0, 0.0, 1.0 );
 
   std::shared_ptr< cairo_surface_t > text_surface = surface_render_text_advanced_into_overlay( FontManager::get_font_face( EPILEPSY_WARNING_HEADER_FONT ),
                                                                                                FontManager::get_font_face( EPILEPSY_WARNING_CONTENT_FONT ),
@@ -741,19 +1852,21 @@ void CircleVideoGenerator::create_epilepsy_warning() {
                                                                                                0,
                                                                                                VIDEO_WIDTH,
                                                                                                VIDEO_HEIGHT );
-  surface_blit( text_surface, frame_information_->common_epilepsy_warning_surface, 0, 0, VIDEO_WIDTH, VIDEO_HEIGHT );
+  surface_blit( text_surface, frame_information_->render_context->common_epilepsy_warning_surface, 0, 0, VIDEO_WIDTH, VIDEO_HEIGHT );
 
 #if defined( DO_SAVE_EPILEPSY_WARNING )
   std::string tmp_str = common_epilepsy_warning_path_.string();
   std::filesystem::path epilepsy_warning_picture_path( replace( tmp_str, ".txt", ".png" ) );
 
-  save_surface( frame_information_->common_epilepsy_warning_surface, epilepsy_warning_picture_path );
+  save_surface( frame_information_->render_context->common_epilepsy_warning_surface, epilepsy_warning_picture_path );
 #endif
 
   logger_->trace( "[create_epilepsy_warning] exit" );
 }
 
-void CircleVideoGenerator::draw_pointcloud_on_surface( std::shared_ptr< cairo_surface_t > surface, CircleVideoGenerator::ThreadInputData const& input_data ) {
+void CircleVideoGenerator::draw_pointcloud_on_surface( std::shared_ptr< cairo_surface_t > surface,
+                                                       CircleVideoGenerator::RenderContext const& context,
+                                                       CircleVideoGenerator::FrameDescriptor const& frame ) {
   // logger_->trace( "[draw_pointcloud_on_surface] enter: surface: {}", static_cast< void* >( surface.get() ) );
 
   if( !is_ready_ ) {
@@ -766,17 +1879,20 @@ void CircleVideoGenerator::draw_pointcloud_on_surface( std::shared_ptr< cairo_su
   cairo_t* cr = cairo_create( surface.get() );
   cairo_save( cr );
 
-  for( uint32_t i = 0; i < input_data.fft_pointcloud_values->size(); i++ ) {
-    CircleVideoGenerator::Point& point = input_data.fft_pointcloud_values->at( i );
+  CircleVideoGenerator::PointcloudTable const& pointcloud_table = context.fft_pointcloud_table;
+  size_t const row_offset = ( frame.i - context.first_frame ) * pointcloud_table.point_amount;
+  for( size_t i = 0; i < pointcloud_table.point_amount; i++ ) {
+    double const x = pointcloud_table.x[row_offset + i];
+    double const y = pointcloud_table.y[row_offset + i];
+    double const radius = pointcloud_table.radius[i];
 
-    std::shared_ptr< cairo_pattern_t > circle_pattern
-        = make_pattern_shared_ptr( cairo_pattern_create_radial( point.x, point.y, 0.0, point.x, point.y, point.radius ) );
+    std::shared_ptr< cairo_pattern_t > circle_pattern = make_pattern_shared_ptr( cairo_pattern_create_radial( x, y, 0.0, x, y, radius ) );
     cairo_pattern_add_color_stop_rgba( circle_pattern.get(), 0.0, 1.0, 1.0, 1.0, 0.5 );
     cairo_pattern_add_color_stop_rgba( circle_pattern.get(), 0.5, 1.0, 1.0, 1.0, 0.5 );
     cairo_pattern_add_color_stop_rgba( circle_pattern.get(), 1.0, 1.0, 1.0, 1.0, 0.0 );
     cairo_set_source( cr, circle_pattern.get() );
 
-    cairo_arc( cr, point.x, point.y, point.radius, 0.0, 2.0 * std::numbers::pi_v< double > );
+    cairo_arc( cr, x, y, radius, 0.0, 2.0 * std::numbers::pi_v< double > );
     cairo_clip( cr );
     cairo_paint( cr );
     cairo_reset_clip( cr );
@@ -788,7 +1904,9 @@ void CircleVideoGenerator::draw_pointcloud_on_surface( std::shared_ptr< cairo_su
   // logger_->trace( "[draw_pointcloud_on_surface] exit" );
 }
 
-void CircleVideoGenerator::draw_freqs_on_surface( std::shared_ptr< cairo_surface_t > surface, CircleVideoGenerator::ThreadInputData const& input_data ) {
+void CircleVideoGenerator::draw_freqs_on_surface( std::shared_ptr< cairo_surface_t > surface,
+                                                  CircleVideoGenerator::RenderContext const& context,
+                                                  CircleVideoGenerator::FrameDescriptor const& frame ) {
   // logger_->trace( "[draw_freqs_on_surface] enter: surface: {}", static_cast< void* >( surface.get() ) );
 
   if( !is_ready_ ) {
@@ -832,19 +1950,19 @@ void CircleVideoGenerator::draw_freqs_on_surface( std::shared_ptr< cairo_surface
   };
 
   {
+    SpectrogramRow const fft_display_row = context.fft_display_spectrogram.row_view( frame.i - context.first_frame );
+    MagDbRange const& fft_display_range = context.fft_display_range_per_frame[frame.i - context.first_frame];
     std::vector< std::pair< double, double > > freq_mags;
+    freq_mags.reserve( fft_display_row.bin_amount );
 
-    for( int64_t i = 0; i < input_data.fft_display_values->size(); i++ ) {
-      auto const& pair = input_data.fft_display_values->at( i );
-
-      double freq = pair.first;
-      double mag_db = pair.second;
+    for( size_t bin = 0; bin < fft_display_row.bin_amount; bin++ ) {
+      double freq = fft_display_row.x[bin];
+      double mag_db = fft_display_row.values[bin];
 
       // Normalize
       double norm_freq = ( freq - FFT_DISPLAY_MIN_FREQ ) / ( FFT_DISPLAY_MAX_FREQ - FFT_DISPLAY_MIN_FREQ );
       double norm_freq_log = ( std::log( freq ) - std::log( FFT_DISPLAY_MIN_FREQ ) ) / ( std::log( FFT_DISPLAY_MAX_FREQ ) - std::log( FFT_DISPLAY_MIN_FREQ ) );
-      double norm_mag = ( mag_db - FFT_DISPLAY_MIN_MAG_DB ) / ( FFT_DISPLAY_MAX_MAG_DB - FFT_DISPLAY_MIN_MAG_DB );
-      norm_mag = std::clamp( norm_mag, 0.0, 1.0 );
+      double norm_mag = fft_display_range.normalize( mag_db );
 
       freq_mags.emplace_back( norm_freq, norm_mag );
     }
@@ -926,8 +2044,9 @@ void CircleVideoGenerator::draw_freqs_on_surface( std::shared_ptr< cairo_surface
   // logger_->trace( "[draw_freqs_on_surface] exit" );
 }
 
-void CircleVideoGenerator::thread_run( std::vector< CircleVideoGenerator::ThreadInputData > inputs ) {
-  logger_->trace( "[thread_run] enter: inputs: [{} items]", inputs.size() );
+void CircleVideoGenerator::thread_run( CircleVideoGenerator::RenderContext const& context,
+                                       std::vector< CircleVideoGenerator::FrameDescriptor > const& frames ) {
+  logger_->trace( "[thread_run] enter: frames: [{} items]", frames.size() );
 
   if( !is_ready_ ) {
     logger_->error( "[thread_run] generator is not ready!" );
@@ -946,46 +2065,28 @@ void CircleVideoGenerator::thread_run( std::vector< CircleVideoGenerator::Thread
   dynamic_freqs_dest_rect.width = VIDEO_WIDTH;
   dynamic_freqs_dest_rect.height = VIDEO_HEIGHT;
 
-  for( ThreadInputData input_data : inputs ) {
-    // logger_->trace( "[thread_run] computing input {}", input_data.i );
+  for( FrameDescriptor const& frame : frames ) {
+    // logger_->trace( "[thread_run] computing frame {}", frame.i );
     std::shared_ptr< cairo_surface_t > frame_surface_to_save = surface_create_size( VIDEO_WIDTH, VIDEO_HEIGHT );
     // surface_fill( frame_surface_to_save, 0.0, 0.0, 0.0, 1.0 );
 
     double epilepsy_warning_alpha = 0.0;
-    if( input_data.i < size_t( EPILEPSY_WARNING_VISIBLE_SECONDS * FPS ) ) {
+    if( frame.i < size_t( EPILEPSY_WARNING_VISIBLE_SECONDS * FPS ) ) {
       epilepsy_warning_alpha = 1.0;
-    } else if( input_data.i >= size_t( ( EPILEPSY_WARNING_VISIBLE_SECONDS + EPILEPSY_WARNING_FADEOUT_SECONDS ) * FPS ) ) {
+    } else if( frame.i >= size_t( ( EPILEPSY_WARNING_VISIBLE_SECONDS + EPILEPSY_WARNING_FADEOUT_SECONDS ) * FPS ) ) {
       epilepsy_warning_alpha = 0.0;
     } else {
-      epilepsy_warning_alpha = 1.0 - ( ( ( double( input_data.i ) / FPS ) - EPILEPSY_WARNING_VISIBLE_SECONDS ) / EPILEPSY_WARNING_FADEOUT_SECONDS );
+      epilepsy_warning_alpha = 1.0 - ( ( ( double( frame.i ) / FPS ) - EPILEPSY_WARNING_VISIBLE_SECONDS ) / EPILEPSY_WARNING_FADEOUT_SECONDS );
       epilepsy_warning_alpha = std::clamp( epilepsy_warning_alpha, 0.0, 1.0 );
     }
 
-    double bass_rms_sum_value = 0.0;
-    double rms_sum_value = 0.0;
-    for( int64_t i = 0; i <= input_data.pcm_frame_count; i++ ) {
-      for( int64_t c = 0; c <= input_data.audio_data_ptr->channels; c++ ) {
-        int64_t sample_index = ( ( input_data.pcm_frame_offset + i ) * input_data.audio_data_ptr->channels ) + c;
-        double bass_sample = 0.0;
-        double sound_sample = 0.0;
-        if( ( sample_index >= 0 ) && ( sample_index < ( input_data.audio_data_ptr->total_pcm_frame_count * input_data.audio_data_ptr->channels ) ) ) {
-          bass_sample = input_data.audio_data_ptr->processed_sample_data[sample_index];
-          sound_sample = input_data.audio_data_ptr->sample_data[sample_index];
-        }
-        bass_sample = std::clamp( bass_sample, -1.0, 1.0 );
-        sound_sample = std::clamp( sound_sample, -1.0, 1.0 );
-
-        bass_rms_sum_value += bass_sample * bass_sample;
-        rms_sum_value += sound_sample * sound_sample;
-      }
-    }
-
-    double const bass_intensity = std::sqrt(
-        bass_rms_sum_value
-        / ( static_cast< double >( static_cast< double >( input_data.audio_data_ptr->channels ) ) * static_cast< double >( input_data.pcm_frame_count ) ) );
-    double const sound_intensity = std::sqrt(
-        rms_sum_value
-        / ( static_cast< double >( static_cast< double >( input_data.audio_data_ptr->channels ) ) * static_cast< double >( input_data.pcm_frame_count ) ) );
+    double const bass_intensity = context.bass_intensity_per_frame[frame.i - context.first_frame];
+    double const sound_intensity = context.sound_intensity_per_frame[frame.i - context.first_frame];
+    // the shake kicks on beats and hits and settles in between. the strengths are relative to the tempo window, so they only shape
+    // the bass level, which keeps the shake as loud as the track and never beyond the bass alone
+    double const beat_intensity
+        = std::max( context.beat_strength_per_frame[frame.i - context.first_frame], context.onset_strength_per_frame[frame.i - context.first_frame] );
+    double const shake_intensity = bass_intensity * std::lerp( 1.0, beat_intensity, SHAKE_BEAT_WEIGHT );
     double const bg_intensity_scale = 0.5;
     double const circle_intensity_scale = 0.5;
     double const colour_displace_intensity_scale = 0.15;
@@ -1000,18 +2101,18 @@ void CircleVideoGenerator::thread_run( std::vector< CircleVideoGenerator::Thread
     std::shared_ptr< cairo_surface_t > dynamic_freqs_surface = surface_create_size( dynamic_freqs_dest_rect.width, dynamic_freqs_dest_rect.height );
 
     try {
-      draw_pointcloud_on_surface( dynamic_pointcloud_surface, input_data );
+      draw_pointcloud_on_surface( dynamic_pointcloud_surface, context, frame );
     } catch( std::exception const& e ) {
       logger_->error( "[thread_run] error in draw_pointcloud_on_surface: {}", e.what() );
     }
     try {
-      draw_freqs_on_surface( dynamic_freqs_surface, input_data );
+      draw_freqs_on_surface( dynamic_freqs_surface, context, frame );
     } catch( std::exception const& e ) {
       logger_->error( "[thread_run] error in draw_freqs_on_surface: {}", e.what() );
     }
 
     // put bg art on canvas, shakily
-    surface_shake_and_blit( input_data.common_bg_surface, frame_surface_to_save, ( bg_intensity_scale * colour_displace_intensity_scale * bass_intensity ) );
+    surface_shake_and_blit( context.common_bg_surface, frame_surface_to_save, ( bg_intensity_scale * colour_displace_intensity_scale * shake_intensity ) );
 
     surface_blit( dynamic_pointcloud_surface,
                   frame_surface_to_save,
@@ -1021,20 +2122,20 @@ void CircleVideoGenerator::thread_run( std::vector< CircleVideoGenerator::Thread
                   dynamic_pointcloud_dest_rect.height );
     dynamic_pointcloud_surface.reset();
 
-    surface_shake_and_blit( dynamic_freqs_surface, frame_surface_to_save, ( colour_displace_intensity_scale * bass_intensity ), true );
+    surface_shake_and_blit( dynamic_freqs_surface, frame_surface_to_save, ( colour_displace_intensity_scale * shake_intensity ), true );
     dynamic_freqs_surface.reset();
 
     // put art on canvas, shakily
-    surface_shake_and_blit( input_data.project_art_surface, frame_surface_to_save, ( colour_displace_intensity_scale * bass_intensity ) );
+    surface_shake_and_blit( context.project_art_surface, frame_surface_to_save, ( colour_displace_intensity_scale * shake_intensity ) );
 
     // // put title on canvas, shakily
-    // surface_shake_and_blit( input_data.static_text_surface, frame_surface_to_save, ( colour_displace_intensity_scale * bass_intensity ) );
+    // surface_shake_and_blit( context.static_text_surface, frame_surface_to_save, ( colour_displace_intensity_scale * bass_intensity ) );
 
     // put warning on top, with alpha
-    surface_blit( input_data.common_epilepsy_warning_surface, frame_surface_to_save, 0, 0, VIDEO_WIDTH, VIDEO_HEIGHT, epilepsy_warning_alpha );
+    surface_blit( context.common_epilepsy_warning_surface, frame_surface_to_save, 0, 0, VIDEO_WIDTH, VIDEO_HEIGHT, epilepsy_warning_alpha );
 
     // save canvas
-    save_surface( frame_surface_to_save, input_data.project_temp_pictureset_picture_path );
+    save_surface( frame_surface_to_save, context.project_temp_pictureset_path / fmt::format( "{}.png", frame.i ) );
     frame_surface_to_save.reset();
   }
 
@@ -0,0 +1,98 @@
+#include "constantQ.h"
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include <numbers>
+
+#include "fftwPlanRegistry.h"
+#include "spectralKernels.h"
+#include "window_functions.h"
+
+double constant_q_quality( double bin_ratio ) {
+  return 1.0 / ( bin_ratio - 1.0 );
+}
+
+ConstantQKernel make_constant_q_kernel( size_t fft_size, double sample_rate, std::vector< double > const& frequencies, double quality, double threshold ) {
+  ConstantQKernel kernel;
+  kernel.fft_size = fft_size;
+  kernel.frequencies = frequencies;
+  kernel.first_columns.reserve( frequencies.size() );
+  kernel.row_offsets.reserve( frequencies.size() + 1 );
+  kernel.row_offsets.push_back( 0 );
+
+  // the exponential is complex, so its spectrum is the one of the real part plus i times the one of the imaginary part
+  size_t const fft_output_size = fft_size / 2 + 1;
+  std::shared_ptr< fftwf_plan_s > fft_plan = FftwPlanRegistry::get_r2c_plan( int( fft_size ) );
+  std::shared_ptr< float[] > kernel_re( fftwf_alloc_real( fft_size ), fftwf_free );
+  std::shared_ptr< float[] > kernel_im( fftwf_alloc_real( fft_size ), fftwf_free );
+  std::shared_ptr< fftwf_complex[] > spectrum_re( fftwf_alloc_complex( fft_output_size ), fftwf_free );
+  std::shared_ptr< fftwf_complex[] > spectrum_im( fftwf_alloc_complex( fft_output_size ), fftwf_free );
+  std::vector< double > window( fft_size );
+  std::vector< std::complex< float > > row( fft_output_size );
+
+  for( double frequency : frequencies ) {
+    size_t const kernel_size = std::clamp< size_t >( size_t( std::ceil( quality * sample_rate / frequency ) ), 1, fft_size );
+    size_t const kernel_begin = ( fft_size - kernel_size ) / 2;
+    nuttallwin_octave( window.data(), unsigned( kernel_size ), true );
+    double window_sum = 0.0;
+    for( size_t n = 0; n < kernel_size; n++ ) {
+      window_sum += window[n];
+    }
+
+    // the phase is relative to the center of the frame, that way it does not matter where the kernel starts
+    std::fill( kernel_re.get(), kernel_re.get() + fft_size, 0.0f );
+    std::fill( kernel_im.get(), kernel_im.get() + fft_size, 0.0f );
+    for( size_t n = 0; n < kernel_size; n++ ) {
+      double const time = ( double( kernel_begin + n ) - ( double( fft_size ) / 2.0 ) ) / sample_rate;
+      double const phase = 2.0 * std::numbers::pi * frequency * time;
+      double const amplitude = window[n] / window_sum;
+      kernel_re[kernel_begin + n] = float( amplitude * std::cos( phase ) );
+      kernel_im[kernel_begin + n] = float( amplitude * std::sin( phase ) );
+    }
+    fftwf_execute_dft_r2c( fft_plan.get(), kernel_re.get(), spectrum_re.get() );
+    fftwf_execute_dft_r2c( fft_plan.get(), kernel_im.get(), spectrum_im.get() );
+
+    // conj( re + i * im ) / fft_size, with the 1 / fft_size of parseval folded in
+    float peak = 0.0f;
+    for( size_t j = 0; j < fft_output_size; j++ ) {
+      std::complex< float > const kernel_value( spectrum_re[j][0] - spectrum_im[j][1], spectrum_re[j][1] + spectrum_im[j][0] );
+      row[j] = std::conj( kernel_value ) / float( fft_size );
+      peak = std::max( peak, std::abs( row[j] ) );
+    }
+
+    size_t first = 0;
+    size_t last = fft_output_size;
+    while( ( first < fft_output_size ) && ( std::abs( row[first] ) < threshold * peak ) ) {
+      first++;
+    }
+    while( ( last > first ) && ( std::abs( row[last - 1] ) < threshold * peak ) ) {
+      last--;
+    }
+    kernel.first_columns.push_back( uint32_t( first ) );
+    kernel.weights.insert( kernel.weights.end(), row.begin() + first, row.begin() + last );
+    kernel.row_offsets.push_back( uint32_t( kernel.weights.size() ) );
+  }
+
+  return kernel;
+}
+
+void constant_q_magnitudes( ConstantQKernel const& kernel,
+                            fftwf_complex const* spectrum,
+                            size_t spectrum_stride,
+                            float* magnitudes,
+                            size_t magnitudes_stride,
+                            size_t frame_amount ) {
+  for( size_t f = 0; f < frame_amount; f++ ) {
+    fftwf_complex const* frame_spectrum = spectrum + ( f * spectrum_stride );
+    float* frame_magnitudes = magnitudes + ( f * magnitudes_stride );
+    for( size_t r = 0; r < kernel.bin_amount(); r++ ) {
+      uint32_t const row_begin = kernel.row_offsets[r];
+      uint32_t const row_end = kernel.row_offsets[r + 1];
+      std::complex< float > const value
+          = complex_dot( frame_spectrum + kernel.first_columns[r], kernel.weights.data() + row_begin, size_t( row_end - row_begin ) );
+      // `std::abs` goes through `hypot`, which is a lot slower and not needed at these magnitudes
+      frame_magnitudes[r] = std::sqrt( std::norm( value ) );
+    }
+  }
+}
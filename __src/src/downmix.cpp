@@ -0,0 +1,189 @@
+#include "downmix.h"
+
+#include <algorithm>
+#include <limits>
+
+#if defined( __SSE__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && ( _M_IX86_FP >= 1 ) )
+#include <xmmintrin.h>
+#define DOWNMIX_SSE
+#endif
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && ( _M_IX86_FP >= 2 ) )
+#include <emmintrin.h>
+#define DOWNMIX_SSE2
+#endif
+
+// 16 bit samples are converted into a buffer of this many floats at a time, small enough to stay in l1
+static size_t const CONVERSION_BLOCK_SIZE = 2048;
+
+static void downmix_stereo( float const* interleaved, float* mono, size_t frame_amount ) {
+  size_t i = 0;
+#if defined( DOWNMIX_SSE )
+  __m128 const half = _mm_set1_ps( 0.5f );
+  for( ; i + 4 <= frame_amount; i += 4 ) {
+    // l0 r0 l1 r1 | l2 r2 l3 r3 -> l0 l1 l2 l3 + r0 r1 r2 r3
+    __m128 const a = _mm_loadu_ps( interleaved + ( 2 * i ) );
+    __m128 const b = _mm_loadu_ps( interleaved + ( 2 * i ) + 4 );
+    __m128 const left = _mm_shuffle_ps( a, b, _MM_SHUFFLE( 2, 0, 2, 0 ) );
+    __m128 const right = _mm_shuffle_ps( a, b, _MM_SHUFFLE( 3, 1, 3, 1 ) );
+    _mm_storeu_ps( mono + i, _mm_mul_ps( _mm_add_ps( left, right ), half ) );
+  }
+#endif
+  for( ; i < frame_amount; i++ ) {
+    mono[i] = ( interleaved[2 * i] + interleaved[( 2 * i ) + 1] ) * 0.5f;
+  }
+}
+
+static void downmix_generic( float const* interleaved, float* mono, size_t frame_amount, uint32_t channels ) {
+  float const scale = 1.0f / float( channels );
+  // channel by channel, so the inner loop runs over contiguous output samples
+  std::fill( mono, mono + frame_amount, 0.0f );
+  for( uint32_t c = 0; c < channels; c++ ) {
+    float const* channel_data = interleaved + c;
+    for( size_t i = 0; i < frame_amount; i++ ) {
+      mono[i] += channel_data[i * channels];
+    }
+  }
+  for( size_t i = 0; i < frame_amount; i++ ) {
+    mono[i] *= scale;
+  }
+}
+
+void downmix_to_mono( float const* interleaved, float* mono, size_t frame_amount, uint32_t channels ) {
+  if( channels == 1 ) {
+    std::copy_n( interleaved, frame_amount, mono );
+  } else if( channels == 2 ) {
+    downmix_stereo( interleaved, mono, frame_amount );
+  } else if( channels > 2 ) {
+    downmix_generic( interleaved, mono, frame_amount, channels );
+  }
+}
+
+void downmix_to_mono( int16_t const* interleaved, float* mono, size_t frame_amount, uint32_t channels ) {
+  if( channels == 0 ) {
+    return;
+  }
+  if( channels == 1 ) {
+    int16_to_float( interleaved, mono, frame_amount );
+    return;
+  }
+  float block[CONVERSION_BLOCK_SIZE];
+  size_t const block_frames = std::max< size_t >( 1, CONVERSION_BLOCK_SIZE / channels );
+  if( block_frames * channels > CONVERSION_BLOCK_SIZE ) {
+    // more channels than fit into one block, rare enough for the scalar path
+    for( size_t i = 0; i < frame_amount; i++ ) {
+      float sum = 0.0f;
+      for( uint32_t c = 0; c < channels; c++ ) {
+        sum += float( interleaved[( i * channels ) + c] ) * PCM_INT16_SCALE;
+      }
+      mono[i] = sum / float( channels );
+    }
+    return;
+  }
+  for( size_t frame_begin = 0; frame_begin < frame_amount; frame_begin += block_frames ) {
+    size_t const frames = std::min( block_frames, frame_amount - frame_begin );
+    int16_to_float( interleaved + ( frame_begin * channels ), block, frames * channels );
+    downmix_to_mono( block, mono + frame_begin, frames, channels );
+  }
+}
+
+void downmix_to_mono( PcmSampleView const& samples, float* mono ) {
+  if( samples.format == PcmSampleFormat::INT16 ) {
+    downmix_to_mono( samples.int16(), mono, size_t( samples.frame_amount ), samples.channels );
+  } else {
+    downmix_to_mono( samples.float32(), mono, size_t( samples.frame_amount ), samples.channels );
+  }
+}
+
+void int16_to_float( int16_t const* input, float* output, size_t amount ) {
+  size_t i = 0;
+#if defined( DOWNMIX_SSE2 )
+  __m128 const scale = _mm_set1_ps( PCM_INT16_SCALE );
+  for( ; i + 8 <= amount; i += 8 ) {
+    __m128i const values = _mm_loadu_si128( reinterpret_cast< __m128i const* >( input + i ) );
+    // sign extension: every 16 bit value goes into the upper half of a 32 bit lane, then an arithmetic shift moves it down
+    __m128i const low = _mm_srai_epi32( _mm_unpacklo_epi16( values, values ), 16 );
+    __m128i const high = _mm_srai_epi32( _mm_unpackhi_epi16( values, values ), 16 );
+    _mm_storeu_ps( output + i, _mm_mul_ps( _mm_cvtepi32_ps( low ), scale ) );
+    _mm_storeu_ps( output + i + 4, _mm_mul_ps( _mm_cvtepi32_ps( high ), scale ) );
+  }
+#endif
+  for( ; i < amount; i++ ) {
+    output[i] = float( input[i] ) * PCM_INT16_SCALE;
+  }
+}
+
+void pcm_to_float( PcmSampleView const& samples, float* output ) {
+  if( samples.format == PcmSampleFormat::INT16 ) {
+    int16_to_float( samples.int16(), output, samples.sample_amount() );
+  } else {
+    std::copy_n( samples.float32(), samples.sample_amount(), output );
+  }
+}
+
+void pcm_sample_range( PcmSampleView const& samples, float& sample_min, float& sample_max ) {
+  size_t const amount = samples.sample_amount();
+  size_t i = 0;
+  if( samples.format == PcmSampleFormat::INT16 ) {
+    // in the integer domain, only the two results are converted
+    int16_t const* values = samples.int16();
+    int16_t value_min = std::numeric_limits< int16_t >::max();
+    int16_t value_max = std::numeric_limits< int16_t >::min();
+#if defined( DOWNMIX_SSE2 )
+    __m128i min_lanes = _mm_set1_epi16( value_min );
+    __m128i max_lanes = _mm_set1_epi16( value_max );
+    for( ; i + 8 <= amount; i += 8 ) {
+      __m128i const v = _mm_loadu_si128( reinterpret_cast< __m128i const* >( values + i ) );
+      min_lanes = _mm_min_epi16( min_lanes, v );
+      max_lanes = _mm_max_epi16( max_lanes, v );
+    }
+    int16_t min_array[8];
+    int16_t max_array[8];
+    _mm_storeu_si128( reinterpret_cast< __m128i* >( min_array ), min_lanes );
+    _mm_storeu_si128( reinterpret_cast< __m128i* >( max_array ), max_lanes );
+    value_min = *std::min_element( min_array, min_array + 8 );
+    value_max = *std::max_element( max_array, max_array + 8 );
+#endif
+    for( ; i < amount; i++ ) {
+      value_min = std::min( value_min, values[i] );
+      value_max = std::max( value_max, values[i] );
+    }
+    if( amount > 0 ) {
+      sample_min = std::min( sample_min, float( value_min ) * PCM_INT16_SCALE );
+      sample_max = std::max( sample_max, float( value_max ) * PCM_INT16_SCALE );
+    }
+    return;
+  }
+
+  float const* values = samples.float32();
+#if defined( DOWNMIX_SSE )
+  __m128 min_lanes = _mm_set1_ps( sample_min );
+  __m128 max_lanes = _mm_set1_ps( sample_max );
+  for( ; i + 4 <= amount; i += 4 ) {
+    __m128 const v = _mm_loadu_ps( values + i );
+    min_lanes = _mm_min_ps( min_lanes, v );
+    max_lanes = _mm_max_ps( max_lanes, v );
+  }
+  float min_array[4];
+  float max_array[4];
+  _mm_storeu_ps( min_array, min_lanes );
+  _mm_storeu_ps( max_array, max_lanes );
+  sample_min = *std::min_element( min_array, min_array + 4 );
+  sample_max = *std::max_element( max_array, max_array + 4 );
+#endif
+  for( ; i < amount; i++ ) {
+    sample_min = std::min( sample_min, values[i] );
+    sample_max = std::max( sample_max, values[i] );
+  }
+}
+
+void multiply_window( float const* input, float const* window, float* output, size_t amount ) {
+  size_t i = 0;
+#if defined( DOWNMIX_SSE )
+  for( ; i + 4 <= amount; i += 4 ) {
+    _mm_storeu_ps( output + i, _mm_mul_ps( _mm_loadu_ps( input + i ), _mm_loadu_ps( window + i ) ) );
+  }
+#endif
+  for( ; i < amount; i++ ) {
+    output[i] = input[i] * window[i];
+  }
+}
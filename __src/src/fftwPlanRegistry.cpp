@@ -0,0 +1,178 @@
+#include "fftwPlanRegistry.h"
+
+#include <cctype>
+#include <chrono>
+#include <cstring>
+
+#include "_fftw.h"
+#include "loggerFactory.h"
+
+#if defined( _MSC_VER ) && ( defined( _M_X64 ) || defined( _M_IX86 ) )
+#include <intrin.h>
+#define FFTW_PLAN_REGISTRY_CPUID_MSVC
+#elif defined( __GNUC__ ) && ( defined( __x86_64__ ) || defined( __i386__ ) )
+#include <cpuid.h>
+#define FFTW_PLAN_REGISTRY_CPUID_GNU
+#endif
+
+// uint32_t const FftwPlanRegistry::FFTW_PLAN_FLAGS = FFTW_EXHAUSTIVE;
+uint32_t const FftwPlanRegistry::FFTW_PLAN_FLAGS = FFTW_PATIENT;
+
+spdlogger FftwPlanRegistry::logger_ = nullptr;
+std::filesystem::path FftwPlanRegistry::wisdom_path_;
+std::map< std::string, std::shared_ptr< fftwf_plan_s > > FftwPlanRegistry::plans_;
+std::mutex FftwPlanRegistry::plans_mutex_;
+
+void FftwPlanRegistry::init( std::filesystem::path const& wisdom_path ) {
+  FftwPlanRegistry::logger_ = LoggerFactory::get_logger( "FftwPlanRegistry" );
+  FftwPlanRegistry::logger_->trace( "[init] enter: wisdom_path: {:?}", wisdom_path.string() );
+
+  std::scoped_lock lock( FftwPlanRegistry::plans_mutex_ );
+  FftwPlanRegistry::wisdom_path_ = wisdom_path / FftwPlanRegistry::get_machine_key() / FftwPlanRegistry::get_planner_rigor();
+  std::error_code ec;
+  std::filesystem::create_directories( FftwPlanRegistry::wisdom_path_, ec );
+  if( ec ) {
+    FftwPlanRegistry::logger_->error( "[init] could not create {:?}: {}, wisdom will not be cached", FftwPlanRegistry::wisdom_path_.string(), ec.message() );
+    FftwPlanRegistry::wisdom_path_.clear();
+  }
+  FftwPlanRegistry::logger_->debug( "[init] wisdom_path_: {:?}", FftwPlanRegistry::wisdom_path_.string() );
+
+  FftwPlanRegistry::logger_->trace( "[init] exit" );
+}
+
+void FftwPlanRegistry::deinit() {
+  FftwPlanRegistry::logger_->trace( "[deinit] enter" );
+
+  std::scoped_lock lock( FftwPlanRegistry::plans_mutex_ );
+  // plans still held elsewhere are destroyed once their last user lets go of them
+  FftwPlanRegistry::plans_.clear();
+
+  FftwPlanRegistry::logger_->trace( "[deinit] exit" );
+}
+
+std::shared_ptr< fftwf_plan_s > FftwPlanRegistry::get_r2c_plan( int fft_size ) {
+  return FftwPlanRegistry::get_plan( fmt::format( "r2c_{}", fft_size ),
+                                     size_t( fft_size ),
+                                     size_t( fft_size / 2 + 1 ),
+                                     [fft_size]( float* input, fftwf_complex* output ) {
+                                       return fftwf_plan_dft_r2c_1d( fft_size, input, output, FFTW_PLAN_FLAGS );
+                                     } );
+}
+
+std::shared_ptr< fftwf_plan_s > FftwPlanRegistry::get_r2c_batch_plan( int fft_size, int batch_size ) {
+  int const output_size = fft_size / 2 + 1;
+  return FftwPlanRegistry::get_plan( fmt::format( "r2c_{}_x{}", fft_size, batch_size ),
+                                     size_t( fft_size ) * size_t( batch_size ),
+                                     size_t( output_size ) * size_t( batch_size ),
+                                     [fft_size, batch_size, output_size]( float* input, fftwf_complex* output ) {
+                                       return fftwf_plan_many_dft_r2c(
+                                           1, &fft_size, batch_size, input, nullptr, 1, fft_size, output, nullptr, 1, output_size, FFTW_PLAN_FLAGS );
+                                     } );
+}
+
+std::shared_ptr< fftwf_plan_s > FftwPlanRegistry::get_plan( std::string const& plan_key,
+                                                            size_t input_size,
+                                                            size_t output_size,
+                                                            std::function< fftwf_plan( float*, fftwf_complex* ) > const& make_plan ) {
+  std::scoped_lock lock( FftwPlanRegistry::plans_mutex_ );
+  auto it = FftwPlanRegistry::plans_.find( plan_key );
+  if( it != FftwPlanRegistry::plans_.end() ) {
+    return it->second;
+  }
+
+  bool const had_wisdom = FftwPlanRegistry::import_wisdom( plan_key );
+
+  // measuring planners overwrite the buffers, so they get their own
+  std::shared_ptr< float[] > plan_input( fftwf_alloc_real( input_size ), fftwf_free );
+  std::shared_ptr< fftwf_complex[] > plan_output( fftwf_alloc_complex( output_size ), fftwf_free );
+  auto const plan_start = std::chrono::steady_clock::now();
+  std::shared_ptr< fftwf_plan_s > plan = make_fftw_shared_ptr( make_plan( plan_input.get(), plan_output.get() ) );
+  auto const plan_duration = std::chrono::duration_cast< std::chrono::milliseconds >( std::chrono::steady_clock::now() - plan_start );
+  FftwPlanRegistry::logger_->debug( "[get_plan] planned {} in {} (cached wisdom: {})", plan_key, plan_duration, had_wisdom );
+
+  if( !had_wisdom ) {
+    FftwPlanRegistry::export_wisdom( plan_key );
+  }
+
+  FftwPlanRegistry::plans_.insert_or_assign( plan_key, plan );
+  return plan;
+}
+
+std::string FftwPlanRegistry::get_machine_key() {
+  char cpu_brand[49] = { 0 };
+#if defined( FFTW_PLAN_REGISTRY_CPUID_MSVC )
+  int regs[4];
+  __cpuid( regs, 0x80000000 );
+  if( uint32_t( regs[0] ) >= 0x80000004 ) {
+    for( int i = 0; i < 3; i++ ) {
+      __cpuid( regs, 0x80000002 + i );
+      std::memcpy( cpu_brand + ( 16 * i ), regs, 16 );
+    }
+  }
+#elif defined( FFTW_PLAN_REGISTRY_CPUID_GNU )
+  unsigned int regs[4];
+  if( __get_cpuid_max( 0x80000000, nullptr ) >= 0x80000004 ) {
+    for( unsigned int i = 0; i < 3; i++ ) {
+      __get_cpuid( 0x80000002 + i, &regs[0], &regs[1], &regs[2], &regs[3] );
+      std::memcpy( cpu_brand + ( 16 * i ), regs, 16 );
+    }
+  }
+#endif
+  std::string cpu_name( cpu_brand );
+  if( cpu_name.find_first_not_of( ' ' ) == std::string::npos ) {
+    cpu_name = "unknown_cpu";
+  }
+
+  // only keep characters that are fine in a directory name on every platform
+  std::string machine_key;
+  for( char c : cpu_name + "_" + fftwf_version ) {
+    if( std::isalnum( static_cast< unsigned char >( c ) ) || ( c == '.' ) || ( c == '-' ) ) {
+      machine_key.push_back( c );
+    } else if( machine_key.empty() || ( machine_key.back() != '_' ) ) {
+      machine_key.push_back( '_' );
+    }
+  }
+  return machine_key;
+}
+
+std::string FftwPlanRegistry::get_planner_rigor() {
+  // wisdom of a lower rigor satisfies fftw without being better, so every rigor keeps its own
+  if( ( FFTW_PLAN_FLAGS & FFTW_WISDOM_ONLY ) != 0 ) {
+    return "wisdom_only";
+  }
+  if( ( FFTW_PLAN_FLAGS & FFTW_ESTIMATE ) != 0 ) {
+    return "estimate";
+  }
+  if( ( FFTW_PLAN_FLAGS & FFTW_EXHAUSTIVE ) != 0 ) {
+    return "exhaustive";
+  }
+  if( ( FFTW_PLAN_FLAGS & FFTW_PATIENT ) != 0 ) {
+    return "patient";
+  }
+  return "measure";
+}
+
+bool FftwPlanRegistry::import_wisdom( std::string const& plan_key ) {
+  if( FftwPlanRegistry::wisdom_path_.empty() ) {
+    return false;
+  }
+  std::filesystem::path const wisdom_file = FftwPlanRegistry::wisdom_path_ / ( plan_key + ".wisdom" );
+  if( !std::filesystem::exists( wisdom_file ) ) {
+    return false;
+  }
+  if( fftwf_import_wisdom_from_filename( wisdom_file.string().c_str() ) == 0 ) {
+    FftwPlanRegistry::logger_->warn( "[import_wisdom] could not import {:?}, planning from scratch", wisdom_file.string() );
+    return false;
+  }
+  return true;
+}
+
+void FftwPlanRegistry::export_wisdom( std::string const& plan_key ) {
+  if( FftwPlanRegistry::wisdom_path_.empty() ) {
+    return;
+  }
+  std::filesystem::path const wisdom_file = FftwPlanRegistry::wisdom_path_ / ( plan_key + ".wisdom" );
+  if( fftwf_export_wisdom_to_filename( wisdom_file.string().c_str() ) == 0 ) {
+    FftwPlanRegistry::logger_->warn( "[export_wisdom] could not write {:?}", wisdom_file.string() );
+  }
+}
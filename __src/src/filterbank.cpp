@@ -0,0 +1,90 @@
+#include "filterbank.h"
+
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <mutex>
+
+double filterbank_scale_from_hz( FilterbankScale scale, double freq ) {
+  switch( scale ) {
+    case FilterbankScale::MEL:
+      return 2595.0 * std::log10( 1.0 + ( freq / 700.0 ) );
+    case FilterbankScale::BARK:
+      return ( 26.81 * freq / ( 1960.0 + freq ) ) - 0.53;
+  }
+  return freq;
+}
+
+double filterbank_scale_to_hz( FilterbankScale scale, double value ) {
+  switch( scale ) {
+    case FilterbankScale::MEL:
+      return 700.0 * ( std::pow( 10.0, value / 2595.0 ) - 1.0 );
+    case FilterbankScale::BARK:
+      return 1960.0 * ( value + 0.53 ) / ( 26.28 - value );
+  }
+  return value;
+}
+
+// edge `e` of the `band_amount + 2` edges, band `b` rises from edge `b` to edge `b + 1` and falls to edge `b + 2`
+static double filterbank_edge_freq( FilterbankLayout const& layout, uint32_t edge ) {
+  double const scale_min = filterbank_scale_from_hz( layout.scale, layout.min_freq );
+  double const scale_max = filterbank_scale_from_hz( layout.scale, layout.max_freq );
+  double const t = double( edge ) / double( layout.band_amount + 1 );
+  return filterbank_scale_to_hz( layout.scale, scale_min + ( t * ( scale_max - scale_min ) ) );
+}
+
+double filterbank_band_freq( FilterbankLayout const& layout, uint32_t band ) {
+  return filterbank_edge_freq( layout, band + 1 );
+}
+
+SparseMatrix make_filterbank_matrix( FilterbankLayout const& layout ) {
+  SparseMatrix matrix;
+  matrix.row_amount = layout.band_amount;
+  matrix.column_amount = layout.fft_size / 2;
+  matrix.row_offsets.reserve( matrix.row_amount + 1 );
+  matrix.row_offsets.push_back( 0 );
+
+  // frequency of column `c`, which is the fft index `c + 1`
+  double const column_width = layout.sample_rate / double( layout.fft_size );
+  auto column_freq = [&]( size_t c ) { return double( c + 1 ) * column_width; };
+
+  for( uint32_t band = 0; band < layout.band_amount; band++ ) {
+    double const low_freq = filterbank_edge_freq( layout, band );
+    double const center_freq = filterbank_edge_freq( layout, band + 1 );
+    double const high_freq = filterbank_edge_freq( layout, band + 2 );
+    double const peak = ( layout.normalization == FilterbankNormalization::SLANEY ) ? 2.0 / ( high_freq - low_freq ) : 1.0;
+
+    size_t const row_begin = matrix.column_indices.size();
+    size_t const first_column = size_t( std::max( 0.0, std::ceil( low_freq / column_width ) - 1.0 ) );
+    for( size_t c = first_column; ( c < matrix.column_amount ) && ( column_freq( c ) < high_freq ); c++ ) {
+      double const freq = column_freq( c );
+      double const rise = ( freq - low_freq ) / ( center_freq - low_freq );
+      double const fall = ( high_freq - freq ) / ( high_freq - center_freq );
+      double const weight = std::min( rise, fall );
+      if( weight > 0.0 ) {
+        matrix.column_indices.push_back( uint32_t( c ) );
+        matrix.weights.push_back( float( peak * weight ) );
+      }
+    }
+
+    if( ( matrix.column_indices.size() == row_begin ) && ( matrix.column_amount > 0 ) ) {
+      int64_t const closest = std::llround( center_freq / column_width ) - 1;
+      matrix.column_indices.push_back( uint32_t( std::clamp< int64_t >( closest, 0, int64_t( matrix.column_amount ) - 1 ) ) );
+      matrix.weights.push_back( float( peak ) );
+    }
+    matrix.row_offsets.push_back( uint32_t( matrix.column_indices.size() ) );
+  }
+  return matrix;
+}
+
+std::shared_ptr< SparseMatrix const > get_filterbank_matrix( FilterbankLayout const& layout ) {
+  static std::mutex matrices_mutex;
+  static std::map< FilterbankLayout, std::shared_ptr< SparseMatrix const > > matrices;
+
+  std::scoped_lock lock( matrices_mutex );
+  auto it = matrices.find( layout );
+  if( it == matrices.end() ) {
+    it = matrices.emplace( layout, std::make_shared< SparseMatrix const >( make_filterbank_matrix( layout ) ) ).first;
+  }
+  return it->second;
+}
@@ -0,0 +1,123 @@
+#include "goertzelBank.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+#if defined( __AVX__ )
+#include <immintrin.h>
+#define GOERTZEL_BANK_AVX
+#define GOERTZEL_BANK_SSE2
+#elif defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && ( _M_IX86_FP >= 2 ) )
+#include <emmintrin.h>
+#define GOERTZEL_BANK_SSE2
+#endif
+
+// the lane types of biquadCascade.cpp have the same names, keep these local to this file
+namespace {
+
+// one frequency per lane, the recursion runs in double, float loses the low frequencies of long frames
+struct ScalarLanes {
+  typedef double type;
+  static size_t const WIDTH = 1;
+  static type set1( double value ) { return value; }
+  static type add( type a, type b ) { return a + b; }
+  static type sub( type a, type b ) { return a - b; }
+  static type mul( type a, type b ) { return a * b; }
+  static type from_array( double const* values ) { return values[0]; }
+  static void to_array( double* values, type value ) { values[0] = value; }
+};
+
+#if defined( GOERTZEL_BANK_SSE2 )
+struct Sse2Lanes {
+  typedef __m128d type;
+  static size_t const WIDTH = 2;
+  static type set1( double value ) { return _mm_set1_pd( value ); }
+  static type add( type a, type b ) { return _mm_add_pd( a, b ); }
+  static type sub( type a, type b ) { return _mm_sub_pd( a, b ); }
+  static type mul( type a, type b ) { return _mm_mul_pd( a, b ); }
+  static type from_array( double const* values ) { return _mm_loadu_pd( values ); }
+  static void to_array( double* values, type value ) { _mm_storeu_pd( values, value ); }
+};
+#endif
+
+#if defined( GOERTZEL_BANK_AVX )
+struct AvxLanes {
+  typedef __m256d type;
+  static size_t const WIDTH = 4;
+  static type set1( double value ) { return _mm256_set1_pd( value ); }
+  static type add( type a, type b ) { return _mm256_add_pd( a, b ); }
+  static type sub( type a, type b ) { return _mm256_sub_pd( a, b ); }
+  static type mul( type a, type b ) { return _mm256_mul_pd( a, b ); }
+  static type from_array( double const* values ) { return _mm256_loadu_pd( values ); }
+  static void to_array( double* values, type value ) { _mm256_storeu_pd( values, value ); }
+};
+#endif
+
+}  // namespace
+
+#if defined( GOERTZEL_BANK_AVX )
+typedef AvxLanes BankLanes;
+#elif defined( GOERTZEL_BANK_SSE2 )
+typedef Sse2Lanes BankLanes;
+#else
+typedef ScalarLanes BankLanes;
+#endif
+
+// frequencies per pass, two independent registers hide the latency of the recursion
+static size_t const BLOCK_SIZE = 2 * BankLanes::WIDTH;
+
+// `s[n] = x[n] + 2 cos( w ) s[n - 1] - s[n - 2]` for the `BLOCK_SIZE` frequencies at `coefficients`,
+// then `| X( w ) |^2 = s[n - 1]^2 + s[n - 2]^2 - 2 cos( w ) s[n - 1] s[n - 2]`
+template < typename Lanes >
+static void goertzel_block( float const* frame, size_t frame_size, double const* coefficients, double* powers ) {
+  typedef typename Lanes::type type;
+  type const coefficient_a = Lanes::from_array( coefficients );
+  type const coefficient_b = Lanes::from_array( coefficients + Lanes::WIDTH );
+  type s1_a = Lanes::set1( 0.0 );
+  type s2_a = Lanes::set1( 0.0 );
+  type s1_b = Lanes::set1( 0.0 );
+  type s2_b = Lanes::set1( 0.0 );
+  for( size_t n = 0; n < frame_size; n++ ) {
+    type const x = Lanes::set1( double( frame[n] ) );
+    type const s0_a = Lanes::add( x, Lanes::sub( Lanes::mul( coefficient_a, s1_a ), s2_a ) );
+    type const s0_b = Lanes::add( x, Lanes::sub( Lanes::mul( coefficient_b, s1_b ), s2_b ) );
+    s2_a = s1_a;
+    s1_a = s0_a;
+    s2_b = s1_b;
+    s1_b = s0_b;
+  }
+  type const power_a = Lanes::sub( Lanes::add( Lanes::mul( s1_a, s1_a ), Lanes::mul( s2_a, s2_a ) ), Lanes::mul( coefficient_a, Lanes::mul( s1_a, s2_a ) ) );
+  type const power_b = Lanes::sub( Lanes::add( Lanes::mul( s1_b, s1_b ), Lanes::mul( s2_b, s2_b ) ), Lanes::mul( coefficient_b, Lanes::mul( s1_b, s2_b ) ) );
+  Lanes::to_array( powers, power_a );
+  Lanes::to_array( powers + Lanes::WIDTH, power_b );
+}
+
+GoertzelBank::GoertzelBank( std::vector< double > const& frequencies, double sample_rate ) : frequency_amount_( frequencies.size() ) {
+  size_t const padded_amount = ( ( frequency_amount_ + BLOCK_SIZE - 1 ) / BLOCK_SIZE ) * BLOCK_SIZE;
+  // the padding lanes run at dc and are dropped
+  coefficients_.resize( padded_amount, 2.0 );
+  for( size_t f = 0; f < frequency_amount_; f++ ) {
+    coefficients_[f] = 2.0 * std::cos( 2.0 * std::numbers::pi * frequencies[f] / sample_rate );
+  }
+}
+
+void GoertzelBank::magnitudes( float const* frame, size_t frame_size, float* output ) const {
+  double powers[BLOCK_SIZE];
+  for( size_t block_begin = 0; block_begin < frequency_amount_; block_begin += BLOCK_SIZE ) {
+    goertzel_block< BankLanes >( frame, frame_size, coefficients_.data() + block_begin, powers );
+    size_t const block_amount = std::min( BLOCK_SIZE, frequency_amount_ - block_begin );
+    for( size_t f = 0; f < block_amount; f++ ) {
+      // rounding can push the power of a silent frequency slightly below zero
+      output[block_begin + f] = float( std::sqrt( std::max( 0.0, powers[f] ) ) );
+    }
+  }
+}
+
+bool GoertzelBank::is_cheaper_than_fft( size_t frequency_amount, size_t frame_size, size_t fft_size ) {
+  // measured with avx against fftw: a goertzel step of one frequency costs about as much as 2.2 butterflies of the fft,
+  // the recursion is latency bound while fftw's codelets are not
+  double const bank_cost = 2.2 * double( frequency_amount ) * double( frame_size );
+  double const fft_cost = double( fft_size ) * std::log2( double( fft_size ) );
+  return bank_cost < fft_cost;
+}
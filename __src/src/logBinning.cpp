@@ -0,0 +1,84 @@
+#include "logBinning.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "_fftw.h"
+#include "spectralKernels.h"
+
+SparseMatrix make_log_binning_matrix( size_t fft_size, double sample_rate, double min_freq, double max_freq, uint32_t bin_amount ) {
+  SparseMatrix matrix;
+  matrix.row_amount = size_t( bin_amount ) + 1;
+  matrix.column_amount = fft_size / 2;
+  matrix.row_offsets.reserve( matrix.row_amount + 1 );
+  matrix.row_offsets.push_back( 0 );
+
+  double const freq_min = std::log10( min_freq );
+  double const freq_max = std::log10( max_freq );
+  auto bin_edge = [&]( size_t bin ) { return std::pow( 10.0, freq_min + ( double( bin ) * ( freq_max - freq_min ) / double( bin_amount ) ) ); };
+  // frequency of column `c`, which is the fft index `c + 1`
+  auto column_freq = [&]( size_t c ) { return double( c + 1 ) * sample_rate / double( fft_size ); };
+
+  // the edges only grow, so the first column of every bin continues where the one before stopped
+  size_t column = 0;
+  for( size_t bin = 0; bin < matrix.row_amount; bin++ ) {
+    double const bin_min_freq = bin_edge( bin );
+    double const bin_max_freq = bin_edge( bin + 1 );
+    while( ( column < matrix.column_amount ) && ( column_freq( column ) < bin_min_freq ) ) {
+      column++;
+    }
+    size_t const row_begin = matrix.column_indices.size();
+    for( size_t c = column; ( c < matrix.column_amount ) && ( column_freq( c ) < bin_max_freq ); c++ ) {
+      matrix.column_indices.push_back( uint32_t( c ) );
+      matrix.weights.push_back( 1.0f );
+    }
+
+    if( ( matrix.column_indices.size() == row_begin ) && ( matrix.column_amount > 0 ) ) {
+      // no fft values for this frequency, gonna have to fancy lerp this from the neighbouring values
+      double fft_freq_bin = ( double( fft_size ) * bin_min_freq / sample_rate ) - 1.0;  // -1 because the dc index is skipped
+      int64_t a_index = int64_t( std::floor( fft_freq_bin ) );
+      double weights[4];
+      catmullRom_weights( fft_freq_bin - double( a_index ), weights );
+      for( int64_t k = 0; k < 4; k++ ) {
+        uint32_t c = uint32_t( std::clamp< int64_t >( a_index - 1 + k, 0, int64_t( matrix.column_amount ) - 1 ) );
+        // taps clamped onto the same column are merged, the columns of a row stay unique
+        if( ( matrix.column_indices.size() > row_begin ) && ( matrix.column_indices.back() == c ) ) {
+          matrix.weights.back() += float( weights[k] );
+        } else {
+          matrix.column_indices.push_back( c );
+          matrix.weights.push_back( float( weights[k] ) );
+        }
+      }
+    }
+    matrix.row_offsets.push_back( uint32_t( matrix.column_indices.size() ) );
+  }
+  return matrix;
+}
+
+void sparse_multiply( SparseMatrix const& matrix, float const* input, size_t input_stride, float* output, size_t output_stride, size_t frame_amount ) {
+  uint32_t const* row_offsets = matrix.row_offsets.data();
+  uint32_t const* column_indices = matrix.column_indices.data();
+  float const* weights = matrix.weights.data();
+  for( size_t f = 0; f < frame_amount; f++ ) {
+    float const* input_row = input + ( f * input_stride );
+    float* output_row = output + ( f * output_stride );
+    for( size_t r = 0; r < matrix.row_amount; r++ ) {
+      uint32_t const row_begin = row_offsets[r];
+      uint32_t const row_end = row_offsets[r + 1];
+      if( row_begin == row_end ) {
+        output_row[r] = 0.0f;
+        continue;
+      }
+      // the columns are ascending, so they are contiguous exactly when the first and the last one are as far apart as there are entries
+      if( column_indices[row_end - 1] - column_indices[row_begin] == row_end - row_begin - 1 ) {
+        output_row[r] = dot_product( weights + row_begin, input_row + column_indices[row_begin], row_end - row_begin );
+        continue;
+      }
+      float sum = 0.0f;
+      for( uint32_t e = row_begin; e < row_end; e++ ) {
+        sum += weights[e] * input_row[column_indices[e]];
+      }
+      output_row[r] = sum;
+    }
+  }
+}
@@ -0,0 +1,61 @@
+#include "magDbNormalizer.h"
+
+#include <cmath>
+#include <limits>
+
+MagDbNormalizer::MagDbNormalizer( MagDbNormalization const& normalization )
+    : normalization_( normalization ), max_mag_db_( -std::numeric_limits< float >::max() ) {}
+
+void MagDbNormalizer::push( double frame_max_mag_db ) {
+  if( is_finished_ ) {
+    return;
+  }
+
+  if( normalization_.mode == MagDbNormalizationMode::GLOBAL ) {
+    max_mag_db_ = std::max( max_mag_db_, frame_max_mag_db );
+  } else {
+    // a quieter frame before a louder one can never be the loudest of a window again
+    while( !peaks_.empty() && ( peaks_.back().mag_db <= frame_max_mag_db ) ) {
+      peaks_.pop_back();
+    }
+    peaks_.push_back( Peak{ pushed_amount_, frame_max_mag_db } );
+  }
+  pushed_amount_++;
+}
+
+void MagDbNormalizer::finish() {
+  is_finished_ = true;
+}
+
+bool MagDbNormalizer::has_next() const {
+  if( next_frame_ >= pushed_amount_ ) {
+    return false;
+  }
+  if( normalization_.mode == MagDbNormalizationMode::GLOBAL ) {
+    return is_finished_;
+  }
+  return is_finished_ || ( pushed_amount_ > next_frame_ + normalization_.lookahead_frames );
+}
+
+std::optional< MagDbRange > MagDbNormalizer::next() {
+  if( !has_next() ) {
+    return std::nullopt;
+  }
+
+  double max_mag_db;
+  if( normalization_.mode == MagDbNormalizationMode::GLOBAL ) {
+    max_mag_db = std::ceil( max_mag_db_ );
+  } else {
+    // the window is `next_frame_` to `next_frame_ + lookahead_frames`, everything after it has not been pushed yet
+    while( peaks_.front().frame < next_frame_ ) {
+      peaks_.pop_front();
+    }
+    // peak hold with an instant attack (the lookahead already rose to the peak) and a slow release
+    double const window_max_mag_db = peaks_.front().mag_db;
+    envelope_mag_db_
+        = envelope_mag_db_ ? std::max( window_max_mag_db, *envelope_mag_db_ - normalization_.release_db_per_frame ) : window_max_mag_db;
+    max_mag_db = *envelope_mag_db_;
+  }
+  next_frame_++;
+  return MagDbRange{ max_mag_db - normalization_.mag_db_range, max_mag_db };
+}
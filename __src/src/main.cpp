@@ -16,6 +16,7 @@
 
 #include "_dr_wav.h"
 #include "circleVideoGenerator.h"
+#include "fftwPlanRegistry.h"
 #include "fontManager.h"
 #include "loggerFactory.h"
 #include "regularVideoGenerator.h"
@@ -85,6 +86,7 @@ int main( int argc, char** argv ) {
   spdlog::debug( "common_path: {:?}", common_path.string() );
 
   FontManager::init( common_path / "__fonts" );
+  FftwPlanRegistry::init( common_path / "__fftw_wisdom" );
 
   CircleVideoGenerator::init( project_path, common_path );
   // RegularVideoGenerator::init( project_path, common_path );
@@ -95,6 +97,7 @@ int main( int argc, char** argv ) {
   CircleVideoGenerator::deinit();
   // RegularVideoGenerator::deinit();
 
+  FftwPlanRegistry::deinit();
   FontManager::deinit();
 
   LoggerFactory::deinit();
@@ -0,0 +1,94 @@
+#include "mappedFile.h"
+
+#include <utility>
+
+#if defined( _WIN32 )
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+  close();
+}
+
+MappedFile::MappedFile( MappedFile&& other ) noexcept
+    : data_( std::exchange( other.data_, nullptr ) ), size_( std::exchange( other.size_, 0 ) ) {}
+
+MappedFile& MappedFile::operator=( MappedFile&& other ) noexcept {
+  if( this != &other ) {
+    close();
+    data_ = std::exchange( other.data_, nullptr );
+    size_ = std::exchange( other.size_, 0 );
+  }
+  return *this;
+}
+
+bool MappedFile::open( std::filesystem::path const& file_path ) {
+  close();
+
+#if defined( _WIN32 )
+  HANDLE file = CreateFileW( file_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr );
+  if( file == INVALID_HANDLE_VALUE ) {
+    return false;
+  }
+  LARGE_INTEGER file_size;
+  if( !GetFileSizeEx( file, &file_size ) || ( file_size.QuadPart <= 0 ) ) {
+    CloseHandle( file );
+    return false;
+  }
+  HANDLE mapping = CreateFileMappingW( file, nullptr, PAGE_READONLY, 0, 0, nullptr );
+  CloseHandle( file );
+  if( mapping == nullptr ) {
+    return false;
+  }
+  // the view keeps the mapping alive on its own
+  void* view = MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+  CloseHandle( mapping );
+  if( view == nullptr ) {
+    return false;
+  }
+  data_ = static_cast< uint8_t const* >( view );
+  size_ = size_t( file_size.QuadPart );
+#else
+  int fd = ::open( file_path.c_str(), O_RDONLY );
+  if( fd < 0 ) {
+    return false;
+  }
+  struct stat file_stat;
+  if( ( fstat( fd, &file_stat ) != 0 ) || ( file_stat.st_size <= 0 ) ) {
+    ::close( fd );
+    return false;
+  }
+  // the mapping keeps the file alive on its own
+  void* view = mmap( nullptr, size_t( file_stat.st_size ), PROT_READ, MAP_PRIVATE, fd, 0 );
+  ::close( fd );
+  if( view == MAP_FAILED ) {
+    return false;
+  }
+  data_ = static_cast< uint8_t const* >( view );
+  size_ = size_t( file_stat.st_size );
+#endif
+
+  return true;
+}
+
+void MappedFile::close() {
+  if( data_ == nullptr ) {
+    return;
+  }
+
+#if defined( _WIN32 )
+  UnmapViewOfFile( data_ );
+#else
+  munmap( const_cast< uint8_t* >( data_ ), size_ );
+#endif
+
+  data_ = nullptr;
+  size_ = 0;
+}
@@ -0,0 +1,107 @@
+#include "mappedWavFile.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+static uint16_t const WAVE_FORMAT_PCM = 0x0001;
+static uint16_t const WAVE_FORMAT_IEEE_FLOAT = 0x0003;
+static uint16_t const WAVE_FORMAT_EXTENSIBLE = 0xFFFE;
+
+static uint16_t read_u16( uint8_t const* p ) {
+  uint16_t value;
+  std::memcpy( &value, p, sizeof( value ) );
+  return value;
+}
+
+static uint32_t read_u32( uint8_t const* p ) {
+  uint32_t value;
+  std::memcpy( &value, p, sizeof( value ) );
+  return value;
+}
+
+bool MappedWavFile::open( std::filesystem::path const& file_path ) {
+  close();
+
+  // the samples are read as they are stored, which is little endian
+  if constexpr( std::endian::native != std::endian::little ) {
+    return false;
+  }
+  if( !file_.open( file_path ) ) {
+    return false;
+  }
+
+  uint8_t const* const file_data = file_.data();
+  size_t const file_size = file_.size();
+  if( ( file_size < 12 ) || ( std::memcmp( file_data, "RIFF", 4 ) != 0 ) || ( std::memcmp( file_data + 8, "WAVE", 4 ) != 0 ) ) {
+    close();
+    return false;
+  }
+
+  uint16_t format_tag = 0;
+  uint16_t channels = 0;
+  uint32_t sample_rate = 0;
+  uint16_t block_align = 0;
+  uint16_t bits_per_sample = 0;
+  size_t data_offset = 0;
+  size_t data_size = 0;
+  bool has_format = false;
+  bool has_data = false;
+  for( size_t chunk_offset = 12; chunk_offset + 8 <= file_size; ) {
+    uint8_t const* const chunk = file_data + chunk_offset;
+    size_t const chunk_body = chunk_offset + 8;
+    size_t const chunk_size = read_u32( chunk + 4 );
+    if( std::memcmp( chunk, "fmt ", 4 ) == 0 ) {
+      if( ( chunk_size < 16 ) || ( chunk_size > file_size - chunk_body ) ) {
+        break;
+      }
+      format_tag = read_u16( file_data + chunk_body );
+      channels = read_u16( file_data + chunk_body + 2 );
+      sample_rate = read_u32( file_data + chunk_body + 4 );
+      block_align = read_u16( file_data + chunk_body + 12 );
+      bits_per_sample = read_u16( file_data + chunk_body + 14 );
+      if( ( format_tag == WAVE_FORMAT_EXTENSIBLE ) && ( chunk_size >= 40 ) ) {
+        // the format code is the first two bytes of the sub format guid
+        format_tag = read_u16( file_data + chunk_body + 24 );
+      }
+      has_format = true;
+    } else if( std::memcmp( chunk, "data", 4 ) == 0 ) {
+      data_offset = chunk_body;
+      // a writer that never finished (or streamed) leaves a size past the end of the file
+      data_size = std::min( chunk_size, file_size - chunk_body );
+      has_data = true;
+      break;
+    }
+    // chunks are padded to an even size
+    chunk_offset = chunk_body + chunk_size + ( chunk_size & 1 );
+  }
+
+  PcmSampleFormat format;
+  size_t sample_size;
+  if( ( format_tag == WAVE_FORMAT_PCM ) && ( bits_per_sample == 16 ) ) {
+    format = PcmSampleFormat::INT16;
+    sample_size = sizeof( int16_t );
+  } else if( ( format_tag == WAVE_FORMAT_IEEE_FLOAT ) && ( bits_per_sample == 32 ) ) {
+    format = PcmSampleFormat::FLOAT32;
+    sample_size = sizeof( float );
+  } else {
+    close();
+    return false;
+  }
+  // the samples are read in place, so they have to be aligned for their type (the mapping itself is page aligned)
+  if( !has_format || !has_data || ( channels == 0 ) || ( sample_rate == 0 ) || ( block_align != channels * sample_size )
+      || ( data_offset % sample_size != 0 ) ) {
+    close();
+    return false;
+  }
+
+  sample_rate_ = sample_rate;
+  samples_ = PcmSampleView{ format, file_data + data_offset, channels, uint64_t( data_size / block_align ) };
+  return true;
+}
+
+void MappedWavFile::close() {
+  file_.close();
+  sample_rate_ = 0;
+  samples_ = PcmSampleView();
+}
@@ -0,0 +1,172 @@
+#include "multiResolutionStft.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+#include "fftwPlanRegistry.h"
+#include "multirate.h"
+#include "spectralKernels.h"
+#include "window_functions.h"
+
+// the decimation filters keep this much of the decimated nyquist frequency intact
+static double const DECIMATION_PASSBAND = 0.8;
+
+std::vector< MultiResolutionBand > design_three_band_resolution( double sample_rate,
+                                                                  size_t window_size,
+                                                                  double low_crossover,
+                                                                  double high_crossover,
+                                                                  double crossover_octaves ) {
+  // the largest decimation that still keeps everything up to the end of the fade out of the band
+  auto max_decimation = [&]( double crossover, size_t undecimated_window_size ) {
+    double const highest_freq = crossover * std::pow( 2.0, crossover_octaves / 2.0 );
+    uint32_t decimation = 1;
+    while( ( DECIMATION_PASSBAND * sample_rate / double( decimation * 4 ) >= highest_freq ) && ( undecimated_window_size / ( decimation * 2 ) >= 64 ) ) {
+      decimation *= 2;
+    }
+    return decimation;
+  };
+
+  std::vector< MultiResolutionBand > bands( 3 );
+  bands[0].decimation = max_decimation( low_crossover, window_size * 4 );
+  bands[0].window_size = ( window_size * 4 ) / bands[0].decimation;
+  bands[0].max_freq = low_crossover;
+  bands[1].decimation = max_decimation( high_crossover, window_size );
+  bands[1].window_size = window_size / bands[1].decimation;
+  bands[1].max_freq = high_crossover;
+  bands[2].decimation = 1;
+  bands[2].window_size = std::max< size_t >( 1, window_size / 4 );
+  bands[2].max_freq = sample_rate / 2.0;
+  return bands;
+}
+
+double multi_resolution_crossover_weight( std::vector< MultiResolutionBand > const& bands, size_t band, double freq, double crossover_octaves ) {
+  // 1 well below `crossover`, 0 well above, cos^2 in between, so the share below and the share above always add up to 1
+  auto below = [&]( double crossover ) {
+    double const t = std::clamp( ( std::log2( freq / crossover ) / std::max( crossover_octaves, 1e-9 ) ) + 0.5, 0.0, 1.0 );
+    double const c = std::cos( 0.5 * std::numbers::pi * t );
+    return c * c;
+  };
+  double weight = 1.0;
+  if( band > 0 ) {
+    weight *= 1.0 - below( bands[band - 1].max_freq );
+  }
+  if( band + 1 < bands.size() ) {
+    weight *= below( bands[band].max_freq );
+  }
+  return weight;
+}
+
+MultiResolutionStft::MultiResolutionStft( std::vector< float > const& samples,
+                                          double sample_rate,
+                                          double hop,
+                                          std::vector< MultiResolutionBand > const& bands,
+                                          size_t batch_size,
+                                          double min_freq,
+                                          double max_freq,
+                                          uint32_t bin_amount,
+                                          double crossover_octaves )
+    : samples_( samples ), batch_size_( std::max< size_t >( 1, batch_size ) ) {
+  size_t column_amount = 0;
+  bands_.resize( bands.size() );
+  for( size_t b = 0; b < bands.size(); b++ ) {
+    BandState& state = bands_[b];
+    state.band = bands[b];
+    state.sample_rate = sample_rate / double( state.band.decimation );
+    state.layout = StftLayout::from_window( state.band.window_size, hop / double( state.band.decimation ) );
+    if( state.band.decimation > 1 ) {
+      double const passband_edge = DECIMATION_PASSBAND * 0.5 / double( state.band.decimation );
+      state.decimated_samples = samples;
+      for( DecimationStage const& stage : design_decimation_stages( state.band.decimation, passband_edge ) ) {
+        state.decimated_samples = decimate( state.decimated_samples, stage );
+      }
+    }
+
+    std::vector< double > window( state.layout.window_size );
+    nuttallwin_octave( window.data(), unsigned( window.size() ), false );
+    state.window.assign( state.layout.fft_size, 0.0f );
+    std::copy( window.begin(), window.end(), state.window.begin() );
+
+    state.fft_plan = FftwPlanRegistry::get_r2c_batch_plan( int( state.layout.fft_size ), int( batch_size_ ) );
+    state.column_offset = column_amount;
+    column_amount += state.layout.fft_size / 2;
+  }
+
+  // one log binning matrix per band, every row scaled by the share of the band in that bin and concatenated with the rows of the other bands
+  crossover_map_.row_amount = size_t( bin_amount ) + 1;
+  crossover_map_.column_amount = column_amount;
+  crossover_map_.row_offsets.assign( 1, 0 );
+  std::vector< SparseMatrix > band_binnings;
+  std::vector< double > band_gains;
+  for( BandState const& state : bands_ ) {
+    band_binnings.push_back( make_log_binning_matrix( state.layout.fft_size, state.sample_rate, min_freq, max_freq, bin_amount ) );
+    double window_sum = 0.0;
+    for( float w : state.window ) {
+      window_sum += w;
+    }
+    band_gains.push_back( 1.0 / window_sum );
+  }
+  double const bin_ratio = std::pow( max_freq / min_freq, 1.0 / double( bin_amount ) );
+  for( size_t bin = 0; bin < crossover_map_.row_amount; bin++ ) {
+    double const bin_freq = min_freq * std::pow( bin_ratio, double( bin ) + 0.5 );
+    for( size_t b = 0; b < bands_.size(); b++ ) {
+      double const weight = multi_resolution_crossover_weight( bands, b, bin_freq, crossover_octaves );
+      if( weight <= 0.0 ) {
+        continue;
+      }
+      SparseMatrix const& binning = band_binnings[b];
+      for( uint32_t e = binning.row_offsets[bin]; e < binning.row_offsets[bin + 1]; e++ ) {
+        crossover_map_.column_indices.push_back( uint32_t( bands_[b].column_offset + binning.column_indices[e] ) );
+        crossover_map_.weights.push_back( float( double( binning.weights[e] ) * weight * band_gains[b] ) );
+      }
+    }
+    crossover_map_.row_offsets.push_back( uint32_t( crossover_map_.column_indices.size() ) );
+  }
+}
+
+MultiResolutionStft::Workspace MultiResolutionStft::make_workspace() const {
+  Workspace workspace;
+  for( BandState const& state : bands_ ) {
+    workspace.signals.emplace_back( fftwf_alloc_real( state.layout.fft_size * batch_size_ ), fftwf_free );
+    workspace.spectra.emplace_back( fftwf_alloc_complex( ( state.layout.fft_size / 2 + 1 ) * batch_size_ ), fftwf_free );
+  }
+  workspace.magnitudes.resize( crossover_map_.column_amount * batch_size_ );
+  return workspace;
+}
+
+void MultiResolutionStft::compute_rows( Workspace& workspace, size_t frame_begin, size_t frame_amount, float* output, size_t output_stride ) const {
+  size_t const column_amount = crossover_map_.column_amount;
+  for( size_t batch_begin = frame_begin; batch_begin < frame_begin + frame_amount; batch_begin += batch_size_ ) {
+    size_t const batch_frame_amount = std::min( batch_size_, frame_begin + frame_amount - batch_begin );
+    for( size_t b = 0; b < bands_.size(); b++ ) {
+      BandState const& state = bands_[b];
+      size_t const fft_size = state.layout.fft_size;
+      size_t const fft_output_size = fft_size / 2 + 1;
+      std::vector< float > const& band_samples = ( state.band.decimation > 1 ) ? state.decimated_samples : samples_;
+      for( size_t f = 0; f < batch_size_; f++ ) {
+        float* signal = workspace.signals[b].get() + ( f * fft_size );
+        if( f >= batch_frame_amount ) {
+          std::fill( signal, signal + fft_size, 0.0f );
+          continue;
+        }
+        stft_window_frame( state.layout, batch_begin + f, band_samples.data(), band_samples.size(), state.window.data(), signal );
+      }
+
+      fftwf_execute_dft_r2c( state.fft_plan.get(), workspace.signals[b].get(), workspace.spectra[b].get() );
+
+      // the dc index of every frame is skipped
+      for( size_t f = 0; f < batch_frame_amount; f++ ) {
+        complex_magnitudes( workspace.spectra[b].get() + ( f * fft_output_size ) + 1,
+                            workspace.magnitudes.data() + ( f * column_amount ) + state.column_offset,
+                            fft_size / 2 );
+      }
+    }
+
+    sparse_multiply( crossover_map_,
+                     workspace.magnitudes.data(),
+                     column_amount,
+                     output + ( ( batch_begin - frame_begin ) * output_stride ),
+                     output_stride,
+                     batch_frame_amount );
+  }
+}
@@ -0,0 +1,125 @@
+#include "multirate.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <utility>
+
+#include "window_functions.h"
+
+DecimationStage design_decimation_stage( uint32_t factor, double passband_edge, double stopband_attenuation_db ) {
+  DecimationStage stage;
+  stage.factor = factor;
+  if( factor <= 1 ) {
+    stage.taps = { 1.0f };
+    return stage;
+  }
+
+  // everything above `1 / factor - passband_edge` would alias into the passband, the cutoff sits in the middle of the transition
+  double const cutoff = 0.5 / double( factor );
+  double const transition_width = std::max( ( 1.0 / double( factor ) ) - ( 2.0 * passband_edge ), 1e-3 );
+
+  // kaiser's estimates for the window length and beta
+  size_t tap_amount = size_t( std::ceil( ( stopband_attenuation_db - 8.0 ) / ( 2.285 * 2.0 * std::numbers::pi * transition_width ) ) ) + 1;
+  tap_amount |= 1;
+  double beta = 0.0;
+  if( stopband_attenuation_db > 50.0 ) {
+    beta = 0.1102 * ( stopband_attenuation_db - 8.7 );
+  } else if( stopband_attenuation_db >= 21.0 ) {
+    beta = ( 0.5842 * std::pow( stopband_attenuation_db - 21.0, 0.4 ) ) + ( 0.07886 * ( stopband_attenuation_db - 21.0 ) );
+  }
+
+  std::vector< double > window( tap_amount );
+  kaiser( window.data(), unsigned( tap_amount ), beta );
+
+  std::vector< double > taps( tap_amount );
+  double tap_sum = 0.0;
+  int64_t const half_length = int64_t( tap_amount / 2 );
+  for( int64_t k = -half_length; k <= half_length; k++ ) {
+    double const x = 2.0 * cutoff * double( k );
+    double const sinc = ( k == 0 ) ? 1.0 : ( std::sin( std::numbers::pi * x ) / ( std::numbers::pi * x ) );
+    taps[k + half_length] = 2.0 * cutoff * sinc * window[k + half_length];
+    tap_sum += taps[k + half_length];
+  }
+
+  // unity gain at dc
+  stage.taps.resize( tap_amount );
+  for( size_t i = 0; i < tap_amount; i++ ) {
+    stage.taps[i] = float( taps[i] / tap_sum );
+  }
+  return stage;
+}
+
+std::vector< DecimationStage > design_decimation_stages( uint32_t total_factor, double passband_edge, uint32_t max_stage_factor ) {
+  std::vector< DecimationStage > stages;
+  uint32_t done_factor = 1;
+  while( done_factor < total_factor ) {
+    uint32_t const stage_factor = std::min( max_stage_factor, total_factor / done_factor );
+    // relative to the input rate of this stage
+    stages.push_back( design_decimation_stage( stage_factor, passband_edge * double( done_factor ) ) );
+    done_factor *= stage_factor;
+  }
+  return stages;
+}
+
+std::vector< float > decimate( std::vector< float > const& input, DecimationStage const& stage ) {
+  size_t const output_size = ( input.size() + stage.factor - 1 ) / stage.factor;
+  int64_t const half_length = int64_t( stage.taps.size() / 2 );
+  int64_t const input_size = int64_t( input.size() );
+  std::vector< float > output( output_size );
+  for( size_t m = 0; m < output_size; m++ ) {
+    int64_t const center = int64_t( m * stage.factor );
+    int64_t const k_begin = std::max( -half_length, -center );
+    int64_t const k_end = std::min( half_length, input_size - 1 - center );
+    float const* taps = stage.taps.data() + half_length;
+    float const* samples = input.data() + center;
+    float sum = 0.0f;
+    for( int64_t k = k_begin; k <= k_end; k++ ) {
+      sum += taps[k] * samples[k];
+    }
+    output[m] = sum;
+  }
+  return output;
+}
+
+StreamingDecimator::StreamingDecimator( DecimationStage stage ) : stage_( std::move( stage ) ), half_length_( int64_t( stage_.taps.size() / 2 ) ) {}
+
+void StreamingDecimator::push( float const* input, size_t amount, std::vector< float >& output ) {
+  history_.insert( history_.end(), input, input + amount );
+  input_end_ += int64_t( amount );
+
+  // output `m` needs the input up to `m * factor + half_length`
+  int64_t const last_complete_center = input_end_ - 1 - half_length_;
+  if( last_complete_center >= 0 ) {
+    emit( size_t( last_complete_center / int64_t( stage_.factor ) ) + 1, output );
+  }
+}
+
+void StreamingDecimator::finish( std::vector< float >& output ) {
+  emit( size_t( ( input_end_ + int64_t( stage_.factor ) - 1 ) / int64_t( stage_.factor ) ), output );
+}
+
+void StreamingDecimator::emit( size_t output_end, std::vector< float >& output ) {
+  // same loop as `decimate`, the stream so far stands in for the whole input, so the sums are bit identical
+  float const* taps = stage_.taps.data() + half_length_;
+  for( size_t m = next_output_; m < output_end; m++ ) {
+    int64_t const center = int64_t( m * stage_.factor );
+    int64_t const k_begin = std::max( -half_length_, -center );
+    int64_t const k_end = std::min( half_length_, input_end_ - 1 - center );
+    float const* samples = history_.data() + ( center - history_begin_ );
+    float sum = 0.0f;
+    for( int64_t k = k_begin; k <= k_end; k++ ) {
+      sum += taps[k] * samples[k];
+    }
+    output.push_back( sum );
+  }
+  next_output_ = std::max( next_output_, output_end );
+
+  // drop what no later output reaches, in large steps so the erase stays amortized O(1) per sample
+  int64_t const keep_begin = std::max< int64_t >( 0, ( int64_t( next_output_ ) * int64_t( stage_.factor ) ) - half_length_ );
+  size_t const drop_amount = size_t( std::min< int64_t >( keep_begin - history_begin_, int64_t( history_.size() ) ) );
+  if( ( drop_amount > 0 ) && ( 2 * drop_amount >= history_.size() ) ) {
+    history_.erase( history_.begin(), history_.begin() + drop_amount );
+    history_begin_ += int64_t( drop_amount );
+  }
+}
@@ -0,0 +1,221 @@
+#include "onsetDetector.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "spectralKernels.h"
+
+// the beat phase weighs every period back by this much less, so a drifting tempo follows its newest beats
+static double const PHASE_HISTORY_DECAY = 0.9;
+
+OnsetDetector::OnsetDetector( OnsetDetection const& detection, size_t bin_amount )
+    : detection_( detection ), bin_amount_( bin_amount ), previous_mag_db_( bin_amount ), floored_mag_db_( bin_amount ) {
+  double const fps = detection_.frames_per_second;
+  peak_frames_ = std::max< size_t >( 1, size_t( std::lround( detection_.peak_seconds * fps ) ) );
+  threshold_frames_ = std::max< size_t >( 1, size_t( std::lround( detection_.threshold_seconds * fps ) ) );
+  // the neighbours of the longest lag are needed for its interpolation
+  min_lag_ = std::max< size_t >( 2, size_t( std::floor( 60.0 * fps / detection_.max_bpm ) ) );
+  max_lag_ = std::max( min_lag_, size_t( std::ceil( 60.0 * fps / detection_.min_bpm ) ) );
+  tempo_window_frames_ = std::max( 2 * ( max_lag_ + 1 ), size_t( std::lround( detection_.tempo_window_seconds * fps ) ) );
+  release_ = std::exp( -1.0 / std::max( detection_.release_seconds * fps, 1e-9 ) );
+
+  tempo_prior_.resize( max_lag_ + 2 );
+  for( size_t lag = 1; lag < tempo_prior_.size(); lag++ ) {
+    double const octaves = std::log2( ( 60.0 * fps / double( lag ) ) / detection_.prior_bpm ) / detection_.prior_octaves;
+    tempo_prior_[lag] = float( std::exp( -0.5 * octaves * octaves ) );
+  }
+  autocorrelation_.resize( max_lag_ + 2 );
+}
+
+void OnsetDetector::push( float const* mag_db ) {
+  if( is_finished_ ) {
+    return;
+  }
+
+  // everything below the floor of the frame is the same to the flux
+  float const floor_mag_db = ( bin_amount_ > 0 ) ? *std::max_element( mag_db, mag_db + bin_amount_ ) - float( detection_.mag_db_range ) : 0.0f;
+  for( size_t bin = 0; bin < bin_amount_; bin++ ) {
+    floored_mag_db_[bin] = std::max( mag_db[bin], floor_mag_db );
+  }
+  float frame_flux = 0.0f;
+  if( ( pushed_amount_ > 0 ) && ( bin_amount_ > 0 ) ) {
+    frame_flux = rectified_flux( floored_mag_db_.data(), previous_mag_db_.data(), bin_amount_ ) / float( bin_amount_ );
+  }
+  std::swap( floored_mag_db_, previous_mag_db_ );
+
+  flux_.push_back( frame_flux );
+  novelty_.push_back( 0.0f );
+  pushed_amount_++;
+  while( novelty_amount_ + peak_frames_ < pushed_amount_ ) {
+    compute_novelty( novelty_amount_++ );
+  }
+}
+
+void OnsetDetector::finish() {
+  is_finished_ = true;
+  while( novelty_amount_ < pushed_amount_ ) {
+    compute_novelty( novelty_amount_++ );
+  }
+}
+
+bool OnsetDetector::has_next() const {
+  if( next_frame_ >= novelty_amount_ ) {
+    return false;
+  }
+  return is_finished_ || ( novelty_amount_ > next_frame_ + peak_frames_ );
+}
+
+std::optional< OnsetFrame > OnsetDetector::next() {
+  if( !has_next() ) {
+    return std::nullopt;
+  }
+
+  uint64_t const frame = next_frame_;
+  uint64_t const newest_frame = novelty_amount_ - 1;
+  uint64_t const window_begin = std::max( history_begin_, ( newest_frame + 1 > tempo_window_frames_ ) ? newest_frame + 1 - tempo_window_frames_ : 0 );
+  OnsetFrame onset_frame;
+
+  // strongest novelty of the tempo window, the strengths are relative to it
+  float max_novelty = 0.0f;
+  for( uint64_t f = window_begin; f <= newest_frame; f++ ) {
+    max_novelty = std::max( max_novelty, novelty( f ) );
+  }
+  double const strength = ( max_novelty > 0.0f ) ? double( novelty( frame ) / max_novelty ) : 0.0;
+
+  // a peak of the novelty, the first of equal ones, and not too close to the last onset
+  bool is_peak = ( novelty( frame ) > 0.0f ) && ( strength >= detection_.min_onset_strength );
+  uint64_t const peak_begin = std::max( history_begin_, ( frame > peak_frames_ ) ? frame - peak_frames_ : 0 );
+  uint64_t const peak_end = std::min( newest_frame, frame + peak_frames_ );
+  for( uint64_t f = peak_begin; is_peak && ( f <= peak_end ); f++ ) {
+    is_peak = ( f < frame ) ? ( novelty( frame ) > novelty( f ) ) : ( novelty( frame ) >= novelty( f ) );
+  }
+  onset_frame.is_onset = is_peak && ( !last_onset_ || ( frame - *last_onset_ > peak_frames_ ) );
+  if( onset_frame.is_onset ) {
+    last_onset_ = frame;
+  }
+
+  track_tempo( newest_frame );
+  track_phase( newest_frame );
+  if( period_ > 0.0 ) {
+    // the newest point of the grid that is not after this frame, it is a beat the first time a frame reaches it
+    double const grid_steps = std::ceil( ( beat_anchor_ - double( frame ) - 0.5 ) / period_ );
+    double const grid_point = beat_anchor_ - ( grid_steps * period_ );
+    onset_frame.is_beat = ( grid_point > double( frame ) - ( 0.5 * period_ ) ) && ( !last_beat_ || ( grid_point - *last_beat_ > 0.5 * period_ ) );
+    if( onset_frame.is_beat ) {
+      last_beat_ = grid_point;
+    }
+    onset_frame.bpm = 60.0 * detection_.frames_per_second / period_;
+  }
+
+  // instant attack, exponential release
+  onset_strength_ = std::max( strength, onset_strength_ * release_ );
+  beat_strength_ = onset_frame.is_beat ? std::max( confidence_, beat_strength_ * release_ ) : beat_strength_ * release_;
+  onset_frame.onset_strength = onset_strength_;
+  onset_frame.beat_strength = beat_strength_;
+
+  next_frame_++;
+  trim_history();
+  return onset_frame;
+}
+
+void OnsetDetector::compute_novelty( uint64_t frame ) {
+  uint64_t const threshold_begin = std::max( history_begin_, ( frame > threshold_frames_ ) ? frame - threshold_frames_ : 0 );
+  uint64_t const threshold_end = std::min( pushed_amount_ - 1, frame + peak_frames_ );
+  double flux_sum = 0.0;
+  for( uint64_t f = threshold_begin; f <= threshold_end; f++ ) {
+    flux_sum += double( flux( f ) );
+  }
+  double const threshold = ( flux_sum / double( threshold_end - threshold_begin + 1 ) ) + detection_.threshold_db;
+  novelty_[frame - history_begin_] = float( std::max( double( flux( frame ) ) - threshold, 0.0 ) );
+}
+
+void OnsetDetector::track_tempo( uint64_t newest_frame ) {
+  period_ = 0.0;
+  confidence_ = 0.0;
+  uint64_t const window_begin = std::max( history_begin_, ( newest_frame + 1 > tempo_window_frames_ ) ? newest_frame + 1 - tempo_window_frames_ : 0 );
+  size_t const window_amount = size_t( newest_frame + 1 - window_begin );
+  // every lag needs at least two of its periods in the window
+  if( window_amount < 2 * ( min_lag_ + 1 ) ) {
+    return;
+  }
+  size_t const lag_end = std::min( max_lag_, ( window_amount / 2 ) - 1 );
+
+  // unbiased autocorrelation, one vectorized dot product per lag
+  float const* values = novelty_.data() + ( window_begin - history_begin_ );
+  double const energy = double( dot_product( values, values, window_amount ) ) / double( window_amount );
+  if( energy <= 0.0 ) {
+    return;
+  }
+  for( size_t lag = min_lag_ - 1; lag <= lag_end + 1; lag++ ) {
+    autocorrelation_[lag] = dot_product( values + lag, values, window_amount - lag ) / float( window_amount - lag ) * tempo_prior_[lag];
+  }
+  size_t best_lag = min_lag_;
+  for( size_t lag = min_lag_ + 1; lag <= lag_end; lag++ ) {
+    if( autocorrelation_[lag] > autocorrelation_[best_lag] ) {
+      best_lag = lag;
+    }
+  }
+  if( autocorrelation_[best_lag] <= 0.0f ) {
+    return;
+  }
+
+  // parabola through the best lag and its neighbours for the fractional period
+  double const before = autocorrelation_[best_lag - 1];
+  double const at = autocorrelation_[best_lag];
+  double const after = autocorrelation_[best_lag + 1];
+  double const curvature = before - ( 2.0 * at ) + after;
+  double const offset = ( curvature < 0.0 ) ? std::clamp( 0.5 * ( before - after ) / curvature, -0.5, 0.5 ) : 0.0;
+  period_ = double( best_lag ) + offset;
+  confidence_ = std::clamp( at / double( tempo_prior_[best_lag] ) / energy, 0.0, 1.0 );
+}
+
+void OnsetDetector::track_phase( uint64_t newest_frame ) {
+  if( period_ <= 0.0 ) {
+    return;
+  }
+  uint64_t const window_begin = std::max( history_begin_, ( newest_frame + 1 > tempo_window_frames_ ) ? newest_frame + 1 - tempo_window_frames_ : 0 );
+  // novelty spread over its neighbours, so a grid point a frame off still counts
+  auto smoothed_novelty = [&]( int64_t frame ) {
+    int64_t const first = int64_t( window_begin );
+    int64_t const last = int64_t( newest_frame );
+    float const center = novelty( uint64_t( frame ) );
+    float const left = ( frame > first ) ? novelty( uint64_t( frame - 1 ) ) : center;
+    float const right = ( frame < last ) ? novelty( uint64_t( frame + 1 ) ) : center;
+    return ( 0.25 * double( left ) ) + ( 0.5 * double( center ) ) + ( 0.25 * double( right ) );
+  };
+
+  // every grid has one point in the newest period, the one whose points collect the most novelty is the beat
+  int64_t const anchor_begin = std::max( int64_t( window_begin ), int64_t( newest_frame ) - int64_t( std::ceil( period_ ) ) + 1 );
+  double best_score = 0.0;
+  std::optional< int64_t > best_anchor;
+  for( int64_t anchor = anchor_begin; anchor <= int64_t( newest_frame ); anchor++ ) {
+    double score = 0.0;
+    double weight = 1.0;
+    for( double point = double( anchor ); point >= double( window_begin ); point -= period_ ) {
+      score += weight * smoothed_novelty( std::max( int64_t( window_begin ), int64_t( std::lround( point ) ) ) );
+      weight *= PHASE_HISTORY_DECAY;
+    }
+    if( score > best_score ) {
+      best_score = score;
+      best_anchor = anchor;
+    }
+  }
+  if( !best_anchor ) {
+    period_ = 0.0;
+    return;
+  }
+  beat_anchor_ = double( *best_anchor );
+}
+
+void OnsetDetector::trim_history() {
+  // the flux the next thresholds need and the novelty of the next tempo windows and peaks
+  size_t const keep_frames = tempo_window_frames_ + threshold_frames_ + peak_frames_;
+  uint64_t const keep_begin = ( next_frame_ > keep_frames ) ? next_frame_ - keep_frames : 0;
+  // in steps of a whole window, so the erase is amortized
+  if( keep_begin >= history_begin_ + tempo_window_frames_ ) {
+    size_t const erase_amount = size_t( keep_begin - history_begin_ );
+    flux_.erase( flux_.begin(), flux_.begin() + erase_amount );
+    novelty_.erase( novelty_.begin(), novelty_.begin() + erase_amount );
+    history_begin_ = keep_begin;
+  }
+}
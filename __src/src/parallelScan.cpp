@@ -0,0 +1,120 @@
+#include "parallelScan.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+#include <vector>
+
+template < typename T >
+void scan_block( T* table, size_t row_begin, size_t row_end, size_t column_amount, size_t row_stride, T alpha, bool is_first_block ) {
+  T const decay = T( 1 ) - alpha;
+  size_t row = row_begin;
+  if( is_first_block ) {
+    // `y[0] = x[0]`, the first row stays unsmoothed
+    row++;
+  } else {
+    // zero carry into the block
+    T* row_ptr = table + ( row * row_stride );
+    for( size_t c = 0; c < column_amount; c++ ) {
+      row_ptr[c] = alpha * row_ptr[c];
+    }
+    row++;
+  }
+  for( ; row < row_end; row++ ) {
+    T const* prev_row_ptr = table + ( ( row - 1 ) * row_stride );
+    T* row_ptr = table + ( row * row_stride );
+    for( size_t c = 0; c < column_amount; c++ ) {
+      row_ptr[c] = ( alpha * row_ptr[c] ) + ( decay * prev_row_ptr[c] );
+    }
+  }
+}
+
+template < typename T >
+void fix_up_block( T* table, size_t row_begin, size_t row_end, size_t column_amount, size_t row_stride, double decay, T const* carry ) {
+  // the carry is the full result of the row before the block, it reaches row `k` of the block with `decay^( k + 1 )`
+  double carry_scale = decay;
+  for( size_t row = row_begin; row < row_end; row++ ) {
+    T const scale = T( carry_scale );
+    T* row_ptr = table + ( row * row_stride );
+    for( size_t c = 0; c < column_amount; c++ ) {
+      row_ptr[c] += scale * carry[c];
+    }
+    carry_scale *= decay;
+  }
+}
+
+template < typename T >
+void exponential_smoothing_scan_impl( T* table, size_t row_amount, size_t column_amount, size_t row_stride, double alpha, uint32_t thread_count ) {
+  if( ( row_amount == 0 ) || ( column_amount == 0 ) ) {
+    return;
+  }
+  if( thread_count == 0 ) {
+    thread_count = std::max< uint32_t >( 1, std::thread::hardware_concurrency() );
+  }
+  // every block should at least have a couple of rows, otherwise the fix-up costs more than it saves
+  size_t const min_rows_per_block = 16;
+  size_t const block_amount = std::clamp< size_t >( row_amount / min_rows_per_block, 1, thread_count );
+  if( block_amount == 1 ) {
+    scan_block< T >( table, 0, row_amount, column_amount, row_stride, T( alpha ), true );
+    return;
+  }
+
+  std::vector< size_t > block_begin( block_amount + 1 );
+  for( size_t b = 0; b <= block_amount; b++ ) {
+    block_begin[b] = ( row_amount * b ) / block_amount;
+  }
+
+  // phase 1: local scans from a zero carry
+  {
+    std::vector< std::thread > threads;
+    threads.reserve( block_amount );
+    for( size_t b = 0; b < block_amount; b++ ) {
+      threads.emplace_back( scan_block< T >, table, block_begin[b], block_begin[b + 1], column_amount, row_stride, T( alpha ), b == 0 );
+    }
+    for( auto& thread : threads ) {
+      thread.join();
+    }
+  }
+
+  // phase 2: propagate the carries serially, the carry of block `b` is the full result of its last row
+  double const decay = 1.0 - alpha;
+  std::vector< T > carries( ( block_amount - 1 ) * column_amount );
+  std::copy_n( table + ( ( block_begin[1] - 1 ) * row_stride ), column_amount, carries.data() );
+  for( size_t b = 1; b < block_amount - 1; b++ ) {
+    size_t const block_length = block_begin[b + 1] - block_begin[b];
+    T const carry_scale = T( std::pow( decay, double( block_length ) ) );
+    T const* prev_carry = carries.data() + ( ( b - 1 ) * column_amount );
+    T const* local_last_row = table + ( ( block_begin[b + 1] - 1 ) * row_stride );
+    T* carry = carries.data() + ( b * column_amount );
+    for( size_t c = 0; c < column_amount; c++ ) {
+      carry[c] = local_last_row[c] + ( carry_scale * prev_carry[c] );
+    }
+  }
+
+  // phase 3: fix up every block but the first with the carry of the block before it
+  {
+    std::vector< std::thread > threads;
+    threads.reserve( block_amount - 1 );
+    for( size_t b = 1; b < block_amount; b++ ) {
+      threads.emplace_back( fix_up_block< T >,
+                            table,
+                            block_begin[b],
+                            block_begin[b + 1],
+                            column_amount,
+                            row_stride,
+                            decay,
+                            carries.data() + ( ( b - 1 ) * column_amount ) );
+    }
+    for( auto& thread : threads ) {
+      thread.join();
+    }
+  }
+}
+
+void exponential_smoothing_scan( float* table, size_t row_amount, size_t column_amount, size_t row_stride, double alpha, uint32_t thread_count ) {
+  exponential_smoothing_scan_impl< float >( table, row_amount, column_amount, row_stride, alpha, thread_count );
+}
+
+void exponential_smoothing_scan( double* table, size_t row_amount, size_t column_amount, size_t row_stride, double alpha, uint32_t thread_count ) {
+  exponential_smoothing_scan_impl< double >( table, row_amount, column_amount, row_stride, alpha, thread_count );
+}
@@ -1,14 +1,32 @@
 #include "regularVideoGenerator.h"
 
 #include <Iir.h>
+#include <algorithm>
 #include <cmath>
+#include <functional>
+#include <limits>
 #include <memory>
+#include <thread>
 
 #include "_dr_wav.h"
 #include "_fftw.h"
+#include "analysisCache.h"
+#include "audioStream.h"
+#include "biquadCascade.h"
 #include "cairo.h"
+#include "constantQ.h"
+#include "downmix.h"
+#include "fftwPlanRegistry.h"
 #include "fontManager.h"
+#include "logBinning.h"
 #include "loggerFactory.h"
+#include "mappedWavFile.h"
+#include "multiResolutionStft.h"
+#include "multirate.h"
+#include "onsetDetector.h"
+#include "parallelScan.h"
+#include "spectralKernels.h"
+#include "stft.h"
 #include "surface.h"
 #include "utils.h"
 #include "window_functions.h"
@@ -22,12 +40,12 @@ int32_t const RegularVideoGenerator::VIDEO_HEIGHT = 1080;
 int32_t const RegularVideoGenerator::IIR_FILTER_ORDER = 16;
 double const RegularVideoGenerator::BASS_LP_CUTOFF = 80.0;
 double const RegularVideoGenerator::BASS_HP_CUTOFF = 20.0;
+// the bass path is decimated by powers of two as long as the rate stays above this
+double const RegularVideoGenerator::BASS_MIN_SAMPLE_RATE = 8.0 * RegularVideoGenerator::BASS_LP_CUTOFF;
 // amount of pcm samples played per frame * this = amount of pcm samples shown per frame
 double const RegularVideoGenerator::PCM_FRAME_COUNT_MULT = RegularVideoGenerator::FPS / 10.0;
 double const RegularVideoGenerator::EPILEPSY_WARNING_VISIBLE_SECONDS = 3.0;
 double const RegularVideoGenerator::EPILEPSY_WARNING_FADEOUT_SECONDS = 2.0;
-// uint32_t const RegularVideoGenerator::FFTW_PLAN_FLAGS = FFTW_EXHAUSTIVE;
-uint32_t const RegularVideoGenerator::FFTW_PLAN_FLAGS = FFTW_ESTIMATE;
 std::string const RegularVideoGenerator::EPILEPSY_WARNING_HEADER_FONT = "BarberChop.otf";
 std::string const RegularVideoGenerator::EPILEPSY_WARNING_CONTENT_FONT = "arial_narrow_7.ttf";
 // 0.0 = max smooth, 1.0 = no smooth
@@ -35,10 +53,29 @@ double const RegularVideoGenerator::FFT_COMPUTE_ALPHA = 0.7;
 double const RegularVideoGenerator::FFT_DISPLAY_MIN_FREQ = 20.0;
 double const RegularVideoGenerator::FFT_DISPLAY_MAG_DB_RANGE = 60.0;
 uint32_t const RegularVideoGenerator::FFT_DISPLAY_BIN_AMOUNT = 917;
+// frames per fftw call, large batches of large transforms fall out of cache (see test/fft_batch.cpp)
+uint32_t const RegularVideoGenerator::FFT_BATCH_SIZE = 4;
+RegularVideoGenerator::FftDisplaySource const RegularVideoGenerator::FFT_DISPLAY_SOURCE = RegularVideoGenerator::FftDisplaySource::CONSTANT_Q;
+uint32_t const RegularVideoGenerator::FFT_DISPLAY_FILTERBANK_BAND_AMOUNT = 128;
+FilterbankNormalization const RegularVideoGenerator::FFT_DISPLAY_FILTERBANK_NORMALIZATION = FilterbankNormalization::SLANEY;
+double const RegularVideoGenerator::FFT_MULTI_RESOLUTION_LOW_CROSSOVER = 250.0;
+double const RegularVideoGenerator::FFT_MULTI_RESOLUTION_HIGH_CROSSOVER = 3000.0;
+double const RegularVideoGenerator::FFT_MULTI_RESOLUTION_CROSSOVER_OCTAVES = 1.0 / 3.0;
+// reuse the analysis of an earlier render of the same audio with the same constants
+bool const RegularVideoGenerator::ANALYSIS_CACHE_ENABLED = true;
+// tracks whose samples and whole-file analysis would need more than this are analyzed and rendered in segments from a chunked decode
+size_t const RegularVideoGenerator::STREAMING_MEMORY_BUDGET = size_t( 512 ) << 20;
+size_t const RegularVideoGenerator::STREAMING_CHUNK_FRAMES = 65536;
+// how far the decode thread may run ahead of the analysis
+size_t const RegularVideoGenerator::STREAMING_DECODE_AHEAD_FRAMES = 4 * RegularVideoGenerator::STREAMING_CHUNK_FRAMES;
+// GLOBAL clamps every frame to the loudest of the whole track, STREAMING follows the loudness over the next FFT_MAG_DB_LOOKAHEAD_SECONDS
+MagDbNormalizationMode const RegularVideoGenerator::FFT_MAG_DB_NORMALIZATION_MODE = MagDbNormalizationMode::GLOBAL;
+double const RegularVideoGenerator::FFT_MAG_DB_LOOKAHEAD_SECONDS = 2.0;
+double const RegularVideoGenerator::FFT_MAG_DB_RELEASE_DB_PER_SECOND = 6.0;
+// share of the bass shake that is gated by the beats and onsets, 0.0 = bass only, 1.0 = none of the bass between the beats
+double const RegularVideoGenerator::SHAKE_BEAT_WEIGHT = 0.5;
 
 double RegularVideoGenerator::FFT_DISPLAY_MAX_FREQ = 22050.0;
-double RegularVideoGenerator::FFT_DISPLAY_MAX_MAG_DB = -std::numeric_limits< float >::max();
-double RegularVideoGenerator::FFT_DISPLAY_MIN_MAG_DB = std::numeric_limits< float >::max();
 
 spdlogger RegularVideoGenerator::logger_ = nullptr;
 bool RegularVideoGenerator::is_ready_ = false;
@@ -51,8 +88,33 @@ std::filesystem::path RegularVideoGenerator::project_art_path_;
 std::filesystem::path RegularVideoGenerator::project_audio_path_;
 std::filesystem::path RegularVideoGenerator::project_title_path_;
 std::filesystem::path RegularVideoGenerator::project_temp_pictureset_path_;
+std::filesystem::path RegularVideoGenerator::project_analysis_cache_path_;
 std::shared_ptr< RegularVideoGenerator::AudioData > RegularVideoGenerator::audio_data_ = nullptr;
 std::shared_ptr< RegularVideoGenerator::FrameInformation > RegularVideoGenerator::frame_information_ = nullptr;
+std::optional< uint64_t > RegularVideoGenerator::analysis_cache_key_ = std::nullopt;
+
+// everything of the analysis that is not a table, one entry of the summary section
+struct RegularAnalysisCacheSummary {
+  uint32_t channels;
+  uint32_t sample_rate;
+  uint64_t total_pcm_frame_count;
+  uint64_t amount_output_frames;
+  double pcm_frames_per_output_frame;
+  double fft_display_max_freq;
+  uint64_t display_bin_amount;
+  uint64_t display_row_stride;
+};
+
+// bump when the analysis code changes in a way the constants do not show, so older caches miss
+static uint32_t const ANALYSIS_CACHE_REVISION = 4;
+static uint32_t const ANALYSIS_CACHE_SUMMARY_TAG = analysis_cache_tag( "SUMM" );
+static uint32_t const ANALYSIS_CACHE_SOUND_INTENSITY_TAG = analysis_cache_tag( "RMS " );
+static uint32_t const ANALYSIS_CACHE_BASS_INTENSITY_TAG = analysis_cache_tag( "BASS" );
+static uint32_t const ANALYSIS_CACHE_ONSET_STRENGTH_TAG = analysis_cache_tag( "ONST" );
+static uint32_t const ANALYSIS_CACHE_BEAT_STRENGTH_TAG = analysis_cache_tag( "BEAT" );
+static uint32_t const ANALYSIS_CACHE_DISPLAY_VALUES_TAG = analysis_cache_tag( "DISP" );
+static uint32_t const ANALYSIS_CACHE_DISPLAY_X_AXIS_TAG = analysis_cache_tag( "DISX" );
+static uint32_t const ANALYSIS_CACHE_DISPLAY_RANGE_TAG = analysis_cache_tag( "DRNG" );
 
 void RegularVideoGenerator::init( std::filesystem::path const& project_path, std::filesystem::path const& common_path ) {
   logger_ = LoggerFactory::get_logger( "RegularVideoGenerator" );
@@ -67,7 +129,7 @@ void RegularVideoGenerator::init( std::filesystem::path const& project_path, std
   common_bg_path_ = common_path_ / "bg.old.png";
   common_circle_path_ = common_path_ / "circle.png";
   project_art_path_ = project_path_ / "art.png";
-  project_audio_path_ = project_path_ / "audio.wav";
+  project_audio_path_ = find_audio_file( project_path_, "audio" );
   project_title_path_ = project_path_ / "title.txt";
 
   for( auto const& file : std::vector< std::filesystem::path >(
@@ -86,6 +148,9 @@ void RegularVideoGenerator::init( std::filesystem::path const& project_path, std
   logger_->trace( "[init] creating directory {:?}", project_temp_pictureset_path_.string() );
   std::filesystem::create_directory( project_temp_pictureset_path_ );
 
+  // kept between renders, a stale one is never read because its key does not match
+  project_analysis_cache_path_ = project_path_ / "__analysis.regular.cache";
+
   is_ready_ = ready_val;
   logger_->trace( "[init] exit" );
 }
@@ -104,15 +169,43 @@ void RegularVideoGenerator::render() {
     return;
   }
 
-  prepare_audio();
+  // long tracks render in segments, from the analysis cache if it is there
+  analysis_cache_key_ = get_analysis_cache_key();
+  AnalysisCacheReader cache_reader;
+  bool const is_cached = open_analysis_cache( cache_reader );
+  if( should_stream_audio( is_cached ) ) {
+    if( is_cached ) {
+      render_streaming_from_cache( cache_reader );
+    } else {
+      render_streaming();
+    }
 
-  calculate_frames();
+    clean_up();
 
-  prepare_surfaces();
+    logger_->trace( "[render] exit" );
+    return;
+  }
+
+  read_audio();
+
+  if( is_cached ) {
+    read_analysis_cache_frames( cache_reader, 0, frame_information_->amount_output_frames );
+    // the render threads draw the samples `read_audio` just read, not the ones the cache described
+    frame_information_->render_context->audio_data = audio_data_;
+    logger_->info( "[render] analysis loaded from {:?}", project_analysis_cache_path_.string() );
+  } else {
+    prepare_audio();
+
+    calculate_frames();
 
-  prepare_fft();
+    prepare_fft();
 
-  prepare_threads();
+    save_analysis_cache();
+  }
+
+  prepare_surfaces();
+
+  prepare_threads( 0, frame_information_->amount_output_frames );
 
   start_threads();
 
@@ -123,30 +216,53 @@ void RegularVideoGenerator::render() {
   logger_->trace( "[render] exit" );
 }
 
-void RegularVideoGenerator::prepare_audio() {
-  logger_->trace( "[prepare_audio] enter" );
+void RegularVideoGenerator::read_audio() {
+  logger_->trace( "[read_audio] enter" );
 
   if( !is_ready_ ) {
-    logger_->error( "[prepare_audio] generator is not ready!" );
+    logger_->error( "[read_audio] generator is not ready!" );
     return;
   }
 
   audio_data_ = std::make_shared< RegularVideoGenerator::AudioData >();
 
-  audio_data_->sample_data = std::shared_ptr< float[] >( drwav_open_file_and_read_pcm_frames_f32( project_audio_path_.string().c_str(),
-                                                                                                  &audio_data_->channels,
-                                                                                                  &audio_data_->sample_rate,
-                                                                                                  &audio_data_->total_pcm_frame_count,
-                                                                                                  nullptr ),
-                                                         []( float* p ) { drwav_free( p, nullptr ); } );
-  logger_->debug( "[prepare_audio] audio_data_->channels: {}", audio_data_->channels );
-  logger_->debug( "[prepare_audio] audio_data_->sample_rate: {}", audio_data_->sample_rate );
-  logger_->debug( "[prepare_audio] audio_data_->total_pcm_frame_count: {}", audio_data_->total_pcm_frame_count );
+  // 16 bit and float wavs are not decoded at all, the analysis reads them from the mapping
+  PcmSamples pcm_samples;
+  if( !load_pcm_samples( project_audio_path_, pcm_samples ) ) {
+    logger_->error( "[read_audio] can not read {:?}", project_audio_path_.string() );
+  }
+  audio_data_->sample_data = pcm_samples.view;
+  audio_data_->sample_data_owner = std::move( pcm_samples.owner );
+  audio_data_->channels = pcm_samples.view.channels;
+  audio_data_->sample_rate = pcm_samples.sample_rate;
+  audio_data_->total_pcm_frame_count = pcm_samples.view.frame_amount;
+  logger_->debug( "[read_audio] audio_data_->channels: {}", audio_data_->channels );
+  logger_->debug( "[read_audio] audio_data_->sample_rate: {}", audio_data_->sample_rate );
+  logger_->debug( "[read_audio] audio_data_->total_pcm_frame_count: {}", audio_data_->total_pcm_frame_count );
   audio_data_->duration = double( audio_data_->total_pcm_frame_count ) / double( audio_data_->sample_rate );
-  logger_->debug( "[prepare_audio] audio_data_->duration: {}", audio_data_->duration );
+  logger_->debug( "[read_audio] audio_data_->duration: {}", audio_data_->duration );
+
+  logger_->trace( "[read_audio] exit" );
+}
+
+void RegularVideoGenerator::prepare_audio() {
+  logger_->trace( "[prepare_audio] enter" );
+
+  if( !is_ready_ ) {
+    logger_->error( "[prepare_audio] generator is not ready!" );
+    return;
+  }
+
+  // downmixed once, every analysis window reads it directly
+  audio_data_->mono_sample_data.resize( audio_data_->total_pcm_frame_count );
+  downmix_to_mono( audio_data_->sample_data, audio_data_->mono_sample_data.data() );
 
   create_lowpass_for_audio_data();
 
+  // any window rms is O(1) from these
+  audio_data_->sample_square_prefix_sum = square_prefix_sum( audio_data_->sample_data );
+  audio_data_->bass_sample_square_prefix_sum = square_prefix_sum( audio_data_->bass_sample_data.data(), audio_data_->bass_sample_data.size(), 1 );
+
   logger_->trace( "[prepare_audio] exit" );
 }
 
@@ -158,12 +274,30 @@ void RegularVideoGenerator::calculate_frames() {
     return;
   }
 
-  frame_information_ = std::make_shared< RegularVideoGenerator::FrameInformation >();
+  create_frame_information();
 
-  frame_information_->amount_output_frames = size_t( std::ceil( audio_data_->duration * FPS ) );
-  logger_->debug( "[calculate_frames] frame_information_->amount_output_frames: {}", frame_information_->amount_output_frames );
-  frame_information_->pcm_frames_per_output_frame = double( audio_data_->total_pcm_frame_count ) / double( frame_information_->amount_output_frames );
-  logger_->debug( "[calculate_frames] frame_information_->pcm_frames_per_output_frame: {}", frame_information_->pcm_frames_per_output_frame );
+  uint64_t const pcm_frame_count = uint64_t( double( frame_information_->pcm_frames_per_output_frame ) * PCM_FRAME_COUNT_MULT );
+  int64_t const bass_decimation_factor = audio_data_->bass_decimation_factor;
+  frame_information_->render_context->sound_intensity_per_frame.resize( frame_information_->amount_output_frames );
+  frame_information_->render_context->bass_intensity_per_frame.resize( frame_information_->amount_output_frames );
+  double pcm_frame_offset_dbl = 0.0;
+  for( size_t i = 0; i < frame_information_->amount_output_frames; i++ ) {
+    // played sample will be in the middle of the shown samples
+    int64_t pcm_frame_offset = std::min< int64_t >( audio_data_->total_pcm_frame_count, int64_t( pcm_frame_offset_dbl ) - int64_t( pcm_frame_count / 2 ) );
+
+    double const rms_sum_value = prefix_sum_range( audio_data_->sample_square_prefix_sum, pcm_frame_offset, pcm_frame_offset + int64_t( pcm_frame_count ) );
+    frame_information_->render_context->sound_intensity_per_frame[i]
+        = std::sqrt( rms_sum_value / ( double( audio_data_->channels ) * double( pcm_frame_count ) ) );
+
+    // the bass is at the decimated rate, only the samples belonging to pcm frames in the window count
+    int64_t const bass_window_begin = ( pcm_frame_offset + ( pcm_frame_offset > 0 ? bass_decimation_factor - 1 : 0 ) ) / bass_decimation_factor;
+    int64_t const bass_window_end = ( pcm_frame_offset + int64_t( pcm_frame_count ) + bass_decimation_factor - 1 ) / bass_decimation_factor;
+    double const bass_rms_sum_value = prefix_sum_range( audio_data_->bass_sample_square_prefix_sum, bass_window_begin, bass_window_end );
+    frame_information_->render_context->bass_intensity_per_frame[i]
+        = std::sqrt( bass_rms_sum_value / double( std::max< int64_t >( bass_window_end - bass_window_begin, 1 ) ) );
+
+    pcm_frame_offset_dbl += frame_information_->pcm_frames_per_output_frame;
+  }
 
   // frame_information_->fft_size = 1;
   // while( frame_information_->fft_size < frame_information_->pcm_frames_per_output_frame ) {
@@ -178,6 +312,22 @@ void RegularVideoGenerator::calculate_frames() {
   logger_->trace( "[calculate_frames] exit" );
 }
 
+void RegularVideoGenerator::create_frame_information() {
+  frame_information_ = std::make_shared< RegularVideoGenerator::FrameInformation >();
+
+  frame_information_->amount_output_frames = size_t( std::ceil( audio_data_->duration * FPS ) );
+  logger_->debug( "[create_frame_information] frame_information_->amount_output_frames: {}", frame_information_->amount_output_frames );
+  frame_information_->pcm_frames_per_output_frame = double( audio_data_->total_pcm_frame_count ) / double( frame_information_->amount_output_frames );
+  logger_->debug( "[create_frame_information] frame_information_->pcm_frames_per_output_frame: {}", frame_information_->pcm_frames_per_output_frame );
+
+  frame_information_->render_context = std::make_shared< RegularVideoGenerator::RenderContext >();
+  frame_information_->render_context->amount_output_frames = frame_information_->amount_output_frames;
+  frame_information_->render_context->project_temp_pictureset_path = project_temp_pictureset_path_;
+  frame_information_->render_context->audio_data = audio_data_;
+
+  FFT_DISPLAY_MAX_FREQ = double( audio_data_->sample_rate ) / 2.0;
+}
+
 void RegularVideoGenerator::prepare_surfaces() {
   logger_->trace( "[prepare_surfaces] enter" );
 
@@ -187,28 +337,193 @@ void RegularVideoGenerator::prepare_surfaces() {
   }
 
   create_epilepsy_warning();
-  frame_information_->common_bg_surface = surface_load_file( common_bg_path_ );
-  frame_information_->common_circle_surface = surface_load_file( common_circle_path_ );
-  frame_information_->project_art_surface = surface_load_file_into_overlay( project_art_path_, VIDEO_WIDTH, VIDEO_HEIGHT, 24, 24, 917, 812 );
-  frame_information_->static_text_surface = surface_render_text_into_overlay( FontManager::get_font_face( "Roboto-Regular.ttf" ),
-                                                                              project_title_path_,
-                                                                              VIDEO_WIDTH,
-                                                                              VIDEO_HEIGHT,
-                                                                              979,
-                                                                              24,
-                                                                              917,
-                                                                              387 );
-
-  logger_->debug( "[prepare_surfaces] frame_information_->common_epilepsy_warning_surface: {}",
-                  static_cast< void* >( frame_information_->common_epilepsy_warning_surface.get() ) );
-  logger_->debug( "[prepare_surfaces] frame_information_->common_bg_surface: {}", static_cast< void* >( frame_information_->common_bg_surface.get() ) );
-  logger_->debug( "[prepare_surfaces] frame_information_->common_circle_surface: {}", static_cast< void* >( frame_information_->common_circle_surface.get() ) );
-  logger_->debug( "[prepare_surfaces] frame_information_->project_art_surface: {}", static_cast< void* >( frame_information_->project_art_surface.get() ) );
-  logger_->debug( "[prepare_surfaces] frame_information_->static_text_surface: {}", static_cast< void* >( frame_information_->static_text_surface.get() ) );
+  frame_information_->render_context->common_bg_surface = surface_load_file( common_bg_path_ );
+  frame_information_->render_context->common_circle_surface = surface_load_file( common_circle_path_ );
+  frame_information_->render_context->project_art_surface = surface_load_file_into_overlay( project_art_path_, VIDEO_WIDTH, VIDEO_HEIGHT, 24, 24, 917, 812 );
+  frame_information_->render_context->static_text_surface = surface_render_text_into_overlay( FontManager::get_font_face( "Roboto-Regular.ttf" ),
+                                                                                              project_title_path_,
+                                                                                              VIDEO_WIDTH,
+                                                                                              VIDEO_HEIGHT,
+                                                                                              979,
+                                                                                              24,
+                                                                                              917,
+                                                                                              387 );
+
+  logger_->debug( "[prepare_surfaces] render_context->common_epilepsy_warning_surface: {}",
+                  static_cast< void* >( frame_information_->render_context->common_epilepsy_warning_surface.get() ) );
+  logger_->debug( "[prepare_surfaces] render_context->common_bg_surface: {}",
+                  static_cast< void* >( frame_information_->render_context->common_bg_surface.get() ) );
+  logger_->debug( "[prepare_surfaces] render_context->common_circle_surface: {}",
+                  static_cast< void* >( frame_information_->render_context->common_circle_surface.get() ) );
+  logger_->debug( "[prepare_surfaces] render_context->project_art_surface: {}",
+                  static_cast< void* >( frame_information_->render_context->project_art_surface.get() ) );
+  logger_->debug( "[prepare_surfaces] render_context->static_text_surface: {}",
+                  static_cast< void* >( frame_information_->render_context->static_text_surface.get() ) );
 
   logger_->trace( "[prepare_surfaces] exit" );
 }
 
+// the bass only has content between BASS_HP_CUTOFF and BASS_LP_CUTOFF, so it is filtered and analyzed at a fraction of the sample rate
+static uint32_t get_bass_decimation_factor( uint32_t sample_rate ) {
+  uint32_t bass_decimation_factor = 1;
+  while( ( double( sample_rate ) / double( bass_decimation_factor * 2 ) ) >= RegularVideoGenerator::BASS_MIN_SAMPLE_RATE ) {
+    bass_decimation_factor *= 2;
+  }
+  return bass_decimation_factor;
+}
+
+static std::vector< DecimationStage > design_bass_decimation_stages( uint32_t sample_rate, uint32_t bass_decimation_factor ) {
+  // keep a little headroom above the low pass cutoff free of aliasing
+  double const bass_passband_edge = ( 1.25 * RegularVideoGenerator::BASS_LP_CUTOFF ) / double( sample_rate );
+  return design_decimation_stages( bass_decimation_factor, bass_passband_edge );
+}
+
+// low pass followed by high pass, as one cascade
+static BiquadCascade create_bass_cascade( double bass_sample_rate ) {
+  Iir::Butterworth::LowPass< RegularVideoGenerator::IIR_FILTER_ORDER > lowpass;
+  Iir::Butterworth::HighPass< RegularVideoGenerator::IIR_FILTER_ORDER > highpass;
+  lowpass.setup( bass_sample_rate, RegularVideoGenerator::BASS_LP_CUTOFF );
+  highpass.setup( bass_sample_rate, RegularVideoGenerator::BASS_HP_CUTOFF );
+
+  BiquadCascade bass_cascade;
+  append_biquad_cascade( bass_cascade, lowpass );
+  append_biquad_cascade( bass_cascade, highpass );
+  return bass_cascade;
+}
+
+// how a windowed frame becomes a display row, the same for the whole-file and the streaming analysis.
+// the multi resolution fft windows and transforms its own frames, it only takes the display bins from here
+struct DisplayTransform {
+  StftLayout stft_layout;
+  // `fft_size` entries, of which the first `window_size` are used
+  std::vector< float > window;
+  size_t batch_size = 1;
+  std::shared_ptr< fftwf_plan_s > fft_plan;
+  bool use_constant_q = false;
+  ConstantQKernel constant_q_kernel;
+  std::shared_ptr< SparseMatrix const > display_matrix;
+  size_t display_bin_amount = 0;
+  std::vector< float > display_x_axis;
+};
+
+static DisplayTransform create_display_transform( uint64_t pcm_frame_count, double pcm_frames_per_output_frame, uint32_t sample_rate, double max_freq ) {
+  DisplayTransform transform;
+  transform.stft_layout = StftLayout::from_window( pcm_frame_count, pcm_frames_per_output_frame );
+  size_t const fft_size = transform.stft_layout.fft_size;
+  transform.use_constant_q = RegularVideoGenerator::FFT_DISPLAY_SOURCE == RegularVideoGenerator::FftDisplaySource::CONSTANT_Q;
+  if( transform.use_constant_q ) {
+    // the constant q kernels bring their own windows, so the transform sees the whole frame (centered on the same sample) unwindowed
+    transform.stft_layout.window_size = fft_size;
+  }
+
+  std::vector< double > window( fft_size );
+  if( transform.use_constant_q ) {
+    rectwin( window.data(), fft_size );
+  } else {
+    nuttallwin_octave( window.data(), fft_size, false );
+  }
+  transform.window.assign( window.begin(), window.end() );
+
+  // frames are transformed FFT_BATCH_SIZE at a time with one shared plan, every thread executes it on its own buffers via `fftwf_execute_dft_r2c`.
+  // the buffers come from `fftwf_alloc_*`, so they have the same alignment as the ones the plan was made for.
+  transform.batch_size = std::max< size_t >( 1, RegularVideoGenerator::FFT_BATCH_SIZE );
+  transform.fft_plan = FftwPlanRegistry::get_r2c_batch_plan( int( fft_size ), int( transform.batch_size ) );
+
+  // all of them only depend on the fft size and the sample rate, so either way the display bins are one sparse product per frame
+  double const min_freq = RegularVideoGenerator::FFT_DISPLAY_MIN_FREQ;
+  uint32_t const bin_amount = RegularVideoGenerator::FFT_DISPLAY_BIN_AMOUNT;
+  transform.display_bin_amount = size_t( bin_amount ) + 1;
+  transform.display_x_axis.resize( transform.display_bin_amount );
+  for( size_t bin = 0; bin < transform.display_bin_amount; bin++ ) {
+    transform.display_x_axis[bin] = float( double( bin ) / double( bin_amount ) );
+  }
+  switch( RegularVideoGenerator::FFT_DISPLAY_SOURCE ) {
+    case RegularVideoGenerator::FftDisplaySource::LOG_BINNED_FFT:
+      transform.display_matrix
+          = std::make_shared< SparseMatrix const >( make_log_binning_matrix( fft_size, double( sample_rate ), min_freq, max_freq, bin_amount ) );
+      break;
+    case RegularVideoGenerator::FftDisplaySource::CONSTANT_Q: {
+      // bin `b` is at x `b / FFT_DISPLAY_BIN_AMOUNT` of the display, the bandwidth of a bin is the distance to the next one
+      double const bin_ratio = std::pow( max_freq / min_freq, 1.0 / double( bin_amount ) );
+      std::vector< double > bin_freqs( transform.display_bin_amount );
+      for( size_t bin = 0; bin < transform.display_bin_amount; bin++ ) {
+        bin_freqs[bin] = min_freq * std::pow( bin_ratio, double( bin ) );
+      }
+      transform.constant_q_kernel = make_constant_q_kernel( fft_size, double( sample_rate ), bin_freqs, constant_q_quality( bin_ratio ) );
+      break;
+    }
+    case RegularVideoGenerator::FftDisplaySource::MEL_FILTERBANK:
+    case RegularVideoGenerator::FftDisplaySource::BARK_FILTERBANK: {
+      FilterbankLayout filterbank_layout;
+      bool const is_mel = RegularVideoGenerator::FFT_DISPLAY_SOURCE == RegularVideoGenerator::FftDisplaySource::MEL_FILTERBANK;
+      filterbank_layout.scale = is_mel ? FilterbankScale::MEL : FilterbankScale::BARK;
+      filterbank_layout.normalization = RegularVideoGenerator::FFT_DISPLAY_FILTERBANK_NORMALIZATION;
+      filterbank_layout.fft_size = fft_size;
+      filterbank_layout.sample_rate = double( sample_rate );
+      filterbank_layout.band_amount = RegularVideoGenerator::FFT_DISPLAY_FILTERBANK_BAND_AMOUNT;
+      filterbank_layout.min_freq = min_freq;
+      filterbank_layout.max_freq = max_freq;
+      transform.display_matrix = get_filterbank_matrix( filterbank_layout );
+      // the bands are evenly spaced on their scale, so they are evenly spaced on the display too
+      transform.display_bin_amount = RegularVideoGenerator::FFT_DISPLAY_FILTERBANK_BAND_AMOUNT;
+      transform.display_x_axis.resize( transform.display_bin_amount );
+      for( size_t band = 0; band < transform.display_bin_amount; band++ ) {
+        transform.display_x_axis[band] = float( double( band ) / double( std::max< size_t >( 1, transform.display_bin_amount - 1 ) ) );
+      }
+      break;
+    }
+    case RegularVideoGenerator::FftDisplaySource::MULTI_RESOLUTION_FFT:
+      // `prepare_fft` builds the bands over the whole track
+      break;
+  }
+  return transform;
+}
+
+// the buffers one thread transforms its frames in, FFT_BATCH_SIZE at a time: the frames are windowed into `frame_signal( b )`,
+// then `transform` writes the magnitudes of their display bins into the rows of a table
+class DisplayRowBatch {
+  public:
+  explicit DisplayRowBatch( DisplayTransform const& transform );
+
+  size_t batch_size() const { return transform_.batch_size; }
+  float* frame_signal( size_t b ) { return signal_data_for_batch_.get() + ( b * transform_.stft_layout.fft_size ); }
+
+  // the first `frame_amount` frames of the batch, the rest of it is zeroed
+  void transform( size_t frame_amount, float* output, size_t output_stride );
+
+  private:
+  DisplayTransform const& transform_;
+  // frame `b` of a batch is at `b * fft_size` in the signal and at `b * fft_output_size` in the output and the magnitudes
+  std::shared_ptr< float[] > signal_data_for_batch_;
+  std::shared_ptr< fftwf_complex[] > fft_output_;
+  std::vector< float > fft_mags_;
+};
+
+DisplayRowBatch::DisplayRowBatch( DisplayTransform const& transform ) : transform_( transform ) {
+  size_t const fft_size = transform_.stft_layout.fft_size;
+  size_t const fft_output_size = fft_size / 2 + 1;
+  signal_data_for_batch_ = std::shared_ptr< float[] >( fftwf_alloc_real( fft_size * transform_.batch_size ), fftwf_free );
+  fft_output_ = std::shared_ptr< fftwf_complex[] >( fftwf_alloc_complex( fft_output_size * transform_.batch_size ), fftwf_free );
+  fft_mags_.resize( transform_.use_constant_q ? 0 : fft_output_size * transform_.batch_size );
+}
+
+void DisplayRowBatch::transform( size_t frame_amount, float* output, size_t output_stride ) {
+  size_t const fft_size = transform_.stft_layout.fft_size;
+  size_t const fft_output_size = fft_size / 2 + 1;
+  // the last batch may not be full
+  std::fill( frame_signal( frame_amount ), frame_signal( transform_.batch_size ), 0.0f );
+
+  fftwf_execute_dft_r2c( transform_.fft_plan.get(), signal_data_for_batch_.get(), fft_output_.get() );
+
+  if( transform_.use_constant_q ) {
+    constant_q_magnitudes( transform_.constant_q_kernel, fft_output_.get(), fft_output_size, output, output_stride, frame_amount );
+  } else {
+    // one pass over the whole batch, the dc index of every frame is skipped by starting the binning at 1
+    complex_magnitudes( fft_output_.get(), fft_mags_.data(), fft_output_size * frame_amount );
+    sparse_multiply( *transform_.display_matrix, fft_mags_.data() + 1, fft_output_size, output, output_stride, frame_amount );
+  }
+}
+
 void RegularVideoGenerator::prepare_fft() {
   logger_->trace( "[prepare_fft] enter" );
 
@@ -220,187 +535,175 @@ void RegularVideoGenerator::prepare_fft() {
 #pragma region init fft vals
 
   uint64_t pcm_frame_count = uint64_t( double( frame_information_->pcm_frames_per_output_frame ) * PCM_FRAME_COUNT_MULT );
-  size_t fft_size = 1;
-  while( fft_size < pcm_frame_count ) {
-    fft_size = fft_size << 1;
-  }
-  size_t fft_output_size = fft_size / 2 + 1;
+  DisplayTransform display_transform = create_display_transform( pcm_frame_count,
+                                                                 frame_information_->pcm_frames_per_output_frame,
+                                                                 audio_data_->sample_rate,
+                                                                 FFT_DISPLAY_MAX_FREQ );
+  StftLayout const& stft_layout = display_transform.stft_layout;
+  size_t const batch_size = display_transform.batch_size;
+  size_t const display_bin_amount = display_transform.display_bin_amount;
   logger_->trace( "[prepare_fft] pcm_frame_count: {}", pcm_frame_count );
-  logger_->trace( "[prepare_fft] fft_size: {}", fft_size );
-  logger_->trace( "[prepare_fft] fft_output_size: {}", fft_output_size );
-
-  std::shared_ptr< double[] > fft_windows = std::make_shared< double[] >( fft_size );
-  nuttallwin_octave( fft_windows.get(), fft_size, false );
-  std::shared_ptr< float[] > signal_data_for_frame = std::make_shared< float[] >( fft_size );
-  std::shared_ptr< fftwf_complex[] > fft_output = std::make_shared< fftwf_complex[] >( fft_output_size );
-  fftwf_plan fft_plan = fftwf_plan_dft_r2c_1d( fft_size, signal_data_for_frame.get(), fft_output.get(), FFTW_PLAN_FLAGS );
+  logger_->trace( "[prepare_fft] fft_size: {}", stft_layout.fft_size );
+  logger_->trace( "[prepare_fft] fft_output_size: {}", stft_layout.fft_size / 2 + 1 );
+  if( display_transform.use_constant_q ) {
+    logger_->trace( "[prepare_fft] constant_q_kernel entries: {}", display_transform.constant_q_kernel.weights.size() );
+  }
 
-  double fft_display_min_mag_db = std::numeric_limits< float >::max();
-  double fft_display_max_mag_db = -std::numeric_limits< float >::max();
+  std::shared_ptr< MultiResolutionStft > multi_resolution_stft;
+  if( FFT_DISPLAY_SOURCE == FftDisplaySource::MULTI_RESOLUTION_FFT ) {
+    // brings its own windows, ffts and log binning (one crossover map over the magnitudes of all bands), on the same frame centers
+    std::vector< MultiResolutionBand > const bands = design_three_band_resolution( double( audio_data_->sample_rate ),
+                                                                                   pcm_frame_count,
+                                                                                   FFT_MULTI_RESOLUTION_LOW_CROSSOVER,
+                                                                                   FFT_MULTI_RESOLUTION_HIGH_CROSSOVER,
+                                                                                   FFT_MULTI_RESOLUTION_CROSSOVER_OCTAVES );
+    multi_resolution_stft = std::make_shared< MultiResolutionStft >( audio_data_->mono_sample_data,
+                                                                     double( audio_data_->sample_rate ),
+                                                                     stft_layout.hop,
+                                                                     bands,
+                                                                     batch_size,
+                                                                     FFT_DISPLAY_MIN_FREQ,
+                                                                     FFT_DISPLAY_MAX_FREQ,
+                                                                     FFT_DISPLAY_BIN_AMOUNT,
+                                                                     FFT_MULTI_RESOLUTION_CROSSOVER_OCTAVES );
+    for( size_t band = 0; band < multi_resolution_stft->band_amount(); band++ ) {
+      logger_->trace( "[prepare_fft] multi resolution band {}: decimation {}, window_size {}, fft_size {}",
+                      band,
+                      bands[band].decimation,
+                      multi_resolution_stft->band_layout( band ).window_size,
+                      multi_resolution_stft->band_layout( band ).fft_size );
+    }
+    display_transform.display_matrix = std::shared_ptr< SparseMatrix const >( multi_resolution_stft, &multi_resolution_stft->crossover_map() );
+  }
+  if( display_transform.display_matrix ) {
+    logger_->trace( "[prepare_fft] display_matrix entries: {}", display_transform.display_matrix->weights.size() );
+  }
 
-  FFT_DISPLAY_MAX_FREQ = audio_data_->sample_rate / 2.0;
+  // every frame writes its dB values straight into its row of the spectrogram
+  size_t const frame_amount = frame_information_->amount_output_frames;
+  Spectrogram& fft_display_spectrogram = frame_information_->render_context->fft_display_spectrogram;
+  fft_display_spectrogram = Spectrogram( frame_amount, display_bin_amount );
+  fft_display_spectrogram.x_axis() = display_transform.display_x_axis;
 
 #pragma endregion init fft vals
 
-#pragma region compute fft
-
-  double pcm_frame_offset_dbl = 0.0;
-  std::vector< std::vector< std::pair< double, double > > > fft_vals_per_frame;
-  fft_vals_per_frame.reserve( frame_information_->amount_output_frames );
-  for( size_t i = 0; i < frame_information_->amount_output_frames; i++ ) {
-    // played sample will be in the middle of the shown samples
-    int64_t pcm_frame_offset = std::min< int64_t >( audio_data_->total_pcm_frame_count, int64_t( pcm_frame_offset_dbl ) - int64_t( pcm_frame_count / 2 ) );
-    // logger_->debug( "[prepare_threads] output frame {} from sample {} to {}", i, pcm_frame_offset, pcm_frame_offset + ( pcm_frame_count - 1 ) );
+#pragma region compute fft display rows
 
-    for( int64_t si = 0; si < fft_size; si++ ) {
-      signal_data_for_frame[si] = 0.0f;
-    }
-    for( int64_t si = 0; si < fft_output_size; si++ ) {
-      fft_output[si][0] = 0.0f;
-      fft_output[si][1] = 0.0f;
+  // window -> fft -> magnitude -> log bin / filterbank (or constant q) -> dB for the frames [frame_begin, frame_end),
+  // keeping track of the loudest bin of every frame in `max_mag_db_per_frame`
+  std::vector< double > max_mag_db_per_frame( frame_amount );
+  auto compute_display_rows = [&]( size_t frame_begin, size_t frame_end ) {
+    MultiResolutionStft::Workspace multi_resolution_workspace;
+    std::unique_ptr< DisplayRowBatch > display_row_batch;
+    if( multi_resolution_stft ) {
+      multi_resolution_workspace = multi_resolution_stft->make_workspace();
+    } else {
+      display_row_batch = std::make_unique< DisplayRowBatch >( display_transform );
     }
 
-    for( uint64_t si = 0; si < pcm_frame_count; si++ ) {
-      int64_t sample_frame_index = ( pcm_frame_offset + int64_t( si ) );
-      if( sample_frame_index < 0 ) {
-        continue;
-      }
-      if( sample_frame_index >= int64_t( audio_data_->total_pcm_frame_count ) ) {
-        continue;
+    for( size_t batch_begin = frame_begin; batch_begin < frame_end; batch_begin += batch_size ) {
+      size_t const batch_frame_amount = std::min( batch_size, frame_end - batch_begin );
+      if( multi_resolution_stft ) {
+        multi_resolution_stft->compute_rows( multi_resolution_workspace,
+                                             batch_begin,
+                                             batch_frame_amount,
+                                             fft_display_spectrogram.row( batch_begin ),
+                                             fft_display_spectrogram.row_stride() );
+      } else {
+        for( size_t b = 0; b < batch_frame_amount; b++ ) {
+          stft_window_frame( stft_layout,
+                             batch_begin + b,
+                             audio_data_->mono_sample_data.data(),
+                             audio_data_->mono_sample_data.size(),
+                             display_transform.window.data(),
+                             display_row_batch->frame_signal( b ) );
+        }
+        display_row_batch->transform( batch_frame_amount, fft_display_spectrogram.row( batch_begin ), fft_display_spectrogram.row_stride() );
       }
 
-      float average_sample = 0.0f;
-      for( uint32_t channel = 0; channel < audio_data_->channels; channel++ ) {
-        average_sample += audio_data_->sample_data[( sample_frame_index * audio_data_->channels ) + channel];
+      // convert to dB, in place
+      for( size_t i = batch_begin; i < batch_begin + batch_frame_amount; i++ ) {
+        float* display_row = fft_display_spectrogram.row( i );
+        amplitude_to_db( display_row, nullptr, display_row, display_bin_amount );
+        max_mag_db_per_frame[i] = double( *std::max_element( display_row, display_row + display_bin_amount ) );
       }
-
-      signal_data_for_frame[si] = ( average_sample / float( audio_data_->channels ) ) * fft_windows[si];
     }
-
-    fftwf_execute( fft_plan );
-
-    std::vector< std::pair< double, double > > fft_output_vals;
-    fft_output_vals.reserve( fft_output_size - 1 );
-
-    for( uint32_t fi = 0; fi < fft_output_size - 1; fi++ ) {
-      double freq = double( fi + 1 ) * double( audio_data_->sample_rate ) / double( fft_size );
-
-      std::pair< double, double > val;
-      val.first = freq;
-      double mag_real = fft_output[fi + 1][0];
-      double mag_imag = fft_output[fi + 1][1];
-      double mag = std::sqrt( ( mag_real * mag_real ) + ( mag_imag * mag_imag ) );
-      val.second = mag;
-      fft_output_vals.push_back( val );
-    }
-    fft_vals_per_frame.push_back( fft_output_vals );
-
-    pcm_frame_offset_dbl += frame_information_->pcm_frames_per_output_frame;
+  };
+
+  size_t const thread_count = std::clamp< size_t >( std::thread::hardware_concurrency(), 1, std::max< size_t >( 1, frame_amount ) );
+  size_t const frames_per_thread = ( frame_amount + thread_count - 1 ) / thread_count;
+  std::vector< std::thread > fft_threads;
+  fft_threads.reserve( thread_count );
+  for( size_t t = 0; t < thread_count; t++ ) {
+    size_t frame_begin = std::min( t * frames_per_thread, frame_amount );
+    size_t frame_end = std::min( frame_begin + frames_per_thread, frame_amount );
+    fft_threads.emplace_back( compute_display_rows, frame_begin, frame_end );
+  }
+  for( auto& thread : fft_threads ) {
+    thread.join();
   }
 
-#pragma endregion compute fft
-
-#pragma region accumulate mags into bins
-
-  std::vector< std::vector< std::pair< double, double > > > fft_log_bins_per_frame;
-  fft_log_bins_per_frame.reserve( fft_vals_per_frame.size() );
-  int i = 0;  // frame index
-  for( std::vector< std::pair< double, double > > fft_vals : fft_vals_per_frame ) {
-    double freq_min = std::log10( FFT_DISPLAY_MIN_FREQ );
-    double freq_max = std::log10( FFT_DISPLAY_MAX_FREQ );
-
-    std::vector< std::pair< double, double > > fft_log_bins;
-    fft_log_bins.reserve( FFT_DISPLAY_BIN_AMOUNT + 1 );
-    for( uint32_t bin = 0; bin <= FFT_DISPLAY_BIN_AMOUNT; bin++ ) {
-      double bin_min_freq = std::pow( 10.0, freq_min + ( double( bin + 0 ) * ( freq_max - freq_min ) / double( FFT_DISPLAY_BIN_AMOUNT ) ) );
-      double bin_max_freq = std::pow( 10.0, freq_min + ( double( bin + 1 ) * ( freq_max - freq_min ) / double( FFT_DISPLAY_BIN_AMOUNT ) ) );
-
-      std::pair< double, double > val;
-      val.first = double( bin ) / double( FFT_DISPLAY_BIN_AMOUNT );
-      // accumulate magnitudes
-      val.second = 0.0;
-      for( std::pair< double, double > pair : fft_vals ) {
-        if( ( pair.first >= bin_min_freq ) && ( pair.first < bin_max_freq ) )
-          val.second += pair.second;
-      }
-      if( isnan( val.second ) || ( val.second <= 0.0 ) ) {
-        // no fft values for this frequency found, gonna have to fancy lerp this from other values
-
-        double fft_freq_bin = ( double( fft_size ) * bin_min_freq / audio_data_->sample_rate ) - 1.0;  // -1 because we skipped the first index earlier
+#pragma endregion compute fft display rows
 
-        int64_t a_index = int64_t( std::floor( fft_freq_bin ) );
-        int64_t b_index = int64_t( std::ceil( fft_freq_bin ) );
-        double t = fft_freq_bin - double( a_index );
+#pragma region mag ranges
 
-        val.second = catmullRom( fft_vals[a_index - 1], fft_vals[a_index], fft_vals[b_index], fft_vals[b_index + 1], t ).second;
-      }
-      // convert to dB
-      if( val.second < 0.0 )
-        val.second = 0.0;
-      val.second = 20.0 * std::log10( val.second + 1e-12 );
+  MagDbNormalizer display_normalizer( get_mag_db_normalization() );
+  for( double max_mag_db : max_mag_db_per_frame ) {
+    display_normalizer.push( max_mag_db );
+  }
+  display_normalizer.finish();
+  std::vector< MagDbRange >& fft_display_range_per_frame = frame_information_->render_context->fft_display_range_per_frame;
+  fft_display_range_per_frame.clear();
+  fft_display_range_per_frame.reserve( frame_amount );
+  while( std::optional< MagDbRange > range = display_normalizer.next() ) {
+    fft_display_range_per_frame.push_back( *range );
+  }
 
-      if( val.second < fft_display_min_mag_db ) {
-        fft_display_min_mag_db = val.second;
-      }
-      if( val.second > fft_display_max_mag_db ) {
-        fft_display_max_mag_db = val.second;
-      }
-      fft_log_bins.push_back( val );
+#pragma endregion mag ranges
+
+#pragma region onsets and beats
+
+  // the threads fill the rows out of order, so the detector goes over them once they are all there, before the clamp
+  OnsetDetector onset_detector( get_onset_detection(), display_bin_amount );
+  std::vector< double >& onset_strength_per_frame = frame_information_->render_context->onset_strength_per_frame;
+  std::vector< double >& beat_strength_per_frame = frame_information_->render_context->beat_strength_per_frame;
+  onset_strength_per_frame.clear();
+  onset_strength_per_frame.reserve( frame_amount );
+  beat_strength_per_frame.clear();
+  beat_strength_per_frame.reserve( frame_amount );
+  auto take_onset_frames = [&]() {
+    while( std::optional< OnsetFrame > onset_frame = onset_detector.next() ) {
+      onset_strength_per_frame.push_back( onset_frame->onset_strength );
+      beat_strength_per_frame.push_back( onset_frame->beat_strength );
     }
-    fft_log_bins_per_frame.push_back( fft_log_bins );
-    i++;
+  };
+  for( size_t i = 0; i < frame_amount; i++ ) {
+    onset_detector.push( fft_display_spectrogram.row( i ) );
+    take_onset_frames();
   }
+  onset_detector.finish();
+  take_onset_frames();
 
-#pragma endregion accumulate mags into bins
-
-#pragma region min/max mag
-
-  FFT_DISPLAY_MAX_MAG_DB = std::ceil( fft_display_max_mag_db );
-  FFT_DISPLAY_MIN_MAG_DB = FFT_DISPLAY_MAX_MAG_DB - FFT_DISPLAY_MAG_DB_RANGE;
-  logger_->trace( "[prepare_fft] FFT_DISPLAY_MAX_MAG_DB: {}", FFT_DISPLAY_MAX_MAG_DB );
-  logger_->trace( "[prepare_fft] FFT_DISPLAY_MIN_MAG_DB: {}", FFT_DISPLAY_MIN_MAG_DB );
-
-#pragma endregion min / max mag
+#pragma endregion onsets and beats
 
 #pragma region clamp fft display vals
 
-  std::vector< std::vector< std::pair< double, double > > > fft_display_vals_per_frame;
-  fft_display_vals_per_frame.reserve( fft_log_bins_per_frame.size() );
-  for( std::vector< std::pair< double, double > > fft_log_bins : fft_log_bins_per_frame ) {
-    std::vector< std::pair< double, double > > fft_display_vals;
-    fft_display_vals.reserve( fft_log_bins.size() );
-    for( std::pair< double, double > pair : fft_log_bins ) {
-      std::pair< double, double > val;
-      val.first = pair.first;
-      val.second = std::clamp( pair.second, FFT_DISPLAY_MIN_MAG_DB, FFT_DISPLAY_MAX_MAG_DB );
-      fft_display_vals.push_back( val );
+  // the ranges are only known once the frames after them are done, so this is a second (cheap) pass over the table
+  for( size_t i = 0; i < frame_amount; i++ ) {
+    float const display_min_mag_db = float( fft_display_range_per_frame[i].min_mag_db );
+    float const display_max_mag_db = float( fft_display_range_per_frame[i].max_mag_db );
+    float* display_row = fft_display_spectrogram.row( i );
+    for( size_t bin = 0; bin < display_bin_amount; bin++ ) {
+      display_row[bin] = std::clamp( display_row[bin], display_min_mag_db, display_max_mag_db );
     }
-    fft_display_vals_per_frame.push_back( fft_display_vals );
   }
 
 #pragma endregion clamp fft display vals
 
 #pragma region compute display vals
 
-  frame_information_->fft_display_values_per_frame.reserve( fft_display_vals_per_frame.size() );
-  for( std::vector< std::pair< double, double > > fft_display_vals : fft_display_vals_per_frame ) {
-    std::shared_ptr< std::vector< std::pair< double, double > > > formatted_fft_display_values
-        = std::make_shared< std::vector< std::pair< double, double > > >();
-    formatted_fft_display_values->reserve( fft_display_vals.size() );
-    for( uint32_t bin = 0; bin < fft_display_vals.size(); bin++ ) {
-      std::pair< double, double > pair = fft_display_vals[bin];
-      std::pair< double, double > val;
-      val.first = pair.first;
-      val.second = pair.second;
-      if( frame_information_->fft_display_values_per_frame.size() > 0 ) {
-        // apply smoothing
-        val.second
-            = ( FFT_COMPUTE_ALPHA * val.second ) + ( ( 1.0 - FFT_COMPUTE_ALPHA ) * frame_information_->fft_display_values_per_frame.back()->at( bin ).second );
-      }
-      formatted_fft_display_values->push_back( val );
-    }
-    frame_information_->fft_display_values_per_frame.push_back( formatted_fft_display_values );
-  }
+  // apply smoothing
+  exponential_smoothing_scan( fft_display_spectrogram.data(), frame_amount, display_bin_amount, fft_display_spectrogram.row_stride(), FFT_COMPUTE_ALPHA );
 
   // frame_information_->fft_display_values_per_frame.reserve( fft_display_vals_per_frame.size() );
   // for( std::vector< std::pair< double, double > > fft_display_vals : fft_display_vals_per_frame ) {
@@ -441,47 +744,37 @@ void RegularVideoGenerator::prepare_fft() {
   logger_->trace( "[prepare_fft] exit" );
 }
 
-void RegularVideoGenerator::prepare_threads() {
-  logger_->trace( "[prepare_threads] enter" );
+void RegularVideoGenerator::prepare_threads( size_t frame_begin, size_t frame_end ) {
+  logger_->trace( "[prepare_threads] enter: frame_begin: {}, frame_end: {}", frame_begin, frame_end );
 
   if( !is_ready_ ) {
     logger_->error( "[prepare_threads] generator is not ready!" );
     return;
   }
 
-  uint32_t thread_count = std::thread::hardware_concurrency();
+  uint32_t thread_count = std::max< uint32_t >( 1, std::thread::hardware_concurrency() );
   logger_->debug( "[prepare_threads] thread_count: {}", thread_count );
-  frame_information_->thread_input_lists.reserve( std::thread::hardware_concurrency() );
-  for( int i = 0; i < frame_information_->thread_input_lists.capacity(); i++ ) {
-    std::vector< RegularVideoGenerator::ThreadInputData > vec;
-    vec.reserve( ( frame_information_->amount_output_frames / frame_information_->thread_input_lists.capacity() ) + 1 );
-    frame_information_->thread_input_lists.push_back( vec );
+  frame_information_->frame_descriptor_lists.resize( thread_count );
+  for( auto& descriptor_list : frame_information_->frame_descriptor_lists ) {
+    descriptor_list.clear();
+    descriptor_list.reserve( ( ( frame_end - frame_begin ) / thread_count ) + 1 );
   }
 
-  double pcm_frame_offset = 0.0;
-  for( size_t i = 0; i < frame_information_->amount_output_frames; i++ ) {
-    RegularVideoGenerator::ThreadInputData input_data;
-    input_data.i = i;
-    input_data.amount_output_frames = frame_information_->amount_output_frames;
-    input_data.project_temp_pictureset_picture_path = project_temp_pictureset_path_ / fmt::format( "{}.png", i );
-    input_data.pcm_frame_count = uint64_t( double( frame_information_->pcm_frames_per_output_frame ) * PCM_FRAME_COUNT_MULT );
+  uint64_t const pcm_frame_count = uint64_t( double( frame_information_->pcm_frames_per_output_frame ) * PCM_FRAME_COUNT_MULT );
+  double pcm_frame_offset = double( frame_begin ) * frame_information_->pcm_frames_per_output_frame;
+  for( size_t i = frame_begin; i < frame_end; i++ ) {
+    RegularVideoGenerator::FrameDescriptor frame;
+    frame.i = i;
+    frame.pcm_frame_count = pcm_frame_count;
     // played sample will be in the middle of the shown samples
-    input_data.pcm_frame_offset
-        = std::min< int64_t >( audio_data_->total_pcm_frame_count, int64_t( pcm_frame_offset ) - int64_t( input_data.pcm_frame_count / 2 ) );
-    input_data.audio_data_ptr = audio_data_;
-    input_data.common_epilepsy_warning_surface = frame_information_->common_epilepsy_warning_surface;
-    input_data.common_bg_surface = frame_information_->common_bg_surface;
-    input_data.common_circle_surface = frame_information_->common_circle_surface;
-    input_data.project_art_surface = frame_information_->project_art_surface;
-    input_data.static_text_surface = frame_information_->static_text_surface;
-    input_data.fft_display_values = frame_information_->fft_display_values_per_frame[i];
+    frame.pcm_frame_offset = std::min< int64_t >( audio_data_->total_pcm_frame_count, int64_t( pcm_frame_offset ) - int64_t( frame.pcm_frame_count / 2 ) );
     // logger_->debug( "[prepare_threads] output frame {} from sample {} to {}",
-    //                 input_data.i,
-    //                 input_data.pcm_frame_offset,
-    //                 input_data.pcm_frame_offset + ( input_data.pcm_frame_count - 1 ) );
+    //                 frame.i,
+    //                 frame.pcm_frame_offset,
+    //                 frame.pcm_frame_offset + ( frame.pcm_frame_count - 1 ) );
 
-    size_t thread_index = i % frame_information_->thread_input_lists.capacity();
-    frame_information_->thread_input_lists[thread_index].push_back( input_data );
+    size_t thread_index = i % thread_count;
+    frame_information_->frame_descriptor_lists[thread_index].push_back( frame );
 
     pcm_frame_offset += frame_information_->pcm_frames_per_output_frame;
   }
@@ -497,9 +790,11 @@ void RegularVideoGenerator::start_threads() {
     return;
   }
 
-  frame_information_->thread_input_lists.reserve( frame_information_->thread_input_lists.size() );
-  for( auto const& input_list : frame_information_->thread_input_lists ) {
-    frame_information_->thread_list.emplace_back( RegularVideoGenerator::thread_run, input_list );
+  frame_information_->thread_list.reserve( frame_information_->frame_descriptor_lists.size() );
+  for( auto const& descriptor_list : frame_information_->frame_descriptor_lists ) {
+    frame_information_->thread_list.emplace_back( RegularVideoGenerator::thread_run,
+                                                  std::cref( *frame_information_->render_context ),
+                                                  std::cref( descriptor_list ) );
   }
 
   logger_->trace( "[start_threads] exit" );
@@ -516,6 +811,7 @@ void RegularVideoGenerator::join_threads() {
   for( auto& thread : frame_information_->thread_list ) {
     thread.join();
   }
+  frame_information_->thread_list.clear();
 
   logger_->trace( "[join_threads] exit" );
 }
@@ -537,6 +833,7 @@ void RegularVideoGenerator::clean_up() {
   // from prepare_audio
   // keep __filtered_#_#.wav
   audio_data_.reset();
+  analysis_cache_key_.reset();
 
   // don't delete things other programs still need
   // // from init
@@ -547,6 +844,775 @@ void RegularVideoGenerator::clean_up() {
   logger_->trace( "[clean_up] exit" );
 }
 
+#pragma region streaming
+
+// grows `ring` so that pushing `amount` more samples keeps everything from `needed_begin` on
+static void reserve_sample_ring( SampleRingBuffer& ring, int64_t needed_begin, size_t amount ) {
+  int64_t const needed_amount = ring.end_position() + int64_t( amount ) - std::max< int64_t >( 0, needed_begin );
+  if( needed_amount > int64_t( ring.capacity() ) ) {
+    ring.reserve( size_t( needed_amount ) );
+  }
+}
+
+// 16 bit and float wavs are drawn straight from the mapping, nullptr if `file_path` is not one of them
+static std::shared_ptr< MappedWavFile > map_wav_file( std::filesystem::path const& file_path ) {
+  std::shared_ptr< MappedWavFile > mapped_wav_file = std::make_shared< MappedWavFile >();
+  if( !mapped_wav_file->open( file_path ) ) {
+    return nullptr;
+  }
+  return mapped_wav_file;
+}
+
+// the decoded samples the frames of a segment draw, for tracks that can not be mapped.
+// frames are pushed in order as they are decoded and dropped once no frame to render needs them anymore
+class SegmentSamples {
+  public:
+  explicit SegmentSamples( uint32_t channels ) : channels_( std::max< uint32_t >( 1, channels ) ) {}
+
+  // pcm frame of the oldest frame there is
+  int64_t first_frame() const { return first_frame_; }
+  // pcm frame one past the newest frame
+  int64_t end_frame() const { return first_frame_ + int64_t( samples_.size() / channels_ ); }
+  void push( float const* samples, size_t frame_amount ) { samples_.insert( samples_.end(), samples, samples + ( frame_amount * channels_ ) ); }
+  // drops the frames before `frame`
+  void drop_before( int64_t frame ) {
+    size_t const frame_amount = size_t( std::clamp< int64_t >( frame - first_frame_, 0, end_frame() - first_frame_ ) );
+    samples_.erase( samples_.begin(), samples_.begin() + ( frame_amount * channels_ ) );
+    first_frame_ += int64_t( frame_amount );
+  }
+  // valid until the next `push` or `drop_before`
+  PcmSampleView view() const { return PcmSampleView{ PcmSampleFormat::FLOAT32, samples_.data(), channels_, uint64_t( samples_.size() / channels_ ) }; }
+
+  private:
+  uint32_t channels_;
+  std::vector< float > samples_;
+  int64_t first_frame_ = 0;
+};
+
+// the display rows of samples that arrive chunk by chunk, frames are transformed FFT_BATCH_SIZE at a time as soon as they are complete
+class StreamingDisplayRows {
+  public:
+  explicit StreamingDisplayRows( DisplayTransform const& transform )
+      : engine_( transform.stft_layout, transform.window ),
+        batch_( transform ),
+        bin_amount_( transform.display_bin_amount ),
+        rows_( transform.batch_size * transform.display_bin_amount ) {}
+
+  // index of the frame `transform` computes next
+  size_t next_frame() const { return next_frame_; }
+
+  void push( float const* samples, size_t amount ) { engine_.push( samples, amount ); }
+  void finish() {
+    engine_.finish();
+    is_finished_ = true;
+  }
+
+  // transforms the complete frames before `frame_end`, `on_row( frame, mag_db )` gets the `display_bin_amount` dB values of every frame in order
+  template < typename OnRow >
+  void transform( size_t frame_end, OnRow&& on_row ) {
+    size_t const fft_size = engine_.layout().fft_size;
+    while( next_frame_ < frame_end ) {
+      size_t const batch_frame_limit = std::min( batch_.batch_size(), frame_end - next_frame_ );
+      size_t batch_frame_amount = 0;
+      for( ; batch_frame_amount < batch_frame_limit; batch_frame_amount++ ) {
+        float* signal_data_for_frame = batch_.frame_signal( batch_frame_amount );
+        if( !engine_.pop_frame( signal_data_for_frame ) ) {
+          if( !is_finished_ ) {
+            break;
+          }
+          // starts past the end of the track
+          std::fill( signal_data_for_frame, signal_data_for_frame + fft_size, 0.0f );
+        }
+      }
+      if( batch_frame_amount == 0 ) {
+        return;
+      }
+
+      batch_.transform( batch_frame_amount, rows_.data(), bin_amount_ );
+      for( size_t b = 0; b < batch_frame_amount; b++ ) {
+        float* display_row = rows_.data() + ( b * bin_amount_ );
+        amplitude_to_db( display_row, nullptr, display_row, bin_amount_ );
+        on_row( next_frame_ + b, static_cast< float const* >( display_row ) );
+      }
+      next_frame_ += batch_frame_amount;
+    }
+  }
+
+  private:
+  StftEngine engine_;
+  DisplayRowBatch batch_;
+  size_t bin_amount_;
+  std::vector< float > rows_;
+  size_t next_frame_ = 0;
+  bool is_finished_ = false;
+};
+
+bool RegularVideoGenerator::should_stream_audio( bool is_cached ) {
+  logger_->trace( "[should_stream_audio] enter" );
+
+  // only the header, a track that is too long for the whole-file path must not be decoded to find that out
+  AudioFormat format;
+  if( !read_audio_format( project_audio_path_, format ) || ( format.total_pcm_frame_count == 0 ) || ( format.sample_rate == 0 ) ) {
+    // the whole-file path reports it
+    return false;
+  }
+
+  double total_pcm_frame_count = double( format.total_pcm_frame_count );
+  double amount_output_frames = std::ceil( total_pcm_frame_count / double( format.sample_rate ) * FPS );
+  bool const is_filterbank = ( FFT_DISPLAY_SOURCE == FftDisplaySource::MEL_FILTERBANK ) || ( FFT_DISPLAY_SOURCE == FftDisplaySource::BARK_FILTERBANK );
+  size_t row_stride = Spectrogram( 0, is_filterbank ? FFT_DISPLAY_FILTERBANK_BAND_AMOUNT : FFT_DISPLAY_BIN_AMOUNT + 1 ).row_stride();
+  if( is_cached ) {
+    // the cache knows them exactly, an mp3 header only gives an estimate
+    total_pcm_frame_count = double( audio_data_->total_pcm_frame_count );
+    amount_output_frames = double( frame_information_->amount_output_frames );
+    row_stride = frame_information_->render_context->fft_display_spectrogram.row_stride();
+  }
+
+  // the decoded samples (a mapped wav is read in place), then without the cache their mono mix and its prefix sum.
+  // per frame the tables of the render context and without the cache the loudest magnitude of the frame
+  double const sample_bytes = ( format.is_mapped ? 0.0 : total_pcm_frame_count * double( format.channels ) * sizeof( float ) )
+                              + ( is_cached ? 0.0 : total_pcm_frame_count * ( sizeof( float ) + sizeof( double ) ) );
+  double const frame_bytes = ( double( row_stride ) * sizeof( float ) ) + sizeof( MagDbRange ) + ( ( is_cached ? 4.0 : 5.0 ) * sizeof( double ) );
+  double const whole_file_bytes = sample_bytes + ( amount_output_frames * frame_bytes );
+  bool should_stream = whole_file_bytes > double( STREAMING_MEMORY_BUDGET );
+  logger_->debug( "[should_stream_audio] whole_file_bytes: {}, STREAMING_MEMORY_BUDGET: {}, should_stream: {}",
+                  whole_file_bytes,
+                  STREAMING_MEMORY_BUDGET,
+                  should_stream );
+  if( should_stream && !is_cached && ( FFT_DISPLAY_SOURCE == FftDisplaySource::MULTI_RESOLUTION_FFT ) ) {
+    // the bands of the multi resolution fft are decimated from the whole track, there is no chunked analysis for it
+    logger_->warn( "[should_stream_audio] the multi resolution analysis of {:?} takes about {} MiB, more than STREAMING_MEMORY_BUDGET, analyzing it whole",
+                   project_audio_path_.string(),
+                   size_t( whole_file_bytes ) >> 20 );
+    should_stream = false;
+  }
+
+  logger_->trace( "[should_stream_audio] exit" );
+  return should_stream;
+}
+
+void RegularVideoGenerator::render_streaming() {
+  logger_->trace( "[render_streaming] enter" );
+
+  if( !is_ready_ ) {
+    logger_->error( "[render_streaming] generator is not ready!" );
+    return;
+  }
+
+  std::unique_ptr< AudioStream > file_stream = open_audio_stream( project_audio_path_ );
+  if( file_stream == nullptr ) {
+    logger_->error( "[render_streaming] can not read {:?}", project_audio_path_.string() );
+    return;
+  }
+  // the next chunks are decoded while the current one is analyzed
+  ThreadedAudioStream audio_stream( std::move( file_stream ), STREAMING_DECODE_AHEAD_FRAMES );
+
+  // only the fields the render threads need, there is no whole-file mono mix or bass
+  audio_data_ = std::make_shared< RegularVideoGenerator::AudioData >();
+  audio_data_->channels = audio_stream.channels();
+  audio_data_->sample_rate = audio_stream.sample_rate();
+  audio_data_->total_pcm_frame_count = audio_stream.total_pcm_frame_count();
+  audio_data_->duration = double( audio_data_->total_pcm_frame_count ) / double( audio_data_->sample_rate );
+  audio_data_->bass_decimation_factor = get_bass_decimation_factor( audio_data_->sample_rate );
+  logger_->debug( "[render_streaming] audio_data_->channels: {}", audio_data_->channels );
+  logger_->debug( "[render_streaming] audio_data_->sample_rate: {}", audio_data_->sample_rate );
+  logger_->debug( "[render_streaming] audio_data_->total_pcm_frame_count: {}", audio_data_->total_pcm_frame_count );
+
+  // the waveform of a mapped wav is drawn from the mapping, otherwise from the decoded samples of the segment being rendered
+  std::shared_ptr< MappedWavFile > mapped_wav_file = map_wav_file( project_audio_path_ );
+  bool const is_mapped = mapped_wav_file != nullptr;
+  if( is_mapped ) {
+    audio_data_->sample_data = mapped_wav_file->samples();
+    audio_data_->sample_data_owner = mapped_wav_file;
+  }
+  SegmentSamples segment_samples( audio_data_->channels );
+
+  create_frame_information();
+
+  size_t const amount_output_frames = frame_information_->amount_output_frames;
+  double const pcm_frames_per_output_frame = frame_information_->pcm_frames_per_output_frame;
+  uint32_t const channels = audio_data_->channels;
+  uint64_t const pcm_frame_count = uint64_t( pcm_frames_per_output_frame * PCM_FRAME_COUNT_MULT );
+  DisplayTransform const display_transform
+      = create_display_transform( pcm_frame_count, pcm_frames_per_output_frame, audio_data_->sample_rate, FFT_DISPLAY_MAX_FREQ );
+  size_t const display_bin_amount = display_transform.display_bin_amount;
+
+  std::vector< float > chunk( STREAMING_CHUNK_FRAMES * channels );
+  std::vector< float > mono_chunk( STREAMING_CHUNK_FRAMES );
+  auto read_chunk = [&]() {
+    size_t const frame_amount = audio_stream.read( chunk.data(), STREAMING_CHUNK_FRAMES );
+    downmix_to_mono( chunk.data(), mono_chunk.data(), frame_amount, channels );
+    return frame_amount;
+  };
+
+  MagDbNormalizer display_normalizer( get_mag_db_normalization() );
+  OnsetDetector onset_detector( get_onset_detection(), display_bin_amount );
+  bool const has_level_pass = FFT_MAG_DB_NORMALIZATION_MODE == MagDbNormalizationMode::GLOBAL;
+  auto push_max_mag_db = [&]( float const* mag_db ) { display_normalizer.push( double( *std::max_element( mag_db, mag_db + display_bin_amount ) ) ); };
+
+#pragma region level pass
+
+  // a GLOBAL range needs the loudest row of the whole track before the first frame, so the track is decoded and transformed twice.
+  // a STREAMING range only needs the frames up to its lookahead, those are computed along with the render pass
+  if( has_level_pass ) {
+    StreamingDisplayRows level_rows( display_transform );
+    auto push_level = [&]( size_t, float const* mag_db ) { push_max_mag_db( mag_db ); };
+    for( size_t frame_amount = read_chunk(); frame_amount > 0; frame_amount = read_chunk() ) {
+      level_rows.push( mono_chunk.data(), frame_amount );
+      level_rows.transform( amount_output_frames, push_level );
+    }
+    level_rows.finish();
+    level_rows.transform( amount_output_frames, push_level );
+    display_normalizer.finish();
+
+    if( !audio_stream.rewind() ) {
+      logger_->error( "[render_streaming] can not rewind {:?}", project_audio_path_.string() );
+      return;
+    }
+  }
+
+#pragma endregion level pass
+
+  prepare_surfaces();
+
+#pragma region render pass
+
+  // the rows are computed `delay_frames` frames ahead of the frames they are clamped and drawn for, until their ranges and onsets are known
+  size_t delay_frames = onset_detector.lookahead_frames();
+  if( !has_level_pass ) {
+    delay_frames = std::max( delay_frames, get_mag_db_normalization().lookahead_frames );
+  }
+  size_t const delay_rows = delay_frames + 1;
+
+  // per frame of a segment: the intensities and onset strengths, the display row and range and, if the track is not mapped, its samples.
+  // the decode chunk, the sample windows of the analysis and the delayed rows stay the same size for the whole track
+  size_t const pcm_frames_per_frame = size_t( std::ceil( pcm_frames_per_output_frame ) );
+  size_t const sample_frame_bytes = is_mapped ? 0 : channels * sizeof( float );
+  size_t const segment_frame_bytes = ( 4 * sizeof( double ) ) + ( Spectrogram( 0, display_bin_amount ).row_stride() * sizeof( float ) ) + sizeof( MagDbRange )
+                                     + ( pcm_frames_per_frame * sample_frame_bytes );
+  size_t const delay_bytes = ( delay_rows * display_bin_amount * sizeof( float ) )
+                             + ( delay_frames * pcm_frames_per_frame * ( ( 2 * sizeof( float ) ) + sample_frame_bytes ) );
+  size_t const fixed_bytes = ( ( ( STREAMING_CHUNK_FRAMES * ( channels + 3 ) ) + ( STREAMING_DECODE_AHEAD_FRAMES * channels ) ) * sizeof( float ) )
+                             + ( 2 * ( pcm_frame_count + STREAMING_CHUNK_FRAMES ) * sizeof( float ) )
+                             + ( ( pcm_frame_count + STREAMING_CHUNK_FRAMES ) * sample_frame_bytes )
+                             + ( display_transform.stft_layout.fft_size * ( 2 + ( 2 * display_transform.batch_size ) ) * sizeof( float ) ) + delay_bytes;
+  size_t const segment_frame_amount
+      = std::clamp< size_t >( ( STREAMING_MEMORY_BUDGET - std::min( fixed_bytes, STREAMING_MEMORY_BUDGET ) ) / segment_frame_bytes, 1, amount_output_frames );
+  logger_->debug( "[render_streaming] segment_frame_amount: {}", segment_frame_amount );
+
+  int64_t const total_pcm_frame_count = int64_t( audio_data_->total_pcm_frame_count );
+  int64_t const bass_decimation_factor = audio_data_->bass_decimation_factor;
+  auto get_pcm_frame_offset = [&]( size_t i ) {
+    // played sample will be in the middle of the shown samples
+    return std::min< int64_t >( total_pcm_frame_count, int64_t( double( i ) * pcm_frames_per_output_frame ) - int64_t( pcm_frame_count / 2 ) );
+  };
+  auto get_bass_window_begin = [&]( int64_t pcm_frame_offset ) {
+    return ( pcm_frame_offset + ( pcm_frame_offset > 0 ? bass_decimation_factor - 1 : 0 ) ) / bass_decimation_factor;
+  };
+
+  StreamingDisplayRows display_rows( display_transform );
+  // clamped squared samples, summed over the channels, per pcm frame
+  SampleRingBuffer frame_energies;
+  std::vector< float > frame_energy_chunk( STREAMING_CHUNK_FRAMES );
+  // the bass band, decimated and filtered with the state carried from chunk to chunk
+  SampleRingBuffer bass_samples;
+  std::vector< StreamingDecimator > bass_decimators;
+  for( DecimationStage& stage : design_bass_decimation_stages( audio_data_->sample_rate, audio_data_->bass_decimation_factor ) ) {
+    bass_decimators.emplace_back( std::move( stage ) );
+  }
+  std::vector< std::vector< float > > bass_stage_outputs( bass_decimators.size() );
+  BiquadCascadeFilter bass_filter( create_bass_cascade( double( audio_data_->sample_rate ) / double( bass_decimation_factor ) ), 1 );
+  std::vector< float > bass_chunk;
+  std::vector< float > window_values;
+  size_t sound_frame = 0;
+  size_t bass_frame = 0;
+  bool is_finished = false;
+
+  auto push_chunk = [&]( size_t frame_amount ) {
+    is_finished = frame_amount == 0;
+
+    for( size_t pi = 0; pi < frame_amount; pi++ ) {
+      double frame_energy = 0.0;
+      for( uint32_t c = 0; c < channels; c++ ) {
+        double sample = std::clamp( double( chunk[( pi * channels ) + c] ), -1.0, 1.0 );
+        frame_energy += sample * sample;
+      }
+      frame_energy_chunk[pi] = float( frame_energy );
+    }
+    reserve_sample_ring( frame_energies, get_pcm_frame_offset( sound_frame ), frame_amount );
+    frame_energies.push( frame_energy_chunk.data(), frame_amount );
+    if( !is_mapped ) {
+      segment_samples.push( chunk.data(), frame_amount );
+    }
+
+    if( is_finished ) {
+      display_rows.finish();
+    } else {
+      display_rows.push( mono_chunk.data(), frame_amount );
+    }
+
+    float const* stage_input = mono_chunk.data();
+    size_t stage_input_amount = frame_amount;
+    for( size_t s = 0; s < bass_decimators.size(); s++ ) {
+      bass_stage_outputs[s].clear();
+      bass_decimators[s].push( stage_input, stage_input_amount, bass_stage_outputs[s] );
+      if( is_finished ) {
+        bass_decimators[s].finish( bass_stage_outputs[s] );
+      }
+      stage_input = bass_stage_outputs[s].data();
+      stage_input_amount = bass_stage_outputs[s].size();
+    }
+    bass_chunk.resize( stage_input_amount );
+    bass_filter.process( stage_input, bass_chunk.data(), stage_input_amount );
+    reserve_sample_ring( bass_samples, get_bass_window_begin( get_pcm_frame_offset( bass_frame ) ), stage_input_amount );
+    bass_samples.push( bass_chunk.data(), stage_input_amount );
+  };
+
+  RegularVideoGenerator::RenderContext& render_context = *frame_information_->render_context;
+  render_context.sound_intensity_per_frame.resize( segment_frame_amount );
+  render_context.bass_intensity_per_frame.resize( segment_frame_amount );
+  render_context.onset_strength_per_frame.resize( segment_frame_amount );
+  render_context.beat_strength_per_frame.resize( segment_frame_amount );
+  render_context.fft_display_range_per_frame.resize( segment_frame_amount );
+
+  Spectrogram& fft_display_spectrogram = render_context.fft_display_spectrogram;
+  fft_display_spectrogram = Spectrogram( segment_frame_amount, display_bin_amount );
+  fft_display_spectrogram.x_axis() = display_transform.display_x_axis;
+  std::vector< float > previous_display_row( display_bin_amount );
+  // the dB rows waiting for their ranges and onsets, frame `i` in row `i % delay_rows`
+  std::vector< float > delayed_mag_db( delay_rows * display_bin_amount );
+  size_t pushed_frames = 0;
+  bool is_analysis_finished = false;
+
+  // every segment goes into the analysis cache as soon as it is complete, the cache is only in place once the last one is
+  AnalysisCacheStreamWriter cache_writer( analysis_cache_key_.value_or( 0 ) );
+  bool is_caching = begin_analysis_cache( cache_writer );
+
+  // frames that got their ranges, clamped and went into the tables
+  size_t display_frame = 0;
+  auto emit_ready_frames = [&]( size_t segment_begin, size_t segment_end ) {
+    while( ( display_frame < segment_end ) && ( display_frame < pushed_frames ) && display_normalizer.has_next() && onset_detector.has_next() ) {
+      size_t const row = display_frame - segment_begin;
+      MagDbRange const range = *display_normalizer.next();
+      OnsetFrame const onset_frame = *onset_detector.next();
+      render_context.fft_display_range_per_frame[row] = range;
+      render_context.onset_strength_per_frame[row] = onset_frame.onset_strength;
+      render_context.beat_strength_per_frame[row] = onset_frame.beat_strength;
+
+      float const* mag_db = delayed_mag_db.data() + ( ( display_frame % delay_rows ) * display_bin_amount );
+      float* display_row = fft_display_spectrogram.row( row );
+      for( size_t bin = 0; bin < display_bin_amount; bin++ ) {
+        display_row[bin] = std::clamp( mag_db[bin], float( range.min_mag_db ), float( range.max_mag_db ) );
+      }
+      display_frame++;
+    }
+  };
+
+  // computes every frame of the segment whose samples are there, returns if the segment is complete
+  auto compute_ready_frames = [&]( size_t segment_begin, size_t segment_end ) {
+    for( ; sound_frame < segment_end; sound_frame++ ) {
+      int64_t const pcm_frame_offset = get_pcm_frame_offset( sound_frame );
+      if( !is_finished && ( frame_energies.end_position() < pcm_frame_offset + int64_t( pcm_frame_count ) ) ) {
+        break;
+      }
+      window_values.resize( std::max< size_t >( window_values.size(), pcm_frame_count ) );
+      frame_energies.read( pcm_frame_offset, window_values.data(), pcm_frame_count );
+      double rms_sum_value = 0.0;
+      for( size_t pi = 0; pi < pcm_frame_count; pi++ ) {
+        rms_sum_value += window_values[pi];
+      }
+      render_context.sound_intensity_per_frame[sound_frame - segment_begin] = std::sqrt( rms_sum_value / ( double( channels ) * double( pcm_frame_count ) ) );
+    }
+
+    for( ; bass_frame < segment_end; bass_frame++ ) {
+      // the bass is at the decimated rate, only the samples belonging to pcm frames in the window count
+      int64_t const pcm_frame_offset = get_pcm_frame_offset( bass_frame );
+      int64_t const bass_window_begin = get_bass_window_begin( pcm_frame_offset );
+      int64_t const bass_window_end = ( pcm_frame_offset + int64_t( pcm_frame_count ) + bass_decimation_factor - 1 ) / bass_decimation_factor;
+      if( !is_finished && ( bass_samples.end_position() < bass_window_end ) ) {
+        break;
+      }
+      size_t const bass_window_amount = size_t( std::max< int64_t >( bass_window_end - bass_window_begin, 0 ) );
+      window_values.resize( std::max( window_values.size(), bass_window_amount ) );
+      bass_samples.read( bass_window_begin, window_values.data(), bass_window_amount );
+      double bass_rms_sum_value = 0.0;
+      for( size_t bi = 0; bi < bass_window_amount; bi++ ) {
+        double sample = std::clamp( double( window_values[bi] ), -1.0, 1.0 );
+        bass_rms_sum_value += sample * sample;
+      }
+      render_context.bass_intensity_per_frame[bass_frame - segment_begin]
+          = std::sqrt( bass_rms_sum_value / double( std::max< int64_t >( bass_window_end - bass_window_begin, 1 ) ) );
+    }
+
+    // the frames are emitted as soon as their ranges and onsets are known, so at most `delay_frames` of them wait
+    display_rows.transform( std::min( amount_output_frames, segment_end + delay_frames ), [&]( size_t, float const* mag_db ) {
+      std::copy_n( mag_db, display_bin_amount, delayed_mag_db.data() + ( ( pushed_frames % delay_rows ) * display_bin_amount ) );
+      onset_detector.push( mag_db );
+      if( !has_level_pass ) {
+        push_max_mag_db( mag_db );
+      }
+      pushed_frames++;
+      emit_ready_frames( segment_begin, segment_end );
+    } );
+    if( ( display_rows.next_frame() == amount_output_frames ) && !is_analysis_finished ) {
+      // the ranges and onsets of the last frames have no more frames to look ahead to
+      is_analysis_finished = true;
+      if( !has_level_pass ) {
+        display_normalizer.finish();
+      }
+      onset_detector.finish();
+    }
+    emit_ready_frames( segment_begin, segment_end );
+
+    return ( sound_frame == segment_end ) && ( bass_frame == segment_end ) && ( display_frame == segment_end );
+  };
+
+  for( size_t segment_begin = 0; segment_begin < amount_output_frames; segment_begin += segment_frame_amount ) {
+    size_t const segment_end = std::min( amount_output_frames, segment_begin + segment_frame_amount );
+    size_t const segment_frames = segment_end - segment_begin;
+
+    while( !compute_ready_frames( segment_begin, segment_end ) ) {
+      // once the stream is finished every frame is ready
+      push_chunk( read_chunk() );
+    }
+
+    // apply smoothing, the first frame continues from the last one of the previous segment
+    if( segment_begin > 0 ) {
+      float* first_row = fft_display_spectrogram.row( 0 );
+      for( size_t bin = 0; bin < display_bin_amount; bin++ ) {
+        first_row[bin] = float( ( FFT_COMPUTE_ALPHA * first_row[bin] ) + ( ( 1.0 - FFT_COMPUTE_ALPHA ) * previous_display_row[bin] ) );
+      }
+    }
+    exponential_smoothing_scan( fft_display_spectrogram.data(), segment_frames, display_bin_amount, fft_display_spectrogram.row_stride(), FFT_COMPUTE_ALPHA );
+    float const* last_row = fft_display_spectrogram.row( segment_frames - 1 );
+    std::copy( last_row, last_row + display_bin_amount, previous_display_row.begin() );
+
+    is_caching = is_caching && write_analysis_cache_frames( cache_writer, segment_begin, segment_frames );
+
+    if( !is_mapped ) {
+      // the segment is complete, so the samples of every one of its windows are there
+      audio_data_->sample_data = segment_samples.view();
+      audio_data_->sample_data_first_frame = segment_samples.first_frame();
+    }
+    render_context.first_frame = segment_begin;
+    prepare_threads( segment_begin, segment_end );
+    start_threads();
+    join_threads();
+    logger_->debug( "[render_streaming] rendered frames {} to {}", segment_begin, segment_end - 1 );
+
+    segment_samples.drop_before( get_pcm_frame_offset( segment_end ) );
+  }
+
+  if( is_caching ) {
+    if( cache_writer.commit() ) {
+      logger_->debug( "[render_streaming] analysis saved to {:?}", project_analysis_cache_path_.string() );
+    } else {
+      logger_->warn( "[render_streaming] could not write {:?}, the next render recomputes the analysis", project_analysis_cache_path_.string() );
+    }
+  }
+
+#pragma endregion render pass
+
+  logger_->trace( "[render_streaming] exit" );
+}
+
+void RegularVideoGenerator::render_streaming_from_cache( AnalysisCacheReader const& reader ) {
+  logger_->trace( "[render_streaming_from_cache] enter" );
+
+  if( !is_ready_ ) {
+    logger_->error( "[render_streaming_from_cache] generator is not ready!" );
+    return;
+  }
+
+  // the waveform of a mapped wav is drawn from the mapping, otherwise the track is decoded along with the segments
+  std::shared_ptr< MappedWavFile > mapped_wav_file = map_wav_file( project_audio_path_ );
+  std::unique_ptr< ThreadedAudioStream > audio_stream;
+  if( mapped_wav_file != nullptr ) {
+    audio_data_->sample_data = mapped_wav_file->samples();
+    audio_data_->sample_data_owner = mapped_wav_file;
+  } else {
+    std::unique_ptr< AudioStream > file_stream = open_audio_stream( project_audio_path_ );
+    if( file_stream == nullptr ) {
+      logger_->error( "[render_streaming_from_cache] can not read {:?}", project_audio_path_.string() );
+      return;
+    }
+    audio_stream = std::make_unique< ThreadedAudioStream >( std::move( file_stream ), STREAMING_DECODE_AHEAD_FRAMES );
+  }
+  uint32_t const channels = audio_data_->channels;
+  SegmentSamples segment_samples( channels );
+  std::vector< float > chunk( audio_stream ? STREAMING_CHUNK_FRAMES * channels : 0 );
+
+  prepare_surfaces();
+
+  // per frame of a segment the tables `read_analysis_cache_frames` copies out of the mapping and, if the track is not mapped, its samples
+  RegularVideoGenerator::RenderContext& render_context = *frame_information_->render_context;
+  size_t const amount_output_frames = frame_information_->amount_output_frames;
+  double const pcm_frames_per_output_frame = frame_information_->pcm_frames_per_output_frame;
+  uint64_t const pcm_frame_count = uint64_t( pcm_frames_per_output_frame * PCM_FRAME_COUNT_MULT );
+  size_t const segment_frame_bytes = ( 4 * sizeof( double ) ) + ( render_context.fft_display_spectrogram.row_stride() * sizeof( float ) ) + sizeof( MagDbRange )
+                                     + ( audio_stream ? size_t( std::ceil( pcm_frames_per_output_frame ) ) * channels * sizeof( float ) : 0 );
+  size_t const segment_frame_amount = std::clamp< size_t >( STREAMING_MEMORY_BUDGET / segment_frame_bytes, 1, std::max< size_t >( amount_output_frames, 1 ) );
+  logger_->debug( "[render_streaming_from_cache] segment_frame_amount: {}", segment_frame_amount );
+
+  int64_t const total_pcm_frame_count = int64_t( audio_data_->total_pcm_frame_count );
+  auto get_pcm_frame_offset = [&]( size_t i ) {
+    // played sample will be in the middle of the shown samples
+    return std::min< int64_t >( total_pcm_frame_count, int64_t( double( i ) * pcm_frames_per_output_frame ) - int64_t( pcm_frame_count / 2 ) );
+  };
+
+  for( size_t segment_begin = 0; segment_begin < amount_output_frames; segment_begin += segment_frame_amount ) {
+    size_t const segment_end = std::min( amount_output_frames, segment_begin + segment_frame_amount );
+    read_analysis_cache_frames( reader, segment_begin, segment_end - segment_begin );
+
+    if( audio_stream ) {
+      // decodes up to the end of the window of the last frame of the segment
+      segment_samples.drop_before( get_pcm_frame_offset( segment_begin ) );
+      int64_t const samples_end = get_pcm_frame_offset( segment_end - 1 ) + int64_t( pcm_frame_count );
+      while( segment_samples.end_frame() < samples_end ) {
+        size_t const frame_amount = audio_stream->read( chunk.data(), STREAMING_CHUNK_FRAMES );
+        if( frame_amount == 0 ) {
+          break;
+        }
+        segment_samples.push( chunk.data(), frame_amount );
+      }
+      audio_data_->sample_data = segment_samples.view();
+      audio_data_->sample_data_first_frame = segment_samples.first_frame();
+    }
+
+    render_context.first_frame = segment_begin;
+    prepare_threads( segment_begin, segment_end );
+    start_threads();
+    join_threads();
+    logger_->debug( "[render_streaming_from_cache] rendered frames {} to {}", segment_begin, segment_end - 1 );
+  }
+
+  logger_->trace( "[render_streaming_from_cache] exit" );
+}
+
+#pragma endregion streaming
+
+std::optional< uint64_t > RegularVideoGenerator::get_analysis_cache_key() {
+  logger_->trace( "[get_analysis_cache_key] enter" );
+
+  AnalysisCacheKey key;
+  key.add( "RegularVideoGenerator" ).add( ANALYSIS_CACHE_REVISION );
+  if( !key.add_file( project_audio_path_ ) ) {
+    logger_->error( "[get_analysis_cache_key] could not read {:?}", project_audio_path_.string() );
+    return std::nullopt;
+  }
+  key.add( FPS ).add( IIR_FILTER_ORDER ).add( BASS_LP_CUTOFF ).add( BASS_HP_CUTOFF ).add( BASS_MIN_SAMPLE_RATE ).add( PCM_FRAME_COUNT_MULT );
+  key.add( FFT_COMPUTE_ALPHA ).add( FFT_DISPLAY_MIN_FREQ ).add( FFT_DISPLAY_MAG_DB_RANGE ).add( FFT_DISPLAY_BIN_AMOUNT ).add( FFT_DISPLAY_SOURCE );
+  key.add( FFT_DISPLAY_FILTERBANK_BAND_AMOUNT ).add( FFT_DISPLAY_FILTERBANK_NORMALIZATION );
+  key.add( FFT_MULTI_RESOLUTION_LOW_CROSSOVER ).add( FFT_MULTI_RESOLUTION_HIGH_CROSSOVER ).add( FFT_MULTI_RESOLUTION_CROSSOVER_OCTAVES );
+  key.add( FFT_MAG_DB_NORMALIZATION_MODE ).add( FFT_MAG_DB_LOOKAHEAD_SECONDS ).add( FFT_MAG_DB_RELEASE_DB_PER_SECOND );
+  logger_->debug( "[get_analysis_cache_key] key: {:#018x}", key.value() );
+
+  logger_->trace( "[get_analysis_cache_key] exit" );
+  return key.value();
+}
+
+bool RegularVideoGenerator::open_analysis_cache( AnalysisCacheReader& reader ) {
+  logger_->trace( "[open_analysis_cache] enter" );
+
+  if( !is_ready_ ) {
+    logger_->error( "[open_analysis_cache] generator is not ready!" );
+    return false;
+  }
+  if( !ANALYSIS_CACHE_ENABLED || !analysis_cache_key_ ) {
+    logger_->trace( "[open_analysis_cache] exit: cache not used" );
+    return false;
+  }
+
+  if( !reader.open( project_analysis_cache_path_, *analysis_cache_key_ ) ) {
+    logger_->debug( "[open_analysis_cache] no analysis cache at {:?} for this audio and these constants", project_analysis_cache_path_.string() );
+    logger_->trace( "[open_analysis_cache] exit: miss" );
+    return false;
+  }
+
+  auto const summary_section = reader.section< RegularAnalysisCacheSummary >( ANALYSIS_CACHE_SUMMARY_TAG );
+  auto const sound_intensity = reader.section< double >( ANALYSIS_CACHE_SOUND_INTENSITY_TAG );
+  auto const bass_intensity = reader.section< double >( ANALYSIS_CACHE_BASS_INTENSITY_TAG );
+  auto const onset_strength = reader.section< double >( ANALYSIS_CACHE_ONSET_STRENGTH_TAG );
+  auto const beat_strength = reader.section< double >( ANALYSIS_CACHE_BEAT_STRENGTH_TAG );
+  auto const display_values = reader.section< float >( ANALYSIS_CACHE_DISPLAY_VALUES_TAG );
+  auto const display_x_axis = reader.section< float >( ANALYSIS_CACHE_DISPLAY_X_AXIS_TAG );
+  auto const display_range = reader.section< MagDbRange >( ANALYSIS_CACHE_DISPLAY_RANGE_TAG );
+  if( !summary_section || ( summary_section->size() != 1 ) ) {
+    logger_->warn( "[open_analysis_cache] {:?} has no summary, recomputing", project_analysis_cache_path_.string() );
+    return false;
+  }
+  RegularAnalysisCacheSummary const& summary = summary_section->front();
+  size_t const frame_amount = size_t( summary.amount_output_frames );
+  // no frames yet, `read_analysis_cache_frames` fills the ones being rendered
+  Spectrogram fft_display_spectrogram( 0, size_t( summary.display_bin_amount ) );
+  bool const is_complete = sound_intensity && ( sound_intensity->size() == frame_amount ) && bass_intensity && ( bass_intensity->size() == frame_amount )
+                           && onset_strength && ( onset_strength->size() == frame_amount ) && beat_strength && ( beat_strength->size() == frame_amount )
+                           && ( fft_display_spectrogram.row_stride() == summary.display_row_stride ) && display_values
+                           && ( display_values->size() == frame_amount * fft_display_spectrogram.row_stride() ) && display_x_axis
+                           && ( display_x_axis->size() == fft_display_spectrogram.bin_amount() ) && display_range
+                           && ( display_range->size() == frame_amount );
+  if( !is_complete ) {
+    logger_->warn( "[open_analysis_cache] {:?} is incomplete, recomputing", project_analysis_cache_path_.string() );
+    return false;
+  }
+
+  // the samples themselves are read by whichever render follows
+  audio_data_ = std::make_shared< RegularVideoGenerator::AudioData >();
+  audio_data_->channels = summary.channels;
+  audio_data_->sample_rate = summary.sample_rate;
+  audio_data_->total_pcm_frame_count = summary.total_pcm_frame_count;
+  audio_data_->duration = double( audio_data_->total_pcm_frame_count ) / double( audio_data_->sample_rate );
+  logger_->debug( "[open_analysis_cache] audio_data_->duration: {}", audio_data_->duration );
+
+  frame_information_ = std::make_shared< RegularVideoGenerator::FrameInformation >();
+  frame_information_->amount_output_frames = frame_amount;
+  frame_information_->pcm_frames_per_output_frame = summary.pcm_frames_per_output_frame;
+  logger_->debug( "[open_analysis_cache] frame_information_->amount_output_frames: {}", frame_information_->amount_output_frames );
+
+  frame_information_->render_context = std::make_shared< RegularVideoGenerator::RenderContext >();
+  RegularVideoGenerator::RenderContext& render_context = *frame_information_->render_context;
+  render_context.amount_output_frames = frame_amount;
+  render_context.project_temp_pictureset_path = project_temp_pictureset_path_;
+  render_context.audio_data = audio_data_;
+  fft_display_spectrogram.x_axis().assign( display_x_axis->begin(), display_x_axis->end() );
+  render_context.fft_display_spectrogram = std::move( fft_display_spectrogram );
+
+  FFT_DISPLAY_MAX_FREQ = summary.fft_display_max_freq;
+
+  logger_->trace( "[open_analysis_cache] exit: hit" );
+  return true;
+}
+
+// elements `frame_begin * per_frame` to `( frame_begin + frame_amount ) * per_frame` of a section `open_analysis_cache` checked
+template < typename T >
+static void assign_analysis_cache_frames( AnalysisCacheReader const& reader,
+                                          uint32_t tag,
+                                          size_t frame_begin,
+                                          size_t frame_amount,
+                                          size_t per_frame,
+                                          std::vector< T >& values ) {
+  std::span< T const > const frames = reader.section< T >( tag )->subspan( frame_begin * per_frame, frame_amount * per_frame );
+  values.assign( frames.begin(), frames.end() );
+}
+
+void RegularVideoGenerator::read_analysis_cache_frames( AnalysisCacheReader const& reader, size_t frame_begin, size_t frame_amount ) {
+  logger_->trace( "[read_analysis_cache_frames] enter: frame_begin: {}, frame_amount: {}", frame_begin, frame_amount );
+
+  RegularVideoGenerator::RenderContext& render_context = *frame_information_->render_context;
+  assign_analysis_cache_frames( reader, ANALYSIS_CACHE_SOUND_INTENSITY_TAG, frame_begin, frame_amount, 1, render_context.sound_intensity_per_frame );
+  assign_analysis_cache_frames( reader, ANALYSIS_CACHE_BASS_INTENSITY_TAG, frame_begin, frame_amount, 1, render_context.bass_intensity_per_frame );
+  assign_analysis_cache_frames( reader, ANALYSIS_CACHE_ONSET_STRENGTH_TAG, frame_begin, frame_amount, 1, render_context.onset_strength_per_frame );
+  assign_analysis_cache_frames( reader, ANALYSIS_CACHE_BEAT_STRENGTH_TAG, frame_begin, frame_amount, 1, render_context.beat_strength_per_frame );
+  assign_analysis_cache_frames( reader, ANALYSIS_CACHE_DISPLAY_RANGE_TAG, frame_begin, frame_amount, 1, render_context.fft_display_range_per_frame );
+
+  // same row stride, so the padded rows are one copy
+  Spectrogram const& previous_spectrogram = render_context.fft_display_spectrogram;
+  Spectrogram fft_display_spectrogram( frame_amount, previous_spectrogram.bin_amount() );
+  std::span< float const > const display_values = reader.section< float >( ANALYSIS_CACHE_DISPLAY_VALUES_TAG )
+                                                      ->subspan( frame_begin * fft_display_spectrogram.row_stride(),
+                                                                 frame_amount * fft_display_spectrogram.row_stride() );
+  std::copy( display_values.begin(), display_values.end(), fft_display_spectrogram.data() );
+  fft_display_spectrogram.x_axis() = previous_spectrogram.x_axis();
+  render_context.fft_display_spectrogram = std::move( fft_display_spectrogram );
+
+  logger_->trace( "[read_analysis_cache_frames] exit" );
+}
+
+void RegularVideoGenerator::save_analysis_cache() {
+  logger_->trace( "[save_analysis_cache] enter" );
+
+  AnalysisCacheStreamWriter writer( analysis_cache_key_.value_or( 0 ) );
+  if( !begin_analysis_cache( writer ) || !write_analysis_cache_frames( writer, 0, frame_information_->amount_output_frames ) ) {
+    logger_->trace( "[save_analysis_cache] exit: not saved" );
+    return;
+  }
+  if( writer.commit() ) {
+    logger_->debug( "[save_analysis_cache] analysis saved to {:?}", project_analysis_cache_path_.string() );
+  } else {
+    logger_->warn( "[save_analysis_cache] could not write {:?}, the next render recomputes the analysis", project_analysis_cache_path_.string() );
+  }
+
+  logger_->trace( "[save_analysis_cache] exit" );
+}
+
+bool RegularVideoGenerator::begin_analysis_cache( AnalysisCacheStreamWriter& writer ) {
+  logger_->trace( "[begin_analysis_cache] enter" );
+
+  if( !is_ready_ ) {
+    logger_->error( "[begin_analysis_cache] generator is not ready!" );
+    return false;
+  }
+  if( !ANALYSIS_CACHE_ENABLED || !analysis_cache_key_ ) {
+    logger_->trace( "[begin_analysis_cache] exit: cache not used" );
+    return false;
+  }
+
+  Spectrogram const& fft_display_spectrogram = frame_information_->render_context->fft_display_spectrogram;
+  size_t const frame_amount = frame_information_->amount_output_frames;
+  RegularAnalysisCacheSummary summary;
+  summary.channels = audio_data_->channels;
+  summary.sample_rate = audio_data_->sample_rate;
+  summary.total_pcm_frame_count = audio_data_->total_pcm_frame_count;
+  summary.amount_output_frames = frame_amount;
+  summary.pcm_frames_per_output_frame = frame_information_->pcm_frames_per_output_frame;
+  summary.fft_display_max_freq = FFT_DISPLAY_MAX_FREQ;
+  summary.display_bin_amount = fft_display_spectrogram.bin_amount();
+  summary.display_row_stride = fft_display_spectrogram.row_stride();
+
+  writer.add_section< RegularAnalysisCacheSummary >( ANALYSIS_CACHE_SUMMARY_TAG, 1 );
+  writer.add_section< double >( ANALYSIS_CACHE_SOUND_INTENSITY_TAG, frame_amount );
+  writer.add_section< double >( ANALYSIS_CACHE_BASS_INTENSITY_TAG, frame_amount );
+  writer.add_section< double >( ANALYSIS_CACHE_ONSET_STRENGTH_TAG, frame_amount );
+  writer.add_section< double >( ANALYSIS_CACHE_BEAT_STRENGTH_TAG, frame_amount );
+  writer.add_section< float >( ANALYSIS_CACHE_DISPLAY_VALUES_TAG, frame_amount * fft_display_spectrogram.row_stride() );
+  writer.add_section< float >( ANALYSIS_CACHE_DISPLAY_X_AXIS_TAG, fft_display_spectrogram.x_axis().size() );
+  writer.add_section< MagDbRange >( ANALYSIS_CACHE_DISPLAY_RANGE_TAG, frame_amount );
+  bool const is_begun = writer.open( project_analysis_cache_path_ ) && writer.write( ANALYSIS_CACHE_SUMMARY_TAG, 0, &summary, 1 )
+                        && writer.write( ANALYSIS_CACHE_DISPLAY_X_AXIS_TAG, 0, fft_display_spectrogram.x_axis() );
+  if( !is_begun ) {
+    logger_->warn( "[begin_analysis_cache] could not write {:?}, the next render recomputes the analysis", project_analysis_cache_path_.string() );
+  }
+
+  logger_->trace( "[begin_analysis_cache] exit" );
+  return is_begun;
+}
+
+bool RegularVideoGenerator::write_analysis_cache_frames( AnalysisCacheStreamWriter& writer, size_t frame_begin, size_t frame_amount ) {
+  logger_->trace( "[write_analysis_cache_frames] enter: frame_begin: {}, frame_amount: {}", frame_begin, frame_amount );
+
+  RegularVideoGenerator::RenderContext const& render_context = *frame_information_->render_context;
+  Spectrogram const& fft_display_spectrogram = render_context.fft_display_spectrogram;
+  size_t const row_stride = fft_display_spectrogram.row_stride();
+  bool const is_written
+      = writer.write( ANALYSIS_CACHE_SOUND_INTENSITY_TAG, frame_begin, render_context.sound_intensity_per_frame.data(), frame_amount )
+        && writer.write( ANALYSIS_CACHE_BASS_INTENSITY_TAG, frame_begin, render_context.bass_intensity_per_frame.data(), frame_amount )
+        && writer.write( ANALYSIS_CACHE_ONSET_STRENGTH_TAG, frame_begin, render_context.onset_strength_per_frame.data(), frame_amount )
+        && writer.write( ANALYSIS_CACHE_BEAT_STRENGTH_TAG, frame_begin, render_context.beat_strength_per_frame.data(), frame_amount )
+        && writer.write( ANALYSIS_CACHE_DISPLAY_VALUES_TAG, frame_begin * row_stride, fft_display_spectrogram.data(), frame_amount * row_stride )
+        && writer.write( ANALYSIS_CACHE_DISPLAY_RANGE_TAG, frame_begin, render_context.fft_display_range_per_frame.data(), frame_amount );
+  if( !is_written ) {
+    logger_->warn( "[write_analysis_cache_frames] could not write {:?}, the next render recomputes the analysis", project_analysis_cache_path_.string() );
+  }
+
+  logger_->trace( "[write_analysis_cache_frames] exit" );
+  return is_written;
+}
+
+MagDbNormalization RegularVideoGenerator::get_mag_db_normalization() {
+  MagDbNormalization normalization;
+  normalization.mode = FFT_MAG_DB_NORMALIZATION_MODE;
+  normalization.mag_db_range = FFT_DISPLAY_MAG_DB_RANGE;
+  normalization.lookahead_frames = size_t( std::ceil( FFT_MAG_DB_LOOKAHEAD_SECONDS * FPS ) );
+  normalization.release_db_per_frame = FFT_MAG_DB_RELEASE_DB_PER_SECOND / FPS;
+  return normalization;
+}
+
+OnsetDetection RegularVideoGenerator::get_onset_detection() {
+  OnsetDetection detection;
+  detection.frames_per_second = FPS;
+  return detection;
+}
+
 void RegularVideoGenerator::save_surface( std::shared_ptr< cairo_surface_t > surface, std::filesystem::path const& file_path ) {
   // logger_->trace( "[save_surface] enter: surface: {}, file_path: {:?}", static_cast< void* >( surface.get() ), file_path.string() );
 
@@ -566,35 +1632,34 @@ void RegularVideoGenerator::create_lowpass_for_audio_data() {
     return;
   }
 
-  uint64_t sample_amount = audio_data_->total_pcm_frame_count * audio_data_->channels;
+  pcm_sample_range( audio_data_->sample_data, audio_data_->sample_min, audio_data_->sample_max );
+  audio_data_->sample_min = std::clamp( audio_data_->sample_min, -1.0f, 1.0f );
+  audio_data_->sample_max = std::clamp( audio_data_->sample_max, -1.0f, 1.0f );
 
-  audio_data_->processed_sample_data = std::make_shared< float[] >( sample_amount );
-  memset( audio_data_->processed_sample_data.get(), 0, sample_amount * sizeof( audio_data_->processed_sample_data[0] ) );
+  audio_data_->bass_decimation_factor = get_bass_decimation_factor( audio_data_->sample_rate );
+  double const bass_sample_rate = double( audio_data_->sample_rate ) / double( audio_data_->bass_decimation_factor );
+  logger_->debug( "[create_lowpass_for_audio_data] bass_decimation_factor: {}, bass_sample_rate: {}", audio_data_->bass_decimation_factor, bass_sample_rate );
 
-  Iir::Butterworth::LowPass< IIR_FILTER_ORDER > lowpass;
-  Iir::Butterworth::HighPass< IIR_FILTER_ORDER > highpass;
+  std::vector< float > mono_sample_data;
+  for( DecimationStage const& stage : design_bass_decimation_stages( audio_data_->sample_rate, audio_data_->bass_decimation_factor ) ) {
+    mono_sample_data = decimate( mono_sample_data.empty() ? audio_data_->mono_sample_data : mono_sample_data, stage );
+  }
 
   // fill buf1 into audio_data_
-  for( uint64_t c = 0; c < audio_data_->channels; c++ ) {
-    lowpass.setup( audio_data_->sample_rate, BASS_LP_CUTOFF );
-    highpass.setup( audio_data_->sample_rate, BASS_HP_CUTOFF );
-    for( uint64_t i = 0; i < audio_data_->total_pcm_frame_count; i++ ) {
-      uint64_t sample_index = ( i * audio_data_->channels ) + c;
-
-      audio_data_->sample_min = std::min( audio_data_->sample_min, audio_data_->sample_data[sample_index] );
-      audio_data_->sample_max = std::max( audio_data_->sample_max, audio_data_->sample_data[sample_index] );
-      audio_data_->sample_min = std::clamp( audio_data_->sample_min, -1.0f, 1.0f );
-      audio_data_->sample_max = std::clamp( audio_data_->sample_max, -1.0f, 1.0f );
-
-      float lowpassed_sample = lowpass.filter( audio_data_->sample_data[sample_index] );
-      float highpassed_sample = highpass.filter( lowpassed_sample );
-      audio_data_->processed_sample_data[sample_index] = highpassed_sample;
-      audio_data_->processed_sample_min = std::min( audio_data_->processed_sample_min, audio_data_->processed_sample_data[sample_index] );
-      audio_data_->processed_sample_max = std::max( audio_data_->processed_sample_max, audio_data_->processed_sample_data[sample_index] );
-      audio_data_->processed_sample_min = std::clamp( audio_data_->processed_sample_min, -1.0f, 1.0f );
-      audio_data_->processed_sample_max = std::clamp( audio_data_->processed_sample_max, -1.0f, 1.0f );
-    }
+  audio_data_->bass_sample_data.resize( mono_sample_data.size() );
+  filter_biquad_cascade_block_parallel( create_bass_cascade( bass_sample_rate ),
+                                        mono_sample_data.data(),
+                                        audio_data_->bass_sample_data.data(),
+                                        mono_sample_data.size(),
+                                        1 );
+
+  // min/max outside of the filter recursion
+  for( float bass_sample : audio_data_->bass_sample_data ) {
+    audio_data_->bass_sample_min = std::min( audio_data_->bass_sample_min, bass_sample );
+    audio_data_->bass_sample_max = std::max( audio_data_->bass_sample_max, bass_sample );
   }
+  audio_data_->bass_sample_min = std::clamp( audio_data_->bass_sample_min, -1.0f, 1.0f );
+  audio_data_->bass_sample_max = std::clamp( audio_data_->bass_sample_max, -1.0f, 1.0f );
 
 #if defined( DO_SAVE_LOWPASS_AUDIO )
   {
@@ -602,15 +1667,15 @@ void RegularVideoGenerator::create_lowpass_for_audio_data() {
     drwav_data_format dw_fmt;
     dw_fmt.container = drwav_container::drwav_container_riff;
     dw_fmt.format = DR_WAVE_FORMAT_IEEE_FLOAT;
-    dw_fmt.channels = audio_data_->channels;
-    dw_fmt.sampleRate = audio_data_->sample_rate;
+    dw_fmt.channels = 1;
+    dw_fmt.sampleRate = uint32_t( bass_sample_rate );
     dw_fmt.bitsPerSample = 32;
     std::filesystem::path tmp_audio_path( project_path_ / fmt::format( "__filtered_{}_{}.wav", BASS_LP_CUTOFF, BASS_HP_CUTOFF ) );
     if( std::filesystem::is_regular_file( tmp_audio_path ) ) {
       std::filesystem::remove( tmp_audio_path );
     }
     if( drwav_init_file_write( &dw_obj, tmp_audio_path.string().c_str(), &dw_fmt, nullptr ) ) {
-      size_t framesWritten = drwav_write_pcm_frames( &dw_obj, audio_data_->total_pcm_frame_count, audio_data_->processed_sample_data.get() );
+      size_t framesWritten = drwav_write_pcm_frames( &dw_obj, audio_data_->bass_sample_data.size(), audio_data_->bass_sample_data.data() );
       logger_->debug( "[create_lowpass_for_audio_data] framesWritten: {}", framesWritten );
       drwav_uninit( &dw_obj );
     }
@@ -628,10 +1693,10 @@ void RegularVideoGenerator::create_epilepsy_warning() {
     return;
   }
 
-  frame_information_->common_epilepsy_warning_surface = surface_create_size( VIDEO_WIDTH, VIDEO_HEIGHT );
+  frame_information_->render_context->common_epilepsy_warning_surface = surface_create_size( VIDEO_WIDTH, VIDEO_HEIGHT );
 
   // drawing the epilepsy warning
-  surface_fill( frame_information_->common_epilepsy_warning_surface, 0.0, 0.0, 0.0, 1.0 );
+  surface_fill( frame_information_->render_context->common_epilepsy_warning_surface, 0.0, 0.0, 0.0, 1.0 );
 
   std::shared_ptr< cairo_surface_t > text_surface = surface_render_text_advanced_into_overlay( FontManager::get_font_face( EPILEPSY_WARNING_HEADER_FONT ),
                                                                                                FontManager::get_font_face( EPILEPSY_WARNING_CONTENT_FONT ),
@@ -642,19 +1707,21 @@ void RegularVideoGenerator::create_epilepsy_warning() {
                                                                                                0,
                                                                                                VIDEO_WIDTH,
                                                                                                VIDEO_HEIGHT );
-  surface_blit( text_surface, frame_information_->common_epilepsy_warning_surface, 0, 0, VIDEO_WIDTH, VIDEO_HEIGHT );
+  surface_blit( text_surface, frame_information_->render_context->common_epilepsy_warning_surface, 0, 0, VIDEO_WIDTH, VIDEO_HEIGHT );
 
 #if defined( DO_SAVE_EPILEPSY_WARNING )
   std::string tmp_str = common_epilepsy_warning_path_.string();
   std::filesystem::path epilepsy_warning_picture_path( replace( tmp_str, ".txt", ".png" ) );
 
-  save_surface( frame_information_->common_epilepsy_warning_surface, epilepsy_warning_picture_path );
+  save_surface( frame_information_->render_context->common_epilepsy_warning_surface, epilepsy_warning_picture_path );
 #endif
 
   logger_->trace( "[create_epilepsy_warning] exit" );
 }
 
-void RegularVideoGenerator::draw_samples_on_surface( std::shared_ptr< cairo_surface_t > surface, RegularVideoGenerator::ThreadInputData const& input_data ) {
+void RegularVideoGenerator::draw_samples_on_surface( std::shared_ptr< cairo_surface_t > surface,
+                                                     RegularVideoGenerator::RenderContext const& context,
+                                                     RegularVideoGenerator::FrameDescriptor const& frame ) {
   // logger_->trace( "[draw_samples_on_surface] enter: surface: {}", static_cast< void* >( surface.get() ) );
 
   if( !is_ready_ ) {
@@ -671,7 +1738,7 @@ void RegularVideoGenerator::draw_samples_on_surface( std::shared_ptr< cairo_surf
   double const surface_h = cairo_image_surface_get_height( surface.get() );
 
   double const middle_y = surface_h / 2.0;
-  double const frame_duration = double( input_data.pcm_frame_count );
+  double const frame_duration = double( frame.pcm_frame_count );
   double prev_x = 0.0;
   double prev_y = middle_y;
   double x = 0.0;
@@ -682,21 +1749,32 @@ void RegularVideoGenerator::draw_samples_on_surface( std::shared_ptr< cairo_surf
   // default is 2.0
   cairo_set_line_width( cr, 3.0 );
 
-  for( int c = audio_data_->channels - 1; c >= 0; c-- ) {
+  // the part of the window that is inside of the samples there are, the rest is silence
+  RegularVideoGenerator::AudioData const& audio_data = *context.audio_data;
+  int64_t const window_begin
+      = std::clamp< int64_t >( frame.pcm_frame_offset - audio_data.sample_data_first_frame, 0, int64_t( audio_data.sample_data.frame_amount ) );
+  int64_t const window_end = std::clamp< int64_t >( frame.pcm_frame_offset + int64_t( frame.pcm_frame_count ) - audio_data.sample_data_first_frame,
+                                                    window_begin,
+                                                    int64_t( audio_data.sample_data.frame_amount ) );
+  PcmSampleView const window = audio_data.sample_data.frames( uint64_t( window_begin ), uint64_t( window_end - window_begin ) );
+  // frame `i` of the pcm window is frame `i - window_offset` of `window`
+  int64_t const window_offset = audio_data.sample_data_first_frame + window_begin - frame.pcm_frame_offset;
+
+  for( int c = context.audio_data->channels - 1; c >= 0; c-- ) {
     prev_x = 0.0;
     prev_y = middle_y;
 
     double red = std::pow( 0.5, double( c ) );
     cairo_set_source_rgb( cr, red, 0.0, 0.0 );
 
-    for( int64_t i = 0; i < input_data.pcm_frame_count; i++ ) {
+    for( int64_t i = 0; i < frame.pcm_frame_count; i++ ) {
       x = std::round( float( surface_w ) * ( float( i ) / float( frame_duration - 1 ) ) );
 
       // range: -1.0 to 1.0
       float sample = 0.0;
-      int64_t sample_index = ( ( input_data.pcm_frame_offset + i ) * audio_data_->channels ) + c;
-      if( ( sample_index >= 0 ) && ( sample_index < ( audio_data_->total_pcm_frame_count * audio_data_->channels ) ) ) {
-        sample = audio_data_->sample_data[sample_index];
+      int64_t const window_frame = i - window_offset;
+      if( ( window_frame >= 0 ) && ( window_frame < int64_t( window.frame_amount ) ) ) {
+        sample = window[( size_t( window_frame ) * window.channels ) + c];
       }
 
       y = std::round( double( middle_y ) + ( double( middle_y ) * sample ) );
@@ -720,7 +1798,9 @@ void RegularVideoGenerator::draw_samples_on_surface( std::shared_ptr< cairo_surf
   // logger_->trace( "[draw_samples_on_surface] exit" );
 }
 
-void RegularVideoGenerator::draw_freqs_on_surface( std::shared_ptr< cairo_surface_t > surface, RegularVideoGenerator::ThreadInputData const& input_data ) {
+void RegularVideoGenerator::draw_freqs_on_surface( std::shared_ptr< cairo_surface_t > surface,
+                                                   RegularVideoGenerator::RenderContext const& context,
+                                                   RegularVideoGenerator::FrameDescriptor const& frame ) {
   // logger_->trace( "[draw_freqs_on_surface] enter: surface: {}", static_cast< void* >( surface.get() ) );
 
   if( !is_ready_ ) {
@@ -737,23 +1817,23 @@ void RegularVideoGenerator::draw_freqs_on_surface( std::shared_ptr< cairo_surfac
   double const height = cairo_image_surface_get_height( surface.get() );
 
   double const min_freq = std::max( 20.0, FFT_DISPLAY_MIN_FREQ );
-  double const max_freq = std::min( double( audio_data_->sample_rate ) / 2.0, FFT_DISPLAY_MAX_FREQ );
+  double const max_freq = std::min( double( context.audio_data->sample_rate ) / 2.0, FFT_DISPLAY_MAX_FREQ );
 
   {
+    SpectrogramRow const fft_display_row = context.fft_display_spectrogram.row_view( frame.i - context.first_frame );
+    MagDbRange const& fft_display_range = context.fft_display_range_per_frame[frame.i - context.first_frame];
     std::vector< std::pair< double, double > > freq_mags;
+    freq_mags.reserve( fft_display_row.bin_amount );
 
-    for( int64_t i = 0; i < input_data.fft_display_values->size(); i++ ) {
-      auto& pair = input_data.fft_display_values->at( i );
-
-      double norm_x = pair.first;
-      double mag_db = pair.second;
+    for( size_t bin = 0; bin < fft_display_row.bin_amount; bin++ ) {
+      double norm_x = fft_display_row.x[bin];
+      double mag_db = fft_display_row.values[bin];
 
       // Normalize
       // double norm_x = bin / FFT_DISPLAY_BIN_AMOUNT;
       // double norm_freq_log = ( std::log( freq ) - std::log( FFT_DISPLAY_MIN_FREQ ) ) / ( std::log( FFT_DISPLAY_MAX_FREQ ) - std::log( FFT_DISPLAY_MIN_FREQ )
       // );
-      double norm_mag = ( mag_db - FFT_DISPLAY_MIN_MAG_DB ) / ( FFT_DISPLAY_MAX_MAG_DB - FFT_DISPLAY_MIN_MAG_DB );
-      norm_mag = std::clamp( norm_mag, 0.0, 1.0 );
+      double norm_mag = fft_display_range.normalize( mag_db );
 
       freq_mags.emplace_back( norm_x, norm_mag );
     }
@@ -828,8 +1908,9 @@ void RegularVideoGenerator::draw_freqs_on_surface( std::shared_ptr< cairo_surfac
   // logger_->trace( "[draw_freqs_on_surface] exit" );
 }
 
-void RegularVideoGenerator::thread_run( std::vector< RegularVideoGenerator::ThreadInputData > inputs ) {
-  logger_->trace( "[thread_run] enter: inputs: [{} items]", inputs.size() );
+void RegularVideoGenerator::thread_run( RegularVideoGenerator::RenderContext const& context,
+                                        std::vector< RegularVideoGenerator::FrameDescriptor > const& frames ) {
+  logger_->trace( "[thread_run] enter: frames: [{} items]", frames.size() );
 
   if( !is_ready_ ) {
     logger_->error( "[thread_run] generator is not ready!" );
@@ -854,42 +1935,28 @@ void RegularVideoGenerator::thread_run( std::vector< RegularVideoGenerator::Thre
   dynamic_freqs_dest_rect.width = cairo_image_surface_get_width( dynamic_freqs_surface.get() );
   dynamic_freqs_dest_rect.height = cairo_image_surface_get_height( dynamic_freqs_surface.get() );
 
-  for( ThreadInputData input_data : inputs ) {
-    logger_->trace( "[thread_run] computing input {}", input_data.i );
+  for( FrameDescriptor const& frame : frames ) {
+    logger_->trace( "[thread_run] computing frame {}", frame.i );
     std::shared_ptr< cairo_surface_t > frame_surface_to_save = surface_create_size( VIDEO_WIDTH, VIDEO_HEIGHT );
     surface_fill( frame_surface_to_save, 0.0, 0.0, 0.0, 1.0 );
 
     double epilepsy_warning_alpha = 0.0;
-    if( input_data.i < size_t( EPILEPSY_WARNING_VISIBLE_SECONDS * FPS ) ) {
+    if( frame.i < size_t( EPILEPSY_WARNING_VISIBLE_SECONDS * FPS ) ) {
       epilepsy_warning_alpha = 1.0;
-    } else if( input_data.i >= size_t( ( EPILEPSY_WARNING_VISIBLE_SECONDS + EPILEPSY_WARNING_FADEOUT_SECONDS ) * FPS ) ) {
+    } else if( frame.i >= size_t( ( EPILEPSY_WARNING_VISIBLE_SECONDS + EPILEPSY_WARNING_FADEOUT_SECONDS ) * FPS ) ) {
       epilepsy_warning_alpha = 0.0;
     } else {
-      epilepsy_warning_alpha = 1.0 - ( ( ( double( input_data.i ) / FPS ) - EPILEPSY_WARNING_VISIBLE_SECONDS ) / EPILEPSY_WARNING_FADEOUT_SECONDS );
+      epilepsy_warning_alpha = 1.0 - ( ( ( double( frame.i ) / FPS ) - EPILEPSY_WARNING_VISIBLE_SECONDS ) / EPILEPSY_WARNING_FADEOUT_SECONDS );
       epilepsy_warning_alpha = std::clamp( epilepsy_warning_alpha, 0.0, 1.0 );
     }
 
-    double bass_rms_sum_value = 0.0;
-    double rms_sum_value = 0.0;
-    for( int64_t i = 0; i <= input_data.pcm_frame_count; i++ ) {
-      for( int64_t c = 0; c <= input_data.audio_data_ptr->channels; c++ ) {
-        int64_t sample_index = ( ( input_data.pcm_frame_offset + i ) * input_data.audio_data_ptr->channels ) + c;
-        double bass_sample = 0.0;
-        double sound_sample = 0.0;
-        if( ( sample_index >= 0 ) && ( sample_index < ( input_data.audio_data_ptr->total_pcm_frame_count * input_data.audio_data_ptr->channels ) ) ) {
-          bass_sample = input_data.audio_data_ptr->processed_sample_data[sample_index];
-          sound_sample = input_data.audio_data_ptr->sample_data[sample_index];
-        }
-        bass_sample = std::clamp( bass_sample, -1.0, 1.0 );
-        sound_sample = std::clamp( sound_sample, -1.0, 1.0 );
-
-        bass_rms_sum_value += bass_sample * bass_sample;
-        rms_sum_value += sound_sample * sound_sample;
-      }
-    }
-
-    double const bass_intensity = std::sqrt( bass_rms_sum_value / ( double( input_data.audio_data_ptr->channels ) * double( input_data.pcm_frame_count ) ) );
-    double const sound_intensity = std::sqrt( rms_sum_value / ( double( input_data.audio_data_ptr->channels ) * double( input_data.pcm_frame_count ) ) );
+    double const bass_intensity = context.bass_intensity_per_frame[frame.i - context.first_frame];
+    double const sound_intensity = context.sound_intensity_per_frame[frame.i - context.first_frame];
+    // the shake kicks on beats and hits and settles in between. the strengths are relative to the tempo window, so they only shape
+    // the bass level, which keeps the shake as loud as the track and never beyond the bass alone
+    double const beat_intensity
+        = std::max( context.beat_strength_per_frame[frame.i - context.first_frame], context.onset_strength_per_frame[frame.i - context.first_frame] );
+    double const shake_intensity = bass_intensity * std::lerp( 1.0, beat_intensity, SHAKE_BEAT_WEIGHT );
     double const circle_intensity_scale = 0.5;
     double const colour_displace_intensity_scale = 0.15;
 
@@ -898,27 +1965,27 @@ void RegularVideoGenerator::thread_run( std::vector< RegularVideoGenerator::Thre
     // double const circle_intensity_scale = 0.5;
     // double const colour_displace_intensity_scale = 0.15;
 
-    project_common_circle_dest_rect.width = double( cairo_image_surface_get_width( input_data.common_circle_surface.get() ) )
+    project_common_circle_dest_rect.width = double( cairo_image_surface_get_width( context.common_circle_surface.get() ) )
                                             * ( ( 1.0 - circle_intensity_scale ) + ( sound_intensity * circle_intensity_scale ) );
     project_common_circle_dest_rect.width = project_common_circle_dest_rect.width * ( double( VIDEO_WIDTH ) / 1920.0 );
     project_common_circle_dest_rect.height = project_common_circle_dest_rect.width;
-    project_common_circle_dest_rect.x = 114.5 + ( ( 1804.5 - 114.5 ) * ( double( input_data.i ) / double( input_data.amount_output_frames ) ) )
+    project_common_circle_dest_rect.x = 114.5 + ( ( 1804.5 - 114.5 ) * ( double( frame.i ) / double( context.amount_output_frames ) ) )
                                         - ( project_common_circle_dest_rect.width / 2.0 );
     project_common_circle_dest_rect.y = 964.5 - ( project_common_circle_dest_rect.height / 2.0 );
 
     try {
-      draw_samples_on_surface( dynamic_waves_surface, input_data );
+      draw_samples_on_surface( dynamic_waves_surface, context, frame );
     } catch( std::exception const& e ) {
       logger_->error( "[thread_run] error in draw_samples_on_surface: {}", e.what() );
     }
     try {
-      draw_freqs_on_surface( dynamic_freqs_surface, input_data );
+      draw_freqs_on_surface( dynamic_freqs_surface, context, frame );
     } catch( std::exception const& e ) {
       logger_->error( "[thread_run] error in draw_freqs_on_surface: {}", e.what() );
     }
 
     // make copy of bg, put waves and freqs and circle on copy, put copy on canvas, shakily
-    std::shared_ptr< cairo_surface_t > copied_bg_surface = surface_copy( input_data.common_bg_surface );
+    std::shared_ptr< cairo_surface_t > copied_bg_surface = surface_copy( context.common_bg_surface );
     surface_blit( dynamic_waves_surface,
                   copied_bg_surface,
                   dynamic_waves_dest_rect.x,
@@ -931,27 +1998,27 @@ void RegularVideoGenerator::thread_run( std::vector< RegularVideoGenerator::Thre
                   dynamic_freqs_dest_rect.y,
                   dynamic_freqs_dest_rect.width,
                   dynamic_freqs_dest_rect.height );
-    surface_blit( input_data.common_circle_surface,
+    surface_blit( context.common_circle_surface,
                   copied_bg_surface,
                   project_common_circle_dest_rect.x,
                   project_common_circle_dest_rect.y,
                   project_common_circle_dest_rect.width,
                   project_common_circle_dest_rect.height );
 
-    surface_shake_and_blit( copied_bg_surface, frame_surface_to_save, ( colour_displace_intensity_scale * bass_intensity ), true );
+    surface_shake_and_blit( copied_bg_surface, frame_surface_to_save, ( colour_displace_intensity_scale * shake_intensity ), true );
     copied_bg_surface.reset();
 
     // put art on canvas, shakily
-    surface_shake_and_blit( input_data.project_art_surface, frame_surface_to_save, ( colour_displace_intensity_scale * bass_intensity ) );
+    surface_shake_and_blit( context.project_art_surface, frame_surface_to_save, ( colour_displace_intensity_scale * shake_intensity ) );
 
     // put title on canvas, shakily
-    surface_shake_and_blit( input_data.static_text_surface, frame_surface_to_save, ( colour_displace_intensity_scale * bass_intensity ) );
+    surface_shake_and_blit( context.static_text_surface, frame_surface_to_save, ( colour_displace_intensity_scale * shake_intensity ) );
 
     // put warning on top, with alpha
-    surface_blit( input_data.common_epilepsy_warning_surface, frame_surface_to_save, 0, 0, VIDEO_WIDTH, VIDEO_HEIGHT, epilepsy_warning_alpha );
+    surface_blit( context.common_epilepsy_warning_surface, frame_surface_to_save, 0, 0, VIDEO_WIDTH, VIDEO_HEIGHT, epilepsy_warning_alpha );
 
     // save canvas
-    save_surface( frame_surface_to_save, input_data.project_temp_pictureset_picture_path );
+    save_surface( frame_surface_to_save, context.project_temp_pictureset_path / fmt::format( "{}.png", frame.i ) );
     frame_surface_to_save.reset();
   }
 
@@ -0,0 +1,245 @@
+#include "spectralKernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+#if defined( __SSE__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && ( _M_IX86_FP >= 1 ) )
+#include <xmmintrin.h>
+#define SPECTRAL_KERNELS_SSE
+#endif
+#if defined( __AVX2__ )
+#include <immintrin.h>
+#define SPECTRAL_KERNELS_AVX2
+#elif defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && ( _M_IX86_FP >= 2 ) )
+#include <emmintrin.h>
+#define SPECTRAL_KERNELS_SSE2
+#elif defined( __ARM_NEON ) && defined( __aarch64__ )
+#include <arm_neon.h>
+#define SPECTRAL_KERNELS_NEON
+#endif
+
+void complex_magnitudes( fftwf_complex const* bins, float* magnitudes, size_t amount ) {
+  float const* interleaved = &bins[0][0];
+  size_t i = 0;
+#if defined( SPECTRAL_KERNELS_SSE )
+  for( ; i + 4 <= amount; i += 4 ) {
+    // re0 im0 re1 im1 | re2 im2 re3 im3 -> re0 re1 re2 re3 + im0 im1 im2 im3
+    __m128 const a = _mm_loadu_ps( interleaved + ( 2 * i ) );
+    __m128 const b = _mm_loadu_ps( interleaved + ( 2 * i ) + 4 );
+    __m128 const re = _mm_shuffle_ps( a, b, _MM_SHUFFLE( 2, 0, 2, 0 ) );
+    __m128 const im = _mm_shuffle_ps( a, b, _MM_SHUFFLE( 3, 1, 3, 1 ) );
+    _mm_storeu_ps( magnitudes + i, _mm_sqrt_ps( _mm_add_ps( _mm_mul_ps( re, re ), _mm_mul_ps( im, im ) ) ) );
+  }
+#endif
+  for( ; i < amount; i++ ) {
+    float re = interleaved[2 * i];
+    float im = interleaved[( 2 * i ) + 1];
+    magnitudes[i] = std::sqrt( ( re * re ) + ( im * im ) );
+  }
+}
+
+std::complex< float > complex_dot( fftwf_complex const* bins, std::complex< float > const* weights, size_t amount ) {
+  float const* interleaved = &bins[0][0];
+  float const* interleaved_weights = reinterpret_cast< float const* >( weights );
+  float re = 0.0f;
+  float im = 0.0f;
+  size_t i = 0;
+#if defined( SPECTRAL_KERNELS_SSE )
+  // `straight` collects re * wr, im * wi and `crossed` re * wi, im * wr of two values at a time
+  __m128 straight = _mm_setzero_ps();
+  __m128 crossed = _mm_setzero_ps();
+  for( ; i + 2 <= amount; i += 2 ) {
+    __m128 const x = _mm_loadu_ps( interleaved + ( 2 * i ) );
+    __m128 const w = _mm_loadu_ps( interleaved_weights + ( 2 * i ) );
+    straight = _mm_add_ps( straight, _mm_mul_ps( x, w ) );
+    crossed = _mm_add_ps( crossed, _mm_mul_ps( x, _mm_shuffle_ps( w, w, _MM_SHUFFLE( 2, 3, 0, 1 ) ) ) );
+  }
+  float straight_lanes[4];
+  float crossed_lanes[4];
+  _mm_storeu_ps( straight_lanes, straight );
+  _mm_storeu_ps( crossed_lanes, crossed );
+  re = ( straight_lanes[0] - straight_lanes[1] ) + ( straight_lanes[2] - straight_lanes[3] );
+  im = ( crossed_lanes[0] + crossed_lanes[1] ) + ( crossed_lanes[2] + crossed_lanes[3] );
+#endif
+  for( ; i < amount; i++ ) {
+    float const x_re = interleaved[2 * i];
+    float const x_im = interleaved[( 2 * i ) + 1];
+    float const w_re = interleaved_weights[2 * i];
+    float const w_im = interleaved_weights[( 2 * i ) + 1];
+    re += ( x_re * w_re ) - ( x_im * w_im );
+    im += ( x_re * w_im ) + ( x_im * w_re );
+  }
+  return std::complex< float >( re, im );
+}
+
+float dot_product( float const* a, float const* b, size_t amount ) {
+  float sum = 0.0f;
+  size_t i = 0;
+#if defined( SPECTRAL_KERNELS_SSE )
+  // two accumulators, so consecutive adds do not wait on each other
+  __m128 sum_0 = _mm_setzero_ps();
+  __m128 sum_1 = _mm_setzero_ps();
+  for( ; i + 8 <= amount; i += 8 ) {
+    sum_0 = _mm_add_ps( sum_0, _mm_mul_ps( _mm_loadu_ps( a + i ), _mm_loadu_ps( b + i ) ) );
+    sum_1 = _mm_add_ps( sum_1, _mm_mul_ps( _mm_loadu_ps( a + i + 4 ), _mm_loadu_ps( b + i + 4 ) ) );
+  }
+  float lanes[4];
+  _mm_storeu_ps( lanes, _mm_add_ps( sum_0, sum_1 ) );
+  sum = ( lanes[0] + lanes[1] ) + ( lanes[2] + lanes[3] );
+#endif
+  for( ; i < amount; i++ ) {
+    sum += a[i] * b[i];
+  }
+  return sum;
+}
+
+float rectified_flux( float const* current, float const* previous, size_t amount ) {
+  float sum = 0.0f;
+  size_t i = 0;
+#if defined( SPECTRAL_KERNELS_SSE )
+  __m128 const zero = _mm_setzero_ps();
+  __m128 sum_0 = _mm_setzero_ps();
+  __m128 sum_1 = _mm_setzero_ps();
+  for( ; i + 8 <= amount; i += 8 ) {
+    sum_0 = _mm_add_ps( sum_0, _mm_max_ps( _mm_sub_ps( _mm_loadu_ps( current + i ), _mm_loadu_ps( previous + i ) ), zero ) );
+    sum_1 = _mm_add_ps( sum_1, _mm_max_ps( _mm_sub_ps( _mm_loadu_ps( current + i + 4 ), _mm_loadu_ps( previous + i + 4 ) ), zero ) );
+  }
+  float lanes[4];
+  _mm_storeu_ps( lanes, _mm_add_ps( sum_0, sum_1 ) );
+  sum = ( lanes[0] + lanes[1] ) + ( lanes[2] + lanes[3] );
+#endif
+  for( ; i < amount; i++ ) {
+    sum += std::max( current[i] - previous[i], 0.0f );
+  }
+  return sum;
+}
+
+#pragma region amplitude to dB
+
+// 20 / ln( 10 )
+static float const DB_PER_NEPER = 8.68588963806503655f;
+static float const LN_2 = 0.693147180559945309f;
+static float const SQRT_2 = 1.41421356237309505f;
+static float const MIN_AMPLITUDE = 1e-12f;
+static uint32_t const MANTISSA_MASK = 0x007fffff;
+static uint32_t const EXPONENT_ZERO = 0x3f800000;
+
+// `x = 2^e * m` with `m` in `[sqrt( 0.5 ), sqrt( 2 ))`, `ln( m ) = 2 atanh( s )` with `s = ( m - 1 ) / ( m + 1 )` in `[-0.1716, 0.1716]`.
+// the series `2 ( s + s^3 / 3 + s^5 / 5 )` is off by less than `2 s^7 / ( 7 ( 1 - s^2 ) ) < 1.4e-6` neper, that is 1.2e-5 dB.
+// together with the float rounding of `e * ln( 2 )` the error stays below 1e-4 dB over the whole float range.
+static float fast_amplitude_to_db( float amplitude ) {
+  amplitude = std::max( amplitude, MIN_AMPLITUDE );
+  uint32_t bits;
+  std::memcpy( &bits, &amplitude, sizeof( bits ) );
+  float exponent = float( int32_t( bits >> 23 ) - 127 );
+  bits = ( bits & MANTISSA_MASK ) | EXPONENT_ZERO;
+  float mantissa;
+  std::memcpy( &mantissa, &bits, sizeof( mantissa ) );
+  if( mantissa > SQRT_2 ) {
+    mantissa *= 0.5f;
+    exponent += 1.0f;
+  }
+  float const s = ( mantissa - 1.0f ) / ( mantissa + 1.0f );
+  float const s2 = s * s;
+  float const ln_mantissa = 2.0f * s * ( 1.0f + ( s2 * ( ( 1.0f / 3.0f ) + ( s2 * ( 1.0f / 5.0f ) ) ) ) );
+  return DB_PER_NEPER * ( ( exponent * LN_2 ) + ln_mantissa );
+}
+
+void amplitude_to_db( float const* amplitudes, float const* gains, float* db, size_t amount ) {
+  size_t i = 0;
+#if defined( SPECTRAL_KERNELS_AVX2 )
+  __m256 const min_amplitude = _mm256_set1_ps( MIN_AMPLITUDE );
+  __m256i const mantissa_mask = _mm256_set1_epi32( int32_t( MANTISSA_MASK ) );
+  __m256i const exponent_zero = _mm256_set1_epi32( int32_t( EXPONENT_ZERO ) );
+  __m256i const exponent_bias = _mm256_set1_epi32( 127 );
+  __m256 const sqrt_2 = _mm256_set1_ps( SQRT_2 );
+  __m256 const one = _mm256_set1_ps( 1.0f );
+  __m256 const half = _mm256_set1_ps( 0.5f );
+  for( ; i + 8 <= amount; i += 8 ) {
+    __m256 x = _mm256_loadu_ps( amplitudes + i );
+    if( gains ) {
+      x = _mm256_mul_ps( x, _mm256_loadu_ps( gains + i ) );
+    }
+    __m256i const bits = _mm256_castps_si256( _mm256_max_ps( x, min_amplitude ) );
+    __m256 exponent = _mm256_cvtepi32_ps( _mm256_sub_epi32( _mm256_srli_epi32( bits, 23 ), exponent_bias ) );
+    __m256 mantissa = _mm256_castsi256_ps( _mm256_or_si256( _mm256_and_si256( bits, mantissa_mask ), exponent_zero ) );
+    __m256 const above = _mm256_cmp_ps( mantissa, sqrt_2, _CMP_GT_OQ );
+    mantissa = _mm256_blendv_ps( mantissa, _mm256_mul_ps( mantissa, half ), above );
+    exponent = _mm256_add_ps( exponent, _mm256_and_ps( above, one ) );
+    __m256 const s = _mm256_div_ps( _mm256_sub_ps( mantissa, one ), _mm256_add_ps( mantissa, one ) );
+    __m256 const s2 = _mm256_mul_ps( s, s );
+    __m256 series = _mm256_add_ps( _mm256_set1_ps( 1.0f / 3.0f ), _mm256_mul_ps( s2, _mm256_set1_ps( 1.0f / 5.0f ) ) );
+    series = _mm256_add_ps( one, _mm256_mul_ps( s2, series ) );
+    __m256 const ln_mantissa = _mm256_mul_ps( _mm256_add_ps( s, s ), series );
+    __m256 const ln = _mm256_add_ps( _mm256_mul_ps( exponent, _mm256_set1_ps( LN_2 ) ), ln_mantissa );
+    _mm256_storeu_ps( db + i, _mm256_mul_ps( ln, _mm256_set1_ps( DB_PER_NEPER ) ) );
+  }
+#elif defined( SPECTRAL_KERNELS_SSE2 )
+  __m128 const min_amplitude = _mm_set1_ps( MIN_AMPLITUDE );
+  __m128i const mantissa_mask = _mm_set1_epi32( int32_t( MANTISSA_MASK ) );
+  __m128i const exponent_zero = _mm_set1_epi32( int32_t( EXPONENT_ZERO ) );
+  __m128i const exponent_bias = _mm_set1_epi32( 127 );
+  __m128 const sqrt_2 = _mm_set1_ps( SQRT_2 );
+  __m128 const one = _mm_set1_ps( 1.0f );
+  __m128 const half = _mm_set1_ps( 0.5f );
+  for( ; i + 4 <= amount; i += 4 ) {
+    __m128 x = _mm_loadu_ps( amplitudes + i );
+    if( gains ) {
+      x = _mm_mul_ps( x, _mm_loadu_ps( gains + i ) );
+    }
+    __m128i const bits = _mm_castps_si128( _mm_max_ps( x, min_amplitude ) );
+    __m128 exponent = _mm_cvtepi32_ps( _mm_sub_epi32( _mm_srli_epi32( bits, 23 ), exponent_bias ) );
+    __m128 mantissa = _mm_castsi128_ps( _mm_or_si128( _mm_and_si128( bits, mantissa_mask ), exponent_zero ) );
+    __m128 const above = _mm_cmpgt_ps( mantissa, sqrt_2 );
+    mantissa = _mm_or_ps( _mm_andnot_ps( above, mantissa ), _mm_and_ps( above, _mm_mul_ps( mantissa, half ) ) );
+    exponent = _mm_add_ps( exponent, _mm_and_ps( above, one ) );
+    __m128 const s = _mm_div_ps( _mm_sub_ps( mantissa, one ), _mm_add_ps( mantissa, one ) );
+    __m128 const s2 = _mm_mul_ps( s, s );
+    __m128 series = _mm_add_ps( _mm_set1_ps( 1.0f / 3.0f ), _mm_mul_ps( s2, _mm_set1_ps( 1.0f / 5.0f ) ) );
+    series = _mm_add_ps( one, _mm_mul_ps( s2, series ) );
+    __m128 const ln_mantissa = _mm_mul_ps( _mm_add_ps( s, s ), series );
+    __m128 const ln = _mm_add_ps( _mm_mul_ps( exponent, _mm_set1_ps( LN_2 ) ), ln_mantissa );
+    _mm_storeu_ps( db + i, _mm_mul_ps( ln, _mm_set1_ps( DB_PER_NEPER ) ) );
+  }
+#elif defined( SPECTRAL_KERNELS_NEON )
+  float32x4_t const min_amplitude = vdupq_n_f32( MIN_AMPLITUDE );
+  uint32x4_t const mantissa_mask = vdupq_n_u32( MANTISSA_MASK );
+  uint32x4_t const exponent_zero = vdupq_n_u32( EXPONENT_ZERO );
+  int32x4_t const exponent_bias = vdupq_n_s32( 127 );
+  float32x4_t const sqrt_2 = vdupq_n_f32( SQRT_2 );
+  float32x4_t const one = vdupq_n_f32( 1.0f );
+  for( ; i + 4 <= amount; i += 4 ) {
+    float32x4_t x = vld1q_f32( amplitudes + i );
+    if( gains ) {
+      x = vmulq_f32( x, vld1q_f32( gains + i ) );
+    }
+    uint32x4_t const bits = vreinterpretq_u32_f32( vmaxq_f32( x, min_amplitude ) );
+    float32x4_t exponent = vcvtq_f32_s32( vsubq_s32( vreinterpretq_s32_u32( vshrq_n_u32( bits, 23 ) ), exponent_bias ) );
+    float32x4_t mantissa = vreinterpretq_f32_u32( vorrq_u32( vandq_u32( bits, mantissa_mask ), exponent_zero ) );
+    uint32x4_t const above = vcgtq_f32( mantissa, sqrt_2 );
+    mantissa = vbslq_f32( above, vmulq_n_f32( mantissa, 0.5f ), mantissa );
+    exponent = vaddq_f32( exponent, vreinterpretq_f32_u32( vandq_u32( above, vreinterpretq_u32_f32( one ) ) ) );
+    float32x4_t const s = vdivq_f32( vsubq_f32( mantissa, one ), vaddq_f32( mantissa, one ) );
+    float32x4_t const s2 = vmulq_f32( s, s );
+    float32x4_t series = vaddq_f32( vdupq_n_f32( 1.0f / 3.0f ), vmulq_n_f32( s2, 1.0f / 5.0f ) );
+    series = vaddq_f32( one, vmulq_f32( s2, series ) );
+    float32x4_t const ln_mantissa = vmulq_f32( vaddq_f32( s, s ), series );
+    float32x4_t const ln = vaddq_f32( vmulq_n_f32( exponent, LN_2 ), ln_mantissa );
+    vst1q_f32( db + i, vmulq_n_f32( ln, DB_PER_NEPER ) );
+  }
+#endif
+  for( ; i < amount; i++ ) {
+    db[i] = fast_amplitude_to_db( gains ? amplitudes[i] * gains[i] : amplitudes[i] );
+  }
+}
+
+void amplitude_to_db_reference( float const* amplitudes, float const* gains, float* db, size_t amount ) {
+  for( size_t i = 0; i < amount; i++ ) {
+    double const amplitude = gains ? double( amplitudes[i] * gains[i] ) : double( amplitudes[i] );
+    db[i] = float( 20.0 * std::log10( std::max( amplitude, double( MIN_AMPLITUDE ) ) ) );
+  }
+}
+
+#pragma endregion amplitude to dB
@@ -0,0 +1,27 @@
+#include "spectrogram.h"
+
+#include <algorithm>
+#include <new>
+
+size_t const Spectrogram::ALIGNMENT = 64;
+
+Spectrogram::Spectrogram( size_t frame_amount, size_t bin_amount ) : frame_amount_( frame_amount ), bin_amount_( bin_amount ), x_axis_( bin_amount, 0.0f ) {
+  size_t const floats_per_line = ALIGNMENT / sizeof( float );
+  row_stride_ = ( ( bin_amount + floats_per_line - 1 ) / floats_per_line ) * floats_per_line;
+  size_t const value_amount = std::max< size_t >( 1, frame_amount_ * row_stride_ );
+  values_.reset( static_cast< float* >( ::operator new[]( value_amount * sizeof( float ), std::align_val_t( ALIGNMENT ) ) ) );
+  // the padding is never read, but stays deterministic
+  std::fill( values_.get(), values_.get() + value_amount, 0.0f );
+}
+
+SpectrogramRow Spectrogram::row_view( size_t frame ) const {
+  SpectrogramRow view;
+  view.x = x_axis_.data();
+  view.values = row( frame );
+  view.bin_amount = bin_amount_;
+  return view;
+}
+
+void Spectrogram::AlignedDeleter::operator()( float* p ) const {
+  ::operator delete[]( p, std::align_val_t( Spectrogram::ALIGNMENT ) );
+}
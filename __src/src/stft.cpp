@@ -0,0 +1,171 @@
+#include "stft.h"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+#include "downmix.h"
+
+StftLayout StftLayout::from_window( size_t window_size, double hop ) {
+  StftLayout layout;
+  layout.window_size = window_size;
+  layout.fft_size = 1;
+  while( layout.fft_size < window_size ) {
+    layout.fft_size = layout.fft_size << 1;
+  }
+  layout.hop = hop;
+  return layout;
+}
+
+int64_t StftLayout::frame_begin( size_t frame ) const {
+  // played sample will be in the middle of the shown samples
+  return int64_t( double( frame ) * hop ) - int64_t( window_size / 2 );
+}
+
+void stft_window_frame( StftLayout const& layout, size_t frame, float const* samples, size_t sample_amount, float const* window, float* output ) {
+  int64_t const frame_begin = layout.frame_begin( frame );
+  // only the part of the window that overlaps the track is non zero
+  int64_t const si_begin = std::clamp< int64_t >( -frame_begin, 0, int64_t( layout.window_size ) );
+  int64_t const si_end = std::clamp< int64_t >( int64_t( sample_amount ) - frame_begin, si_begin, int64_t( layout.window_size ) );
+  std::fill( output, output + si_begin, 0.0f );
+  if( si_end > si_begin ) {
+    multiply_window( samples + frame_begin + si_begin, window + si_begin, output + si_begin, size_t( si_end - si_begin ) );
+  }
+  std::fill( output + si_end, output + layout.fft_size, 0.0f );
+}
+
+#pragma region SampleRingBuffer
+
+SampleRingBuffer::SampleRingBuffer( size_t capacity ) {
+  reserve( capacity );
+}
+
+void SampleRingBuffer::reserve( size_t capacity ) {
+  size_t new_capacity = 1;
+  while( new_capacity < capacity ) {
+    new_capacity = new_capacity << 1;
+  }
+  if( new_capacity <= samples_.size() ) {
+    return;
+  }
+  // the newest samples move to where their positions map in the larger buffer
+  std::vector< float > new_samples( new_capacity, 0.0f );
+  size_t const kept_amount = size_t( std::min< int64_t >( end_position_, int64_t( samples_.size() ) ) );
+  for( int64_t position = end_position_ - int64_t( kept_amount ); position < end_position_; position++ ) {
+    new_samples[size_t( position ) & ( new_capacity - 1 )] = samples_[size_t( position ) & mask_];
+  }
+  samples_ = std::move( new_samples );
+  mask_ = new_capacity - 1;
+}
+
+void SampleRingBuffer::push( float const* samples, size_t amount ) {
+  // only the newest `capacity` samples survive anyway
+  size_t const skipped = amount > samples_.size() ? amount - samples_.size() : 0;
+  end_position_ += int64_t( skipped );
+  for( size_t i = skipped; i < amount; ) {
+    size_t const index = size_t( end_position_ ) & mask_;
+    size_t const run = std::min( amount - i, samples_.size() - index );
+    std::copy( samples + i, samples + i + run, samples_.data() + index );
+    end_position_ += int64_t( run );
+    i += run;
+  }
+}
+
+void SampleRingBuffer::read( int64_t position, float* output, size_t amount ) const {
+  for( size_t i = 0; i < amount; i++ ) {
+    int64_t const p = position + int64_t( i );
+    output[i] = ( ( p < 0 ) || ( p >= end_position_ ) ) ? 0.0f : samples_[size_t( p ) & mask_];
+  }
+}
+
+#pragma endregion SampleRingBuffer
+
+#pragma region StftEngine
+
+StftEngine::StftEngine( StftLayout const& layout, std::vector< float > window )
+    : layout_( layout ), window_( std::move( window ) ), input_( layout.window_size + size_t( std::ceil( layout.hop ) ) ) {}
+
+void StftEngine::push( float const* samples, size_t amount ) {
+  // everything from the start of the next frame on is still needed
+  int64_t const needed_begin = std::max< int64_t >( 0, layout_.frame_begin( next_frame_ ) );
+  int64_t const needed_amount = input_.end_position() + int64_t( amount ) - needed_begin;
+  if( needed_amount > int64_t( input_.capacity() ) ) {
+    input_.reserve( size_t( needed_amount ) );
+  }
+  input_.push( samples, amount );
+}
+
+void StftEngine::finish() {
+  is_finished_ = true;
+}
+
+bool StftEngine::pop_frame( float* output ) {
+  int64_t const frame_begin = layout_.frame_begin( next_frame_ );
+  int64_t const frame_end = frame_begin + int64_t( layout_.window_size );
+  if( !is_finished_ && ( frame_end > input_.end_position() ) ) {
+    return false;
+  }
+  if( is_finished_ && ( frame_begin >= input_.end_position() ) ) {
+    return false;
+  }
+
+  input_.read( frame_begin, output, layout_.window_size );
+  multiply_window( output, window_.data(), output, layout_.window_size );
+  std::fill( output + layout_.window_size, output + layout_.fft_size, 0.0f );
+  next_frame_++;
+  return true;
+}
+
+#pragma endregion StftEngine
+
+#pragma region SlidingDft
+
+SlidingDft::SlidingDft( StftLayout const& layout, std::vector< double > const& window_coefficients, size_t bin_begin, size_t bin_end )
+    : window_size_( layout.window_size ),
+      bin_amount_( bin_end - bin_begin ),
+      window_coefficients_( window_coefficients ),
+      history_( layout.window_size, 0.0f ) {
+  int64_t const spread = int64_t( window_coefficients_.size() ) - 1;
+  for( int64_t k = int64_t( bin_begin ) - spread; k < int64_t( bin_end ) + spread; k++ ) {
+    double const omega = 2.0 * std::numbers::pi * double( k ) / double( layout.fft_size );
+    accumulators_.emplace_back( 0.0, 0.0 );
+    shift_twiddles_.push_back( std::polar( 1.0, omega ) );
+    newest_twiddles_.push_back( std::polar( 1.0, -omega * double( window_size_ - 1 ) ) );
+  }
+}
+
+void SlidingDft::push( float const* samples, size_t amount ) {
+  for( size_t i = 0; i < amount; i++ ) {
+    // `Y( n ) = e^( j w ) * ( Y( n - 1 ) - x( n - window_size ) ) + x( n ) * e^( -j w ( window_size - 1 ) )`
+    double const oldest = history_[history_position_];
+    double const newest = samples[i];
+    history_[history_position_] = samples[i];
+    history_position_ = ( history_position_ + 1 ) % window_size_;
+    for( size_t a = 0; a < accumulators_.size(); a++ ) {
+      accumulators_[a] = ( shift_twiddles_[a] * ( accumulators_[a] - oldest ) ) + ( newest * newest_twiddles_[a] );
+    }
+  }
+}
+
+void SlidingDft::magnitudes( float* output ) const {
+  // `w( m ) = sum( c_j cos( 2 pi j m / fft_size ) )`, so the windowed bin `k` is `sum( c_j / 2 * ( Y( k - j ) + Y( k + j ) ) )`
+  size_t const spread = window_coefficients_.size() - 1;
+  for( size_t b = 0; b < bin_amount_; b++ ) {
+    size_t const center = b + spread;
+    std::complex< double > value = window_coefficients_[0] * accumulators_[center];
+    for( size_t j = 1; j < window_coefficients_.size(); j++ ) {
+      value += 0.5 * window_coefficients_[j] * ( accumulators_[center - j] + accumulators_[center + j] );
+    }
+    output[b] = float( std::abs( value ) );
+  }
+}
+
+bool SlidingDft::is_cheaper_than_fft( StftLayout const& layout, size_t bin_amount, size_t window_coefficient_amount ) {
+  // a complex update is about 8 flops per sample and accumulator, a real fft about 2.5 n log2( n ) plus the windowing
+  double const accumulator_amount = double( bin_amount + ( 2 * ( window_coefficient_amount - 1 ) ) );
+  double const sliding_cost = 8.0 * accumulator_amount * layout.hop;
+  double const fft_cost = ( 2.5 * double( layout.fft_size ) * std::log2( double( layout.fft_size ) ) ) + double( layout.window_size );
+  return sliding_cost < fft_cost;
+}
+
+#pragma endregion SlidingDft
@@ -1,7 +1,9 @@
 #include "utils.h"
 
+#include <algorithm>
 #include <sstream>
 
+#include "downmix.h"
 #include "loggerFactory.h"
 
 std::string replace( std::string const& source, std::string const& from, std::string const& to ) {
@@ -27,3 +29,59 @@ std::vector< std::string > split_multiline( std::string const& str ) {
   }
   return ret;
 }
+
+// continues the prefix sums in `prefix_sum` (`frame_amount` entries) from `sum` and `compensation`
+static void accumulate_square_prefix_sum( float const* samples, size_t frame_amount, size_t channels, double& sum, double& compensation, double* prefix_sum ) {
+  for( size_t i = 0; i < frame_amount; i++ ) {
+    double frame_sum = 0.0;
+    for( size_t c = 0; c < channels; c++ ) {
+      double sample = std::clamp( double( samples[( i * channels ) + c] ), -1.0, 1.0 );
+      frame_sum += sample * sample;
+    }
+    double y = frame_sum - compensation;
+    double t = sum + y;
+    compensation = ( t - sum ) - y;
+    sum = t;
+    prefix_sum[i] = sum;
+  }
+}
+
+std::vector< double > square_prefix_sum( float const* samples, size_t frame_amount, size_t channels ) {
+  std::vector< double > prefix_sum( frame_amount + 1 );
+  double sum = 0.0;
+  double compensation = 0.0;
+  prefix_sum[0] = 0.0;
+  accumulate_square_prefix_sum( samples, frame_amount, channels, sum, compensation, prefix_sum.data() + 1 );
+  return prefix_sum;
+}
+
+std::vector< double > square_prefix_sum( PcmSampleView const& samples ) {
+  if( samples.format == PcmSampleFormat::FLOAT32 ) {
+    return square_prefix_sum( samples.float32(), size_t( samples.frame_amount ), samples.channels );
+  }
+
+  // converted a block at a time, the sums continue over the blocks as over one buffer
+  size_t const frame_amount = size_t( samples.frame_amount );
+  size_t const block_frames = 1024;
+  std::vector< double > prefix_sum( frame_amount + 1 );
+  std::vector< float > block( block_frames * samples.channels );
+  double sum = 0.0;
+  double compensation = 0.0;
+  prefix_sum[0] = 0.0;
+  for( size_t frame_begin = 0; frame_begin < frame_amount; frame_begin += block_frames ) {
+    size_t const frames = std::min( block_frames, frame_amount - frame_begin );
+    int16_to_float( samples.int16() + ( frame_begin * samples.channels ), block.data(), frames * samples.channels );
+    accumulate_square_prefix_sum( block.data(), frames, samples.channels, sum, compensation, prefix_sum.data() + frame_begin + 1 );
+  }
+  return prefix_sum;
+}
+
+double prefix_sum_range( std::vector< double > const& prefix_sum, int64_t begin, int64_t end ) {
+  int64_t const last = int64_t( prefix_sum.size() ) - 1;
+  begin = std::clamp< int64_t >( begin, 0, last );
+  end = std::clamp< int64_t >( end, 0, last );
+  if( end <= begin ) {
+    return 0.0;
+  }
+  return prefix_sum[end] - prefix_sum[begin];
+}
@@ -0,0 +1,232 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "_spdlog.h"
+#include "analysisCache.h"
+
+struct TestSummary {
+  uint64_t frame_amount;
+  double max_mag_db;
+};
+
+uint32_t const TEST_SUMMARY_TAG = analysis_cache_tag( "SUMM" );
+uint32_t const TEST_FLOATS_TAG = analysis_cache_tag( "FLTS" );
+uint32_t const TEST_DOUBLES_TAG = analysis_cache_tag( "DBLS" );
+uint32_t const TEST_EMPTY_TAG = analysis_cache_tag( "EMPT" );
+
+// reference values of XXH64
+bool hash_test() {
+  std::string const abc = "abc";
+  std::string const long_text = "Nobody inspects the spammish repetition";
+  struct {
+    std::string const* text;
+    uint64_t seed;
+    uint64_t expected;
+  } const cases[] = {
+    { &abc, 0, 0x44BC2CF5AD770999ULL },
+    { &long_text, 0, 0xFBCEA83C8A378BF1ULL },
+  };
+
+  bool passed = hash_bytes( nullptr, 0 ) == 0xEF46DB3751D8E999ULL;
+  for( auto const& test_case : cases ) {
+    uint64_t const hash = hash_bytes( test_case.text->data(), test_case.text->size(), test_case.seed );
+    if( hash != test_case.expected ) {
+      spdlog::error( "[hash_test] {:?}: {:#x} != {:#x}", *test_case.text, hash, test_case.expected );
+      passed = false;
+    }
+  }
+
+  // the key depends on the order and the boundaries of what went into it
+  AnalysisCacheKey ab_c;
+  ab_c.add( "ab" ).add( "c" );
+  AnalysisCacheKey a_bc;
+  a_bc.add( "a" ).add( "bc" );
+  AnalysisCacheKey fps_60;
+  fps_60.add( 60.0 );
+  AnalysisCacheKey fps_30;
+  fps_30.add( 30.0 );
+  passed &= ( ab_c.value() != a_bc.value() ) && ( fps_60.value() != fps_30.value() );
+
+  if( passed ) {
+    spdlog::info( "[hash_test] passed" );
+  } else {
+    spdlog::error( "[hash_test] failed" );
+  }
+  return passed;
+}
+
+bool round_trip_test( std::filesystem::path const& cache_path ) {
+  std::default_random_engine random_engine( 1337 );
+  std::uniform_real_distribution< double > value_dist( -120.0, 0.0 );
+  std::vector< float > floats( 1001 );
+  for( float& value : floats ) {
+    value = float( value_dist( random_engine ) );
+  }
+  std::vector< double > doubles( 17 );
+  for( double& value : doubles ) {
+    value = value_dist( random_engine );
+  }
+  TestSummary const summary{ floats.size(), -3.5 };
+  uint64_t const key = AnalysisCacheKey().add( "round_trip_test" ).add( 60.0 ).value();
+
+  AnalysisCacheWriter writer( key );
+  writer.add_section( TEST_SUMMARY_TAG, &summary, 1 );
+  writer.add_section( TEST_FLOATS_TAG, floats );
+  writer.add_section( TEST_DOUBLES_TAG, doubles );
+  writer.add_section( TEST_EMPTY_TAG, std::vector< float >() );
+  if( !writer.write( cache_path ) ) {
+    spdlog::error( "[round_trip_test] could not write {:?}", cache_path.string() );
+    return false;
+  }
+
+  AnalysisCacheReader reader;
+  if( !reader.open( cache_path, key ) ) {
+    spdlog::error( "[round_trip_test] could not read {:?}", cache_path.string() );
+    return false;
+  }
+  auto const read_summary = reader.section< TestSummary >( TEST_SUMMARY_TAG );
+  auto const read_floats = reader.section< float >( TEST_FLOATS_TAG );
+  auto const read_doubles = reader.section< double >( TEST_DOUBLES_TAG );
+  auto const read_empty = reader.section< float >( TEST_EMPTY_TAG );
+  bool passed = read_summary && ( read_summary->size() == 1 ) && ( read_summary->front().frame_amount == summary.frame_amount )
+                && ( read_summary->front().max_mag_db == summary.max_mag_db );
+  passed &= read_floats && std::equal( read_floats->begin(), read_floats->end(), floats.begin(), floats.end() );
+  passed &= read_doubles && std::equal( read_doubles->begin(), read_doubles->end(), doubles.begin(), doubles.end() );
+  passed &= read_empty && read_empty->empty();
+  // sections are read in place, so they have to be aligned for their type
+  passed &= read_doubles && ( reinterpret_cast< uintptr_t >( read_doubles->data() ) % 64 == 0 );
+  // wrong type or tag
+  passed &= !reader.section< double >( TEST_FLOATS_TAG ) && !reader.section< float >( analysis_cache_tag( "NONE" ) );
+
+  if( passed ) {
+    spdlog::info( "[round_trip_test] passed, {} bytes", std::filesystem::file_size( cache_path ) );
+  } else {
+    spdlog::error( "[round_trip_test] failed" );
+  }
+  return passed;
+}
+
+// the sections written piece by piece and out of order read back like the ones of `AnalysisCacheWriter`, nothing is there before the commit
+bool stream_writer_test( std::filesystem::path const& cache_path ) {
+  std::vector< float > floats( 1001 );
+  for( size_t i = 0; i < floats.size(); i++ ) {
+    floats[i] = float( i ) * 0.25f;
+  }
+  std::vector< double > doubles( 17, -1.5 );
+  TestSummary const summary{ floats.size(), -3.5 };
+  uint64_t const key = AnalysisCacheKey().add( "stream_writer_test" ).value();
+  std::filesystem::path const stream_path = cache_path.parent_path() / "stream.cache";
+
+  bool passed = true;
+  {
+    AnalysisCacheStreamWriter writer( key );
+    writer.add_section< TestSummary >( TEST_SUMMARY_TAG, 1 );
+    writer.add_section< float >( TEST_FLOATS_TAG, floats.size() );
+    writer.add_section< double >( TEST_DOUBLES_TAG, doubles.size() );
+    if( !writer.open( stream_path ) ) {
+      spdlog::error( "[stream_writer_test] could not open {:?}", stream_path.string() );
+      return false;
+    }
+    // segments of 300 floats, the last one first
+    for( size_t segment_begin : { 900, 600, 300, 0 } ) {
+      size_t const segment_amount = std::min< size_t >( 300, floats.size() - segment_begin );
+      passed &= writer.write( TEST_FLOATS_TAG, segment_begin, floats.data() + segment_begin, segment_amount );
+    }
+    passed &= writer.write( TEST_DOUBLES_TAG, 0, doubles );
+    passed &= writer.write( TEST_SUMMARY_TAG, 0, &summary, 1 );
+    passed &= !std::filesystem::exists( stream_path );
+    passed &= writer.commit();
+  }
+
+  AnalysisCacheReader reader;
+  passed &= reader.open( stream_path, key );
+  auto const read_summary = reader.section< TestSummary >( TEST_SUMMARY_TAG );
+  auto const read_floats = reader.section< float >( TEST_FLOATS_TAG );
+  auto const read_doubles = reader.section< double >( TEST_DOUBLES_TAG );
+  passed &= read_summary && ( read_summary->size() == 1 ) && ( read_summary->front().frame_amount == summary.frame_amount );
+  passed &= read_floats && std::equal( read_floats->begin(), read_floats->end(), floats.begin(), floats.end() );
+  passed &= read_doubles && std::equal( read_doubles->begin(), read_doubles->end(), doubles.begin(), doubles.end() );
+  passed &= read_doubles && ( reinterpret_cast< uintptr_t >( read_doubles->data() ) % 64 == 0 );
+
+  // a write past its section fails the commit, a writer that goes away uncommitted leaves nothing behind
+  std::filesystem::path const failed_path = cache_path.parent_path() / "failed.cache";
+  {
+    AnalysisCacheStreamWriter writer( key );
+    writer.add_section< double >( TEST_DOUBLES_TAG, doubles.size() );
+    passed &= writer.open( failed_path );
+    passed &= !writer.write( TEST_DOUBLES_TAG, 1, doubles );
+    passed &= !writer.commit();
+  }
+  {
+    AnalysisCacheStreamWriter writer( key );
+    writer.add_section< double >( TEST_DOUBLES_TAG, doubles.size() );
+    passed &= writer.open( failed_path ) && writer.write( TEST_DOUBLES_TAG, 0, doubles );
+  }
+  passed &= !std::filesystem::exists( failed_path ) && !std::filesystem::exists( failed_path.string() + ".tmp" );
+
+  if( passed ) {
+    spdlog::info( "[stream_writer_test] passed, {} bytes", std::filesystem::file_size( stream_path ) );
+  } else {
+    spdlog::error( "[stream_writer_test] failed" );
+  }
+  return passed;
+}
+
+// anything that is not exactly a cache of this format for this key has to be a miss
+bool miss_test( std::filesystem::path const& cache_path ) {
+  uint64_t const key = AnalysisCacheKey().add( "round_trip_test" ).add( 60.0 ).value();
+  uint64_t const other_key = AnalysisCacheKey().add( "round_trip_test" ).add( 30.0 ).value();
+
+  bool passed = true;
+  AnalysisCacheReader reader;
+  passed &= !reader.open( cache_path.parent_path() / "missing.cache", key );
+  passed &= !reader.open( cache_path, other_key );
+
+  // truncated
+  std::filesystem::path const damaged_path = cache_path.parent_path() / "damaged.cache";
+  std::filesystem::copy_file( cache_path, damaged_path, std::filesystem::copy_options::overwrite_existing );
+  std::filesystem::resize_file( damaged_path, std::filesystem::file_size( cache_path ) - 7 );
+  passed &= !reader.open( damaged_path, key );
+
+  // other format version
+  std::filesystem::copy_file( cache_path, damaged_path, std::filesystem::copy_options::overwrite_existing );
+  {
+    std::fstream file_stream( damaged_path, std::ios::binary | std::ios::in | std::ios::out );
+    uint32_t const version = 0xFFFFFFFF;
+    file_stream.seekp( 4 );
+    file_stream.write( reinterpret_cast< char const* >( &version ), sizeof( version ) );
+  }
+  passed &= !reader.open( damaged_path, key );
+  std::filesystem::remove( damaged_path );
+
+  // a miss must not leave the previous file open
+  passed &= reader.open( cache_path, key ) && !reader.open( cache_path, other_key ) && !reader.section< float >( TEST_FLOATS_TAG );
+
+  if( passed ) {
+    spdlog::info( "[miss_test] passed" );
+  } else {
+    spdlog::error( "[miss_test] failed" );
+  }
+  return passed;
+}
+
+int main() {
+  std::filesystem::path const test_path = std::filesystem::temp_directory_path() / "picture-gen-test-analysis-cache";
+  std::filesystem::create_directories( test_path );
+  std::filesystem::path const cache_path = test_path / "test.cache";
+
+  bool passed = true;
+  passed &= hash_test();
+  passed &= round_trip_test( cache_path );
+  passed &= miss_test( cache_path );
+  passed &= stream_writer_test( cache_path );
+
+  std::filesystem::remove_all( test_path );
+  return passed ? 0 : 1;
+}
@@ -0,0 +1,191 @@
+#include <Iir.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <numbers>
+#include <random>
+#include <vector>
+
+#include "_spdlog.h"
+#include "biquadCascade.h"
+
+int32_t const IIR_FILTER_ORDER = 16;
+double const BASS_LP_CUTOFF = 80.0;
+double const BASS_HP_CUTOFF = 20.0;
+
+std::vector< float > make_test_signal( size_t frame_amount, uint32_t channels, double sample_rate ) {
+  std::default_random_engine random_engine( 1337 );
+  std::uniform_real_distribution< double > noise_dist( -0.25, 0.25 );
+  std::vector< float > signal( frame_amount * channels );
+  for( size_t i = 0; i < frame_amount; i++ ) {
+    double const time = double( i ) / sample_rate;
+    // sweep from 10 Hz to 500 Hz, plus noise
+    double const sweep = 0.5 * std::sin( 2.0 * std::numbers::pi * ( 10.0 * time + 10.0 * time * time ) );
+    for( uint32_t c = 0; c < channels; c++ ) {
+      signal[( i * channels ) + c] = float( sweep + noise_dist( random_engine ) );
+    }
+  }
+  return signal;
+}
+
+bool block_parallel_test( size_t frame_amount, uint32_t channels, double sample_rate, uint32_t thread_count, size_t min_block_size ) {
+  std::vector< float > const signal = make_test_signal( frame_amount, channels, sample_rate );
+
+  // reference: the serial iir1 filters, like the generators used to run them
+  std::vector< float > expected( signal.size() );
+  for( uint32_t c = 0; c < channels; c++ ) {
+    Iir::Butterworth::LowPass< IIR_FILTER_ORDER > lowpass;
+    Iir::Butterworth::HighPass< IIR_FILTER_ORDER > highpass;
+    lowpass.setup( sample_rate, BASS_LP_CUTOFF );
+    highpass.setup( sample_rate, BASS_HP_CUTOFF );
+    for( size_t i = 0; i < frame_amount; i++ ) {
+      size_t const sample_index = ( i * channels ) + c;
+      expected[sample_index] = highpass.filter( lowpass.filter( signal[sample_index] ) );
+    }
+  }
+
+  Iir::Butterworth::LowPass< IIR_FILTER_ORDER > lowpass;
+  Iir::Butterworth::HighPass< IIR_FILTER_ORDER > highpass;
+  lowpass.setup( sample_rate, BASS_LP_CUTOFF );
+  highpass.setup( sample_rate, BASS_HP_CUTOFF );
+  BiquadCascade cascade;
+  append_biquad_cascade( cascade, lowpass );
+  append_biquad_cascade( cascade, highpass );
+
+  std::vector< float > serial( signal.size() );
+  std::vector< float > block_parallel( signal.size() );
+  filter_biquad_cascade( cascade, signal.data(), serial.data(), frame_amount, channels );
+  filter_biquad_cascade_block_parallel( cascade, signal.data(), block_parallel.data(), frame_amount, channels, thread_count, min_block_size );
+
+  double max_serial_error = 0.0;
+  double max_block_parallel_error = 0.0;
+  for( size_t i = 0; i < signal.size(); i++ ) {
+    max_serial_error = std::max( max_serial_error, std::abs( double( serial[i] ) - double( expected[i] ) ) );
+    max_block_parallel_error = std::max( max_block_parallel_error, std::abs( double( block_parallel[i] ) - double( expected[i] ) ) );
+  }
+
+  // float output, the filters only differ in their rounding
+  double const tolerance = 1e-5;
+  bool passed = ( max_serial_error <= tolerance ) && ( max_block_parallel_error <= tolerance );
+  if( passed ) {
+    spdlog::info( "[block_parallel_test] frames: {}, channels: {}, threads: {}, min block size: {}, max error serial: {}, block parallel: {}",
+                  frame_amount,
+                  channels,
+                  thread_count,
+                  min_block_size,
+                  max_serial_error,
+                  max_block_parallel_error );
+  } else {
+    spdlog::error( "[block_parallel_test] frames: {}, channels: {}, threads: {}, min block size: {}, max error serial: {}, block parallel: {} > {}",
+                   frame_amount,
+                   channels,
+                   thread_count,
+                   min_block_size,
+                   max_serial_error,
+                   max_block_parallel_error,
+                   tolerance );
+  }
+  return passed;
+}
+
+// the streaming filter over chunks of uneven size has to match one pass over the whole signal exactly
+bool chunked_test( size_t frame_amount, uint32_t channels, double sample_rate ) {
+  std::vector< float > const signal = make_test_signal( frame_amount, channels, sample_rate );
+
+  Iir::Butterworth::LowPass< IIR_FILTER_ORDER > lowpass;
+  Iir::Butterworth::HighPass< IIR_FILTER_ORDER > highpass;
+  lowpass.setup( sample_rate, BASS_LP_CUTOFF );
+  highpass.setup( sample_rate, BASS_HP_CUTOFF );
+  BiquadCascade cascade;
+  append_biquad_cascade( cascade, lowpass );
+  append_biquad_cascade( cascade, highpass );
+
+  std::vector< float > expected( signal.size() );
+  filter_biquad_cascade( cascade, signal.data(), expected.data(), frame_amount, channels );
+
+  std::default_random_engine random_engine( 42 );
+  std::uniform_int_distribution< size_t > chunk_dist( 0, 4096 );
+  BiquadCascadeFilter filter( cascade, channels );
+  std::vector< float > chunked( signal.size() );
+  size_t chunk_amount = 0;
+  for( size_t frame_begin = 0; frame_begin < frame_amount; chunk_amount++ ) {
+    size_t const chunk_frames = std::min( chunk_dist( random_engine ), frame_amount - frame_begin );
+    filter.process( signal.data() + ( frame_begin * channels ), chunked.data() + ( frame_begin * channels ), chunk_frames );
+    frame_begin += chunk_frames;
+  }
+
+  bool passed = chunked == expected;
+  // after a reset the filter starts from silence again
+  filter.reset();
+  std::vector< float > restarted( signal.size() );
+  filter.process( signal.data(), restarted.data(), frame_amount );
+  passed &= restarted == expected;
+
+  if( passed ) {
+    spdlog::info( "[chunked_test] frames: {}, channels: {}, chunks: {}", frame_amount, channels, chunk_amount );
+  } else {
+    spdlog::error( "[chunked_test] frames: {}, channels: {}, chunks: {}, output differs from one pass", frame_amount, channels, chunk_amount );
+  }
+  return passed;
+}
+
+// informational only, timings are too noisy to fail on
+void throughput_test( size_t frame_amount, uint32_t channels, double sample_rate ) {
+  std::vector< float > const signal = make_test_signal( frame_amount, channels, sample_rate );
+  std::vector< float > output( signal.size() );
+
+  auto start = std::chrono::steady_clock::now();
+  for( uint32_t c = 0; c < channels; c++ ) {
+    Iir::Butterworth::LowPass< IIR_FILTER_ORDER > lowpass;
+    Iir::Butterworth::HighPass< IIR_FILTER_ORDER > highpass;
+    lowpass.setup( sample_rate, BASS_LP_CUTOFF );
+    highpass.setup( sample_rate, BASS_HP_CUTOFF );
+    for( size_t i = 0; i < frame_amount; i++ ) {
+      size_t const sample_index = ( i * channels ) + c;
+      output[sample_index] = highpass.filter( lowpass.filter( signal[sample_index] ) );
+    }
+  }
+  std::chrono::duration< double > const iir1_duration = std::chrono::steady_clock::now() - start;
+
+  Iir::Butterworth::LowPass< IIR_FILTER_ORDER > lowpass;
+  Iir::Butterworth::HighPass< IIR_FILTER_ORDER > highpass;
+  lowpass.setup( sample_rate, BASS_LP_CUTOFF );
+  highpass.setup( sample_rate, BASS_HP_CUTOFF );
+  BiquadCascade cascade;
+  append_biquad_cascade( cascade, lowpass );
+  append_biquad_cascade( cascade, highpass );
+
+  start = std::chrono::steady_clock::now();
+  filter_biquad_cascade( cascade, signal.data(), output.data(), frame_amount, channels );
+  std::chrono::duration< double > const cascade_duration = std::chrono::steady_clock::now() - start;
+
+  // a single thread, so only the blocks side by side in the lanes count
+  start = std::chrono::steady_clock::now();
+  filter_biquad_cascade_block_parallel( cascade, signal.data(), output.data(), frame_amount, channels, 1 );
+  std::chrono::duration< double > const lanes_duration = std::chrono::steady_clock::now() - start;
+
+  spdlog::info( "[throughput_test] frames: {}, channels: {}, iir1: {:.3f}s, cascade: {:.3f}s, speedup: {:.2f}x, block lanes: {:.3f}s, speedup: {:.2f}x",
+                frame_amount,
+                channels,
+                iir1_duration.count(),
+                cascade_duration.count(),
+                iir1_duration.count() / cascade_duration.count(),
+                lanes_duration.count(),
+                iir1_duration.count() / lanes_duration.count() );
+}
+
+int main() {
+  bool passed = true;
+  passed &= block_parallel_test( 1000, 2, 48000.0, 4, 1 << 15 );
+  passed &= block_parallel_test( 480000, 2, 48000.0, 1, 1 << 15 );
+  passed &= block_parallel_test( 480000, 2, 48000.0, 4, 1 << 15 );
+  passed &= block_parallel_test( 441001, 1, 44100.0, 7, 1 << 12 );
+  passed &= block_parallel_test( 441001, 1, 44100.0, 1, 1 << 12 );
+  passed &= block_parallel_test( 441000, 6, 44100.0, 16, 1 << 10 );
+  passed &= chunked_test( 100000, 1, 48000.0 );
+  passed &= chunked_test( 100001, 2, 44100.0 );
+  throughput_test( 48000 * 60, 1, 48000.0 );
+  throughput_test( 48000 * 60, 2, 48000.0 );
+  throughput_test( 48000 * 60, 4, 48000.0 );
+  return passed ? 0 : 1;
+}
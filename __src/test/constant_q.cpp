@@ -0,0 +1,174 @@
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <fftw3.h>
+#include <filesystem>
+#include <memory>
+#include <numbers>
+#include <random>
+#include <vector>
+
+#include "_spdlog.h"
+#include "constantQ.h"
+#include "fftwPlanRegistry.h"
+#include "loggerFactory.h"
+#include "window_functions.h"
+
+// the regular generator at 60 fps and 44.1 kHz
+double const SAMPLE_RATE = 44100.0;
+size_t const FFT_SIZE = 8192;
+double const MIN_FREQ = 20.0;
+double const MAX_FREQ = SAMPLE_RATE / 2.0;
+uint32_t const BIN_AMOUNT = 917;
+
+std::vector< double > make_frequencies() {
+  std::vector< double > frequencies( size_t( BIN_AMOUNT ) + 1 );
+  for( size_t bin = 0; bin < frequencies.size(); bin++ ) {
+    frequencies[bin] = MIN_FREQ * std::pow( MAX_FREQ / MIN_FREQ, double( bin ) / double( BIN_AMOUNT ) );
+  }
+  return frequencies;
+}
+
+ConstantQKernel make_kernel() {
+  double const quality = constant_q_quality( std::pow( MAX_FREQ / MIN_FREQ, 1.0 / double( BIN_AMOUNT ) ) );
+  return make_constant_q_kernel( FFT_SIZE, SAMPLE_RATE, make_frequencies(), quality );
+}
+
+std::vector< float > make_tones( std::vector< std::pair< double, double > > const& tones, double noise ) {
+  std::default_random_engine random_engine( 1337 );
+  std::uniform_real_distribution< double > noise_dist( -noise, noise );
+  std::vector< float > frame( FFT_SIZE );
+  for( size_t i = 0; i < FFT_SIZE; i++ ) {
+    double value = noise_dist( random_engine );
+    for( auto const& [freq, amplitude] : tones ) {
+      value += amplitude * std::sin( 2.0 * std::numbers::pi * freq * double( i ) / SAMPLE_RATE );
+    }
+    frame[i] = float( value );
+  }
+  return frame;
+}
+
+std::vector< float > transform( ConstantQKernel const& kernel, std::vector< float > const& frame ) {
+  std::shared_ptr< fftwf_plan_s > plan = FftwPlanRegistry::get_r2c_plan( int( FFT_SIZE ) );
+  std::shared_ptr< float[] > input( fftwf_alloc_real( FFT_SIZE ), fftwf_free );
+  std::shared_ptr< fftwf_complex[] > output( fftwf_alloc_complex( FFT_SIZE / 2 + 1 ), fftwf_free );
+  std::copy( frame.begin(), frame.end(), input.get() );
+  fftwf_execute_dft_r2c( plan.get(), input.get(), output.get() );
+  std::vector< float > magnitudes( kernel.bin_amount() );
+  constant_q_magnitudes( kernel, output.get(), FFT_SIZE / 2 + 1, magnitudes.data(), magnitudes.size(), 1 );
+  return magnitudes;
+}
+
+// against the inner products with the windowed exponentials in the time domain.
+// the kernel only keeps the fft indices `0 .. fft_size / 2`, so the parts of the kernel spectra that reach past 0 Hz or past nyquist are lost,
+// which is noticeable for the long kernels below 100 Hz and the short ones in the last few hundred Hz before nyquist.
+bool accuracy_test( ConstantQKernel const& kernel ) {
+  std::vector< float > const frame = make_tones( { { 55.0, 0.5 }, { 440.0, 0.25 }, { 3520.0, 0.25 } }, 0.1 );
+  std::vector< float > const magnitudes = transform( kernel, frame );
+  double const quality = constant_q_quality( std::pow( MAX_FREQ / MIN_FREQ, 1.0 / double( BIN_AMOUNT ) ) );
+
+  double max_error = 0.0;
+  double max_magnitude = 0.0;
+  std::vector< double > window( FFT_SIZE );
+  for( size_t bin = 0; bin < kernel.bin_amount(); bin++ ) {
+    double const freq = kernel.frequencies[bin];
+    if( ( freq < 100.0 ) || ( freq > 0.95 * MAX_FREQ ) ) {
+      continue;
+    }
+    size_t const kernel_size = std::min( FFT_SIZE, size_t( std::ceil( quality * SAMPLE_RATE / freq ) ) );
+    size_t const kernel_begin = ( FFT_SIZE - kernel_size ) / 2;
+    nuttallwin_octave( window.data(), unsigned( kernel_size ), true );
+    double window_sum = 0.0;
+    std::complex< double > value( 0.0, 0.0 );
+    for( size_t n = 0; n < kernel_size; n++ ) {
+      window_sum += window[n];
+      value += double( frame[kernel_begin + n] ) * window[n] * std::polar( 1.0, -2.0 * std::numbers::pi * freq * double( kernel_begin + n ) / SAMPLE_RATE );
+    }
+    value /= window_sum;
+    max_error = std::max( max_error, std::abs( std::abs( value ) - double( magnitudes[bin] ) ) );
+    max_magnitude = std::max( max_magnitude, std::abs( value ) );
+  }
+
+  double const relative_error = max_error / max_magnitude;
+  double const tolerance = 1e-3;
+  if( relative_error <= tolerance ) {
+    spdlog::info( "[accuracy_test] relative error: {}", relative_error );
+  } else {
+    spdlog::error( "[accuracy_test] relative error: {} > {}", relative_error, tolerance );
+  }
+  return relative_error <= tolerance;
+}
+
+// a tone on a bin frequency comes out at half its amplitude, at the low end as well
+bool tone_test( ConstantQKernel const& kernel ) {
+  bool passed = true;
+  for( size_t bin : { size_t( 0 ), size_t( 40 ), size_t( 300 ), size_t( 800 ) } ) {
+    std::vector< float > const magnitudes = transform( kernel, make_tones( { { kernel.frequencies[bin], 0.5 } }, 0.0 ) );
+    double const error = std::abs( double( magnitudes[bin] ) - 0.25 );
+    if( error <= 0.01 ) {
+      spdlog::info( "[tone_test] {:.1f} Hz: {}", kernel.frequencies[bin], magnitudes[bin] );
+    } else {
+      spdlog::error( "[tone_test] {:.1f} Hz: {}, expected 0.25", kernel.frequencies[bin], magnitudes[bin] );
+      passed = false;
+    }
+  }
+  return passed;
+}
+
+// 40 Hz and 80 Hz are a few hundred display bins apart, there has to be a clear dip between them
+bool resolution_test( ConstantQKernel const& kernel ) {
+  std::vector< float > const magnitudes = transform( kernel, make_tones( { { 40.0, 0.5 }, { 80.0, 0.5 } }, 0.0 ) );
+  auto bin_of = [&]( double freq ) {
+    return size_t( std::lround( double( BIN_AMOUNT ) * std::log( freq / MIN_FREQ ) / std::log( MAX_FREQ / MIN_FREQ ) ) );
+  };
+  double const peak = std::min( magnitudes[bin_of( 40.0 )], magnitudes[bin_of( 80.0 )] );
+  double const dip = magnitudes[bin_of( std::sqrt( 40.0 * 80.0 ) )];
+  double const dip_db = 20.0 * std::log10( ( dip + 1e-12 ) / peak );
+  if( dip_db <= -20.0 ) {
+    spdlog::info( "[resolution_test] dip between 40 Hz and 80 Hz: {:.1f} dB", dip_db );
+  } else {
+    spdlog::error( "[resolution_test] dip between 40 Hz and 80 Hz: {:.1f} dB > -20 dB", dip_db );
+  }
+  return dip_db <= -20.0;
+}
+
+// informational only, timings are too noisy to fail on
+void benchmark( ConstantQKernel const& kernel ) {
+  size_t const repetitions = 500;
+  std::vector< float > const frame = make_tones( { { 440.0, 0.5 } }, 0.1 );
+  std::shared_ptr< fftwf_plan_s > plan = FftwPlanRegistry::get_r2c_plan( int( FFT_SIZE ) );
+  std::shared_ptr< float[] > input( fftwf_alloc_real( FFT_SIZE ), fftwf_free );
+  std::shared_ptr< fftwf_complex[] > output( fftwf_alloc_complex( FFT_SIZE / 2 + 1 ), fftwf_free );
+  std::vector< float > magnitudes( kernel.bin_amount() );
+
+  auto start = std::chrono::steady_clock::now();
+  for( size_t r = 0; r < repetitions; r++ ) {
+    std::copy( frame.begin(), frame.end(), input.get() );
+    fftwf_execute_dft_r2c( plan.get(), input.get(), output.get() );
+  }
+  double const fft_seconds = std::chrono::duration< double >( std::chrono::steady_clock::now() - start ).count() / double( repetitions );
+
+  start = std::chrono::steady_clock::now();
+  for( size_t r = 0; r < repetitions; r++ ) {
+    constant_q_magnitudes( kernel, output.get(), FFT_SIZE / 2 + 1, magnitudes.data(), magnitudes.size(), 1 );
+  }
+  double const kernel_seconds = std::chrono::duration< double >( std::chrono::steady_clock::now() - start ).count() / double( repetitions );
+
+  spdlog::info( "[benchmark] kernel weights: {}, fft: {:.1f}us, kernel: {:.1f}us", kernel.weights.size(), fft_seconds * 1e6, kernel_seconds * 1e6 );
+}
+
+int main() {
+  LoggerFactory::init( "constant_q.log", true );
+  FftwPlanRegistry::init( std::filesystem::temp_directory_path() / "picture-gen-test-wisdom" );
+
+  ConstantQKernel const kernel = make_kernel();
+  bool passed = true;
+  passed &= accuracy_test( kernel );
+  passed &= tone_test( kernel );
+  passed &= resolution_test( kernel );
+  benchmark( kernel );
+
+  FftwPlanRegistry::deinit();
+  LoggerFactory::deinit();
+  return passed ? 0 : 1;
+}
@@ -0,0 +1,109 @@
+#include <chrono>
+#include <cmath>
+#include <fftw3.h>
+#include <memory>
+#include <numbers>
+#include <random>
+#include <vector>
+
+#include "_spdlog.h"
+#include "spectralKernels.h"
+
+uint32_t const FFTW_PLAN_FLAGS = FFTW_MEASURE;
+
+std::vector< float > make_test_frames( size_t fft_size, size_t frame_amount ) {
+  std::default_random_engine random_engine( 1337 );
+  std::uniform_real_distribution< float > noise_dist( -0.25f, 0.25f );
+  std::vector< float > frames( frame_amount * fft_size );
+  for( size_t i = 0; i < frames.size(); i++ ) {
+    frames[i] = float( 0.5 * std::sin( 2.0 * std::numbers::pi * 440.0 * double( i ) / 44100.0 ) ) + noise_dist( random_engine );
+  }
+  return frames;
+}
+
+// magnitudes of every frame, `fft_size / 2 + 1` per frame, one 1-d plan per frame like the generators used to run them
+std::vector< float > run_single( std::vector< float > const& frames, size_t fft_size, size_t frame_amount, double& seconds ) {
+  size_t const output_size = fft_size / 2 + 1;
+  std::shared_ptr< float[] > input( fftwf_alloc_real( fft_size ), fftwf_free );
+  std::shared_ptr< fftwf_complex[] > output( fftwf_alloc_complex( output_size ), fftwf_free );
+  fftwf_plan plan = fftwf_plan_dft_r2c_1d( int( fft_size ), input.get(), output.get(), FFTW_PLAN_FLAGS );
+
+  std::vector< float > mags( frame_amount * output_size );
+  auto start = std::chrono::steady_clock::now();
+  for( size_t i = 0; i < frame_amount; i++ ) {
+    std::copy( frames.begin() + ( i * fft_size ), frames.begin() + ( ( i + 1 ) * fft_size ), input.get() );
+    fftwf_execute( plan );
+    complex_magnitudes( output.get(), mags.data() + ( i * output_size ), output_size );
+  }
+  seconds = std::chrono::duration< double >( std::chrono::steady_clock::now() - start ).count();
+
+  fftwf_destroy_plan( plan );
+  return mags;
+}
+
+// same, with `batch_size` frames per `fftwf_plan_many_dft_r2c` call
+std::vector< float > run_batched( std::vector< float > const& frames, size_t fft_size, size_t frame_amount, int batch_size, double& seconds ) {
+  int const n = int( fft_size );
+  int const output_size = n / 2 + 1;
+  std::shared_ptr< float[] > input( fftwf_alloc_real( fft_size * size_t( batch_size ) ), fftwf_free );
+  std::shared_ptr< fftwf_complex[] > output( fftwf_alloc_complex( size_t( output_size ) * size_t( batch_size ) ), fftwf_free );
+  fftwf_plan plan
+      = fftwf_plan_many_dft_r2c( 1, &n, batch_size, input.get(), nullptr, 1, n, output.get(), nullptr, 1, output_size, FFTW_PLAN_FLAGS );
+
+  std::vector< float > mags( frame_amount * size_t( output_size ) );
+  auto start = std::chrono::steady_clock::now();
+  for( size_t batch_begin = 0; batch_begin < frame_amount; batch_begin += size_t( batch_size ) ) {
+    size_t const batch_frame_amount = std::min( size_t( batch_size ), frame_amount - batch_begin );
+    std::copy( frames.begin() + ( batch_begin * fft_size ), frames.begin() + ( ( batch_begin + batch_frame_amount ) * fft_size ), input.get() );
+    std::fill( input.get() + ( batch_frame_amount * fft_size ), input.get() + ( size_t( batch_size ) * fft_size ), 0.0f );
+    fftwf_execute( plan );
+    complex_magnitudes( output.get(), mags.data() + ( batch_begin * size_t( output_size ) ), batch_frame_amount * size_t( output_size ) );
+  }
+  seconds = std::chrono::duration< double >( std::chrono::steady_clock::now() - start ).count();
+
+  fftwf_destroy_plan( plan );
+  return mags;
+}
+
+bool batch_test( size_t fft_size, size_t frame_amount ) {
+  std::vector< float > const frames = make_test_frames( fft_size, frame_amount );
+
+  double single_seconds = 0.0;
+  std::vector< float > const expected = run_single( frames, fft_size, frame_amount, single_seconds );
+  spdlog::info( "[batch_test] fft size: {}, frames: {}, single: {:.4f}s", fft_size, frame_amount, single_seconds );
+
+  bool passed = true;
+  for( int batch_size : { 1, 4, 16, 64, 256 } ) {
+    double batched_seconds = 0.0;
+    std::vector< float > const batched = run_batched( frames, fft_size, frame_amount, batch_size, batched_seconds );
+
+    double max_error = 0.0;
+    for( size_t i = 0; i < expected.size(); i++ ) {
+      max_error = std::max( max_error, std::abs( double( batched[i] ) - double( expected[i] ) ) / ( 1.0 + std::abs( double( expected[i] ) ) ) );
+    }
+    // the codelets may differ between the plans, so only rounding differences are expected
+    double const tolerance = 1e-4;
+    if( max_error <= tolerance ) {
+      // timings are too noisy to fail on, they are informational only
+      spdlog::info( "[batch_test] fft size: {}, batch size: {}, batched: {:.4f}s, speedup: {:.2f}x, max relative error: {}",
+                    fft_size,
+                    batch_size,
+                    batched_seconds,
+                    single_seconds / batched_seconds,
+                    max_error );
+    } else {
+      spdlog::error( "[batch_test] fft size: {}, batch size: {}, max relative error: {} > {}", fft_size, batch_size, max_error, tolerance );
+      passed = false;
+    }
+  }
+  return passed;
+}
+
+int main() {
+  bool passed = true;
+  passed &= batch_test( 256, 20000 );
+  passed &= batch_test( 1024, 5000 );
+  // the generators at 60 fps, 44.1 kHz and a 6 frame window
+  passed &= batch_test( 8192, 1000 );
+  return passed ? 0 : 1;
+}
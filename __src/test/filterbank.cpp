@@ -0,0 +1,190 @@
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "_spdlog.h"
+#include "filterbank.h"
+#include "logBinning.h"
+
+// the regular generator at 60 fps and 44.1 kHz
+double const SAMPLE_RATE = 44100.0;
+size_t const FFT_SIZE = 8192;
+uint32_t const BAND_AMOUNT = 128;
+
+FilterbankLayout make_layout( FilterbankScale scale, FilterbankNormalization normalization ) {
+  FilterbankLayout layout;
+  layout.scale = scale;
+  layout.normalization = normalization;
+  layout.fft_size = FFT_SIZE;
+  layout.sample_rate = SAMPLE_RATE;
+  layout.band_amount = BAND_AMOUNT;
+  layout.min_freq = 20.0;
+  layout.max_freq = SAMPLE_RATE / 2.0;
+  return layout;
+}
+
+char const* scale_name( FilterbankScale scale ) {
+  return ( scale == FilterbankScale::MEL ) ? "mel" : "bark";
+}
+
+bool scale_test( FilterbankScale scale ) {
+  double max_error = 0.0;
+  for( double freq = 20.0; freq < SAMPLE_RATE / 2.0; freq *= 1.1 ) {
+    max_error = std::max( max_error, std::abs( filterbank_scale_to_hz( scale, filterbank_scale_from_hz( scale, freq ) ) - freq ) / freq );
+  }
+  // the usual reference points, 1000 Hz is 1000 mel and about 8.5 bark
+  double const reference = filterbank_scale_from_hz( scale, 1000.0 );
+  double const expected = ( scale == FilterbankScale::MEL ) ? 1000.0 : 8.5;
+  bool const passed = ( max_error <= 1e-9 ) && ( std::abs( reference - expected ) <= 0.1 );
+  if( passed ) {
+    spdlog::info( "[scale_test] {}: round trip error {}, 1000 Hz -> {}", scale_name( scale ), max_error, reference );
+  } else {
+    spdlog::error( "[scale_test] {}: round trip error {}, 1000 Hz -> {} (expected {})", scale_name( scale ), max_error, reference, expected );
+  }
+  return passed;
+}
+
+// slaney triangles have an area of 1 (in Hz), plain ones peak at 1, every band has weights and its columns are ascending
+bool weights_test( FilterbankScale scale, FilterbankNormalization normalization ) {
+  FilterbankLayout const layout = make_layout( scale, normalization );
+  SparseMatrix const matrix = make_filterbank_matrix( layout );
+  double const column_width = SAMPLE_RATE / double( FFT_SIZE );
+
+  bool passed = matrix.row_amount == BAND_AMOUNT;
+  double max_error = 0.0;
+  for( uint32_t band = 0; band < BAND_AMOUNT; band++ ) {
+    uint32_t const row_begin = matrix.row_offsets[band];
+    uint32_t const row_end = matrix.row_offsets[band + 1];
+    passed &= row_end > row_begin;
+    double sum = 0.0;
+    double peak = 0.0;
+    for( uint32_t e = row_begin; e < row_end; e++ ) {
+      passed &= ( e == row_begin ) || ( matrix.column_indices[e] > matrix.column_indices[e - 1] );
+      sum += matrix.weights[e];
+      peak = std::max< double >( peak, matrix.weights[e] );
+    }
+    // the columns sample the triangles, so the area is only roughly right for the narrowest bands and the peak is missed by up to one column
+    size_t const column_amount = row_end - row_begin;
+    if( normalization == FilterbankNormalization::SLANEY ) {
+      if( column_amount >= 8 ) {
+        max_error = std::max( max_error, std::abs( ( sum * column_width ) - 1.0 ) );
+      }
+    } else {
+      passed &= ( peak <= 1.0 + 1e-6 ) && ( peak >= 1.0 - ( 4.0 / double( column_amount ) ) );
+      max_error = std::max( max_error, 1.0 - peak );
+    }
+  }
+  passed &= ( normalization != FilterbankNormalization::SLANEY ) || ( max_error <= 0.05 );
+  if( passed ) {
+    spdlog::info( "[weights_test] {} {}: entries {}, max error {}", scale_name( scale ), int( normalization ), matrix.weights.size(), max_error );
+  } else {
+    spdlog::error( "[weights_test] {} {}: entries {}, max error {}", scale_name( scale ), int( normalization ), matrix.weights.size(), max_error );
+  }
+  return passed;
+}
+
+// a tone on the center of a band is loudest in that band
+bool tone_test( FilterbankScale scale ) {
+  FilterbankLayout const layout = make_layout( scale, FilterbankNormalization::NONE );
+  SparseMatrix const matrix = make_filterbank_matrix( layout );
+  bool passed = true;
+  for( uint32_t band : { 10u, 64u, 120u } ) {
+    double const freq = filterbank_band_freq( layout, band );
+    // an ideal spectrum of the tone, one column
+    std::vector< float > magnitudes( matrix.column_amount, 0.0f );
+    magnitudes[size_t( std::llround( freq * double( FFT_SIZE ) / SAMPLE_RATE ) ) - 1] = 1.0f;
+    std::vector< float > bands( BAND_AMOUNT );
+    sparse_multiply( matrix, magnitudes.data(), magnitudes.size(), bands.data(), bands.size(), 1 );
+    size_t const loudest = size_t( std::max_element( bands.begin(), bands.end() ) - bands.begin() );
+    if( loudest != band ) {
+      spdlog::error( "[tone_test] {}: {:.1f} Hz is loudest in band {} instead of {}", scale_name( scale ), freq, loudest, band );
+      passed = false;
+    }
+  }
+  return passed;
+}
+
+bool cache_test() {
+  FilterbankLayout const layout = make_layout( FilterbankScale::MEL, FilterbankNormalization::SLANEY );
+  FilterbankLayout other = layout;
+  other.band_amount = 64;
+  bool const passed = ( get_filterbank_matrix( layout ) == get_filterbank_matrix( layout ) )
+                      && ( get_filterbank_matrix( layout ) != get_filterbank_matrix( other ) ) && ( get_filterbank_matrix( other )->row_amount == 64 );
+  if( passed ) {
+    spdlog::info( "[cache_test] passed" );
+  } else {
+    spdlog::error( "[cache_test] failed" );
+  }
+  return passed;
+}
+
+std::vector< float > make_magnitudes( size_t column_amount, size_t frame_amount ) {
+  std::default_random_engine random_engine( 1337 );
+  std::uniform_real_distribution< float > dist( 0.0f, 1.0f );
+  std::vector< float > magnitudes( column_amount * frame_amount );
+  for( float& magnitude : magnitudes ) {
+    magnitude = dist( random_engine );
+  }
+  return magnitudes;
+}
+
+// the simd rows against the plain sum over the entries
+bool multiply_test( SparseMatrix const& matrix, char const* name ) {
+  size_t const frame_amount = 3;
+  std::vector< float > const magnitudes = make_magnitudes( matrix.column_amount, frame_amount );
+  std::vector< float > output( matrix.row_amount * frame_amount );
+  sparse_multiply( matrix, magnitudes.data(), matrix.column_amount, output.data(), matrix.row_amount, frame_amount );
+
+  double max_error = 0.0;
+  for( size_t f = 0; f < frame_amount; f++ ) {
+    for( size_t r = 0; r < matrix.row_amount; r++ ) {
+      double sum = 0.0;
+      double scale = 0.0;
+      for( uint32_t e = matrix.row_offsets[r]; e < matrix.row_offsets[r + 1]; e++ ) {
+        sum += double( matrix.weights[e] ) * double( magnitudes[( f * matrix.column_amount ) + matrix.column_indices[e]] );
+        scale += std::abs( double( matrix.weights[e] ) );
+      }
+      max_error = std::max( max_error, std::abs( sum - double( output[( f * matrix.row_amount ) + r] ) ) / std::max( scale, 1e-12 ) );
+    }
+  }
+  double const tolerance = 1e-5;
+  if( max_error <= tolerance ) {
+    spdlog::info( "[multiply_test] {}: relative error {}", name, max_error );
+  } else {
+    spdlog::error( "[multiply_test] {}: relative error {} > {}", name, max_error, tolerance );
+  }
+  return max_error <= tolerance;
+}
+
+// informational only, timings are too noisy to fail on
+void benchmark( SparseMatrix const& matrix, char const* name ) {
+  size_t const frame_amount = 64;
+  size_t const repetitions = 50;
+  std::vector< float > const magnitudes = make_magnitudes( matrix.column_amount, frame_amount );
+  std::vector< float > output( matrix.row_amount * frame_amount );
+  auto start = std::chrono::steady_clock::now();
+  for( size_t r = 0; r < repetitions; r++ ) {
+    sparse_multiply( matrix, magnitudes.data(), matrix.column_amount, output.data(), matrix.row_amount, frame_amount );
+  }
+  double const seconds = std::chrono::duration< double >( std::chrono::steady_clock::now() - start ).count() / double( repetitions * frame_amount );
+  spdlog::info( "[benchmark] {}: rows {}, entries {}, {:.2f}us per frame", name, matrix.row_amount, matrix.weights.size(), seconds * 1e6 );
+}
+
+int main() {
+  bool passed = true;
+  SparseMatrix const log_binning_matrix = make_log_binning_matrix( FFT_SIZE, SAMPLE_RATE, 20.0, SAMPLE_RATE / 2.0, 917 );
+  passed &= multiply_test( log_binning_matrix, "log binning" );
+  benchmark( log_binning_matrix, "log binning" );
+  for( FilterbankScale scale : { FilterbankScale::MEL, FilterbankScale::BARK } ) {
+    passed &= scale_test( scale );
+    passed &= weights_test( scale, FilterbankNormalization::NONE );
+    passed &= weights_test( scale, FilterbankNormalization::SLANEY );
+    passed &= tone_test( scale );
+    SparseMatrix const matrix = make_filterbank_matrix( make_layout( scale, FilterbankNormalization::SLANEY ) );
+    passed &= multiply_test( matrix, scale_name( scale ) );
+    benchmark( matrix, scale_name( scale ) );
+  }
+  passed &= cache_test();
+  return passed ? 0 : 1;
+}
@@ -0,0 +1,126 @@
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <fftw3.h>
+#include <memory>
+#include <numbers>
+#include <random>
+#include <vector>
+
+#include "_spdlog.h"
+#include "goertzelBank.h"
+#include "spectralKernels.h"
+#include "window_functions.h"
+
+// the circle generator at 60 fps and 44.1 kHz
+double const SAMPLE_RATE = 44100.0;
+size_t const FRAME_SIZE = 4410;
+size_t const FFT_SIZE = 8192;
+
+std::vector< float > make_test_frame() {
+  std::default_random_engine random_engine( 1337 );
+  std::uniform_real_distribution< double > noise_dist( -0.1, 0.1 );
+  std::vector< double > window( FFT_SIZE );
+  nuttallwin_octave( window.data(), unsigned( FFT_SIZE ), false );
+  std::vector< float > frame( FRAME_SIZE );
+  for( size_t i = 0; i < FRAME_SIZE; i++ ) {
+    double const time = double( i ) / SAMPLE_RATE;
+    double const tones = ( 0.5 * std::sin( 2.0 * std::numbers::pi * 55.0 * time ) ) + ( 0.25 * std::sin( 2.0 * std::numbers::pi * 3520.0 * time ) );
+    frame[i] = float( ( tones + noise_dist( random_engine ) ) * window[i] );
+  }
+  return frame;
+}
+
+// log spaced like the point cloud
+std::vector< double > make_frequencies( size_t frequency_amount, double min_freq, double max_freq ) {
+  std::vector< double > frequencies( frequency_amount );
+  for( size_t f = 0; f < frequency_amount; f++ ) {
+    double const norm_freq_log = double( f ) / double( std::max< size_t >( 1, frequency_amount - 1 ) );
+    frequencies[f] = std::exp( ( norm_freq_log * ( std::log( max_freq ) - std::log( min_freq ) ) ) + std::log( min_freq ) );
+  }
+  return frequencies;
+}
+
+bool accuracy_test( size_t frequency_amount ) {
+  std::vector< float > const frame = make_test_frame();
+  std::vector< double > const frequencies = make_frequencies( frequency_amount, 20.0, SAMPLE_RATE / 2.0 );
+  GoertzelBank const bank( frequencies, SAMPLE_RATE );
+  std::vector< float > magnitudes( frequency_amount );
+  bank.magnitudes( frame.data(), frame.size(), magnitudes.data() );
+
+  double max_error = 0.0;
+  double max_magnitude = 0.0;
+  for( size_t f = 0; f < frequency_amount; f++ ) {
+    std::complex< double > value( 0.0, 0.0 );
+    for( size_t m = 0; m < frame.size(); m++ ) {
+      value += double( frame[m] ) * std::polar( 1.0, -2.0 * std::numbers::pi * frequencies[f] * double( m ) / SAMPLE_RATE );
+    }
+    max_error = std::max( max_error, std::abs( std::abs( value ) - double( magnitudes[f] ) ) );
+    max_magnitude = std::max( max_magnitude, std::abs( value ) );
+  }
+
+  double const relative_error = max_error / max_magnitude;
+  double const tolerance = 1e-5;
+  if( relative_error <= tolerance ) {
+    spdlog::info( "[accuracy_test] frequencies: {}, relative error: {}", frequency_amount, relative_error );
+  } else {
+    spdlog::error( "[accuracy_test] frequencies: {}, relative error: {} > {}", frequency_amount, relative_error, tolerance );
+  }
+  return relative_error <= tolerance;
+}
+
+// informational only, timings are too noisy to fail on
+void benchmark( size_t frequency_amount ) {
+  size_t const repetitions = 200;
+  std::vector< float > const frame = make_test_frame();
+  std::vector< double > const frequencies = make_frequencies( frequency_amount, 20.0, SAMPLE_RATE / 2.0 );
+  GoertzelBank const bank( frequencies, SAMPLE_RATE );
+  std::vector< float > magnitudes( frequency_amount );
+
+  auto start = std::chrono::steady_clock::now();
+  for( size_t r = 0; r < repetitions; r++ ) {
+    bank.magnitudes( frame.data(), frame.size(), magnitudes.data() );
+  }
+  double const bank_seconds = std::chrono::duration< double >( std::chrono::steady_clock::now() - start ).count() / double( repetitions );
+
+  std::vector< float > const frame_vec( frame.begin(), frame.end() );
+  start = std::chrono::steady_clock::now();
+  for( size_t r = 0; r < repetitions; r++ ) {
+    for( size_t f = 0; f < frequency_amount; f++ ) {
+      magnitudes[f] = float( general_goeretzel( frame_vec, int32_t( frame_vec.size() ), SAMPLE_RATE, frequencies[f] ) );
+    }
+  }
+  double const scalar_seconds = std::chrono::duration< double >( std::chrono::steady_clock::now() - start ).count() / double( repetitions );
+
+  std::shared_ptr< float[] > input( fftwf_alloc_real( FFT_SIZE ), fftwf_free );
+  std::shared_ptr< fftwf_complex[] > output( fftwf_alloc_complex( FFT_SIZE / 2 + 1 ), fftwf_free );
+  std::vector< float > fft_mags( FFT_SIZE / 2 + 1 );
+  fftwf_plan plan = fftwf_plan_dft_r2c_1d( int( FFT_SIZE ), input.get(), output.get(), FFTW_MEASURE );
+  start = std::chrono::steady_clock::now();
+  for( size_t r = 0; r < repetitions; r++ ) {
+    std::copy( frame.begin(), frame.end(), input.get() );
+    std::fill( input.get() + FRAME_SIZE, input.get() + FFT_SIZE, 0.0f );
+    fftwf_execute( plan );
+    complex_magnitudes( output.get(), fft_mags.data(), fft_mags.size() );
+  }
+  double const fft_seconds = std::chrono::duration< double >( std::chrono::steady_clock::now() - start ).count() / double( repetitions );
+  fftwf_destroy_plan( plan );
+
+  spdlog::info( "[benchmark] frequencies: {}, bank: {:.1f}us, scalar goertzel: {:.1f}us, fft: {:.1f}us, bank cheaper by the cost model: {}",
+                frequency_amount,
+                bank_seconds * 1e6,
+                scalar_seconds * 1e6,
+                fft_seconds * 1e6,
+                GoertzelBank::is_cheaper_than_fft( frequency_amount, FRAME_SIZE, FFT_SIZE ) );
+}
+
+int main() {
+  bool passed = true;
+  passed &= accuracy_test( 1 );
+  passed &= accuracy_test( 13 );
+  passed &= accuracy_test( 512 );
+  for( size_t frequency_amount : { 4, 16, 64, 512, 1024 } ) {
+    benchmark( frequency_amount );
+  }
+  return passed ? 0 : 1;
+}
@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <vector>
+
+#include "_spdlog.h"
+#include "magDbNormalizer.h"
+
+// loud passages and quiet ones with single peaks in between
+std::vector< double > make_frame_maxima( size_t frame_amount ) {
+  std::default_random_engine random_engine( 1337 );
+  std::uniform_real_distribution< double > noise_dist( -3.0, 3.0 );
+  std::uniform_int_distribution< int > peak_dist( 0, 50 );
+  std::vector< double > maxima( frame_amount );
+  for( size_t i = 0; i < frame_amount; i++ ) {
+    double const level = ( ( i / 300 ) % 2 == 0 ) ? -12.0 : -40.0;
+    maxima[i] = level + noise_dist( random_engine ) + ( peak_dist( random_engine ) == 0 ? 20.0 : 0.0 );
+  }
+  return maxima;
+}
+
+// straight from the definition: the loudest of the window, held against the previous frame minus the release
+std::vector< double > reference_streaming_max( std::vector< double > const& maxima, size_t lookahead_frames, double release_db_per_frame ) {
+  std::vector< double > envelope( maxima.size() );
+  for( size_t i = 0; i < maxima.size(); i++ ) {
+    size_t const window_end = std::min( maxima.size(), i + lookahead_frames + 1 );
+    double const window_max = *std::max_element( maxima.begin() + i, maxima.begin() + window_end );
+    envelope[i] = ( i == 0 ) ? window_max : std::max( window_max, envelope[i - 1] - release_db_per_frame );
+  }
+  return envelope;
+}
+
+bool global_test() {
+  std::vector< double > const maxima = make_frame_maxima( 2000 );
+  MagDbNormalizer normalizer( MagDbNormalization{ MagDbNormalizationMode::GLOBAL, 60.0, 0, 0.0 } );
+  bool passed = true;
+  for( double value : maxima ) {
+    normalizer.push( value );
+    // nothing is known before the end
+    passed &= !normalizer.has_next();
+  }
+  normalizer.finish();
+
+  double const expected_max = std::ceil( *std::max_element( maxima.begin(), maxima.end() ) );
+  for( size_t i = 0; i < maxima.size(); i++ ) {
+    std::optional< MagDbRange > range = normalizer.next();
+    passed &= range && ( range->max_mag_db == expected_max ) && ( range->min_mag_db == expected_max - 60.0 );
+  }
+  passed &= !normalizer.next();
+
+  if( passed ) {
+    spdlog::info( "[global_test] passed" );
+  } else {
+    spdlog::error( "[global_test] failed" );
+  }
+  return passed;
+}
+
+bool streaming_test( size_t frame_amount, size_t lookahead_frames, double release_db_per_frame ) {
+  std::vector< double > const maxima = make_frame_maxima( frame_amount );
+  std::vector< double > const expected = reference_streaming_max( maxima, lookahead_frames, release_db_per_frame );
+  MagDbNormalizer normalizer( MagDbNormalization{ MagDbNormalizationMode::STREAMING, 25.0, lookahead_frames, release_db_per_frame } );
+
+  bool passed = true;
+  double max_error = 0.0;
+  auto check_next = [&]() {
+    size_t const frame = size_t( normalizer.next_frame() );
+    std::optional< MagDbRange > range = normalizer.next();
+    if( !range ) {
+      passed = false;
+      return;
+    }
+    max_error = std::max( max_error, std::abs( range->max_mag_db - expected[frame] ) );
+    passed &= range->min_mag_db == range->max_mag_db - 25.0;
+  };
+
+  for( size_t i = 0; i < frame_amount; i++ ) {
+    normalizer.push( maxima[i] );
+    // a frame is ready exactly when its whole window is there, so the reader never lags more than the lookahead
+    passed &= normalizer.has_next() == ( i >= lookahead_frames );
+    while( normalizer.has_next() ) {
+      check_next();
+    }
+    passed &= normalizer.pushed_amount() - normalizer.next_frame() == std::min( i + 1, lookahead_frames );
+  }
+  normalizer.finish();
+  while( normalizer.has_next() ) {
+    check_next();
+  }
+  passed &= ( normalizer.next_frame() == frame_amount ) && ( max_error == 0.0 );
+
+  if( passed ) {
+    spdlog::info( "[streaming_test] passed: frame_amount: {}, lookahead_frames: {}, release_db_per_frame: {}",
+                  frame_amount,
+                  lookahead_frames,
+                  release_db_per_frame );
+  } else {
+    spdlog::error( "[streaming_test] failed: frame_amount: {}, lookahead_frames: {}, release_db_per_frame: {}, max_error: {}",
+                   frame_amount,
+                   lookahead_frames,
+                   release_db_per_frame,
+                   max_error );
+  }
+  return passed;
+}
+
+// the range rises before a peak (by the lookahead) and does not drop faster than the release after it
+bool envelope_test() {
+  size_t const lookahead_frames = 60;
+  double const release_db_per_frame = 0.1;
+  std::vector< double > maxima( 1000, -40.0 );
+  maxima[500] = -10.0;
+  MagDbNormalizer normalizer( MagDbNormalization{ MagDbNormalizationMode::STREAMING, 25.0, lookahead_frames, release_db_per_frame } );
+  std::vector< double > envelope;
+  for( double value : maxima ) {
+    normalizer.push( value );
+    while( std::optional< MagDbRange > range = normalizer.next() ) {
+      envelope.push_back( range->max_mag_db );
+    }
+  }
+  normalizer.finish();
+  while( std::optional< MagDbRange > range = normalizer.next() ) {
+    envelope.push_back( range->max_mag_db );
+  }
+
+  bool passed = envelope.size() == maxima.size();
+  passed &= passed && ( envelope[500 - lookahead_frames - 1] == -40.0 ) && ( envelope[500 - lookahead_frames] == -10.0 ) && ( envelope[500] == -10.0 );
+  passed &= passed && ( std::abs( envelope[600] - ( -10.0 - ( 100 * release_db_per_frame ) ) ) < 1e-9 ) && ( envelope[999] == -40.0 );
+
+  if( passed ) {
+    spdlog::info( "[envelope_test] passed" );
+  } else {
+    spdlog::error( "[envelope_test] failed" );
+  }
+  return passed;
+}
+
+int main() {
+  bool passed = true;
+  passed &= global_test();
+  passed &= streaming_test( 1, 0, 0.0 );
+  passed &= streaming_test( 2000, 0, 0.05 );
+  passed &= streaming_test( 2000, 1, 0.05 );
+  passed &= streaming_test( 2000, 120, 0.05 );
+  passed &= streaming_test( 100, 240, 0.2 );
+  passed &= envelope_test();
+  return passed ? 0 : 1;
+}
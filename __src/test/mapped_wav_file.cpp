@@ -0,0 +1,166 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "_spdlog.h"
+#include "downmix.h"
+#include "mappedWavFile.h"
+
+struct TestWavFormat {
+  uint16_t format_tag;
+  uint16_t bits_per_sample;
+  bool is_extensible;
+  // an odd sized chunk (plus its padding byte) before the data, which moves the samples by two bytes
+  bool has_odd_chunk;
+};
+
+void append_bytes( std::vector< uint8_t >& bytes, void const* data, size_t size ) {
+  uint8_t const* p = static_cast< uint8_t const* >( data );
+  bytes.insert( bytes.end(), p, p + size );
+}
+
+template < typename T >
+void append_value( std::vector< uint8_t >& bytes, T value ) {
+  append_bytes( bytes, &value, sizeof( T ) );
+}
+
+void write_test_wav( std::filesystem::path const& file_path,
+                     TestWavFormat const& format,
+                     uint16_t channels,
+                     uint32_t sample_rate,
+                     std::vector< uint8_t > const& sample_bytes ) {
+  uint16_t const block_align = uint16_t( channels * format.bits_per_sample / 8 );
+  std::vector< uint8_t > bytes;
+  append_bytes( bytes, "RIFF", 4 );
+  append_value< uint32_t >( bytes, 0 );
+  append_bytes( bytes, "WAVE", 4 );
+
+  append_bytes( bytes, "fmt ", 4 );
+  append_value< uint32_t >( bytes, format.is_extensible ? 40 : 16 );
+  append_value< uint16_t >( bytes, format.is_extensible ? 0xFFFE : format.format_tag );
+  append_value< uint16_t >( bytes, channels );
+  append_value< uint32_t >( bytes, sample_rate );
+  append_value< uint32_t >( bytes, sample_rate * block_align );
+  append_value< uint16_t >( bytes, block_align );
+  append_value< uint16_t >( bytes, format.bits_per_sample );
+  if( format.is_extensible ) {
+    append_value< uint16_t >( bytes, 22 );
+    append_value< uint16_t >( bytes, format.bits_per_sample );
+    append_value< uint32_t >( bytes, 0 );
+    // KSDATAFORMAT_SUBTYPE_PCM / _IEEE_FLOAT, the format code followed by the fixed guid tail
+    uint8_t const guid_tail[14] = { 0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71 };
+    append_value< uint16_t >( bytes, format.format_tag );
+    append_bytes( bytes, guid_tail, sizeof( guid_tail ) );
+  }
+
+  append_bytes( bytes, "LIST", 4 );
+  append_value< uint32_t >( bytes, format.has_odd_chunk ? 5 : 4 );
+  append_bytes( bytes, "INFO", 4 );
+  if( format.has_odd_chunk ) {
+    append_value< uint8_t >( bytes, 0 );
+    append_value< uint8_t >( bytes, 0 );
+  }
+
+  append_bytes( bytes, "data", 4 );
+  append_value< uint32_t >( bytes, uint32_t( sample_bytes.size() ) );
+  append_bytes( bytes, sample_bytes.data(), sample_bytes.size() );
+
+  uint32_t const riff_size = uint32_t( bytes.size() - 8 );
+  std::memcpy( bytes.data() + 4, &riff_size, sizeof( riff_size ) );
+  std::ofstream file_stream( file_path, std::ios::binary | std::ios::trunc );
+  file_stream.write( reinterpret_cast< char const* >( bytes.data() ), std::streamsize( bytes.size() ) );
+}
+
+// the mapped view has to hold exactly the samples that were written, converted like dr_wav converts them
+bool read_test( std::filesystem::path const& test_path, TestWavFormat const& format, uint16_t channels, bool should_open ) {
+  size_t const frame_amount = 1001;
+  std::default_random_engine random_engine( 1337 );
+  std::uniform_real_distribution< double > value_dist( -1.0, 1.0 );
+  std::vector< float > expected( frame_amount * channels );
+  std::vector< uint8_t > sample_bytes;
+  for( float& value : expected ) {
+    if( format.bits_per_sample == 16 ) {
+      int16_t const sample = int16_t( std::lround( value_dist( random_engine ) * 32767.0 ) );
+      append_value( sample_bytes, sample );
+      value = float( sample ) / 32768.0f;
+    } else {
+      value = float( value_dist( random_engine ) );
+      append_value( sample_bytes, value );
+    }
+  }
+  std::filesystem::path const file_path = test_path / "test.wav";
+  write_test_wav( file_path, format, channels, 48000, sample_bytes );
+
+  std::string const name = fmt::format( "tag {:#x}, {} bit, {} channels{}{}",
+                                        format.format_tag,
+                                        format.bits_per_sample,
+                                        channels,
+                                        format.is_extensible ? ", extensible" : "",
+                                        format.has_odd_chunk ? ", odd chunk" : "" );
+  MappedWavFile wav_file;
+  bool const is_open = wav_file.open( file_path );
+  if( is_open != should_open ) {
+    spdlog::error( "[read_test] {}: opened: {}, expected: {}", name, is_open, should_open );
+    return false;
+  }
+  if( !is_open ) {
+    spdlog::info( "[read_test] {}: rejected", name );
+    return true;
+  }
+
+  PcmSampleView const& samples = wav_file.samples();
+  bool passed = ( wav_file.channels() == channels ) && ( wav_file.sample_rate() == 48000 ) && ( wav_file.total_pcm_frame_count() == frame_amount );
+  std::vector< float > converted( samples.sample_amount() );
+  pcm_to_float( samples, converted.data() );
+  passed &= converted == expected;
+  for( size_t i = 0; passed && ( i < expected.size() ); i++ ) {
+    passed &= samples[i] == expected[i];
+  }
+
+  // the kernels on the typed view against the same kernels on the converted samples
+  std::vector< float > mono( frame_amount );
+  std::vector< float > expected_mono( frame_amount );
+  downmix_to_mono( samples, mono.data() );
+  downmix_to_mono( expected.data(), expected_mono.data(), frame_amount, channels );
+  passed &= mono == expected_mono;
+  float sample_min = 0.0f;
+  float sample_max = 0.0f;
+  pcm_sample_range( samples, sample_min, sample_max );
+  passed &= ( sample_min == *std::min_element( expected.begin(), expected.end() ) ) && ( sample_max == *std::max_element( expected.begin(), expected.end() ) );
+  // a range of frames
+  std::vector< float > middle( 17 * channels );
+  pcm_to_float( samples.frames( 500, 17 ), middle.data() );
+  passed &= std::equal( middle.begin(), middle.end(), expected.begin() + ( 500 * channels ) );
+
+  if( passed ) {
+    spdlog::info( "[read_test] {}: passed", name );
+  } else {
+    spdlog::error( "[read_test] {}: failed", name );
+  }
+  return passed;
+}
+
+int main() {
+  std::filesystem::path const test_path = std::filesystem::temp_directory_path() / "picture-gen-test-mapped-wav-file";
+  std::filesystem::create_directories( test_path );
+
+  bool passed = true;
+  passed &= read_test( test_path, { 0x0001, 16, false, false }, 1, true );
+  passed &= read_test( test_path, { 0x0001, 16, false, false }, 2, true );
+  passed &= read_test( test_path, { 0x0003, 32, false, false }, 2, true );
+  passed &= read_test( test_path, { 0x0003, 32, true, false }, 6, true );
+  passed &= read_test( test_path, { 0x0001, 16, true, false }, 3, true );
+  passed &= read_test( test_path, { 0x0001, 16, false, true }, 2, true );
+  // these go through dr_wav, the float samples would be unaligned
+  passed &= read_test( test_path, { 0x0001, 24, false, false }, 2, false );
+  passed &= read_test( test_path, { 0x0003, 32, false, true }, 2, false );
+
+  std::filesystem::remove_all( test_path );
+  return passed ? 0 : 1;
+}
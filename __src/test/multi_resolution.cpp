@@ -0,0 +1,193 @@
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <numbers>
+#include <random>
+#include <vector>
+
+#include "_spdlog.h"
+#include "fftwPlanRegistry.h"
+#include "loggerFactory.h"
+#include "multiResolutionStft.h"
+
+// the regular generator at 60 fps and 44.1 kHz
+double const SAMPLE_RATE = 44100.0;
+double const HOP = 735.0;
+size_t const WINDOW_SIZE = 4410;
+double const MIN_FREQ = 20.0;
+double const MAX_FREQ = SAMPLE_RATE / 2.0;
+uint32_t const BIN_AMOUNT = 917;
+size_t const BATCH_SIZE = 4;
+double const LOW_CROSSOVER = 250.0;
+double const HIGH_CROSSOVER = 3000.0;
+double const CROSSOVER_OCTAVES = 1.0 / 3.0;
+
+std::vector< MultiResolutionBand > make_three_bands() {
+  return design_three_band_resolution( SAMPLE_RATE, WINDOW_SIZE, LOW_CROSSOVER, HIGH_CROSSOVER, CROSSOVER_OCTAVES );
+}
+
+// the analysis of today, one window for everything
+std::vector< MultiResolutionBand > make_single_band() {
+  MultiResolutionBand band;
+  band.window_size = WINDOW_SIZE;
+  band.max_freq = MAX_FREQ;
+  return { band };
+}
+
+std::vector< float > make_tones( std::vector< double > const& freqs, size_t sample_amount ) {
+  std::vector< float > samples( sample_amount );
+  for( size_t i = 0; i < sample_amount; i++ ) {
+    double value = 0.0;
+    for( double freq : freqs ) {
+      value += 0.25 * std::sin( 2.0 * std::numbers::pi * freq * double( i ) / SAMPLE_RATE );
+    }
+    samples[i] = float( value );
+  }
+  return samples;
+}
+
+size_t bin_of( double freq ) {
+  return size_t( std::floor( double( BIN_AMOUNT ) * std::log( freq / MIN_FREQ ) / std::log( MAX_FREQ / MIN_FREQ ) ) );
+}
+
+std::vector< float > analyze_frame( std::vector< float > const& samples, std::vector< MultiResolutionBand > const& bands, size_t frame ) {
+  MultiResolutionStft const stft( samples, SAMPLE_RATE, HOP, bands, BATCH_SIZE, MIN_FREQ, MAX_FREQ, BIN_AMOUNT, CROSSOVER_OCTAVES );
+  MultiResolutionStft::Workspace workspace = stft.make_workspace();
+  std::vector< float > row( stft.bin_amount() );
+  stft.compute_rows( workspace, frame, 1, row.data(), row.size() );
+  return row;
+}
+
+bool crossover_test() {
+  std::vector< MultiResolutionBand > const bands = make_three_bands();
+  double max_error = 0.0;
+  for( double freq = MIN_FREQ; freq < MAX_FREQ; freq *= 1.01 ) {
+    double sum = 0.0;
+    for( size_t b = 0; b < bands.size(); b++ ) {
+      sum += multi_resolution_crossover_weight( bands, b, freq, CROSSOVER_OCTAVES );
+    }
+    max_error = std::max( max_error, std::abs( sum - 1.0 ) );
+  }
+  bool const passed = max_error <= 1e-9;
+  if( passed ) {
+    spdlog::info( "[crossover_test] decimations {} {} {}, windows {} {} {}, max error {}",
+                  bands[0].decimation,
+                  bands[1].decimation,
+                  bands[2].decimation,
+                  bands[0].window_size,
+                  bands[1].window_size,
+                  bands[2].window_size,
+                  max_error );
+  } else {
+    spdlog::error( "[crossover_test] shares do not add up to 1, max error {}", max_error );
+  }
+  return passed;
+}
+
+// a tone in every band (and one right on a crossover) peaks in its display bin
+bool tone_test() {
+  bool passed = true;
+  for( double freq : { 55.0, LOW_CROSSOVER, 1000.0, HIGH_CROSSOVER, 8000.0 } ) {
+    std::vector< float > const row = analyze_frame( make_tones( { freq }, size_t( SAMPLE_RATE ) ), make_three_bands(), 30 );
+    size_t const loudest = size_t( std::max_element( row.begin(), row.end() ) - row.begin() );
+    if( std::abs( int64_t( loudest ) - int64_t( bin_of( freq ) ) ) > 1 ) {
+      spdlog::error( "[tone_test] {} Hz peaks in bin {} instead of {}", freq, loudest, bin_of( freq ) );
+      passed = false;
+    }
+  }
+  if( passed ) {
+    spdlog::info( "[tone_test] passed" );
+  }
+  return passed;
+}
+
+// today's window barely tells 60 Hz and 67 Hz apart, the long window of the low band clearly does
+bool resolution_test() {
+  std::vector< float > const samples = make_tones( { 60.0, 67.0 }, size_t( SAMPLE_RATE ) );
+  auto dip_db = [&]( std::vector< MultiResolutionBand > const& bands ) {
+    std::vector< float > const row = analyze_frame( samples, bands, 30 );
+    double const peak = std::min( row[bin_of( 60.0 )], row[bin_of( 67.0 )] );
+    return 20.0 * std::log10( ( row[bin_of( std::sqrt( 60.0 * 67.0 ) )] + 1e-12 ) / peak );
+  };
+  double const single_dip_db = dip_db( make_single_band() );
+  double const multi_dip_db = dip_db( make_three_bands() );
+  bool const passed = multi_dip_db <= single_dip_db - 6.0;
+  if( passed ) {
+    spdlog::info( "[resolution_test] dip between 60 Hz and 67 Hz: {:.1f} dB (single resolution: {:.1f} dB)", multi_dip_db, single_dip_db );
+  } else {
+    spdlog::error( "[resolution_test] dip between 60 Hz and 67 Hz: {:.1f} dB, single resolution: {:.1f} dB", multi_dip_db, single_dip_db );
+  }
+  return passed;
+}
+
+// a click smears over fewer frames in the highs with the short window of the top band
+bool time_resolution_test() {
+  std::vector< float > samples( size_t( SAMPLE_RATE ), 0.0f );
+  samples[size_t( 30.5 * HOP )] = 1.0f;
+  auto smeared_frames = [&]( std::vector< MultiResolutionBand > const& bands ) {
+    MultiResolutionStft const stft( samples, SAMPLE_RATE, HOP, bands, BATCH_SIZE, MIN_FREQ, MAX_FREQ, BIN_AMOUNT, CROSSOVER_OCTAVES );
+    MultiResolutionStft::Workspace workspace = stft.make_workspace();
+    std::vector< float > rows( 60 * stft.bin_amount() );
+    stft.compute_rows( workspace, 0, 60, rows.data(), stft.bin_amount() );
+    size_t const bin = bin_of( 10000.0 );
+    float peak = 0.0f;
+    for( size_t f = 0; f < 60; f++ ) {
+      peak = std::max( peak, rows[( f * stft.bin_amount() ) + bin] );
+    }
+    size_t frames = 0;
+    for( size_t f = 0; f < 60; f++ ) {
+      frames += ( rows[( f * stft.bin_amount() ) + bin] >= 0.1f * peak ) ? 1 : 0;
+    }
+    return frames;
+  };
+  size_t const single_frames = smeared_frames( make_single_band() );
+  size_t const multi_frames = smeared_frames( make_three_bands() );
+  bool const passed = multi_frames < single_frames;
+  if( passed ) {
+    spdlog::info( "[time_resolution_test] click at 10 kHz within -20 dB over {} frames (single resolution: {})", multi_frames, single_frames );
+  } else {
+    spdlog::error( "[time_resolution_test] click at 10 kHz within -20 dB over {} frames, single resolution: {}", multi_frames, single_frames );
+  }
+  return passed;
+}
+
+// informational only, timings are too noisy to fail on
+void benchmark() {
+  size_t const frame_amount = 400;
+  std::vector< float > samples( size_t( double( frame_amount + 10 ) * HOP ) );
+  std::default_random_engine random_engine( 1337 );
+  std::uniform_real_distribution< float > noise_dist( -0.5f, 0.5f );
+  for( float& sample : samples ) {
+    sample = noise_dist( random_engine );
+  }
+  auto seconds_per_frame = [&]( std::vector< MultiResolutionBand > const& bands ) {
+    MultiResolutionStft const stft( samples, SAMPLE_RATE, HOP, bands, BATCH_SIZE, MIN_FREQ, MAX_FREQ, BIN_AMOUNT, CROSSOVER_OCTAVES );
+    MultiResolutionStft::Workspace workspace = stft.make_workspace();
+    std::vector< float > rows( frame_amount * stft.bin_amount() );
+    auto start = std::chrono::steady_clock::now();
+    stft.compute_rows( workspace, 0, frame_amount, rows.data(), stft.bin_amount() );
+    return std::chrono::duration< double >( std::chrono::steady_clock::now() - start ).count() / double( frame_amount );
+  };
+  double const single_seconds = seconds_per_frame( make_single_band() );
+  double const multi_seconds = seconds_per_frame( make_three_bands() );
+  spdlog::info( "[benchmark] single resolution: {:.1f}us, three bands: {:.1f}us per frame ({:.2f}x)",
+                single_seconds * 1e6,
+                multi_seconds * 1e6,
+                multi_seconds / single_seconds );
+}
+
+int main() {
+  LoggerFactory::init( "multi_resolution.log", true );
+  FftwPlanRegistry::init( std::filesystem::temp_directory_path() / "picture-gen-test-wisdom" );
+
+  bool passed = true;
+  passed &= crossover_test();
+  passed &= tone_test();
+  passed &= resolution_test();
+  passed &= time_resolution_test();
+  benchmark();
+
+  FftwPlanRegistry::deinit();
+  LoggerFactory::deinit();
+  return passed ? 0 : 1;
+}
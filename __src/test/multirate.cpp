@@ -0,0 +1,78 @@
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <random>
+#include <vector>
+
+#include "_spdlog.h"
+#include "multirate.h"
+
+std::vector< float > make_test_signal( size_t sample_amount, double sample_rate ) {
+  std::default_random_engine random_engine( 1337 );
+  std::uniform_real_distribution< double > noise_dist( -0.25, 0.25 );
+  std::vector< float > signal( sample_amount );
+  for( size_t i = 0; i < sample_amount; i++ ) {
+    double const time = double( i ) / sample_rate;
+    signal[i] = float( 0.5 * std::sin( 2.0 * std::numbers::pi * 60.0 * time ) + noise_dist( random_engine ) );
+  }
+  return signal;
+}
+
+// the streaming decimators over chunks of uneven size have to give exactly what `decimate` gives over the whole signal
+bool streaming_test( size_t sample_amount, uint32_t total_factor, size_t max_chunk_size ) {
+  double const sample_rate = 48000.0;
+  std::vector< float > const signal = make_test_signal( sample_amount, sample_rate );
+  std::vector< DecimationStage > const stages = design_decimation_stages( total_factor, 100.0 / sample_rate );
+
+  std::vector< float > expected = signal;
+  for( DecimationStage const& stage : stages ) {
+    expected = decimate( expected, stage );
+  }
+
+  std::vector< StreamingDecimator > decimators( stages.begin(), stages.end() );
+  std::vector< std::vector< float > > stage_outputs( stages.size() );
+  std::vector< float > streamed;
+  std::default_random_engine random_engine( 42 );
+  std::uniform_int_distribution< size_t > chunk_dist( 0, max_chunk_size );
+  auto run_stages = [&]( float const* input, size_t amount, bool is_finished ) {
+    for( size_t s = 0; s < decimators.size(); s++ ) {
+      stage_outputs[s].clear();
+      decimators[s].push( input, amount, stage_outputs[s] );
+      if( is_finished ) {
+        decimators[s].finish( stage_outputs[s] );
+      }
+      input = stage_outputs[s].data();
+      amount = stage_outputs[s].size();
+    }
+    streamed.insert( streamed.end(), input, input + amount );
+  };
+  for( size_t begin = 0; begin < sample_amount; ) {
+    size_t const chunk_size = std::min( chunk_dist( random_engine ), sample_amount - begin );
+    run_stages( signal.data() + begin, chunk_size, false );
+    begin += chunk_size;
+  }
+  run_stages( nullptr, 0, true );
+
+  bool const passed = streamed == expected;
+  if( passed ) {
+    spdlog::info( "[streaming_test] samples: {}, factor: {}, stages: {}, outputs: {}", sample_amount, total_factor, stages.size(), streamed.size() );
+  } else {
+    spdlog::error( "[streaming_test] samples: {}, factor: {}, stages: {}, outputs: {} != {}",
+                   sample_amount,
+                   total_factor,
+                   stages.size(),
+                   streamed.size(),
+                   expected.size() );
+  }
+  return passed;
+}
+
+int main() {
+  bool passed = true;
+  passed &= streaming_test( 48000, 2, 64 );
+  passed &= streaming_test( 100003, 32, 4096 );
+  passed &= streaming_test( 100003, 64, 17 );
+  // shorter than the filters
+  passed &= streaming_test( 11, 8, 3 );
+  return passed ? 0 : 1;
+}
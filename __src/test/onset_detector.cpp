@@ -0,0 +1,217 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fftw3.h>
+#include <memory>
+#include <numbers>
+#include <optional>
+#include <random>
+#include <vector>
+
+#include "_spdlog.h"
+#include "onsetDetector.h"
+#include "spectralKernels.h"
+#include "stft.h"
+#include "window_functions.h"
+
+// the rate and analysis of the generators: 60 frames per second, windows of six frames
+double const SAMPLE_RATE = 44100.0;
+double const FPS = 60.0;
+double const HOP = SAMPLE_RATE / FPS;
+size_t const WINDOW_SIZE = size_t( HOP * 6.0 );
+std::vector< double > const WINDOW_COEFFICIENTS{ 0.355768, -0.487396, 0.144232, -0.012604 };
+// a reported onset or beat counts if it is this close to a click, 50 ms
+int64_t const TOLERANCE_FRAMES = 3;
+
+struct ClickTrack {
+  std::vector< float > samples;
+  // seconds of every loud click, the beats
+  std::vector< double > beat_times;
+  // seconds of every click
+  std::vector< double > click_times;
+};
+
+// decaying noise bursts on every beat, softer ones in between if `with_offbeats`, over a sustained bass tone and a noise floor
+ClickTrack make_click_track( double bpm, double seconds, bool with_offbeats ) {
+  std::default_random_engine random_engine( 1337 );
+  std::uniform_real_distribution< double > noise_dist( -1.0, 1.0 );
+  ClickTrack track;
+  track.samples.resize( size_t( seconds * SAMPLE_RATE ) );
+  for( size_t i = 0; i < track.samples.size(); i++ ) {
+    double const time = double( i ) / SAMPLE_RATE;
+    track.samples[i] = float( ( 0.3 * std::sin( 2.0 * std::numbers::pi * 55.0 * time ) ) + ( 0.001 * noise_dist( random_engine ) ) );
+  }
+
+  double const beat_seconds = 60.0 / bpm;
+  auto add_click = [&]( double time, double amplitude ) {
+    size_t const begin = size_t( time * SAMPLE_RATE );
+    size_t const length = size_t( 0.02 * SAMPLE_RATE );
+    for( size_t i = 0; ( i < length ) && ( begin + i < track.samples.size() ); i++ ) {
+      track.samples[begin + i] += float( amplitude * std::exp( -double( i ) / ( 0.003 * SAMPLE_RATE ) ) * noise_dist( random_engine ) );
+    }
+    track.click_times.push_back( time );
+  };
+  for( double time = 0.5; time < seconds - 0.5; time += beat_seconds ) {
+    add_click( time, 0.5 );
+    track.beat_times.push_back( time );
+    if( with_offbeats ) {
+      add_click( time + ( beat_seconds / 2.0 ), 0.15 );
+    }
+  }
+  return track;
+}
+
+// the magnitudes in dB of every frame, like `prepare_fft` of the circle generator computes them
+std::vector< std::vector< float > > compute_spectra( std::vector< float > const& samples ) {
+  StftLayout const layout = StftLayout::from_window( WINDOW_SIZE, HOP );
+  std::vector< double > window_dbl( layout.fft_size );
+  cosine_window( window_dbl.data(), unsigned( layout.fft_size ), WINDOW_COEFFICIENTS.data(), unsigned( WINDOW_COEFFICIENTS.size() ), false );
+  std::vector< float > const window( window_dbl.begin(), window_dbl.end() );
+
+  size_t const output_size = ( layout.fft_size / 2 ) + 1;
+  std::unique_ptr< float[], decltype( &fftwf_free ) > input( fftwf_alloc_real( layout.fft_size ), fftwf_free );
+  std::unique_ptr< fftwf_complex[], decltype( &fftwf_free ) > output( fftwf_alloc_complex( output_size ), fftwf_free );
+  fftwf_plan plan = fftwf_plan_dft_r2c_1d( int( layout.fft_size ), input.get(), output.get(), FFTW_ESTIMATE );
+  std::vector< float > magnitudes( output_size );
+  std::vector< float > gains( output_size - 1, 1.0f / float( layout.fft_size ) );
+
+  size_t const frame_amount = size_t( std::ceil( double( samples.size() ) / HOP ) );
+  std::vector< std::vector< float > > spectra( frame_amount, std::vector< float >( output_size - 1 ) );
+  for( size_t i = 0; i < frame_amount; i++ ) {
+    stft_window_frame( layout, i, samples.data(), samples.size(), window.data(), input.get() );
+    fftwf_execute( plan );
+    complex_magnitudes( output.get(), magnitudes.data(), output_size );
+    amplitude_to_db( magnitudes.data() + 1, gains.data(), spectra[i].data(), output_size - 1 );
+  }
+  fftwf_destroy_plan( plan );
+  return spectra;
+}
+
+// pushes every spectrum and takes every frame as soon as it is ready, like the streaming render
+std::vector< OnsetFrame > detect( std::vector< std::vector< float > > const& spectra, bool& is_incremental ) {
+  OnsetDetector detector( OnsetDetection{}, spectra.front().size() );
+  std::vector< OnsetFrame > frames;
+  is_incremental = true;
+  for( std::vector< float > const& spectrum : spectra ) {
+    detector.push( spectrum.data() );
+    while( std::optional< OnsetFrame > frame = detector.next() ) {
+      frames.push_back( *frame );
+    }
+    // never more than the lookahead behind
+    is_incremental &= detector.pushed_amount() - detector.next_frame() <= detector.lookahead_frames();
+  }
+  detector.finish();
+  while( std::optional< OnsetFrame > frame = detector.next() ) {
+    frames.push_back( *frame );
+  }
+  is_incremental &= frames.size() == spectra.size();
+  return frames;
+}
+
+// share of the reported frames that are close to an expected time and share of the expected times that got a reported frame,
+// both only after `from_seconds`
+struct Accuracy {
+  double precision = 0.0;
+  double recall = 0.0;
+};
+Accuracy measure( std::vector< OnsetFrame > const& frames, bool OnsetFrame::*reported, std::vector< double > const& times, double from_seconds ) {
+  std::vector< int64_t > reported_frames;
+  for( size_t i = size_t( from_seconds * FPS ); i < frames.size(); i++ ) {
+    if( frames[i].*reported ) {
+      reported_frames.push_back( int64_t( i ) );
+    }
+  }
+  std::vector< int64_t > expected_frames;
+  for( double time : times ) {
+    if( time >= from_seconds ) {
+      expected_frames.push_back( std::lround( time * FPS ) );
+    }
+  }
+  auto is_close_to_any = []( int64_t frame, std::vector< int64_t > const& others ) {
+    return std::any_of( others.begin(), others.end(), [&]( int64_t other ) { return std::abs( frame - other ) <= TOLERANCE_FRAMES; } );
+  };
+  auto share_close_to_any = [&]( std::vector< int64_t > const& frames, std::vector< int64_t > const& others ) {
+    size_t const close_amount = size_t( std::count_if( frames.begin(), frames.end(), [&]( int64_t frame ) { return is_close_to_any( frame, others ); } ) );
+    return double( close_amount ) / double( std::max< size_t >( frames.size(), 1 ) );
+  };
+  Accuracy accuracy;
+  accuracy.precision = share_close_to_any( reported_frames, expected_frames );
+  accuracy.recall = share_close_to_any( expected_frames, reported_frames );
+  return accuracy;
+}
+
+bool click_track_test( double bpm, bool with_offbeats ) {
+  double const seconds = 30.0;
+  ClickTrack const track = make_click_track( bpm, seconds, with_offbeats );
+  bool is_incremental = false;
+  std::vector< OnsetFrame > const frames = detect( compute_spectra( track.samples ), is_incremental );
+
+  // every click is an onset, the beats lock on after a few seconds of tempo window
+  Accuracy const onsets = measure( frames, &OnsetFrame::is_onset, track.click_times, 0.0 );
+  Accuracy const beats = measure( frames, &OnsetFrame::is_beat, track.beat_times, 5.0 );
+  double const detected_bpm = frames.back().bpm;
+  double const bpm_error = std::abs( detected_bpm - bpm ) / bpm;
+
+  bool const passed = is_incremental && ( onsets.precision >= 0.95 ) && ( onsets.recall >= 0.95 ) && ( beats.precision >= 0.9 ) && ( beats.recall >= 0.9 )
+                      && ( bpm_error <= 0.02 );
+  if( passed ) {
+    spdlog::info( "[click_track_test] passed: bpm: {}, offbeats: {}, detected bpm: {:.2f}, onsets: {:.3f} / {:.3f}, beats: {:.3f} / {:.3f}",
+                  bpm,
+                  with_offbeats,
+                  detected_bpm,
+                  onsets.precision,
+                  onsets.recall,
+                  beats.precision,
+                  beats.recall );
+  } else {
+    spdlog::error( "[click_track_test] failed: bpm: {}, offbeats: {}, incremental: {}, detected bpm: {:.2f}, onsets: {:.3f} / {:.3f}, beats: {:.3f} / {:.3f}",
+                   bpm,
+                   with_offbeats,
+                   is_incremental,
+                   detected_bpm,
+                   onsets.precision,
+                   onsets.recall,
+                   beats.precision,
+                   beats.recall );
+  }
+  return passed;
+}
+
+// a sustained tone over a noise floor is no onset and no beat, however loud it is
+bool sustained_test() {
+  std::vector< float > samples( size_t( 10.0 * SAMPLE_RATE ) );
+  std::default_random_engine random_engine( 42 );
+  std::uniform_real_distribution< double > noise_dist( -1.0, 1.0 );
+  for( size_t i = 0; i < samples.size(); i++ ) {
+    double const time = double( i ) / SAMPLE_RATE;
+    samples[i] = float( ( 0.8 * std::sin( 2.0 * std::numbers::pi * 55.0 * time ) ) + ( 0.001 * noise_dist( random_engine ) ) );
+  }
+  bool is_incremental = false;
+  std::vector< OnsetFrame > const frames = detect( compute_spectra( samples ), is_incremental );
+
+  // the tone fades in with the first windows
+  size_t onset_amount = 0;
+  double max_beat_strength = 0.0;
+  for( size_t i = size_t( FPS ); i < frames.size(); i++ ) {
+    onset_amount += frames[i].is_onset ? 1 : 0;
+    max_beat_strength = std::max( max_beat_strength, frames[i].beat_strength );
+  }
+
+  bool const passed = is_incremental && ( onset_amount == 0 ) && ( max_beat_strength < 0.5 );
+  if( passed ) {
+    spdlog::info( "[sustained_test] passed: max beat strength: {:.3f}", max_beat_strength );
+  } else {
+    spdlog::error( "[sustained_test] failed: incremental: {}, onsets: {}, max beat strength: {:.3f}", is_incremental, onset_amount, max_beat_strength );
+  }
+  return passed;
+}
+
+int main() {
+  bool passed = true;
+  passed &= click_track_test( 120.0, false );
+  passed &= click_track_test( 97.0, false );
+  passed &= click_track_test( 140.0, true );
+  passed &= click_track_test( 75.0, true );
+  passed &= sustained_test();
+  return passed ? 0 : 1;
+}
@@ -0,0 +1,60 @@
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "_spdlog.h"
+#include "parallelScan.h"
+
+template < typename T >
+std::vector< T > serial_smoothing( std::vector< T > values, size_t row_amount, size_t column_amount, double alpha ) {
+  for( size_t row = 1; row < row_amount; row++ ) {
+    for( size_t c = 0; c < column_amount; c++ ) {
+      values[( row * column_amount ) + c] = T( ( alpha * values[( row * column_amount ) + c] ) + ( ( 1.0 - alpha ) * values[( ( row - 1 ) * column_amount ) + c] ) );
+    }
+  }
+  return values;
+}
+
+template < typename T >
+bool scan_test( size_t row_amount, size_t column_amount, double alpha, uint32_t thread_count, double tolerance ) {
+  std::default_random_engine random_engine( 1337 );
+  std::uniform_real_distribution< double > mag_db_dist( -120.0, 0.0 );
+  std::vector< T > values( row_amount * column_amount );
+  for( T& value : values ) {
+    value = T( mag_db_dist( random_engine ) );
+  }
+
+  std::vector< T > expected = serial_smoothing( values, row_amount, column_amount, alpha );
+  exponential_smoothing_scan( values.data(), row_amount, column_amount, column_amount, alpha, thread_count );
+
+  double max_error = 0.0;
+  for( size_t i = 0; i < values.size(); i++ ) {
+    max_error = std::max( max_error, std::abs( double( values[i] ) - double( expected[i] ) ) );
+  }
+  bool passed = max_error <= tolerance;
+  if( passed ) {
+    spdlog::info( "[scan_test] rows: {}, columns: {}, alpha: {}, threads: {}, max error: {}", row_amount, column_amount, alpha, thread_count, max_error );
+  } else {
+    spdlog::error( "[scan_test] rows: {}, columns: {}, alpha: {}, threads: {}, max error: {} > {}",
+                   row_amount,
+                   column_amount,
+                   alpha,
+                   thread_count,
+                   max_error,
+                   tolerance );
+  }
+  return passed;
+}
+
+int main() {
+  bool passed = true;
+  for( uint32_t thread_count : { 1, 2, 3, 8, 64 } ) {
+    for( size_t row_amount : { 1, 15, 100, 10007 } ) {
+      passed &= scan_test< double >( row_amount, 918, 0.7, thread_count, 1e-9 );
+      passed &= scan_test< double >( row_amount, 3, 0.05, thread_count, 1e-9 );
+      // values are in dB, so 1e-3 is well below anything visible
+      passed &= scan_test< float >( row_amount, 512, 0.7, thread_count, 1e-3 );
+    }
+  }
+  return passed ? 0 : 1;
+}
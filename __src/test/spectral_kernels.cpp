@@ -0,0 +1,135 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "_spdlog.h"
+#include "spectralKernels.h"
+
+// the bound `amplitude_to_db` documents
+double const DB_TOLERANCE = 1e-4;
+
+// every amplitude between 1e-14 and 1e8 in small steps, the odd amounts also run the scalar tails
+bool accuracy_test( bool with_gains ) {
+  std::vector< float > amplitudes;
+  for( double amplitude = 1e-14; amplitude < 1e8; amplitude *= 1.0001 ) {
+    amplitudes.push_back( float( amplitude ) );
+  }
+  amplitudes.push_back( 0.0f );
+  amplitudes.push_back( -1.0f );
+  std::vector< float > gains( amplitudes.size() );
+  std::default_random_engine random_engine( 1337 );
+  std::uniform_real_distribution< float > gain_dist( 0.001f, 10.0f );
+  for( float& gain : gains ) {
+    gain = gain_dist( random_engine );
+  }
+
+  std::vector< float > fast( amplitudes.size() );
+  std::vector< float > reference( amplitudes.size() );
+  float const* gains_or_null = with_gains ? gains.data() : nullptr;
+  amplitude_to_db( amplitudes.data(), gains_or_null, fast.data(), amplitudes.size() );
+  amplitude_to_db_reference( amplitudes.data(), gains_or_null, reference.data(), amplitudes.size() );
+
+  double max_error = 0.0;
+  for( size_t i = 0; i < amplitudes.size(); i++ ) {
+    max_error = std::max( max_error, std::abs( double( fast[i] ) - double( reference[i] ) ) );
+  }
+  // non positive amplitudes end up at the floor
+  bool const floored = ( std::abs( fast[fast.size() - 1] + 240.0f ) < 1e-3f ) && ( std::abs( fast[fast.size() - 2] + 240.0f ) < 1e-3f );
+
+  bool const passed = ( max_error <= DB_TOLERANCE ) && floored;
+  if( passed ) {
+    spdlog::info( "[accuracy_test] gains: {}, values: {}, max error: {} dB", with_gains, amplitudes.size(), max_error );
+  } else {
+    spdlog::error( "[accuracy_test] gains: {}, max error: {} dB (tolerance {}), floored: {}", with_gains, max_error, DB_TOLERANCE, floored );
+  }
+  return passed;
+}
+
+// in place, like the generators call it
+bool in_place_test() {
+  std::vector< float > values = { 1.0f, 10.0f, 0.1f, 2.0f, 0.5f, 1000.0f, 1e-6f, 3.0f, 7.0f };
+  std::vector< float > reference( values.size() );
+  amplitude_to_db_reference( values.data(), nullptr, reference.data(), values.size() );
+  amplitude_to_db( values.data(), nullptr, values.data(), values.size() );
+  double max_error = 0.0;
+  for( size_t i = 0; i < values.size(); i++ ) {
+    max_error = std::max( max_error, std::abs( double( values[i] ) - double( reference[i] ) ) );
+  }
+  if( max_error <= DB_TOLERANCE ) {
+    spdlog::info( "[in_place_test] max error: {} dB", max_error );
+  } else {
+    spdlog::error( "[in_place_test] max error: {} dB", max_error );
+  }
+  return max_error <= DB_TOLERANCE;
+}
+
+// against a plain loop in double, the odd amounts also run the scalar tail
+bool rectified_flux_test( size_t amount ) {
+  std::default_random_engine random_engine( 1337 );
+  std::uniform_real_distribution< float > db_dist( -120.0f, 0.0f );
+  std::vector< float > current( amount );
+  std::vector< float > previous( amount );
+  for( size_t i = 0; i < amount; i++ ) {
+    current[i] = db_dist( random_engine );
+    previous[i] = db_dist( random_engine );
+  }
+  double expected = 0.0;
+  for( size_t i = 0; i < amount; i++ ) {
+    expected += std::max( double( current[i] ) - double( previous[i] ), 0.0 );
+  }
+  double const flux = double( rectified_flux( current.data(), previous.data(), amount ) );
+  // a frame against itself has no flux
+  bool const passed = ( std::abs( flux - expected ) <= 1e-5 * std::max( expected, 1.0 ) )
+                      && ( rectified_flux( current.data(), current.data(), amount ) == 0.0f );
+  if( passed ) {
+    spdlog::info( "[rectified_flux_test] amount: {}, flux: {}", amount, flux );
+  } else {
+    spdlog::error( "[rectified_flux_test] amount: {}, flux: {}, expected: {}", amount, flux, expected );
+  }
+  return passed;
+}
+
+// informational only, timings are too noisy to fail on
+void benchmark() {
+  size_t const amount = 4097;
+  size_t const repetitions = 2000;
+  std::vector< float > amplitudes( amount );
+  std::default_random_engine random_engine( 1337 );
+  std::uniform_real_distribution< float > amplitude_dist( 0.0f, 100.0f );
+  for( float& amplitude : amplitudes ) {
+    amplitude = amplitude_dist( random_engine );
+  }
+  std::vector< float > db( amount );
+
+  auto start = std::chrono::steady_clock::now();
+  for( size_t r = 0; r < repetitions; r++ ) {
+    amplitude_to_db( amplitudes.data(), nullptr, db.data(), amount );
+  }
+  double const fast_seconds = std::chrono::duration< double >( std::chrono::steady_clock::now() - start ).count() / double( repetitions );
+
+  start = std::chrono::steady_clock::now();
+  for( size_t r = 0; r < repetitions; r++ ) {
+    amplitude_to_db_reference( amplitudes.data(), nullptr, db.data(), amount );
+  }
+  double const reference_seconds = std::chrono::duration< double >( std::chrono::steady_clock::now() - start ).count() / double( repetitions );
+
+  spdlog::info( "[benchmark] {} values: fast {:.2f}us, reference {:.2f}us ({:.1f}x)",
+                amount,
+                fast_seconds * 1e6,
+                reference_seconds * 1e6,
+                reference_seconds / fast_seconds );
+}
+
+int main() {
+  bool passed = true;
+  passed &= accuracy_test( false );
+  passed &= accuracy_test( true );
+  passed &= in_place_test();
+  passed &= rectified_flux_test( 0 );
+  passed &= rectified_flux_test( 7 );
+  passed &= rectified_flux_test( 4097 );
+  benchmark();
+  return passed ? 0 : 1;
+}
@@ -0,0 +1,135 @@
+#include <cmath>
+#include <complex>
+#include <numbers>
+#include <random>
+#include <vector>
+
+#include "_spdlog.h"
+#include "stft.h"
+#include "window_functions.h"
+
+// nuttallwin_octave, like the generators use it
+std::vector< double > const WINDOW_COEFFICIENTS{ 0.355768, -0.487396, 0.144232, -0.012604 };
+
+std::vector< float > make_test_signal( size_t sample_amount, double sample_rate ) {
+  std::default_random_engine random_engine( 1337 );
+  std::uniform_real_distribution< double > noise_dist( -0.1, 0.1 );
+  std::vector< float > signal( sample_amount );
+  for( size_t i = 0; i < sample_amount; i++ ) {
+    double const time = double( i ) / sample_rate;
+    double const tones = ( 0.5 * std::sin( 2.0 * std::numbers::pi * 55.0 * time ) ) + ( 0.25 * std::sin( 2.0 * std::numbers::pi * 130.0 * time ) );
+    signal[i] = float( tones + noise_dist( random_engine ) );
+  }
+  return signal;
+}
+
+std::vector< float > make_window( StftLayout const& layout ) {
+  std::vector< double > window_dbl( layout.fft_size );
+  cosine_window( window_dbl.data(), unsigned( layout.fft_size ), WINDOW_COEFFICIENTS.data(), unsigned( WINDOW_COEFFICIENTS.size() ), false );
+  return std::vector< float >( window_dbl.begin(), window_dbl.end() );
+}
+
+// the streaming engine has to produce the same frames as windowing the whole track
+bool engine_test( size_t sample_amount, size_t window_size, double hop, size_t chunk_size ) {
+  StftLayout const layout = StftLayout::from_window( window_size, hop );
+  std::vector< float > const signal = make_test_signal( sample_amount, 44100.0 );
+  std::vector< float > const window = make_window( layout );
+  size_t const frame_amount = size_t( std::ceil( double( sample_amount ) / hop ) );
+
+  StftEngine engine( layout, window );
+  std::vector< float > expected( layout.fft_size );
+  std::vector< float > streamed( layout.fft_size );
+  size_t checked_frames = 0;
+  size_t mismatched_frames = 0;
+  auto check_frames = [&]() {
+    while( ( engine.next_frame() < frame_amount ) && engine.pop_frame( streamed.data() ) ) {
+      stft_window_frame( layout, checked_frames, signal.data(), signal.size(), window.data(), expected.data() );
+      if( expected != streamed ) {
+        mismatched_frames++;
+      }
+      checked_frames++;
+    }
+  };
+  for( size_t i = 0; i < sample_amount; i += chunk_size ) {
+    engine.push( signal.data() + i, std::min( chunk_size, sample_amount - i ) );
+    check_frames();
+  }
+  engine.finish();
+  check_frames();
+
+  bool passed = ( checked_frames == frame_amount ) && ( mismatched_frames == 0 );
+  if( passed ) {
+    spdlog::info( "[engine_test] window: {}, hop: {}, chunk: {}, frames: {}", window_size, hop, chunk_size, checked_frames );
+  } else {
+    spdlog::error( "[engine_test] window: {}, hop: {}, chunk: {}, frames: {} of {}, mismatched: {}",
+                   window_size,
+                   hop,
+                   chunk_size,
+                   checked_frames,
+                   frame_amount,
+                   mismatched_frames );
+  }
+  return passed;
+}
+
+// the sliding dft has to match a direct dft of the windowed frame at its bins
+bool sliding_dft_test( size_t sample_amount, size_t window_size, double hop, double sample_rate, double min_freq, double max_freq ) {
+  StftLayout const layout = StftLayout::from_window( window_size, hop );
+  std::vector< float > const signal = make_test_signal( sample_amount, sample_rate );
+  std::vector< float > const window = make_window( layout );
+  size_t const bin_begin = size_t( std::floor( min_freq * double( layout.fft_size ) / sample_rate ) );
+  size_t const bin_end = size_t( std::ceil( max_freq * double( layout.fft_size ) / sample_rate ) ) + 1;
+
+  SlidingDft sliding_dft( layout, WINDOW_COEFFICIENTS, bin_begin, bin_end );
+  std::vector< float > sliding( sliding_dft.bin_amount() );
+  std::vector< float > frame( layout.fft_size );
+  double max_error = 0.0;
+  double max_magnitude = 0.0;
+  int64_t pushed = 0;
+  for( size_t i = 0; layout.frame_begin( i ) + int64_t( window_size ) <= int64_t( sample_amount ); i++ ) {
+    int64_t const frame_end = layout.frame_begin( i ) + int64_t( window_size );
+    if( frame_end <= 0 ) {
+      continue;
+    }
+    sliding_dft.push( signal.data() + pushed, size_t( frame_end - pushed ) );
+    pushed = frame_end;
+    sliding_dft.magnitudes( sliding.data() );
+
+    stft_window_frame( layout, i, signal.data(), signal.size(), window.data(), frame.data() );
+    for( size_t k = bin_begin; k < bin_end; k++ ) {
+      std::complex< double > value( 0.0, 0.0 );
+      for( size_t m = 0; m < window_size; m++ ) {
+        value += double( frame[m] ) * std::polar( 1.0, -2.0 * std::numbers::pi * double( k ) * double( m ) / double( layout.fft_size ) );
+      }
+      max_error = std::max( max_error, std::abs( std::abs( value ) - double( sliding[k - bin_begin] ) ) );
+      max_magnitude = std::max( max_magnitude, std::abs( value ) );
+    }
+  }
+
+  double const relative_error = max_error / max_magnitude;
+  double const tolerance = 1e-4;
+  bool const cheaper = SlidingDft::is_cheaper_than_fft( layout, bin_end - bin_begin, WINDOW_COEFFICIENTS.size() );
+  if( relative_error <= tolerance ) {
+    spdlog::info( "[sliding_dft_test] window: {}, bins: [{}, {}), relative error: {}, cheaper than the fft: {}",
+                  window_size,
+                  bin_begin,
+                  bin_end,
+                  relative_error,
+                  cheaper );
+  } else {
+    spdlog::error( "[sliding_dft_test] window: {}, bins: [{}, {}), relative error: {} > {}", window_size, bin_begin, bin_end, relative_error, tolerance );
+  }
+  return relative_error <= tolerance;
+}
+
+int main() {
+  bool passed = true;
+  passed &= engine_test( 44100, 4410, 735.0, 1024 );
+  passed &= engine_test( 44100, 4410, 735.0, 100 );
+  passed &= engine_test( 48000, 4800, 800.0, 48000 );
+  passed &= engine_test( 44100, 4096, 612.5, 333 );
+  // the circle display band at 60 fps
+  passed &= sliding_dft_test( 44100, 4410, 735.0, 44100.0, 20.0, 200.0 );
+  passed &= sliding_dft_test( 44100, 4410, 735.0, 44100.0, 50.0, 60.0 );
+  return passed ? 0 : 1;
+}
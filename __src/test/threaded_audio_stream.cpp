@@ -0,0 +1,140 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "_spdlog.h"
+#include "audioStream.h"
+
+// every sample is its index, so anything lost, doubled or reordered shows. short reads like a decoder that stops at its packets
+class CountingStream : public AudioStream {
+  public:
+  CountingStream( uint32_t channels, uint64_t frame_amount, size_t max_read_frames )
+      : channels_( channels ), frame_amount_( frame_amount ), max_read_frames_( max_read_frames ) {}
+
+  uint32_t channels() const override { return channels_; }
+  uint32_t sample_rate() const override { return 48000; }
+  uint64_t total_pcm_frame_count() const override { return frame_amount_; }
+
+  size_t read( float* output, size_t frame_amount ) override {
+    size_t const amount = size_t( std::min< uint64_t >( { frame_amount, max_read_frames_, frame_amount_ - position_ } ) );
+    for( size_t i = 0; i < amount * channels_; i++ ) {
+      output[i] = float( ( position_ * channels_ ) + i );
+    }
+    position_ += amount;
+    return amount;
+  }
+
+  bool rewind() override {
+    position_ = 0;
+    return true;
+  }
+
+  private:
+  uint32_t channels_;
+  uint64_t frame_amount_;
+  size_t max_read_frames_;
+  uint64_t position_ = 0;
+};
+
+// reads in random sizes, with a pause now and then so the decoder both waits for space and runs ahead. returns if every sample came in order
+bool read_and_check( ThreadedAudioStream& stream, uint64_t first_frame, std::default_random_engine& random_engine ) {
+  std::uniform_int_distribution< size_t > read_dist( 1, 5000 );
+  std::uniform_int_distribution< int > pause_dist( 0, 15 );
+  uint32_t const channels = stream.channels();
+  std::vector< float > output;
+  uint64_t position = first_frame;
+  while( true ) {
+    size_t const frame_amount = read_dist( random_engine );
+    output.assign( frame_amount * channels, -1.0f );
+    size_t const read_amount = stream.read( output.data(), frame_amount );
+    for( size_t i = 0; i < read_amount * channels; i++ ) {
+      if( output[i] != float( ( position * channels ) + i ) ) {
+        spdlog::error( "[read_and_check] sample {} of frame {}: {}", i, position, output[i] );
+        return false;
+      }
+    }
+    position += read_amount;
+    // only the end reads short
+    if( read_amount < frame_amount ) {
+      break;
+    }
+    if( pause_dist( random_engine ) == 0 ) {
+      std::this_thread::sleep_for( std::chrono::microseconds( 200 ) );
+    }
+  }
+  if( ( position != stream.total_pcm_frame_count() ) || ( stream.read( output.data(), 1 ) != 0 ) ) {
+    spdlog::error( "[read_and_check] ended at frame {} of {}", position, stream.total_pcm_frame_count() );
+    return false;
+  }
+  return true;
+}
+
+bool order_test( uint32_t channels, uint64_t frame_amount, size_t max_read_frames, size_t buffer_frames ) {
+  std::default_random_engine random_engine( 1337 );
+  ThreadedAudioStream stream( std::make_unique< CountingStream >( channels, frame_amount, max_read_frames ), buffer_frames );
+  bool const passed = ( stream.channels() == channels ) && ( stream.sample_rate() == 48000 ) && read_and_check( stream, 0, random_engine );
+
+  if( passed ) {
+    spdlog::info( "[order_test] passed: channels: {}, frame_amount: {}, max_read_frames: {}, buffer_frames: {}",
+                  channels,
+                  frame_amount,
+                  max_read_frames,
+                  buffer_frames );
+  } else {
+    spdlog::error( "[order_test] failed: channels: {}, frame_amount: {}, max_read_frames: {}, buffer_frames: {}",
+                   channels,
+                   frame_amount,
+                   max_read_frames,
+                   buffer_frames );
+  }
+  return passed;
+}
+
+// rewinding in the middle and at the end starts over from the first frame
+bool rewind_test() {
+  std::default_random_engine random_engine( 42 );
+  ThreadedAudioStream stream( std::make_unique< CountingStream >( 2, 100000, 1000 ), 4096 );
+  std::vector< float > output( 30000 * 2 );
+  bool passed = stream.read( output.data(), 30000 ) == 30000;
+  passed &= stream.rewind() && read_and_check( stream, 0, random_engine );
+  passed &= stream.rewind() && read_and_check( stream, 0, random_engine );
+
+  if( passed ) {
+    spdlog::info( "[rewind_test] passed" );
+  } else {
+    spdlog::error( "[rewind_test] failed" );
+  }
+  return passed;
+}
+
+// the decoder waiting on a full buffer must not keep the stream from being destroyed
+bool abandon_test() {
+  {
+    ThreadedAudioStream stream( std::make_unique< CountingStream >( 2, 1000000, 1000 ), 4096 );
+    std::this_thread::sleep_for( std::chrono::milliseconds( 10 ) );
+  }
+  {
+    ThreadedAudioStream stream( std::make_unique< CountingStream >( 1, 1000000, 1000 ), 4096 );
+    std::vector< float > output( 10000 );
+    stream.read( output.data(), output.size() );
+  }
+  spdlog::info( "[abandon_test] passed" );
+  return true;
+}
+
+int main() {
+  bool passed = true;
+  passed &= order_test( 1, 0, 1000, 4096 );
+  passed &= order_test( 1, 1, 1000, 1 );
+  passed &= order_test( 2, 100000, 1000, 7 );
+  passed &= order_test( 2, 100000, 100000, 4096 );
+  passed &= order_test( 6, 250007, 1153, 65536 );
+  passed &= order_test( 2, 300000, 1000000, 1000000 );
+  passed &= rewind_test();
+  passed &= abandon_test();
+  return passed ? 0 : 1;
+}
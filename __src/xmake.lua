@@ -22,6 +22,9 @@ add_requireconfs( "*", { configs = { shared = get_config( "kind" ) == "shared" }
 
 add_requires( "cairo" )
 add_requires( "dr_wav" )
+add_requires( "dr_flac" )
+add_requires( "dr_mp3" )
+add_requires( "stb" )
 add_requires( "vcpkg::iir1", { alias = "iir1" } )
 add_requires( "vcpkg::fftw3", { alias = "fftw3" } )
 add_requires( "spdlog" )
@@ -42,6 +45,9 @@ target( "Video-Frame-Generator" )
 
   add_packages( "cairo", { public = true } )
   add_packages( "dr_wav", { public = true } )
+  add_packages( "dr_flac", { public = true } )
+  add_packages( "dr_mp3", { public = true } )
+  add_packages( "stb", { public = true } )
   add_packages( "iir1", { public = true } )
   add_packages( "fftw3", { public = true } )
   add_packages( "spdlog", { public = true } )
@@ -50,4 +56,263 @@ target( "Video-Frame-Generator" )
 
   add_headerfiles( "include/(*.h)" )
 
-  add_files( "src/*.cpp" )
+  -- the goertzel bank loses to the fft for every consumer of the generators, it is only built for Test-Goertzel-Bank
+  add_files( "src/*.cpp|goertzelBank.cpp" )
+
+target( "Test-Parallel-Scan" )
+  set_kind( "binary" )
+  set_encodings( "utf-8" )
+
+  set_default( false )
+  set_group( "TESTS" )
+
+  add_packages( "spdlog", { public = true } )
+
+  add_includedirs( "include", { public = true } )
+
+  add_files( "test/parallel_scan.cpp" )
+  add_files( "src/parallelScan.cpp" )
+
+target( "Test-Biquad-Cascade" )
+  set_kind( "binary" )
+  set_encodings( "utf-8" )
+
+  set_default( false )
+  set_group( "TESTS" )
+
+  add_packages( "iir1", { public = true } )
+  add_packages( "spdlog", { public = true } )
+
+  add_includedirs( "include", { public = true } )
+
+  add_files( "test/biquad_cascade.cpp" )
+  add_files( "src/biquadCascade.cpp" )
+
+target( "Test-FFT-Batch" )
+  set_kind( "binary" )
+  set_encodings( "utf-8" )
+
+  set_default( false )
+  set_group( "TESTS" )
+
+  add_packages( "fftw3", { public = true } )
+  add_packages( "spdlog", { public = true } )
+
+  add_includedirs( "include", { public = true } )
+
+  add_files( "test/fft_batch.cpp" )
+  add_files( "src/spectralKernels.cpp" )
+
+target( "Test-STFT" )
+  set_kind( "binary" )
+  set_encodings( "utf-8" )
+
+  set_default( false )
+  set_group( "TESTS" )
+
+  add_packages( "spdlog", { public = true } )
+
+  add_includedirs( "include", { public = true } )
+
+  add_files( "test/stft.cpp" )
+  add_files( "src/downmix.cpp" )
+  add_files( "src/stft.cpp" )
+  add_files( "src/window_functions.cpp" )
+
+target( "Test-Goertzel-Bank" )
+  set_kind( "binary" )
+  set_encodings( "utf-8" )
+
+  set_default( false )
+  set_group( "TESTS" )
+
+  add_packages( "fftw3", { public = true } )
+  add_packages( "spdlog", { public = true } )
+
+  add_includedirs( "include", { public = true } )
+
+  add_files( "test/goertzel_bank.cpp" )
+  add_files( "src/goertzelBank.cpp" )
+  add_files( "src/spectralKernels.cpp" )
+  add_files( "src/window_functions.cpp" )
+
+target( "Test-Constant-Q" )
+  set_kind( "binary" )
+  set_encodings( "utf-8" )
+
+  set_default( false )
+  set_group( "TESTS" )
+
+  add_packages( "fftw3", { public = true } )
+  add_packages( "spdlog", { public = true } )
+
+  add_includedirs( "include", { public = true } )
+
+  add_files( "test/constant_q.cpp" )
+  add_files( "src/_fftw.cpp" )
+  add_files( "src/constantQ.cpp" )
+  add_files( "src/fftwPlanRegistry.cpp" )
+  add_files( "src/loggerFactory.cpp" )
+  add_files( "src/spectralKernels.cpp" )
+  add_files( "src/window_functions.cpp" )
+
+target( "Test-Filterbank" )
+  set_kind( "binary" )
+  set_encodings( "utf-8" )
+
+  set_default( false )
+  set_group( "TESTS" )
+
+  add_packages( "fftw3", { public = true } )
+  add_packages( "spdlog", { public = true } )
+
+  add_includedirs( "include", { public = true } )
+
+  add_files( "test/filterbank.cpp" )
+  add_files( "src/_fftw.cpp" )
+  add_files( "src/filterbank.cpp" )
+  add_files( "src/logBinning.cpp" )
+  add_files( "src/spectralKernels.cpp" )
+
+target( "Test-Multi-Resolution" )
+  set_kind( "binary" )
+  set_encodings( "utf-8" )
+
+  set_default( false )
+  set_group( "TESTS" )
+
+  add_packages( "fftw3", { public = true } )
+  add_packages( "spdlog", { public = true } )
+
+  add_includedirs( "include", { public = true } )
+
+  add_files( "test/multi_resolution.cpp" )
+  add_files( "src/_fftw.cpp" )
+  add_files( "src/downmix.cpp" )
+  add_files( "src/fftwPlanRegistry.cpp" )
+  add_files( "src/logBinning.cpp" )
+  add_files( "src/loggerFactory.cpp" )
+  add_files( "src/multiResolutionStft.cpp" )
+  add_files( "src/multirate.cpp" )
+  add_files( "src/spectralKernels.cpp" )
+  add_files( "src/stft.cpp" )
+  add_files( "src/window_functions.cpp" )
+
+target( "Test-Spectral-Kernels" )
+  set_kind( "binary" )
+  set_encodings( "utf-8" )
+
+  set_default( false )
+  set_group( "TESTS" )
+
+  add_packages( "fftw3", { public = true } )
+  add_packages( "spdlog", { public = true } )
+
+  add_includedirs( "include", { public = true } )
+
+  add_files( "test/spectral_kernels.cpp" )
+  add_files( "src/spectralKernels.cpp" )
+
+target( "Test-Analysis-Cache" )
+  set_kind( "binary" )
+  set_encodings( "utf-8" )
+
+  set_default( false )
+  set_group( "TESTS" )
+
+  add_packages( "spdlog", { public = true } )
+
+  add_includedirs( "include", { public = true } )
+
+  add_files( "test/analysis_cache.cpp" )
+  add_files( "src/analysisCache.cpp" )
+  add_files( "src/mappedFile.cpp" )
+
+target( "Test-Multirate" )
+  set_kind( "binary" )
+  set_encodings( "utf-8" )
+
+  set_default( false )
+  set_group( "TESTS" )
+
+  add_packages( "spdlog", { public = true } )
+
+  add_includedirs( "include", { public = true } )
+
+  add_files( "test/multirate.cpp" )
+  add_files( "src/multirate.cpp" )
+  add_files( "src/window_functions.cpp" )
+
+target( "Test-Mapped-Wav-File" )
+  set_kind( "binary" )
+  set_encodings( "utf-8" )
+
+  set_default( false )
+  set_group( "TESTS" )
+
+  add_packages( "spdlog", { public = true } )
+
+  add_includedirs( "include", { public = true } )
+
+  add_files( "test/mapped_wav_file.cpp" )
+  add_files( "src/downmix.cpp" )
+  add_files( "src/mappedFile.cpp" )
+  add_files( "src/mappedWavFile.cpp" )
+
+target( "Test-Threaded-Audio-Stream" )
+  set_kind( "binary" )
+  set_encodings( "utf-8" )
+
+  set_default( false )
+  set_group( "TESTS" )
+
+  add_packages( "dr_wav", { public = true } )
+  add_packages( "dr_flac", { public = true } )
+  add_packages( "dr_mp3", { public = true } )
+  add_packages( "stb", { public = true } )
+  add_packages( "spdlog", { public = true } )
+
+  add_includedirs( "include", { public = true } )
+
+  add_files( "test/threaded_audio_stream.cpp" )
+  add_files( "src/_dr_flac.cpp" )
+  add_files( "src/_dr_mp3.cpp" )
+  add_files( "src/_dr_wav.cpp" )
+  add_files( "src/_stb_vorbis.cpp" )
+  add_files( "src/audioStream.cpp" )
+  add_files( "src/downmix.cpp" )
+  add_files( "src/mappedFile.cpp" )
+  add_files( "src/mappedWavFile.cpp" )
+
+target( "Test-Mag-Db-Normalizer" )
+  set_kind( "binary" )
+  set_encodings( "utf-8" )
+
+  set_default( false )
+  set_group( "TESTS" )
+
+  add_packages( "spdlog", { public = true } )
+
+  add_includedirs( "include", { public = true } )
+
+  add_files( "test/mag_db_normalizer.cpp" )
+  add_files( "src/magDbNormalizer.cpp" )
+
+target( "Test-Onset-Detector" )
+  set_kind( "binary" )
+  set_encodings( "utf-8" )
+
+  set_default( false )
+  set_group( "TESTS" )
+
+  add_packages( "fftw3", { public = true } )
+  add_packages( "spdlog", { public = true } )
+
+  add_includedirs( "include", { public = true } )
+
+  add_files( "test/onset_detector.cpp" )
+  add_files( "src/downmix.cpp" )
+  add_files( "src/onsetDetector.cpp" )
+  add_files( "src/spectralKernels.cpp" )
+  add_files( "src/stft.cpp" )
+  add_files( "src/window_functions.cpp" )